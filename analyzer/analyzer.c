@@ -44,6 +44,26 @@ suscan_analyzer_is_local(const suscan_analyzer_t *self)
 {
   return SU_FALSE;
 }
+
+unsigned int
+suscan_analyzer_get_source_count(const suscan_analyzer_t *self)
+{
+  return 1;
+}
+
+SUBOOL
+suscan_analyzer_get_source_freq(
+  const suscan_analyzer_t *self,
+  unsigned int index,
+  SUFREQ *freq)
+{
+  if (index != 0)
+    return SU_FALSE;
+
+  *freq = suscan_analyzer_get_source_info(self)->frequency;
+
+  return SU_TRUE;
+}
 #endif /* SUSCAN_THIN_CLIENT */
 
 const struct suscan_analyzer_interface *
@@ -338,7 +358,47 @@ suscan_analyzer_new(
     return NULL;
   }
 
-  return suscan_analyzer_new_from_interface(params, mq, iface, config);
+  /* Single-source analyzer: no auxiliary sources */
+  return suscan_analyzer_new_from_interface(params, mq, iface, config, NULL, 0);
+}
+
+suscan_analyzer_t *
+suscan_analyzer_new_multi(
+    const struct suscan_analyzer_params *params,
+    suscan_source_config_t **config_list,
+    unsigned int config_count,
+    struct suscan_mq *mq)
+{
+  const char *iname;
+  const struct suscan_analyzer_interface *iface;
+  unsigned int i;
+
+  if (config_count == 0) {
+    SU_ERROR("No sources given to multi-source analyzer\n");
+    return NULL;
+  }
+
+  for (i = 0; i < config_count; ++i) {
+    iname = suscan_source_config_get_interface(config_list[i]);
+    if (strcmp(iname, SUSCAN_SOURCE_LOCAL_INTERFACE) != 0) {
+      SU_ERROR("Multi-source analyzers only support local sources\n");
+      return NULL;
+    }
+  }
+
+  iface = suscan_analyzer_interface_lookup(SUSCAN_SOURCE_LOCAL_INTERFACE);
+  if (iface == NULL) {
+    SU_ERROR("Local analyzer interface not available\n");
+    return NULL;
+  }
+
+  return suscan_analyzer_new_from_interface(
+    params,
+    mq,
+    iface,
+    config_list[0],
+    config_list + 1,
+    config_count - 1);
 }
 
 void
@@ -543,6 +603,14 @@ suscan_analyzer_set_buffering_size(suscan_analyzer_t *self, SUSCOUNT size)
   return (self->iface->set_buffering_size) (self->impl, size);
 }
 
+SUBOOL
+suscan_analyzer_set_max_revisit_interval(
+    suscan_analyzer_t *self,
+    SUFLOAT seconds)
+{
+  return (self->iface->set_max_revisit_interval) (self->impl, seconds);
+}
+
 SUBOOL
 suscan_analyzer_set_inspector_freq_overridable(
     suscan_analyzer_t *self,
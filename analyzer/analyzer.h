@@ -53,6 +53,7 @@ extern "C" {
 #define SUSCAN_ANALYZER_SLOW_READ_SIZE        32
 #define SUSCAN_ANALYZER_FAST_READ_SIZE        1024
 #define SUSCAN_ANALYZER_MIN_POST_HOP_FFTS     7
+#define SUSCAN_ANALYZER_MAX_REVISIT_INTERVAL  2.
 
 struct suscan_analyzer;
 
@@ -102,6 +103,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_params) {
 enum suscan_analyzer_sweep_strategy {
   SUSCAN_ANALYZER_SWEEP_STRATEGY_STOCHASTIC,
   SUSCAN_ANALYZER_SWEEP_STRATEGY_PROGRESSIVE,
+  SUSCAN_ANALYZER_SWEEP_STRATEGY_ADAPTIVE,
 };
 
 /*!
@@ -133,6 +135,7 @@ struct suscan_analyzer_sweep_params {
   SUFREQ max_freq;
   SUFLOAT rel_bw;
   SUSCOUNT fft_min_samples; /* Minimum number of FFT frames before updating */
+  SUFLOAT max_revisit_int;  /* Max. time between visits (adaptive strategy) */
 };
 
 /*!
@@ -206,6 +209,7 @@ struct suscan_analyzer_interface {
   SUBOOL   (*set_hop_range) (void *, SUFREQ, SUFREQ);
   SUBOOL   (*set_rel_bandwidth) (void *, SUFLOAT);
   SUBOOL   (*set_buffering_size) (void *, SUSCOUNT);
+  SUBOOL   (*set_max_revisit_interval) (void *, SUFLOAT);
 
   /* Fast methods */
   SUBOOL   (*set_inspector_frequency) (void *, SUHANDLE, SUFREQ);
@@ -258,6 +262,26 @@ suscan_analyzer_t *suscan_analyzer_new(
     suscan_source_config_t *config,
     struct suscan_mq *mq);
 
+/*!
+ * Constructor for local, multi-source analyzers. The first source is the
+ * main source of the analyzer (the one that is used to compute the PSD and
+ * that can be retuned), the rest are auxiliary sources that are read in
+ * lockstep with it and channelized independently. All sources must have
+ * the same sample rate, and only channel mode is supported.
+ * \param params pointer to the analyzer parameters.
+ * \param config_list list of source configurations
+ * \param config_count number of source configurations (at least 1)
+ * \param mq pointer to the user-provided message queue that the analyzer
+ * object will use to store output messages.
+ * \return a pointer to the analyzer object, or NULL on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+suscan_analyzer_t *suscan_analyzer_new_multi(
+    const struct suscan_analyzer_params *params,
+    suscan_source_config_t **config_list,
+    unsigned int config_count,
+    struct suscan_mq *mq);
+
 /*!
  * Destroys the analyzer object, releasing its allocated resources.
  * \author Gonzalo José Carracedo Carballal
@@ -272,6 +296,28 @@ void suscan_analyzer_destroy(suscan_analyzer_t *analyzer);
  */
 SUBOOL suscan_analyzer_is_local(const suscan_analyzer_t *self);
 
+/*!
+ * Returns the number of sources of the analyzer (1 for single-source
+ * analyzers).
+ * \param self a pointer to the analyzer object
+ * \return the number of sources
+ * \author Gonzalo José Carracedo Carballal
+ */
+unsigned int suscan_analyzer_get_source_count(const suscan_analyzer_t *self);
+
+/*!
+ * Returns the tuner frequency of a given source of the analyzer.
+ * \param self a pointer to the analyzer object
+ * \param index source index (0 is the main source)
+ * \param freq pointer to the output frequency
+ * \return SU_TRUE for success or SU_FALSE if the source does not exist
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_get_source_freq(
+    const suscan_analyzer_t *self,
+    unsigned int index,
+    SUFREQ *freq);
+
 /******************************* Inlined methods ******************************/
 /*!
  * Is the analyzer running on top of a real-time source?
@@ -452,6 +498,18 @@ SUBOOL suscan_analyzer_set_rel_bandwidth(
     suscan_analyzer_t *self,
     SUFLOAT rel_bw);
 
+/*!
+ * In adaptive-strategy wideband analyzers, set the maximum time between
+ * two consecutive visits to the same segment of the sweep range.
+ * \param self a pointer to the analyzer object
+ * \param seconds maximum revisit interval, in seconds
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_max_revisit_interval(
+    suscan_analyzer_t *self,
+    SUFLOAT seconds);
+
 /*!
  * In wideband analyzers, set the sweep strategy.
  * \param self a pointer to the analyzer object
@@ -815,6 +873,44 @@ SUBOOL suscan_analyzer_replay_async(
     SUBOOL replay,
     uint32_t req_id);
 
+struct suscan_analyzer_psd_stats_params;
+
+/*!
+ * Configures the PSD statistics stage of channel analyzers. When enabled
+ * (i.e. update_int > 0), the analyzer delivers PSD_STATS messages with
+ * per-bin max, min, average, P50, P90 and occupancy every update_int
+ * seconds.
+ * \param analyzer a pointer to the analyzer object
+ * \param params statistics parameters
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE if the request was delivered, SU_FALSE otherwise
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_psd_stats_params_async(
+    suscan_analyzer_t *analyzer,
+    const struct suscan_analyzer_psd_stats_params *params,
+    uint32_t req_id);
+
+struct suscan_analyzer_cfar_params;
+
+/*!
+ * Configures the CFAR signal detector of channel analyzers. When enabled,
+ * every PSD frame is searched for channels, which are tracked across
+ * frames and delivered in CHANNEL messages every channel_update_int
+ * seconds. If params->auto_open is not NULL, an inspector of that class
+ * is opened on every new channel (up to params->max_open). Their OPEN
+ * responses carry a request ID in SUSCAN_ANALYZER_CFAR_REQ_ID_BASE.
+ * \param analyzer a pointer to the analyzer object
+ * \param params detector parameters
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE if the request was delivered, SU_FALSE otherwise
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_cfar_params_async(
+    suscan_analyzer_t *analyzer,
+    const struct suscan_analyzer_cfar_params *params,
+    uint32_t req_id);
+
 
 /*!
  * For seekable sources (e.g. file replay), sets the current read position
@@ -851,6 +947,28 @@ SUBOOL suscan_analyzer_open_ex_async(
     SUHANDLE parent,
     uint32_t req_id);
 
+/*!
+ * For multi-source channel analyzers, open a new inspector of a given class
+ * at a given frequency of a given source (asynchronous). Handles of the
+ * inspectors of all sources belong to the same handle space.
+ * \param analyzer pointer to the analyzer object
+ * \param source source index (0 is the main source)
+ * \param classname inspector class name
+ * \param channel pointer to the channel structure describing the inspector
+ * frequency and bandwidth, relative to the tuner frequency of the source
+ * \param precise whether to use precise channel centering
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_open_on_source_async(
+    suscan_analyzer_t *analyzer,
+    unsigned int source,
+    const char *classname,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    uint32_t req_id);
+
 /*!
  * For channel analyzers, open a new inspector of a given class at a given
  * frequency (asynchronous). Equivalent to suscan_analyzer_open_ex_async(
@@ -1057,6 +1175,26 @@ SUBOOL suscan_analyzer_inspector_set_spectrum_async(
     uint32_t spectsrc_id,
     uint32_t req_id);
 
+/*!
+ * For channel analyzers, evaluate several spectrum sources of the same
+ * inspector at once (asynchronous). Enabled sources share the windowing
+ * and FFT of the inspector stream, and their updates are reported with
+ * their own spectrum source index. A non-zero mask takes precedence over
+ * the source selected with suscan_analyzer_inspector_set_spectrum_async.
+ * \param analyzer pointer to the analyzer object
+ * \param handle inspector handle
+ * \param spectsrc_mask bitmask of spectrum sources, bit n enabling the
+ * source with index n + 1. 0 to disable
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_inspector_set_spectrum_mask_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    uint32_t spectsrc_mask,
+    uint32_t req_id);
+
 /*!
  * For channel analyzers, configure the Doppler correction of a satellital
  * signal by providing the orbital parameters of the source (asynchronous).
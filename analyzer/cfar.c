@@ -0,0 +1,389 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cfar"
+
+#include <string.h>
+#include <analyzer/cfar.h>
+#include <analyzer/psdstats.h>
+
+void
+suscan_cfar_destroy(suscan_cfar_t *self)
+{
+  if (self->frame != NULL)
+    free(self->frame);
+
+  if (self->noise != NULL)
+    free(self->noise);
+
+  if (self->scratch != NULL)
+    free(self->scratch);
+
+  if (self->cumsum != NULL)
+    free(self->cumsum);
+
+  if (self->segment_list != NULL)
+    free(self->segment_list);
+
+  free(self);
+}
+
+suscan_cfar_t *
+suscan_cfar_new(
+  const struct suscan_analyzer_cfar_params *params,
+  SUSCOUNT size,
+  SUFLOAT samp_rate)
+{
+  suscan_cfar_t *new = NULL;
+
+  SU_TRYCATCH(size > 0, goto fail);
+  SU_TRYCATCH(samp_rate > 0, goto fail);
+  SU_TRYCATCH(params->ref > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_cfar_t);
+
+  new->params           = *params;
+  new->params.auto_open = NULL;
+  new->size             = size;
+  new->samp_rate        = samp_rate;
+
+  new->k_on    = SU_POWER_MAG_RAW(params->on_db);
+  new->k_off   = SU_POWER_MAG_RAW(params->off_db);
+  new->k_floor = SU_POWER_MAG_RAW(SUSCAN_CFAR_FLOOR_MARGIN_DB);
+
+  SU_ALLOCATE_MANY_FAIL(new->frame,   size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->noise,   size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->scratch, size + 2 * params->ref, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->cumsum,  size + 1, SUDOUBLE);
+
+  /* Segments are separated by at least one bin */
+  SU_ALLOCATE_MANY_FAIL(
+    new->segment_list,
+    size / 2 + 1,
+    struct suscan_cfar_segment);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_cfar_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_cfar_reset(suscan_cfar_t *self)
+{
+  self->track_count  = 0;
+  self->report_count = 0;
+  self->frames       = 0;
+}
+
+/*
+ * Noise level of every bin. CA needs just a cumulative sum of the frame,
+ * so its cost does not depend on the number of reference cells.
+ */
+SUPRIVATE void
+suscan_cfar_estimate_noise(suscan_cfar_t *self, SUFLOAT floor)
+{
+  SUSDIFF size  = self->size;
+  SUSDIFF guard = self->params.guard;
+  SUSDIFF ref   = self->params.ref;
+  SUSDIFF i, k, ls, le, rs, re, n, p;
+  SUFLOAT limit = self->k_floor * floor;
+  SUFLOAT level;
+
+  if (self->params.mode == SUSCAN_ANALYZER_CFAR_MODE_CA) {
+    self->cumsum[0] = 0;
+    for (i = 0; i < size; ++i)
+      self->cumsum[i + 1] = self->cumsum[i] + self->frame[i];
+  }
+
+  for (k = 0; k < size; ++k) {
+    /* Reference windows: [ls, le) and [rs, re) */
+    le = SU_MAX(k - guard, 0);
+    ls = SU_MAX(k - guard - ref, 0);
+    rs = SU_MIN(k + guard + 1, size);
+    re = SU_MIN(k + guard + ref + 1, size);
+    n  = (le - ls) + (re - rs);
+
+    if (n == 0) {
+      level = limit;
+    } else if (self->params.mode == SUSCAN_ANALYZER_CFAR_MODE_CA) {
+      level = ((self->cumsum[le] - self->cumsum[ls])
+        + (self->cumsum[re] - self->cumsum[rs])) / n;
+    } else {
+      p = 0;
+      for (i = ls; i < le; ++i)
+        self->scratch[p++] = self->frame[i];
+      for (i = rs; i < re; ++i)
+        self->scratch[p++] = self->frame[i];
+
+      level = suscan_psd_select(self->scratch, n, (3 * n) / 4);
+    }
+
+    self->noise[k] = SU_MIN(level, limit);
+  }
+}
+
+SUPRIVATE void
+suscan_cfar_commit_segment(suscan_cfar_t *self)
+{
+  struct suscan_cfar_segment *seg = self->segment_list + self->segment_count;
+  struct suscan_cfar_segment *prev;
+
+  if (self->segment_count > 0) {
+    prev = seg - 1;
+
+    if (seg->lo - prev->hi - 1 <= self->params.merge_gap) {
+      prev->hi      = seg->hi;
+      prev->bins   += seg->bins;
+      prev->noise  += seg->noise;
+      prev->weight += seg->weight;
+      prev->moment += seg->moment;
+      if (seg->peak > prev->peak)
+        prev->peak = seg->peak;
+      return;
+    }
+  }
+
+  ++self->segment_count;
+}
+
+/* Runs of bins above off_db that contain at least one bin above on_db */
+SUPRIVATE void
+suscan_cfar_find_segments(suscan_cfar_t *self)
+{
+  struct suscan_cfar_segment *seg = NULL;
+  SUSCOUNT k;
+  SUFLOAT x, n, excess;
+  SUBOOL in_run = SU_FALSE;
+  SUBOOL seeded = SU_FALSE;
+
+  self->segment_count = 0;
+
+  for (k = 0; k < self->size; ++k) {
+    x = self->frame[k];
+    n = self->noise[k];
+
+    if (x > self->k_off * n) {
+      if (!in_run) {
+        seg = self->segment_list + self->segment_count;
+        memset(seg, 0, sizeof(struct suscan_cfar_segment));
+        seg->lo = k;
+        in_run  = SU_TRUE;
+        seeded  = SU_FALSE;
+      }
+
+      excess = x - n;
+
+      seg->hi      = k;
+      seg->bins   += 1;
+      seg->noise  += n;
+      seg->weight += excess;
+      seg->moment += excess * k;
+      if (x > seg->peak)
+        seg->peak = x;
+
+      if (x > self->k_on * n)
+        seeded = SU_TRUE;
+    } else if (in_run) {
+      in_run = SU_FALSE;
+      if (seeded)
+        suscan_cfar_commit_segment(self);
+    }
+  }
+
+  if (in_run && seeded)
+    suscan_cfar_commit_segment(self);
+}
+
+SUPRIVATE void
+suscan_cfar_segment_to_channel(
+  const suscan_cfar_t *self,
+  const struct suscan_cfar_segment *seg,
+  struct sigutils_channel *channel)
+{
+  SUFLOAT df = self->samp_rate / self->size;
+  SUFLOAT h  = self->size / 2;
+
+  memset(channel, 0, sizeof(struct sigutils_channel));
+
+  channel->f_lo = (seg->lo - h - .5) * df;
+  channel->f_hi = (seg->hi - h + .5) * df;
+  channel->bw   = channel->f_hi - channel->f_lo;
+
+  /* Power centroid */
+  if (seg->weight > 0)
+    channel->fc = (seg->moment / seg->weight - h) * df;
+  else
+    channel->fc = .5 * (channel->f_lo + channel->f_hi);
+
+  channel->S0  = SU_POWER_DB_RAW(seg->peak + SUFLOAT_THRESHOLD);
+  channel->N0  = SU_POWER_DB_RAW(seg->noise / seg->bins + SUFLOAT_THRESHOLD);
+  channel->snr = channel->S0 - channel->N0;
+}
+
+SUPRIVATE struct suscan_cfar_track *
+suscan_cfar_match_track(
+  suscan_cfar_t *self,
+  const struct sigutils_channel *channel)
+{
+  struct suscan_cfar_track *track, *best = NULL;
+  SUFLOAT overlap, best_overlap = 0;
+  unsigned int i;
+
+  for (i = 0; i < self->track_count; ++i) {
+    track = self->track_list + i;
+    if (track->matched)
+      continue;
+
+    overlap = SU_MIN(channel->f_hi, track->channel.f_hi)
+      - SU_MAX(channel->f_lo, track->channel.f_lo);
+
+    if (overlap > best_overlap) {
+      best_overlap = overlap;
+      best = track;
+    }
+  }
+
+  return best;
+}
+
+SUPRIVATE void
+suscan_cfar_update_track(
+  suscan_cfar_t *self,
+  struct suscan_cfar_track *track,
+  const struct sigutils_channel *channel)
+{
+  struct sigutils_channel *ch = &track->channel;
+  SUFLOAT alpha = SUSCAN_CFAR_TRACK_ALPHA;
+
+  ch->fc   += alpha * (channel->fc   - ch->fc);
+  ch->f_lo += alpha * (channel->f_lo - ch->f_lo);
+  ch->f_hi += alpha * (channel->f_hi - ch->f_hi);
+  ch->S0   += alpha * (channel->S0   - ch->S0);
+  ch->N0   += alpha * (channel->N0   - ch->N0);
+  ch->bw    = ch->f_hi - ch->f_lo;
+  ch->snr   = ch->S0 - ch->N0;
+
+  ++track->hits;
+  ch->present    = track->hits;
+  track->misses  = 0;
+  track->matched = SU_TRUE;
+
+  if (!track->confirmed && track->hits >= self->params.confirm)
+    track->confirmed = track->fresh = SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_cfar_update_tracks(suscan_cfar_t *self)
+{
+  struct sigutils_channel channel;
+  struct suscan_cfar_segment *seg;
+  struct suscan_cfar_track *track;
+  unsigned int i;
+
+  for (i = 0; i < self->track_count; ++i)
+    self->track_list[i].matched = self->track_list[i].fresh = SU_FALSE;
+
+  for (i = 0; i < self->segment_count; ++i) {
+    seg = self->segment_list + i;
+
+    if (seg->hi - seg->lo + 1 < self->params.min_bins)
+      continue;
+
+    suscan_cfar_segment_to_channel(self, seg, &channel);
+
+    if ((track = suscan_cfar_match_track(self, &channel)) != NULL) {
+      suscan_cfar_update_track(self, track, &channel);
+    } else if (self->track_count < SUSCAN_CFAR_MAX_TRACKS) {
+      track = self->track_list + self->track_count++;
+      memset(track, 0, sizeof(struct suscan_cfar_track));
+
+      track->channel = channel;
+      track->id      = self->next_id++;
+      track->hits    = 1;
+      track->matched = SU_TRUE;
+      track->channel.present = 1;
+
+      if (self->params.confirm <= 1)
+        track->confirmed = track->fresh = SU_TRUE;
+    }
+  }
+
+  /* Expire tracks that were missed for too long */
+  i = 0;
+  while (i < self->track_count) {
+    track = self->track_list + i;
+    ++track->channel.age;
+
+    if (!track->matched && ++track->misses > self->params.hold) {
+      *track = self->track_list[--self->track_count];
+      continue;
+    }
+
+    ++i;
+  }
+
+  self->report_count = 0;
+  for (i = 0; i < self->track_count; ++i)
+    if (self->track_list[i].confirmed)
+      self->report_list[self->report_count++] = &self->track_list[i].channel;
+}
+
+SUBOOL
+suscan_cfar_feed(suscan_cfar_t *self, const SUFLOAT *psd, SUSCOUNT size)
+{
+  SUSCOUNT h = size / 2;
+  SUFLOAT floor;
+
+  if (size != self->size) {
+    SU_ERROR(
+      "PSD size mismatch (expected %lu, got %lu)\n",
+      (unsigned long) self->size,
+      (unsigned long) size);
+    return SU_FALSE;
+  }
+
+  /* Negative frequencies first */
+  memcpy(self->frame, psd + size - h, h * sizeof(SUFLOAT));
+  memcpy(self->frame + h, psd, (size - h) * sizeof(SUFLOAT));
+
+  memcpy(self->scratch, self->frame, size * sizeof(SUFLOAT));
+  floor = suscan_psd_select(self->scratch, size, size / 2);
+
+  suscan_cfar_estimate_noise(self, floor);
+  suscan_cfar_find_segments(self);
+  suscan_cfar_update_tracks(self);
+
+  ++self->frames;
+
+  return SU_TRUE;
+}
+
+void
+suscan_cfar_get_channel_list(
+  suscan_cfar_t *self,
+  struct sigutils_channel ***list,
+  unsigned int *count)
+{
+  *list  = self->report_list;
+  *count = self->report_count;
+}
@@ -0,0 +1,148 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_CFAR_H
+#define _ANALYZER_CFAR_H
+
+#include <sigutils/sigutils.h>
+#include <sigutils/detect.h>
+#include <analyzer/msg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_CFAR_MAX_TRACKS      256
+#define SUSCAN_CFAR_TRACK_ALPHA     .25
+#define SUSCAN_CFAR_FLOOR_MARGIN_DB 3
+
+/*
+ * A channel followed across PSD frames. Frequencies are relative to the
+ * center frequency, levels are in dB. age is the number of frames since
+ * the channel was first seen, present the number of frames in which
+ * it was actually detected.
+ */
+struct suscan_cfar_track {
+  struct sigutils_channel channel;
+  uint32_t     id;
+  unsigned int hits;
+  unsigned int misses;
+  SUBOOL       matched;
+  SUBOOL       confirmed;
+  SUBOOL       fresh;   /* Confirmed in the last frame */
+};
+
+/* Run of adjacent bins above the detection threshold */
+struct suscan_cfar_segment {
+  SUSCOUNT lo;
+  SUSCOUNT hi;
+  SUSCOUNT bins;   /* Detected bins, excluding merged gaps */
+  SUFLOAT  peak;
+  SUFLOAT  noise;  /* Sum of the noise estimates of all bins */
+  SUFLOAT  weight; /* Sum of the excess power over the noise */
+  SUFLOAT  moment; /* Same, weighted by bin index */
+};
+
+/*
+ * CFAR signal detector. It works on FFT-ordered PSD frames (as delivered
+ * by smoothpsd). For every bin, the noise level is estimated from the
+ * reference cells around it, either by averaging them (CA) or by taking
+ * their upper quartile (OS), and limited to a few dB above the frame
+ * median, so that wide channels cannot mask themselves.
+ *
+ * Bins above on_db start a detection, which extends to the adjacent bins
+ * above off_db. Detections are matched by overlap to the tracks of
+ * the previous frame. A track is reported once it was detected in
+ * confirm frames, and kept until it is missed for more than hold frames.
+ */
+struct suscan_cfar {
+  struct suscan_analyzer_cfar_params params; /* auto_open is not kept */
+  SUSCOUNT size;
+  SUFLOAT  samp_rate;
+  SUFLOAT  k_on;
+  SUFLOAT  k_off;
+  SUFLOAT  k_floor;
+  uint64_t frames;
+  uint32_t next_id;
+
+  SUFLOAT  *frame;   /* Shifted PSD, negative frequencies first */
+  SUFLOAT  *noise;
+  SUFLOAT  *scratch;
+  SUDOUBLE *cumsum;
+
+  struct suscan_cfar_segment *segment_list;
+  unsigned int segment_count;
+
+  struct suscan_cfar_track track_list[SUSCAN_CFAR_MAX_TRACKS];
+  unsigned int track_count;
+
+  struct sigutils_channel *report_list[SUSCAN_CFAR_MAX_TRACKS];
+  unsigned int report_count;
+};
+
+typedef struct suscan_cfar suscan_cfar_t;
+
+suscan_cfar_t *suscan_cfar_new(
+    const struct suscan_analyzer_cfar_params *params,
+    SUSCOUNT size,
+    SUFLOAT samp_rate);
+
+/* Forget all tracks, e.g. after a retune */
+void suscan_cfar_reset(suscan_cfar_t *self);
+
+/* psd is given in linear units, its size must match the size of self */
+SUBOOL suscan_cfar_feed(suscan_cfar_t *self, const SUFLOAT *psd, SUSCOUNT size);
+
+SUINLINE SUSCOUNT
+suscan_cfar_get_size(const suscan_cfar_t *self)
+{
+  return self->size;
+}
+
+SUINLINE SUFLOAT
+suscan_cfar_get_samp_rate(const suscan_cfar_t *self)
+{
+  return self->samp_rate;
+}
+
+SUINLINE unsigned int
+suscan_cfar_get_track_count(const suscan_cfar_t *self)
+{
+  return self->track_count;
+}
+
+SUINLINE const struct suscan_cfar_track *
+suscan_cfar_get_track(const suscan_cfar_t *self, unsigned int index)
+{
+  return self->track_list + index;
+}
+
+/* Confirmed channels, valid until the next call to suscan_cfar_feed */
+void suscan_cfar_get_channel_list(
+    suscan_cfar_t *self,
+    struct sigutils_channel ***list,
+    unsigned int *count);
+
+void suscan_cfar_destroy(suscan_cfar_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_CFAR_H */
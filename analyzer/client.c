@@ -206,10 +206,81 @@ done:
   return ok;
 }
 
-/****************************** Inspector methods ****************************/
 SUBOOL
-suscan_analyzer_open_ex_async(
+suscan_analyzer_set_psd_stats_params_async(
     suscan_analyzer_t *analyzer,
+    const struct suscan_analyzer_psd_stats_params *params,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_psd_stats_params *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      msg = malloc(sizeof(struct suscan_analyzer_psd_stats_params)),
+      goto done);
+
+  *msg = *params;
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS,
+      msg)) {
+    SU_ERROR("Failed to send PSD statistics parameters\n");
+    goto done;
+  }
+
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    free(msg);
+
+  return ok;
+}
+
+SUBOOL
+suscan_analyzer_set_cfar_params_async(
+    suscan_analyzer_t *analyzer,
+    const struct suscan_analyzer_cfar_params *params,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_cfar_params *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      msg = calloc(1, sizeof(struct suscan_analyzer_cfar_params)),
+      goto done);
+
+  SU_TRYCATCH(suscan_analyzer_cfar_params_copy(msg, params), goto done);
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS,
+      msg)) {
+    SU_ERROR("Failed to send CFAR detector parameters\n");
+    goto done;
+  }
+
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL) {
+    suscan_analyzer_cfar_params_finalize(msg);
+    free(msg);
+  }
+
+  return ok;
+}
+
+/****************************** Inspector methods ****************************/
+SUPRIVATE SUBOOL
+suscan_analyzer_open_source_ex_async(
+    suscan_analyzer_t *analyzer,
+    unsigned int source,
     const char *class,
     const struct sigutils_channel *channel,
     SUBOOL precise,
@@ -230,6 +301,7 @@ suscan_analyzer_open_ex_async(
   req->channel = *channel;
   req->precise = precise;
   req->handle  = parent;
+  req->source  = source;
 
   if (!suscan_analyzer_write(
       analyzer,
@@ -250,6 +322,49 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_open_ex_async(
+    suscan_analyzer_t *analyzer,
+    const char *class,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    SUHANDLE parent,
+    uint32_t req_id)
+{
+  return suscan_analyzer_open_source_ex_async(
+      analyzer,
+      0,
+      class,
+      channel,
+      precise,
+      parent,
+      req_id);
+}
+
+SUBOOL
+suscan_analyzer_open_on_source_async(
+    suscan_analyzer_t *analyzer,
+    unsigned int source,
+    const char *class,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    uint32_t req_id)
+{
+  if (source >= suscan_analyzer_get_source_count(analyzer)) {
+    SU_ERROR("Analyzer has no source #%d\n", source);
+    return SU_FALSE;
+  }
+
+  return suscan_analyzer_open_source_ex_async(
+      analyzer,
+      source,
+      class,
+      channel,
+      precise,
+      -1,
+      req_id);
+}
+
 SUBOOL
 suscan_analyzer_open_async(
     suscan_analyzer_t *analyzer,
@@ -614,6 +729,45 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_inspector_set_spectrum_mask_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    uint32_t spectsrc_mask,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_inspector_msg *req = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      req = suscan_analyzer_inspector_msg_new(
+          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM_MASK,
+          req_id),
+      goto done);
+
+  req->handle = handle;
+  req->spectsrc_mask = spectsrc_mask;
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+      req)) {
+    SU_ERROR("Failed to send set_spectrum_mask command\n");
+    goto done;
+  }
+
+  req = NULL;
+
+  ok = SU_TRUE;
+
+done:
+
+  if (req != NULL)
+    suscan_analyzer_inspector_msg_destroy(req);
+
+  return ok;
+}
+
 SUBOOL
 suscan_analyzer_inspector_set_tle_async(
     suscan_analyzer_t *analyzer,
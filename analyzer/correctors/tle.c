@@ -20,6 +20,8 @@
 #define SU_LOG_DOMAIN "tle-corrector"
 
 #include <sigutils/log.h>
+#include <sigutils/util/util.h>
+#include <pthread.h>
 
 #include "corrector.h"
 #include "tle.h"
@@ -27,10 +29,391 @@
 
 SUPRIVATE struct suscan_frequency_corrector_class g_tle_corrector_class;
 
+/***************************** Doppler tables *********************************/
+struct suscan_tle_doppler_table {
+  /* Key */
+  orbit_t  orbit; /* Name not copied */
+  xyz_t    site;
+  SUDOUBLE req_step;
+  int64_t  window; /* Covers [window, window + 1) * TABLE_SPAN */
+
+  pthread_mutex_t    mutex;
+  SUBOOL             mutex_init;
+  sgdp4_prediction_t prediction;
+  SUBOOL             prediction_init;
+
+  SUBOOL    built; /* Filled on first lookup */
+  SUBOOL    valid; /* If not, queries within the table fall back */
+  SUDOUBLE  step;
+  SUDOUBLE  t0;    /* Unix time of the first sample */
+  SUSCOUNT  count;
+  SUDOUBLE *rate;  /* Range rate, in km/s */
+  SUDOUBLE  max_error;
+
+  unsigned int refcnt;
+};
+
+SUPRIVATE pthread_mutex_t g_doppler_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+PTR_LIST_PRIVATE(struct suscan_tle_doppler_table, g_doppler_table);
+
+SUPRIVATE SUBOOL
+suscan_tle_doppler_table_matches(
+  const struct suscan_tle_doppler_table *self,
+  const orbit_t *orbit,
+  const xyz_t *site,
+  SUDOUBLE step,
+  int64_t window)
+{
+  return self->req_step == step
+    && self->window == window
+    && self->site.x == site->x
+    && self->site.y == site->y
+    && self->site.z == site->z
+    && self->orbit.satno == orbit->satno
+    && self->orbit.ep_year == orbit->ep_year
+    && self->orbit.ep_day == orbit->ep_day
+    && self->orbit.rev == orbit->rev
+    && self->orbit.drevdt == orbit->drevdt
+    && self->orbit.d2revdt2 == orbit->d2revdt2
+    && self->orbit.bstar == orbit->bstar
+    && self->orbit.eqinc == orbit->eqinc
+    && self->orbit.ecc == orbit->ecc
+    && self->orbit.mnan == orbit->mnan
+    && self->orbit.argp == orbit->argp
+    && self->orbit.ascn == orbit->ascn;
+}
+
+SUPRIVATE void
+suscan_tle_doppler_table_destroy(struct suscan_tle_doppler_table *self)
+{
+  if (self->mutex_init)
+    pthread_mutex_destroy(&self->mutex);
+
+  if (self->prediction_init)
+    sgdp4_prediction_finalize(&self->prediction);
+
+  if (self->rate != NULL)
+    free(self->rate);
+
+  free(self);
+}
+
+SUPRIVATE struct suscan_tle_doppler_table *
+suscan_tle_doppler_table_new(
+  const orbit_t *orbit,
+  const xyz_t *site,
+  SUDOUBLE step,
+  int64_t window)
+{
+  struct suscan_tle_doppler_table *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_tle_doppler_table);
+
+  new->orbit      = *orbit;
+  new->orbit.name = NULL;
+  new->site       = *site;
+  new->req_step   = step;
+  new->window     = window;
+  new->step       = step;
+
+  SU_TRY_FAIL(pthread_mutex_init(&new->mutex, NULL) == 0);
+  new->mutex_init = SU_TRUE;
+
+  SU_TRY_FAIL(sgdp4_prediction_init(&new->prediction, &new->orbit, site));
+  new->prediction_init = SU_TRUE;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_tle_doppler_table_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE struct suscan_tle_doppler_table *
+suscan_tle_doppler_table_acquire(
+  const orbit_t *orbit,
+  const xyz_t *site,
+  SUDOUBLE step,
+  int64_t window)
+{
+  struct suscan_tle_doppler_table *table = NULL, *new = NULL;
+  SUBOOL mutex_acquired = SU_FALSE;
+  unsigned int i;
+
+  SU_TRY(pthread_mutex_lock(&g_doppler_table_mutex) == 0);
+  mutex_acquired = SU_TRUE;
+
+  for (i = 0; i < g_doppler_table_count; ++i)
+    if (suscan_tle_doppler_table_matches(
+        g_doppler_table_list[i],
+        orbit,
+        site,
+        step,
+        window)) {
+      table = g_doppler_table_list[i];
+      ++table->refcnt;
+      goto done;
+    }
+
+  SU_TRY(new = suscan_tle_doppler_table_new(orbit, site, step, window));
+  SU_TRYC(PTR_LIST_APPEND_CHECK(g_doppler_table, new));
+
+  table = new;
+  new   = NULL;
+  table->refcnt = 1;
+
+done:
+  if (new != NULL)
+    suscan_tle_doppler_table_destroy(new);
+
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&g_doppler_table_mutex);
+
+  return table;
+}
+
+SUPRIVATE void
+suscan_tle_doppler_table_release(struct suscan_tle_doppler_table *table)
+{
+  unsigned int i;
+
+  (void) pthread_mutex_lock(&g_doppler_table_mutex);
+
+  if (--table->refcnt == 0) {
+    for (i = 0; i < g_doppler_table_count; ++i)
+      if (g_doppler_table_list[i] == table) {
+        g_doppler_table_list[i] = g_doppler_table_list[--g_doppler_table_count];
+        g_doppler_table_list[g_doppler_table_count] = NULL;
+        break;
+      }
+
+    suscan_tle_doppler_table_destroy(table);
+  }
+
+  (void) pthread_mutex_unlock(&g_doppler_table_mutex);
+}
+
+SUPRIVATE void
+suscan_tle_doppler_time_to_timeval(SUDOUBLE t, struct timeval *tv)
+{
+  tv->tv_sec  = floor(t);
+  tv->tv_usec = (t - tv->tv_sec) * 1e6;
+}
+
+SUPRIVATE SUBOOL
+suscan_tle_doppler_table_propagate(
+  struct suscan_tle_doppler_table *self,
+  SUDOUBLE t,
+  SUDOUBLE *rate)
+{
+  struct timeval tv;
+  xyz_t vel_azel;
+
+  suscan_tle_doppler_time_to_timeval(t, &tv);
+
+  if (!sgdp4_prediction_update(&self->prediction, &tv))
+    return SU_FALSE;
+
+  sgdp4_prediction_get_vel_azel(&self->prediction, &vel_azel);
+  *rate = vel_azel.distance;
+
+  return SU_TRUE;
+}
+
+/* Cubic Lagrange interpolation between samples k and k + 1 */
+SUINLINE SUDOUBLE
+suscan_tle_doppler_table_interp(
+  const struct suscan_tle_doppler_table *self,
+  SUSCOUNT k,
+  SUDOUBLE u)
+{
+  const SUDOUBLE *y = self->rate + k - 1;
+
+  return
+    - u * (u - 1) * (u - 2) / 6 * y[0]
+    + (u + 1) * (u - 1) * (u - 2) / 2 * y[1]
+    - (u + 1) * u * (u - 2) / 2 * y[2]
+    + (u + 1) * u * (u - 1) / 6 * y[3];
+}
+
+SUINLINE SUBOOL
+suscan_tle_doppler_table_covers(
+  const struct suscan_tle_doppler_table *self,
+  SUDOUBLE t)
+{
+  return self->count >= 4
+    && t >= self->t0 + self->step
+    && t < self->t0 + (self->count - 2) * self->step;
+}
+
+SUPRIVATE SUBOOL
+suscan_tle_doppler_table_fill(
+  struct suscan_tle_doppler_table *self,
+  SUDOUBLE t0,
+  SUDOUBLE step)
+{
+  SUSCOUNT i, count = ceil(SUSCAN_TLE_CORRECTOR_TABLE_SPAN / step) + 3;
+  SUDOUBLE *tmp;
+
+  if (count > self->count) {
+    SU_TRYCATCH(
+      tmp = realloc(self->rate, count * sizeof(SUDOUBLE)),
+      return SU_FALSE);
+    self->rate = tmp;
+  }
+
+  self->t0    = t0;
+  self->step  = step;
+  self->count = count;
+
+  for (i = 0; i < count; ++i)
+    if (!suscan_tle_doppler_table_propagate(
+        self,
+        t0 + i * step,
+        self->rate + i))
+      return SU_FALSE;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_tle_doppler_table_validate(struct suscan_tle_doppler_table *self)
+{
+  SUDOUBLE rate, err;
+  SUSCOUNT k;
+
+  self->max_error = 0;
+
+  for (k = 1; k + 2 < self->count; ++k) {
+    if (!suscan_tle_doppler_table_propagate(
+        self,
+        self->t0 + (k + .5) * self->step,
+        &rate))
+      return SU_FALSE;
+
+    err = fabs(rate - suscan_tle_doppler_table_interp(self, k, .5));
+    if (err > self->max_error)
+      self->max_error = err;
+  }
+
+  return SU_TRUE;
+}
+
+/* Must be called with the table mutex held */
+SUPRIVATE void
+suscan_tle_doppler_table_build(struct suscan_tle_doppler_table *self)
+{
+  SUDOUBLE t = self->window * SUSCAN_TLE_CORRECTOR_TABLE_SPAN;
+  SUDOUBLE step = self->req_step;
+
+  self->built = SU_TRUE;
+  self->valid = SU_FALSE;
+
+  for (;;) {
+    if (!suscan_tle_doppler_table_fill(self, t - step, step)
+        || !suscan_tle_doppler_table_validate(self))
+      return;
+
+    if (self->max_error <= SUSCAN_TLE_CORRECTOR_MAX_ERROR
+        || step / 2 < SUSCAN_TLE_CORRECTOR_TABLE_MIN_STEP)
+      break;
+
+    step /= 2;
+  }
+
+  if (self->max_error > SUSCAN_TLE_CORRECTOR_MAX_ERROR)
+    SU_WARNING(
+      "Doppler table error of %g m/s exceeds the bound, using direct propagation\n",
+      self->max_error * 1e3);
+  else
+    self->valid = SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_tle_doppler_table_lookup(
+  struct suscan_tle_doppler_table *self,
+  SUDOUBLE t,
+  SUDOUBLE *rate)
+{
+  SUDOUBLE pos;
+  SUSCOUNT k;
+  SUBOOL ok = SU_FALSE;
+
+  (void) pthread_mutex_lock(&self->mutex);
+
+  /* Invalid tables are not rebuilt, queries just fall back */
+  if (!self->built)
+    suscan_tle_doppler_table_build(self);
+
+  if (self->valid && suscan_tle_doppler_table_covers(self, t)) {
+    pos   = (t - self->t0) / self->step;
+    k     = floor(pos);
+    *rate = suscan_tle_doppler_table_interp(self, k, pos - k);
+    ok    = SU_TRUE;
+  }
+
+  (void) pthread_mutex_unlock(&self->mutex);
+
+  return ok;
+}
+
+/****************************** TLE corrector *********************************/
 void
 suscan_tle_corrector_destroy(suscan_tle_corrector_t *self)
 {
+  if (self->table != NULL)
+    suscan_tle_doppler_table_release(self->table);
+
   sgdp4_prediction_finalize(&self->prediction);
+
+  free(self);
+}
+
+SUBOOL
+suscan_tle_corrector_set_table_step(
+  suscan_tle_corrector_t *self,
+  SUDOUBLE step)
+{
+  /* The table of the new step is acquired on the next query */
+  if (self->table != NULL) {
+    suscan_tle_doppler_table_release(self->table);
+    self->table = NULL;
+  }
+
+  self->table_step = step;
+
+  return SU_TRUE;
+}
+
+/* Switches to the table of the window of t, if needed */
+SUPRIVATE SUBOOL
+suscan_tle_corrector_lookup_rate(
+  suscan_tle_corrector_t *self,
+  SUDOUBLE t,
+  SUDOUBLE *rate)
+{
+  int64_t window = floor(t / SUSCAN_TLE_CORRECTOR_TABLE_SPAN);
+
+  if (self->table_step <= 0)
+    return SU_FALSE;
+
+  if (self->table != NULL && self->table->window != window) {
+    suscan_tle_doppler_table_release(self->table);
+    self->table = NULL;
+  }
+
+  if (self->table == NULL)
+    if ((self->table = suscan_tle_doppler_table_acquire(
+        &self->prediction.orbit,
+        &self->prediction.site,
+        self->table_step,
+        window)) == NULL)
+      return SU_FALSE;
+
+  return suscan_tle_doppler_table_lookup(self->table, t, rate);
 }
 
 suscan_tle_corrector_t *
@@ -48,6 +431,10 @@ suscan_tle_corrector_new_from_file(const char *path, const xyz_t *site)
     sgdp4_prediction_init(&new->prediction, &orbit, site),
     goto done);
 
+  SU_TRYCATCH(
+    suscan_tle_corrector_set_table_step(new, SUSCAN_TLE_CORRECTOR_TABLE_STEP),
+    goto done);
+
   ok = SU_TRUE;
 
 done:
@@ -56,6 +443,7 @@ done:
   if (!ok) {
     if (new != NULL)
       suscan_tle_corrector_destroy(new);
+    new = NULL;
   }
 
   return new;
@@ -78,6 +466,10 @@ suscan_tle_corrector_new(const char *string, const xyz_t *site)
     sgdp4_prediction_init(&new->prediction, &orbit, site),
     goto done);
 
+  SU_TRYCATCH(
+    suscan_tle_corrector_set_table_step(new, SUSCAN_TLE_CORRECTOR_TABLE_STEP),
+    goto done);
+
   ok = SU_TRUE;
 
 done:
@@ -86,6 +478,7 @@ done:
   if (!ok) {
     if (new != NULL)
       suscan_tle_corrector_destroy(new);
+    new = NULL;
   }
 
   return new;
@@ -103,12 +496,17 @@ suscan_tle_corrector_new_from_orbit(const orbit_t *orbit, const xyz_t *site)
     sgdp4_prediction_init(&new->prediction, orbit, site),
     goto done);
 
+  SU_TRYCATCH(
+    suscan_tle_corrector_set_table_step(new, SUSCAN_TLE_CORRECTOR_TABLE_STEP),
+    goto done);
+
   ok = SU_TRUE;
 
 done:
   if (!ok) {
     if (new != NULL)
       suscan_tle_corrector_destroy(new);
+    new = NULL;
   }
 
   return new;
@@ -154,7 +552,6 @@ suscan_frequency_corrector_tle_get_report(
   return SU_TRUE;
 }
 
-/* TODO: Use correction reports? */
 SUBOOL
 suscan_tle_corrector_correct_freq(
   suscan_tle_corrector_t *self,
@@ -162,13 +559,19 @@ suscan_tle_corrector_correct_freq(
   SUFREQ freq,
   SUFLOAT *delta_freq)
 {
-  xyz_t pos_azel, vel_azel;
+  xyz_t vel_azel;
+  SUDOUBLE t = tv->tv_sec + 1e-6 * tv->tv_usec;
+  SUDOUBLE rate;
 
-  sgdp4_prediction_update(&self->prediction, tv);
-  sgdp4_prediction_get_azel(&self->prediction, &pos_azel);
-  sgdp4_prediction_get_vel_azel(&self->prediction, &vel_azel);
-  
-  *delta_freq = -vel_azel.distance / SPEED_OF_LIGHT_KM_S * freq;
+  if (!suscan_tle_corrector_lookup_rate(self, t, &rate)) {
+    if (!sgdp4_prediction_update(&self->prediction, tv))
+      return SU_FALSE;
+
+    sgdp4_prediction_get_vel_azel(&self->prediction, &vel_azel);
+    rate = vel_azel.distance;
+  }
+
+  *delta_freq = -rate / SPEED_OF_LIGHT_KM_S * freq;
 
   return SU_TRUE;
 }
@@ -32,8 +32,27 @@ enum suscan_tle_corrector_mode {
   SUSCAN_TLE_CORRECTOR_MODE_ORBIT
 };
 
+/*
+ * Doppler corrections are interpolated (cubic) from tables of range
+ * rates, sampled every SUSCAN_TLE_CORRECTOR_TABLE_STEP seconds. Each
+ * table covers one window of SUSCAN_TLE_CORRECTOR_TABLE_SPAN seconds,
+ * aligned to multiples of the span in Unix time. The midpoint of every
+ * interval is checked against direct propagation. If the error exceeds
+ * SUSCAN_TLE_CORRECTOR_MAX_ERROR, the step is halved (down to
+ * SUSCAN_TLE_CORRECTOR_TABLE_MIN_STEP). Correctors of the same orbit,
+ * site and step share the table of the window they are in.
+ */
+#define SUSCAN_TLE_CORRECTOR_TABLE_STEP      5.
+#define SUSCAN_TLE_CORRECTOR_TABLE_MIN_STEP  .25
+#define SUSCAN_TLE_CORRECTOR_TABLE_SPAN      1800.
+#define SUSCAN_TLE_CORRECTOR_MAX_ERROR       1e-4 /* km/s */
+
+struct suscan_tle_doppler_table;
+
 struct suscan_tle_corrector {
   sgdp4_prediction_t prediction;
+  SUDOUBLE table_step; /* <= 0 if tables are disabled */
+  struct suscan_tle_doppler_table *table; /* Current window. May be NULL */
 };
 
 typedef struct suscan_tle_corrector suscan_tle_corrector_t;
@@ -52,6 +71,11 @@ suscan_tle_corrector_t *suscan_tle_corrector_new_from_orbit(
   const orbit_t *orbit,
   const xyz_t *site);
 
+/* step <= 0 disables the table, and all queries propagate directly */
+SUBOOL suscan_tle_corrector_set_table_step(
+  suscan_tle_corrector_t *self,
+  SUDOUBLE step);
+
 SUBOOL suscan_tle_corrector_correct_freq(
   suscan_tle_corrector_t *self,
   const struct timeval *tv,
@@ -67,9 +67,11 @@ suscan_estimator_new(const struct suscan_estimator_class *class, SUSCOUNT fs)
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_estimator_t)), goto fail);
 
-  new->classptr = class;
-
-  SU_TRYCATCH(new->privdata = (class->ctor) (fs), goto fail);
+  new->classptr   = class;
+  new->fs         = fs;
+  new->block_size = class->block_size > 0
+    ? class->block_size
+    : SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ;
 
   return new;
 
@@ -80,27 +82,94 @@ fail:
   return NULL;
 }
 
+SUPRIVATE SUBOOL
+suscan_estimator_ensure_init(suscan_estimator_t *estimator)
+{
+  if (estimator->privdata == NULL)
+    SU_TRYCATCH(
+        estimator->privdata = (estimator->classptr->ctor) (estimator->fs),
+        return SU_FALSE);
+
+  return SU_TRUE;
+}
+
 SUBOOL
 suscan_estimator_feed(
     suscan_estimator_t *estimator,
     const SUCOMPLEX *samples,
     SUSCOUNT size)
 {
+  SU_TRYCATCH(suscan_estimator_ensure_init(estimator), return SU_FALSE);
+
   return (estimator->classptr->feed) (estimator->privdata, samples, size);
 }
 
+SUSDIFF
+suscan_estimator_collect(
+    suscan_estimator_t *estimator,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size,
+    SUBOOL *ready)
+{
+  SUSCOUNT avail;
+
+  *ready = SU_FALSE;
+
+  if (!estimator->armed)
+    return 0;
+
+  if (estimator->block == NULL)
+    SU_TRYCATCH(
+        estimator->block = malloc(estimator->block_size * sizeof(SUCOMPLEX)),
+        return -1);
+
+  avail = estimator->block_size - estimator->block_ptr;
+  if (size > avail)
+    size = avail;
+
+  memcpy(
+      estimator->block + estimator->block_ptr,
+      samples,
+      size * sizeof(SUCOMPLEX));
+
+  estimator->block_ptr += size;
+
+  if (estimator->block_ptr == estimator->block_size) {
+    SU_TRYCATCH(
+        suscan_estimator_feed(
+            estimator,
+            estimator->block,
+            estimator->block_size),
+        return -1);
+
+    suscan_estimator_disarm(estimator);
+    *ready = SU_TRUE;
+  }
+
+  return size;
+}
+
 SUBOOL
 suscan_estimator_read(const suscan_estimator_t *estimator, SUFLOAT *out)
 {
+  if (estimator->privdata == NULL)
+    return SU_FALSE;
+
   return (estimator->classptr->read) (estimator->privdata, out);
 }
 
 void
 suscan_estimator_destroy(suscan_estimator_t *estimator)
 {
-  if (estimator != NULL)
+  if (estimator == NULL)
+    return;
+
+  if (estimator->privdata != NULL)
     (estimator->classptr->dtor) (estimator->privdata);
 
+  if (estimator->block != NULL)
+    free(estimator->block);
+
   free(estimator);
 }
 
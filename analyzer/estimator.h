@@ -33,6 +33,9 @@ struct suscan_estimator_class {
   const char *desc;
   const char *field;
 
+  /* Samples per estimation, SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ if 0 */
+  SUSCOUNT block_size;
+
   void * (*ctor) (SUSCOUNT fs);
 
   SUBOOL (*feed) (void *privdata, const SUCOMPLEX *samples, SUSCOUNT size);
@@ -42,10 +45,23 @@ struct suscan_estimator_class {
   void (*dtor) (void *privdata);
 };
 
+/*
+ * Estimators are duty-cycled: they do nothing until an estimation is
+ * requested with suscan_estimator_arm. Then, they collect a contiguous
+ * block of samples and feed it to the class at once. The class object
+ * itself is only created the first time the estimator runs, so that
+ * estimators that are never enabled cost nothing.
+ */
 struct suscan_estimator {
   const struct suscan_estimator_class *classptr;
   void *privdata;
   SUBOOL enabled;
+
+  SUSCOUNT   fs;
+  SUCOMPLEX *block;
+  SUSCOUNT   block_size;
+  SUSCOUNT   block_ptr;
+  SUBOOL     armed;
 };
 
 typedef struct suscan_estimator suscan_estimator_t;
@@ -65,6 +81,26 @@ suscan_estimator_set_enabled(suscan_estimator_t *estimator, SUBOOL state)
   estimator->enabled = state;
 }
 
+SUINLINE SUBOOL
+suscan_estimator_is_armed(const suscan_estimator_t *estimator)
+{
+  return estimator->armed;
+}
+
+/* Start collecting samples for the next estimation */
+SUINLINE void
+suscan_estimator_arm(suscan_estimator_t *estimator)
+{
+  estimator->armed = SU_TRUE;
+}
+
+SUINLINE void
+suscan_estimator_disarm(suscan_estimator_t *estimator)
+{
+  estimator->armed     = SU_FALSE;
+  estimator->block_ptr = 0;
+}
+
 SUBOOL suscan_estimator_class_register(
     const struct suscan_estimator_class *classdef);
 
@@ -77,6 +113,17 @@ SUBOOL suscan_estimator_feed(
     const SUCOMPLEX *samples,
     SUSCOUNT size);
 
+/*
+ * Collects samples while the estimator is armed. Once the block is
+ * complete, it is fed to the estimator and *ready is set to SU_TRUE,
+ * leaving the estimator disarmed. Returns the number of samples taken.
+ */
+SUSDIFF suscan_estimator_collect(
+    suscan_estimator_t *estimator,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size,
+    SUBOOL *ready);
+
 SUBOOL suscan_estimator_read(
     const suscan_estimator_t *estimator,
     SUFLOAT *out);
@@ -73,6 +73,7 @@ suscan_estimator_fac_register(void)
       .name  = "baud-fac",
       .desc  = "FAC baud estimator",
       .field = "clock.baud",
+      .block_size = SUSCAN_SOURCE_DEFAULT_BUFSIZ,
       .ctor  = suscan_estimator_fac_ctor,
       .feed  = suscan_estimator_fac_feed,
       .read  = suscan_estimator_fac_read,
@@ -83,6 +83,7 @@ suscan_estimator_nonlinear_register(void)
       .name  = "baud-nonlinear",
       .desc  = "Non-linear baud estimator",
       .field = "clock.baud",
+      .block_size = SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ,
       .ctor  = suscan_estimator_nonlinear_ctor,
       .feed  = suscan_estimator_nonlinear_feed,
       .read  = suscan_estimator_nonlinear_read,
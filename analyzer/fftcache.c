@@ -0,0 +1,348 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "fftcache"
+
+#include <string.h>
+#include <pthread.h>
+#include <sigutils/log.h>
+#include <sigutils/taps.h>
+#include <analyzer/fftcache.h>
+#include <analyzer/realtime.h>
+
+struct suscan_fft_window {
+  enum sigutils_channel_detector_window type;
+  SUSCOUNT     size;
+  SUFLOAT     *taps;
+  unsigned int refcnt;
+};
+
+/*
+ * The FFTW planner is not thread safe, and both lists are shared by
+ * every thread of the process. Everything is done under the same lock.
+ */
+SUPRIVATE pthread_mutex_t g_fft_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE struct suscan_fft_cache_stats g_fft_cache_stats;
+
+PTR_LIST_PRIVATE(suscan_fft_plan_t, g_fft_plan);
+PTR_LIST_PRIVATE(struct suscan_fft_window, g_fft_window);
+
+/* Entries are unordered: removal moves the last entry to the hole */
+SUPRIVATE void
+suscan_fft_cache_remove(void **list, unsigned int *count, unsigned int index)
+{
+  list[index] = list[--*count];
+  list[*count] = NULL;
+}
+
+SUPRIVATE void
+suscan_fft_plan_destroy(suscan_fft_plan_t *self)
+{
+  if (self->plan != NULL)
+    SU_FFTW(_destroy_plan) (self->plan);
+
+  free(self);
+}
+
+SUPRIVATE suscan_fft_plan_t *
+suscan_fft_plan_new(SUSCOUNT size, unsigned int batch, int sign)
+{
+  suscan_fft_plan_t *new = NULL;
+  SUCOMPLEX *buffer = NULL;
+  int n = size;
+  uint64_t start, elapsed;
+
+  SU_ALLOCATE_FAIL(new, suscan_fft_plan_t);
+
+  new->size  = size;
+  new->batch = batch;
+  new->sign  = sign;
+
+  SU_TRY_FAIL(
+      buffer = SU_FFTW(_malloc) (batch * size * sizeof(SUCOMPLEX)));
+
+  start = suscan_gettime_raw();
+
+  SU_TRY_FAIL(
+      new->plan = SU_FFTW(_plan_many_dft) (
+          1,
+          &n,
+          batch,
+          (SU_FFTW(_complex) *) buffer,
+          NULL,
+          1,
+          n,
+          (SU_FFTW(_complex) *) buffer,
+          NULL,
+          1,
+          n,
+          sign,
+          FFTW_ESTIMATE));
+
+  elapsed = suscan_gettime_raw() - start;
+
+  g_fft_cache_stats.plan_time_total += elapsed;
+  if (elapsed > g_fft_cache_stats.plan_time_max)
+    g_fft_cache_stats.plan_time_max = elapsed;
+
+  SU_FFTW(_free) (buffer);
+
+  return new;
+
+fail:
+  if (buffer != NULL)
+    SU_FFTW(_free) (buffer);
+
+  if (new != NULL)
+    suscan_fft_plan_destroy(new);
+
+  return NULL;
+}
+
+suscan_fft_plan_t *
+suscan_fft_plan_acquire(SUSCOUNT size, unsigned int batch, int sign)
+{
+  suscan_fft_plan_t *plan = NULL, *new = NULL;
+  unsigned int i;
+  SUBOOL mutex_acquired = SU_FALSE;
+
+  SU_TRYCATCH(size > 0 && batch > 0, goto done);
+
+  SU_TRYCATCH(pthread_mutex_lock(&g_fft_cache_mutex) == 0, goto done);
+  mutex_acquired = SU_TRUE;
+
+  for (i = 0; i < g_fft_plan_count; ++i) {
+    if (g_fft_plan_list[i]->size == size
+        && g_fft_plan_list[i]->batch == batch
+        && g_fft_plan_list[i]->sign == sign) {
+      plan = g_fft_plan_list[i];
+      ++plan->refcnt;
+      ++g_fft_cache_stats.plan_hits;
+      goto done;
+    }
+  }
+
+  SU_TRYCATCH(new = suscan_fft_plan_new(size, batch, sign), goto done);
+  SU_TRYCATCH(PTR_LIST_APPEND_CHECK(g_fft_plan, new) != -1, goto done);
+
+  plan = new;
+  new  = NULL;
+  plan->refcnt = 1;
+  ++g_fft_cache_stats.plan_misses;
+
+done:
+  if (new != NULL)
+    suscan_fft_plan_destroy(new);
+
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+
+  return plan;
+}
+
+/* Unused plans are kept, unless there are too many of them */
+void
+suscan_fft_plan_release(suscan_fft_plan_t *plan)
+{
+  unsigned int i, idle = 0, index = 0;
+  SUBOOL found = SU_FALSE;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (i = 0; i < g_fft_plan_count; ++i) {
+    if (g_fft_plan_list[i] == plan) {
+      index = i;
+      found = SU_TRUE;
+    }
+
+    if (g_fft_plan_list[i]->refcnt == 0)
+      ++idle;
+  }
+
+  if (!found) {
+    SU_ERROR("Attempting to release a plan that is not in the cache\n");
+  } else if (plan->refcnt > 0 && --plan->refcnt == 0) {
+    if (++idle > SUSCAN_FFT_CACHE_MAX_IDLE) {
+      suscan_fft_cache_remove(
+          (void **) g_fft_plan_list,
+          &g_fft_plan_count,
+          index);
+      suscan_fft_plan_destroy(plan);
+    }
+  }
+
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
+
+SUPRIVATE void
+suscan_fft_window_destroy(struct suscan_fft_window *self)
+{
+  if (self->taps != NULL)
+    free(self->taps);
+
+  free(self);
+}
+
+SUPRIVATE struct suscan_fft_window *
+suscan_fft_window_new(
+    enum sigutils_channel_detector_window type,
+    SUSCOUNT size)
+{
+  struct suscan_fft_window *new = NULL;
+  SUFLOAT power = 0, k;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_fft_window);
+
+  new->type = type;
+  new->size = size;
+
+  SU_ALLOCATE_MANY_FAIL(new->taps, size, SUFLOAT);
+
+  for (i = 0; i < size; ++i)
+    new->taps[i] = 1;
+
+  switch (type) {
+    case SU_CHANNEL_DETECTOR_WINDOW_NONE:
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_HAMMING:
+      su_taps_apply_hamming(new->taps, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_HANN:
+      su_taps_apply_hann(new->taps, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_FLAT_TOP:
+      su_taps_apply_flat_top(new->taps, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_BLACKMANN_HARRIS:
+      su_taps_apply_blackmann_harris(new->taps, size);
+      break;
+
+    default:
+      SU_ERROR("Unsupported window type %d\n", type);
+      goto fail;
+  }
+
+  /* Unit mean power, so that the window does not change the noise level */
+  for (i = 0; i < size; ++i)
+    power += new->taps[i] * new->taps[i];
+
+  k = SU_SQRT(size / power);
+  for (i = 0; i < size; ++i)
+    new->taps[i] *= k;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_fft_window_destroy(new);
+
+  return NULL;
+}
+
+const SUFLOAT *
+suscan_fft_window_acquire(
+    enum sigutils_channel_detector_window type,
+    SUSCOUNT size)
+{
+  struct suscan_fft_window *window = NULL, *new = NULL;
+  unsigned int i;
+  SUBOOL mutex_acquired = SU_FALSE;
+
+  SU_TRYCATCH(size > 0, goto done);
+
+  SU_TRYCATCH(pthread_mutex_lock(&g_fft_cache_mutex) == 0, goto done);
+  mutex_acquired = SU_TRUE;
+
+  for (i = 0; i < g_fft_window_count; ++i) {
+    if (g_fft_window_list[i]->type == type
+        && g_fft_window_list[i]->size == size) {
+      window = g_fft_window_list[i];
+      ++window->refcnt;
+      ++g_fft_cache_stats.window_hits;
+      goto done;
+    }
+  }
+
+  SU_TRYCATCH(new = suscan_fft_window_new(type, size), goto done);
+  SU_TRYCATCH(PTR_LIST_APPEND_CHECK(g_fft_window, new) != -1, goto done);
+
+  window = new;
+  new    = NULL;
+  window->refcnt = 1;
+  ++g_fft_cache_stats.window_misses;
+
+done:
+  if (new != NULL)
+    suscan_fft_window_destroy(new);
+
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+
+  return window != NULL ? window->taps : NULL;
+}
+
+void
+suscan_fft_window_release(const SUFLOAT *taps)
+{
+  struct suscan_fft_window *window = NULL;
+  unsigned int i, idle = 0, index = 0;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (i = 0; i < g_fft_window_count; ++i) {
+    if (g_fft_window_list[i]->taps == taps) {
+      window = g_fft_window_list[i];
+      index  = i;
+    }
+
+    if (g_fft_window_list[i]->refcnt == 0)
+      ++idle;
+  }
+
+  if (window == NULL) {
+    SU_ERROR("Attempting to release a window that is not in the cache\n");
+  } else if (window->refcnt > 0 && --window->refcnt == 0) {
+    if (++idle > SUSCAN_FFT_CACHE_MAX_IDLE) {
+      suscan_fft_cache_remove(
+          (void **) g_fft_window_list,
+          &g_fft_window_count,
+          index);
+      suscan_fft_window_destroy(window);
+    }
+  }
+
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
+
+void
+suscan_fft_cache_get_stats(struct suscan_fft_cache_stats *stats)
+{
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  *stats = g_fft_cache_stats;
+  stats->plan_count   = g_fft_plan_count;
+  stats->window_count = g_fft_window_count;
+
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
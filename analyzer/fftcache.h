@@ -0,0 +1,104 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_FFTCACHE_H
+#define _ANALYZER_FFTCACHE_H
+
+#include <sigutils/sigutils.h>
+#include <sigutils/detect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Process-wide cache of FFT plans and window tables. Entries are
+ * refcounted and shared by every user asking for the same key. Entries
+ * that are no longer used are kept around (up to a limit), so that
+ * opening and closing objects in bursts does not plan again.
+ *
+ * Plans are created for in-place transforms of arrays allocated with
+ * SU_FFTW(_malloc), and must be run through suscan_fft_plan_execute on
+ * the caller's own buffer. Windows are normalized to unit mean power.
+ */
+#define SUSCAN_FFT_CACHE_MAX_IDLE 16
+
+struct suscan_fft_plan {
+  SUSCOUNT       size;
+  unsigned int   batch; /* Number of consecutive transforms */
+  int            sign;
+  SU_FFTW(_plan) plan;
+  unsigned int   refcnt;
+};
+
+typedef struct suscan_fft_plan suscan_fft_plan_t;
+
+struct suscan_fft_cache_stats {
+  uint64_t     plan_hits;
+  uint64_t     plan_misses;
+  uint64_t     window_hits;
+  uint64_t     window_misses;
+  uint64_t     plan_time_total; /* Time spent planning, in nanoseconds */
+  uint64_t     plan_time_max;
+  unsigned int plan_count;      /* Plans currently cached */
+  unsigned int window_count;    /* Windows currently cached */
+};
+
+suscan_fft_plan_t *suscan_fft_plan_acquire(
+    SUSCOUNT size,
+    unsigned int batch,
+    int sign);
+
+void suscan_fft_plan_release(suscan_fft_plan_t *plan);
+
+SUINLINE SUSCOUNT
+suscan_fft_plan_get_size(const suscan_fft_plan_t *self)
+{
+  return self->size;
+}
+
+SUINLINE unsigned int
+suscan_fft_plan_get_batch(const suscan_fft_plan_t *self)
+{
+  return self->batch;
+}
+
+/* buffer holds batch * size samples, allocated with SU_FFTW(_malloc) */
+SUINLINE void
+suscan_fft_plan_execute(const suscan_fft_plan_t *self, SUCOMPLEX *buffer)
+{
+  SU_FFTW(_execute_dft) (
+      self->plan,
+      (SU_FFTW(_complex) *) buffer,
+      (SU_FFTW(_complex) *) buffer);
+}
+
+const SUFLOAT *suscan_fft_window_acquire(
+    enum sigutils_channel_detector_window type,
+    SUSCOUNT size);
+
+void suscan_fft_window_release(const SUFLOAT *window);
+
+void suscan_fft_cache_get_stats(struct suscan_fft_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_FFTCACHE_H */
@@ -28,6 +28,7 @@
 #include "sgdp4/sgdp4-types.h"
 #include <src/suscan.h>
 #include <analyzer/source.h>
+#include <unistd.h>
 
 SUPRIVATE struct suscan_analyzer_interface *g_local_analyzer_interface;
 
@@ -41,6 +42,40 @@ suscan_analyzer_is_local(const suscan_analyzer_t *self)
   return self->iface == g_local_analyzer_interface;
 }
 
+unsigned int
+suscan_analyzer_get_source_count(const suscan_analyzer_t *self)
+{
+  if (!suscan_analyzer_is_local(self))
+    return 1;
+
+  return 1 + SULIMPL(self)->aux_source_count;
+}
+
+SUBOOL
+suscan_analyzer_get_source_freq(
+  const suscan_analyzer_t *self,
+  unsigned int index,
+  SUFREQ *freq)
+{
+  const suscan_local_analyzer_t *local;
+
+  if (index == 0) {
+    *freq = suscan_analyzer_get_source_info(self)->frequency;
+    return SU_TRUE;
+  }
+
+  if (!suscan_analyzer_is_local(self))
+    return SU_FALSE;
+
+  local = SULIMPL(self);
+  if (index > local->aux_source_count)
+    return SU_FALSE;
+
+  *freq = local->aux_source_list[index - 1]->freq;
+
+  return SU_TRUE;
+}
+
 /************************ Source worker callback *****************************/
 SUBOOL
 suscan_local_analyzer_lock_loop(suscan_local_analyzer_t *self)
@@ -290,6 +325,20 @@ suscan_analyzer_thread(void *data)
             suscan_local_analyzer_slow_set_replay(self, replay->replay),
             goto done);
           break;
+
+        case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS:
+          if (!suscan_local_analyzer_set_psd_stats_params_overridable(
+            self,
+            (const struct suscan_analyzer_psd_stats_params *) private))
+            SU_WARNING("Invalid PSD statistics parameters (ignored)\n");
+          break;
+
+        case SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS:
+          if (!suscan_local_analyzer_set_cfar_params_overridable(
+            self,
+            (const struct suscan_analyzer_cfar_params *) private))
+            SU_WARNING("Invalid CFAR detector parameters (ignored)\n");
+          break;
         
         /* Forward these messages to output */
         case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
@@ -444,6 +493,20 @@ suscan_local_analyzer_bbfilt_dtor(void *obj, void *userdata)
   suscan_analyzer_baseband_filter_destroy(obj);
 }
 
+SUPRIVATE unsigned int
+suscan_local_analyzer_get_shard_count(void)
+{
+  long count;
+
+  if ((count = sysconf(_SC_NPROCESSORS_ONLN) / 4) < 1)
+    count = 1;
+
+  if (count > SUSCAN_LOCAL_ANALYZER_MAX_SHARDS)
+    count = SUSCAN_LOCAL_ANALYZER_MAX_SHARDS;
+
+  return count;
+}
+
 void *
 suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
 {
@@ -454,13 +517,24 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   struct suscan_sample_buffer_pool_params bp_params = 
     suscan_sample_buffer_pool_params_INITIALIZER;
   
+  struct suscan_local_analyzer_aux_source *aux = NULL;
   suscan_source_config_t *config;
+  suscan_source_config_t **aux_config_list;
+  unsigned int aux_config_count, i;
   pthread_mutexattr_t attr;
   static SUBOOL insp_server_init = SU_FALSE;
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_local_analyzer_t)), goto fail);
 
-  config = va_arg(ap, suscan_source_config_t *);
+  config           = va_arg(ap, suscan_source_config_t *);
+  aux_config_list  = va_arg(ap, suscan_source_config_t **);
+  aux_config_count = va_arg(ap, unsigned int);
+
+  if (aux_config_count > 0
+    && parent->params.mode != SUSCAN_ANALYZER_MODE_CHANNEL) {
+    SU_ERROR("Multiple sources are only supported in channel mode\n");
+    goto fail;
+  }
 
   new->parent = parent;
 
@@ -596,6 +670,33 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   
   SU_TRYCATCH(suscan_source_start_capture(new->source), goto fail);
 
+  /* Auxiliary sources, channelized in lockstep with the main source */
+  for (i = 0; i < aux_config_count; ++i) {
+    SU_TRYCATCH(
+      aux = suscan_local_analyzer_aux_source_new(
+        new,
+        i + 1,
+        aux_config_list[i],
+        &st_params),
+      goto fail);
+    SU_TRYCATCH(PTR_LIST_APPEND_CHECK(new->aux_source, aux) != -1, goto fail);
+    aux = NULL;
+  }
+
+  /* Channelizer shards, only worth it if we have cores to spare */
+  if (parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL) {
+    SU_TRYCATCH(pthread_mutex_init(&new->shard_mutex, NULL) == 0, goto fail);
+    if (pthread_cond_init(&new->shard_cond, NULL) != 0) {
+      pthread_mutex_destroy(&new->shard_mutex);
+      goto fail;
+    }
+    new->shard_sync_init = SU_TRUE;
+
+    /* Shards (and their workers) are created once they are needed */
+    new->shard_max       = suscan_local_analyzer_get_shard_count() - 1;
+    new->shard_st_params = st_params;
+  }
+
   /* Allocate read buffer */
   new->read_size =
       new->source_info.effective_samp_rate <= SUSCAN_ANALYZER_SLOW_RATE
@@ -645,6 +746,9 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
 return new;
 
 fail:
+  if (aux != NULL)
+    suscan_local_analyzer_aux_source_destroy(aux);
+
   if (new != NULL)
     suscan_local_analyzer_dtor(new);
 
@@ -655,11 +759,16 @@ SUPRIVATE void
 suscan_local_analyzer_dtor(void *ptr)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  unsigned int i;
 
-  /* Prevent source from entering in timeout loops */
+  /* Prevent sources from entering in timeout loops */
   if (self->source != NULL)
     suscan_source_force_eos(self->source);
 
+  for (i = 0; i < self->aux_source_count; ++i)
+    if (self->aux_source_list[i]->source != NULL)
+      suscan_source_force_eos(self->aux_source_list[i]->source);
+
   if (self->thread_running) {
     /* TODO: add a timeout here too */
     if (pthread_join(self->thread, NULL) == -1) {
@@ -696,14 +805,30 @@ suscan_local_analyzer_dtor(void *ptr)
     if (!suscan_analyzer_halt_worker(self->psd_worker)) {
       SU_ERROR("Failed to destroy PSD worker.\n");
 
-      /* Mark smoothPSD object as released */
+      /* Mark all objects owned by the PSD worker as released */
       self->smooth_psd = NULL;
+      self->psd_pool   = NULL;
+      self->psd_stats  = NULL;
+      self->cfar       = NULL;
     }
   }
 
   if (self->smooth_psd != NULL)
     su_smoothpsd_destroy(self->smooth_psd);
 
+  if (self->psd_stats != NULL)
+    suscan_psd_stats_destroy(self->psd_stats);
+
+  if (self->cfar != NULL)
+    suscan_cfar_destroy(self->cfar);
+
+  suscan_analyzer_cfar_params_finalize(&self->cfar_params);
+  suscan_analyzer_cfar_params_finalize(&self->cfar_req_params);
+
+  /* PSD tap buffers, only used by the PSD worker */
+  if (self->psd_pool != NULL)
+    suscan_sample_buffer_pool_destroy(self->psd_pool);
+
   if (self->loop_init)
     pthread_mutex_destroy(&self->loop_mutex);
 
@@ -714,6 +839,26 @@ suscan_local_analyzer_dtor(void *ptr)
   if (self->insp_hash)
     rbtree_destroy(self->insp_hash);
 
+  /* Same for channelizer shards. This also stops their workers. */
+  for (i = 0; i < self->shard_count; ++i)
+    suscan_local_analyzer_shard_destroy(self->shard_list[i]);
+
+  if (self->shard_sync_init) {
+    pthread_cond_destroy(&self->shard_cond);
+    pthread_mutex_destroy(&self->shard_mutex);
+  }
+
+  /* 
+   * Destroy auxiliary sources. Their factories use the scheduler
+   * of the main factory, so they must be destroyed first.
+   */
+  for (i = 0; i < self->aux_source_count; ++i)
+    if (self->aux_source_list[i] != NULL)
+      suscan_local_analyzer_aux_source_destroy(self->aux_source_list[i]);
+
+  if (self->aux_source_list != NULL)
+    free(self->aux_source_list);
+
   /* Destroy inspectors */
   if (self->insp_factory != NULL)
     suscan_inspector_factory_destroy(self->insp_factory);
@@ -733,6 +878,13 @@ suscan_local_analyzer_dtor(void *ptr)
   if (self->read_buf != NULL)
     free(self->read_buf);
 
+  /* Free adaptive sweep state */
+  if (self->segment_list != NULL)
+    free(self->segment_list);
+
+  if (self->activity_buf != NULL)
+    free(self->activity_buf);
+
   /* Delete source information */
   if (self->source != NULL)
     suscan_source_destroy(self->source);
@@ -860,12 +1012,16 @@ SUPRIVATE SUBOOL
 suscan_local_analyzer_force_eos(void *ptr)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  unsigned int i;
 
   if (self->source == NULL)
     return SU_FALSE;
 
   suscan_source_force_eos(self->source);
 
+  for (i = 0; i < self->aux_source_count; ++i)
+    suscan_source_force_eos(self->aux_source_list[i]->source);
+
   return SU_TRUE;
 }
 
@@ -875,6 +1031,118 @@ suscan_local_analyzer_is_real_time_ex(const suscan_local_analyzer_t *self)
   return suscan_source_is_real_time(self->source);
 }
 
+/*
+ * Compare the sample loss counters of the source against the last ones we
+ * reported, and notify the difference in a SAMPLES_LOST message.
+ */
+SUBOOL
+suscan_local_analyzer_check_lost_samples(suscan_local_analyzer_t *self)
+{
+  const struct suscan_source_info *info = suscan_source_get_info(self->source);
+  SUSCOUNT lost, overflows;
+
+  if (info->overflow_count == self->source_info.overflow_count
+    && info->lost_samples == self->source_info.lost_samples)
+    return SU_TRUE;
+
+  lost      = info->lost_samples   - self->source_info.lost_samples;
+  overflows = info->overflow_count - self->source_info.overflow_count;
+
+  self->source_info.hw_timestamps  = info->hw_timestamps;
+  self->source_info.overflow_count = info->overflow_count;
+  self->source_info.lost_samples   = info->lost_samples;
+
+  if (info->hw_timestamps)
+    return suscan_analyzer_send_status(
+      self->parent,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST,
+      SU_MIN(lost, INT32_MAX),
+      "%lld samples lost (%lld overflows)",
+      (long long) lost,
+      (long long) overflows);
+  
+  /* No hardware time: we know there were overflows, but not their size */
+  return suscan_analyzer_send_status(
+    self->parent,
+    SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST,
+    -1,
+    "%lld overflows (unknown number of samples lost)",
+    (long long) overflows);
+}
+
+/*
+ * Channels of the main source go to the main spectral tuner until it
+ * has SUSCAN_LOCAL_ANALYZER_SHARD_MIN_CHANNELS channels. After that, they
+ * go to the least loaded spectral tuner (main or shard). If all of them
+ * are busy and we can still afford it, a new shard is created. Only the
+ * analyzer thread creates shards.
+ */
+SUPRIVATE suscan_inspector_factory_t *
+suscan_local_analyzer_pick_factory(suscan_local_analyzer_t *self)
+{
+  suscan_inspector_factory_t *factory = self->insp_factory;
+  struct suscan_local_analyzer_shard *shard;
+  unsigned int count, min_count, i;
+
+  min_count = su_specttuner_get_channel_count(self->stuner);
+  if (min_count < SUSCAN_LOCAL_ANALYZER_SHARD_MIN_CHANNELS)
+    return factory;
+
+  for (i = 0; i < self->shard_count; ++i) {
+    count = su_specttuner_get_channel_count(self->shard_list[i]->stuner);
+    if (count < min_count) {
+      min_count = count;
+      factory   = self->shard_list[i]->insp_factory;
+    }
+  }
+
+  if (min_count > 0 && self->shard_count < self->shard_max) {
+    shard = suscan_local_analyzer_shard_new(
+      self,
+      self->shard_count + 1,
+      &self->shard_st_params);
+
+    if (shard == NULL) {
+      SU_WARNING("Cannot create channelizer shard, using existing tuners\n");
+    } else {
+      (void) pthread_mutex_lock(&self->shard_mutex);
+      self->shard_list[self->shard_count++] = shard;
+      (void) pthread_mutex_unlock(&self->shard_mutex);
+
+      factory = shard->insp_factory;
+    }
+  }
+
+  return factory;
+}
+
+/* Source 0 is the main source, auxiliary sources are numbered from 1 */
+suscan_inspector_factory_t *
+suscan_local_analyzer_lookup_factory(
+  suscan_local_analyzer_t *self,
+  unsigned int index,
+  SUFREQ *freq,
+  SUFLOAT *samp_rate)
+{
+  struct suscan_local_analyzer_aux_source *aux;
+
+  if (index == 0) {
+    *freq      = self->source_info.frequency;
+    *samp_rate = suscan_analyzer_get_samp_rate(self->parent);
+    return suscan_local_analyzer_pick_factory(self);
+  }
+
+  if (index > self->aux_source_count)
+    return NULL;
+
+  aux = self->aux_source_list[index - 1];
+
+  *freq      = aux->freq;
+  *samp_rate = aux->samp_rate;
+
+  return aux->insp_factory;
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_is_real_time(const void *ptr)
 {
@@ -1051,6 +1319,31 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_local_analyzer_set_max_revisit_interval(void *ptr, SUFLOAT seconds)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      self->parent->params.mode == SUSCAN_ANALYZER_MODE_WIDE_SPECTRUM,
+      goto done);
+
+  SU_TRYCATCH(seconds > 0, goto done);
+
+  self->pending_sweep_params =
+      self->sweep_params_requested
+        ? self->pending_sweep_params
+        : self->current_sweep_params;
+  self->pending_sweep_params.max_revisit_int = seconds;
+  self->sweep_params_requested = SU_TRUE;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_register_baseband_filter(
     void *ptr,
@@ -1185,6 +1478,7 @@ suscan_local_analyzer_get_interface(void)
     SET_CALLBACK(set_hop_range);
     SET_CALLBACK(set_rel_bandwidth);
     SET_CALLBACK(set_buffering_size);
+    SET_CALLBACK(set_max_revisit_interval);
     SET_CALLBACK(set_inspector_frequency);
     SET_CALLBACK(set_inspector_bandwidth);
     SET_CALLBACK(write);
@@ -25,12 +25,21 @@
 #include <analyzer/inspector/factory.h>
 #include <analyzer/inspector/overridable.h>
 #include <analyzer/pool.h>
+#include <analyzer/psdstats.h>
+#include <analyzer/cfar.h>
 
 #include <rbtree.h>
 
 #define SUSCAN_LOCAL_ANALYZER_MIN_RADIO_FREQ -3e11
 #define SUSCAN_LOCAL_ANALYZER_MAX_RADIO_FREQ +3e11
 
+#define SUSCAN_LOCAL_ANALYZER_MAX_SHARDS         4
+#define SUSCAN_LOCAL_ANALYZER_SHARD_MIN_CHANNELS 8
+
+#define SUSCAN_LOCAL_ANALYZER_PSD_POOL_SIZE      4
+#define SUSCAN_LOCAL_ANALYZER_PSD_MAX_DECIMATION 16
+#define SUSCAN_LOCAL_ANALYZER_PSD_RELAX_COUNT    32
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -38,6 +47,92 @@ extern "C" {
 #define SULIMPL(analyzer) ((suscan_local_analyzer_t *) ((analyzer)->impl))
 #define SUSCAN_LOCAL_ANALYZER_AS_ANALYZER(local) ((local)->parent)
 
+/* Adaptive sweep: activity statistics of a spectrum segment */
+struct suscan_local_analyzer_segment {
+  SUFREQ   freq;       /* Center frequency */
+  SUFLOAT  activity;   /* Smoothed activity, from 0 (quiet) to 1 (busy) */
+  SUFLOAT  power;      /* Last measured power (dB) */
+  uint64_t last_visit; /* In microseconds */
+  SUBOOL   visited;
+};
+
+/*
+ * Spectral tuner behind a secondary inspector factory (auxiliary sources
+ * and channelizer shards). Shards follow the sample rate and frequency of
+ * the main source while auxiliary sources have their own, so both are
+ * read through callbacks.
+ */
+struct suscan_local_analyzer_tuner {
+  struct suscan_local_analyzer *owner;
+  const char                   *desc;  /* For error messages */
+  unsigned int                  index;
+  su_specttuner_t              *stuner;
+  pthread_mutex_t              *stuner_mutex;
+  suscan_source_t              *source; /* Time reference */
+
+  void                         *userdata;
+  SUFLOAT                     (*get_samp_rate) (const void *userdata);
+  SUFREQ                      (*get_freq) (const void *userdata);
+};
+
+/*
+ * Multi-source analyzers: auxiliary sources are read in lockstep with the
+ * main source (every read from the main source is followed by a read of
+ * the same number of samples from each auxiliary source) and channelized
+ * by their own spectral tuner. Their inspector factories share the
+ * scheduler of the main factory, and their inspectors are registered in
+ * the same global handle table.
+ */
+struct suscan_local_analyzer_aux_source {
+  struct suscan_local_analyzer *owner;
+  unsigned int                  index; /* 1 for the first auxiliary source */
+  suscan_source_t              *source;
+  SUFREQ                        freq;
+  SUFLOAT                       samp_rate;
+  SUBOOL                        clock_warned;
+
+  su_specttuner_t              *stuner;
+  pthread_mutex_t               stuner_mutex;
+  SUBOOL                        stuner_init;
+  SUBOOL                        stuner_locked;
+
+  SUCOMPLEX                    *read_buf;
+  SUSCOUNT                      read_size;
+  const SUCOMPLEX              *feed_ptr;
+  SUSCOUNT                      feed_left;
+
+  struct suscan_local_analyzer_tuner tuner;
+  suscan_inspector_factory_t   *insp_factory;
+};
+
+/*
+ * Channelizer shards: additional spectral tuners fed with the same samples
+ * as the main spectral tuner, each one driven by its own worker thread.
+ * Once the main spectral tuner has enough channels, new channels are opened
+ * in the least loaded tuner (creating a new shard if every tuner is busy),
+ * so channel extraction is spread across several cores. Shards are fed in
+ * rounds of one window, and the main tuner is released before waiting for
+ * them.
+ */
+struct suscan_local_analyzer_shard {
+  struct suscan_local_analyzer *owner;
+  unsigned int                  index; /* 1 for the first shard */
+
+  su_specttuner_t              *stuner;
+  pthread_mutex_t               stuner_mutex;
+  SUBOOL                        stuner_init;
+
+  suscan_worker_t              *worker;
+  unsigned int                  round;
+  const SUCOMPLEX              *feed_ptr;
+  SUSCOUNT                      feed_left;
+  SUBOOL                        new_data;
+  SUBOOL                        failed;
+
+  struct suscan_local_analyzer_tuner tuner;
+  suscan_inspector_factory_t   *insp_factory;
+};
+
 struct suscan_local_analyzer {
   suscan_analyzer_t *parent;
   struct suscan_mq mq_in;   /* Input queue */
@@ -117,6 +212,28 @@ struct suscan_local_analyzer {
   su_channel_detector_t *detector; /* Channel detector */
   su_smoothpsd_t  *smooth_psd;
   suscan_worker_t *psd_worker;
+  suscan_sample_buffer_pool_t *psd_pool; /* PSD tap buffers */
+  unsigned int psd_decimation; /* Feed the PSD worker one buffer every N */
+  unsigned int psd_skip;
+  unsigned int psd_idle;
+  SUSCOUNT     psd_dropped;    /* Samples that never reached the PSD */
+
+  /* PSD statistics (channel mode only, owned by the PSD worker) */
+  suscan_psd_stats_t *psd_stats;
+  struct suscan_analyzer_psd_stats_params psd_stats_params;
+  struct suscan_analyzer_psd_stats_params psd_stats_req_params;
+  SUBOOL   psd_stats_req;
+  uint64_t psd_stats_last;
+  uint64_t psd_stats_start;
+
+  /* CFAR signal detector (channel mode only, owned by the PSD worker) */
+  suscan_cfar_t *cfar;
+  struct suscan_analyzer_cfar_params cfar_params;
+  struct suscan_analyzer_cfar_params cfar_req_params;
+  SUBOOL       cfar_req;
+  SUFREQ       cfar_fc;     /* Center frequency of the current tracks */
+  unsigned int cfar_opened; /* Live detector inspectors (hotconf_mutex) */
+
   suscan_worker_t *source_wk; /* Used by one source only */
   suscan_worker_t *slow_wk; /* Worker for slow operations */
   SUCOMPLEX *read_buf;
@@ -132,6 +249,20 @@ struct suscan_local_analyzer {
   SUBOOL                  circularity;
   SUBOOL                  circ_state;
 
+  /* Auxiliary sources (channel mode only) */
+  PTR_LIST(struct suscan_local_analyzer_aux_source, aux_source);
+
+  /* Channelizer shards (channel mode only), created on demand */
+  struct suscan_local_analyzer_shard *shard_list[SUSCAN_LOCAL_ANALYZER_MAX_SHARDS];
+  unsigned int            shard_count;
+  unsigned int            shard_max;
+  struct sigutils_specttuner_params shard_st_params;
+  pthread_mutex_t         shard_mutex;
+  pthread_cond_t          shard_cond;
+  SUBOOL                  shard_sync_init;
+  unsigned int            shard_busy;
+  unsigned int            shard_round;
+
   /* Wide sweep parameters */
   SUBOOL sweep_params_requested;
   struct suscan_analyzer_sweep_params current_sweep_params;
@@ -140,6 +271,19 @@ struct suscan_local_analyzer {
   SUSCOUNT part_ndx;
   SUSCOUNT fft_samples; /* Number of FFT frames */
   SUSCOUNT hop_samples;
+  SUBOOL   hop_calibrated; /* Settle time of the current band is known */
+
+  /* Adaptive sweep state */
+  struct suscan_local_analyzer_segment *segment_list;
+  SUSCOUNT     segment_count;
+  SUSCOUNT     segment_curr;
+  SUFREQ       segment_bw;
+  SUFREQ       segment_min_freq;
+  SUFREQ       segment_max_freq;
+  unsigned int dwell_count;
+  unsigned int dwell_target;
+  SUFLOAT     *activity_buf;
+  SUSCOUNT     activity_buf_size;
 
   suscan_inspector_factory_t         *insp_factory;
   suscan_inspector_request_manager_t  insp_reqmgr;
@@ -159,6 +303,39 @@ typedef struct suscan_local_analyzer suscan_local_analyzer_t;
 /* Internal */
 SUBOOL suscan_local_analyzer_register_factory(void);
 
+/* Internal */
+struct suscan_local_analyzer_aux_source *
+suscan_local_analyzer_aux_source_new(
+    suscan_local_analyzer_t *owner,
+    unsigned int index,
+    suscan_source_config_t *config,
+    const struct sigutils_specttuner_params *st_params);
+
+/* Internal */
+void suscan_local_analyzer_aux_source_destroy(
+    struct suscan_local_analyzer_aux_source *self);
+
+/* Internal */
+struct suscan_local_analyzer_shard *
+suscan_local_analyzer_shard_new(
+    suscan_local_analyzer_t *owner,
+    unsigned int index,
+    const struct sigutils_specttuner_params *st_params);
+
+/* Internal */
+void suscan_local_analyzer_shard_destroy(
+    struct suscan_local_analyzer_shard *self);
+
+/* Internal */
+suscan_inspector_factory_t *suscan_local_analyzer_lookup_factory(
+    suscan_local_analyzer_t *self,
+    unsigned int index,
+    SUFREQ *freq,
+    SUFLOAT *samp_rate);
+
+/* Internal */
+SUBOOL suscan_local_analyzer_check_lost_samples(suscan_local_analyzer_t *self);
+
 /* Internal */
 SUBOOL suscan_local_analyzer_is_real_time_ex(const suscan_local_analyzer_t *self);
 
@@ -257,6 +434,18 @@ SUBOOL suscan_local_analyzer_set_psd_samp_rate_overridable(
     suscan_local_analyzer_t *self,
     SUSCOUNT throttle);
 
+/* Internal */
+SUBOOL suscan_local_analyzer_set_psd_stats_params_overridable(
+    suscan_local_analyzer_t *self,
+    const struct suscan_analyzer_psd_stats_params *params);
+
+SUBOOL suscan_local_analyzer_set_cfar_params_overridable(
+    suscan_local_analyzer_t *self,
+    const struct suscan_analyzer_cfar_params *params);
+
+/* Internal */
+void suscan_local_analyzer_release_cfar_channel(suscan_local_analyzer_t *self);
+
 /* Internal */
 SUBOOL suscan_local_analyzer_slow_set_freq(
     suscan_local_analyzer_t *self,
@@ -453,6 +453,10 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_remote_call)
       SUSCAN_PACK(uint, self->buffering_size);
       break;
 
+    case SUSCAN_ANALYZER_REMOTE_SET_MAX_REVISIT_INTERVAL:
+      SUSCAN_PACK(float, self->max_revisit_int);
+      break;
+
     case SUSCAN_ANALYZER_REMOTE_MESSAGE:
       SU_TRYCATCH(
           suscan_analyzer_msg_serialize(self->msg.type, self->msg.ptr, buffer),
@@ -487,7 +491,11 @@ SUSCAN_PARTIAL_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
 }
 
 
-SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
+SUPRIVATE SUBOOL
+suscan_analyzer_remote_call_deserialize_ex(
+    struct suscan_analyzer_remote_call *self,
+    grow_buf_t *buffer,
+    SUBOOL borrow)
 {
   SUSCAN_UNPACK_BOILERPLATE_START;
 
@@ -547,7 +555,9 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
 
     case SUSCAN_ANALYZER_REMOTE_SET_SWEEP_STRATEGY:
       SUSCAN_UNPACK(uint32, self->sweep_strategy);
-      SU_TRYCATCH(self->sweep_strategy < 2, goto fail);
+      SU_TRYCATCH(
+          self->sweep_strategy <= SUSCAN_ANALYZER_SWEEP_STRATEGY_ADAPTIVE,
+          goto fail);
       break;
 
     case SUSCAN_ANALYZER_REMOTE_SET_SPECTRUM_PARTITIONING:
@@ -572,13 +582,29 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
       SUSCAN_UNPACK(uint32, self->buffering_size);
       break;
 
+    case SUSCAN_ANALYZER_REMOTE_SET_MAX_REVISIT_INTERVAL:
+      SUSCAN_UNPACK(float, self->max_revisit_int);
+
+      SU_TRYCATCH(self->max_revisit_int > 0, goto fail);
+      break;
+
     case SUSCAN_ANALYZER_REMOTE_MESSAGE:
-      SU_TRYCATCH(
-          suscan_analyzer_msg_deserialize(
-              &self->msg.type,
-              &self->msg.ptr,
-              buffer),
-          goto fail);
+      /* Always the last item of the PDU: it may take it over */
+      if (borrow) {
+        SU_TRYCATCH(
+            suscan_analyzer_msg_deserialize_pdu(
+                &self->msg.type,
+                &self->msg.ptr,
+                buffer),
+            goto fail);
+      } else {
+        SU_TRYCATCH(
+            suscan_analyzer_msg_deserialize(
+                &self->msg.type,
+                &self->msg.ptr,
+                buffer),
+            goto fail);
+      }
       break;
 
     case SUSCAN_ANALYZER_REMOTE_REQ_HALT:
@@ -598,6 +624,19 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_remote_call)
+{
+  return suscan_analyzer_remote_call_deserialize_ex(self, buffer, SU_FALSE);
+}
+
+SUBOOL
+suscan_analyzer_remote_call_deserialize_pdu(
+    struct suscan_analyzer_remote_call *self,
+    grow_buf_t *pdu)
+{
+  return suscan_analyzer_remote_call_deserialize_ex(self, pdu, SU_TRUE);
+}
+
 void
 suscan_analyzer_remote_call_init(
     struct suscan_analyzer_remote_call *self,
@@ -1218,7 +1257,7 @@ suscan_remote_analyzer_receive_call(
           call = suscan_remote_analyzer_acquire_call(
                 self,
                 SUSCAN_ANALYZER_REMOTE_NONE);
-          SU_TRY(suscan_analyzer_remote_call_deserialize(call, &buf));
+          SU_TRY(suscan_analyzer_remote_call_deserialize_pdu(call, &buf));
           break;
       }
     }
@@ -2644,6 +2683,34 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_remote_analyzer_set_max_revisit_interval(void *ptr, SUFLOAT seconds)
+{
+  suscan_remote_analyzer_t *self = (suscan_remote_analyzer_t *) ptr;
+  struct suscan_analyzer_remote_call *call = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      call = suscan_remote_analyzer_acquire_call(
+          self,
+          SUSCAN_ANALYZER_REMOTE_SET_MAX_REVISIT_INTERVAL),
+      goto done);
+
+  call->max_revisit_int = seconds;
+
+  SU_TRYCATCH(
+      suscan_remote_analyzer_queue_call(self, call, SU_TRUE),
+      goto done);
+
+  ok = SU_TRUE;
+
+done:
+  if (call != NULL)
+    suscan_remote_analyzer_release_call(self, call);
+
+  return ok;
+}
+
 SUPRIVATE SUBOOL
 suscan_remote_analyzer_write(void *ptr, uint32_t type, void *priv)
 {
@@ -2794,6 +2861,7 @@ suscan_remote_analyzer_get_interface(void)
     SET_CALLBACK(set_hop_range);
     SET_CALLBACK(set_rel_bandwidth);
     SET_CALLBACK(set_buffering_size);
+    SET_CALLBACK(set_max_revisit_interval);
     SET_CALLBACK(write);
     SET_CALLBACK(req_halt);
 
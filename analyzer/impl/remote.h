@@ -40,7 +40,7 @@ extern "C" {
 
 #define SUSCAN_REMOTE_PROTOCOL_TOKEN_SIZE   SHA256_BLOCK_SIZE
 #define SUSCAN_REMOTE_PROTOCOL_MAJOR_VERSION                0
-#define SUSCAN_REMOTE_PROTOCOL_MINOR_VERSION               12
+#define SUSCAN_REMOTE_PROTOCOL_MINOR_VERSION               18
 
 #define SUSCAN_REMOTE_AUTH_MODE_NONE                        0
 #define SUSCAN_REMOTE_AUTH_MODE_USER_PASSWORD               1
@@ -76,6 +76,7 @@ enum suscan_analyzer_remote_type {
   SUSCAN_ANALYZER_REMOTE_REQ_HALT,
   SUSCAN_ANALYZER_REMOTE_AUTH_REJECTED,
   SUSCAN_ANALYZER_REMOTE_STARTUP_ERROR,
+  SUSCAN_ANALYZER_REMOTE_SET_MAX_REVISIT_INTERVAL,
 };
 
 enum suscan_analyzer_superframe_type {
@@ -201,6 +202,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_remote_call) {
     SUFLOAT bandwidth;
     SUFLOAT ppm;
     SUFLOAT rel_bw;
+    SUFLOAT max_revisit_int;
     SUBOOL dc_remove;
     SUBOOL iq_reverse;
     SUBOOL agc;
@@ -223,6 +225,15 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_remote_call) {
 /* Remote calls can be partially deserialized */
 SUSCAN_PARTIAL_DESERIALIZER_PROTO(suscan_analyzer_remote_call);
 
+/*
+ * Deserializes a call from a whole received PDU. Messages may adopt the
+ * PDU storage (see suscan_analyzer_msg_deserialize_pdu), in which case
+ * pdu is left empty.
+ */
+SUBOOL suscan_analyzer_remote_call_deserialize_pdu(
+    struct suscan_analyzer_remote_call *self,
+    grow_buf_t *pdu);
+
 #define suscan_analyzer_remote_call_INITIALIZER         \
 {                                                       \
   SUSCAN_ANALYZER_REMOTE_NONE /* type */                \
@@ -120,6 +120,9 @@ suscan_local_analyzer_unregister_inspector(
 
   suscan_inspector_set_handle(insp, -1);
 
+  if (insp->cfar_opened)
+    suscan_local_analyzer_release_cfar_channel(self);
+
   SU_DEREF(insp, global_handle);
 
   ok = SU_TRUE;
@@ -217,14 +220,20 @@ DEF_MSGCB(OPEN)
   suscan_inspector_t *insp = NULL;
   suscan_inspector_t *new_insp = NULL;
   unsigned int fs;
+  SUFLOAT source_fs;
   SUFREQ ft;
   struct suscan_inspector_sampling_info samp_info;
   suscan_inspector_factory_t *factory = NULL;
   char *dup = NULL;
   unsigned int i;
-  SUHANDLE handle;
+  SUHANDLE handle = -1;
+  SUBOOL cfar;
   SUBOOL ok = SU_FALSE;
 
+  cfar = msg->handle == -1
+    && (msg->req_id & SUSCAN_ANALYZER_CFAR_REQ_ID_MASK)
+      == SUSCAN_ANALYZER_CFAR_REQ_ID_BASE;
+
   if (msg->handle != -1) {
     /* Subcarrier inspector */
     insp = suscan_local_analyzer_acquire_inspector(self, msg->handle);
@@ -247,10 +256,21 @@ DEF_MSGCB(OPEN)
       goto done;
     }
   } else {
-    /* Baseband inspector */
-    fs = suscan_analyzer_get_samp_rate(self->parent);
-    ft = self->source_info.frequency;
-    factory = self->insp_factory;
+    /* Baseband inspector, in any of the sources of the analyzer */
+    factory = suscan_local_analyzer_lookup_factory(
+      self,
+      msg->source,
+      &ft,
+      &source_fs);
+
+    if (factory == NULL) {
+      SU_ERROR("Invalid source index %d\n", msg->source);
+      msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_ARGUMENT;
+      ok = SU_TRUE;
+      goto done;
+    }
+
+    fs = source_fs;
   }
 
   /* XXX: Maybe adquire source info safely */
@@ -270,11 +290,13 @@ DEF_MSGCB(OPEN)
     SU_ASFLOAT(self->source_info.effective_samp_rate) / 
     SU_ASFLOAT(self->source_info.source_samp_rate));
 
+  new_insp->cfar_opened = cfar;
+
   handle = suscan_local_analyzer_register_inspector(self, new_insp);
   
   if (handle == -1) {
     SU_ERROR("Could not register inspector globally\n");
-    suscan_inspector_factory_halt_inspector(self->insp_factory, new_insp);
+    suscan_inspector_factory_halt_inspector(factory, new_insp);
 
     msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_ARGUMENT;
     ok = SU_TRUE;
@@ -321,6 +343,10 @@ DEF_MSGCB(OPEN)
   ok = SU_TRUE;
 
 done:
+  /* Detector requests that did not result in an inspector */
+  if (cfar && handle == -1)
+    suscan_local_analyzer_release_cfar_channel(self);
+
   if (insp != NULL)
     suscan_local_analyzer_return_inspector(self, insp);
 
@@ -374,9 +400,12 @@ DEF_MSGCB(SPECTRUM)
   if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
     goto done;
   
-  if (msg->spectsrc_id <= insp->spectsrc_count)
+  if (msg->spectsrc_id <= insp->spectsrc_count) {
+    suscan_inspector_lock(insp);
     insp->spectsrc_index = msg->spectsrc_id;
-  else
+    insp->spectsrc_mask  = 0;
+    suscan_inspector_unlock(insp);
+  } else
     msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_OBJECT;
 
 done:
@@ -386,6 +415,33 @@ done:
   return SU_TRUE;
 }
 
+DEF_MSGCB(SPECTRUM_MASK)
+{
+  suscan_inspector_t *insp = NULL;
+  uint32_t mask = msg->spectsrc_mask;
+
+  if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
+    goto done;
+
+  /* Spectrum source views only exist for time-domain inspectors */
+  if (mask != 0 && suscan_inspector_is_freq_domain(insp))
+    msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_OBJECT;
+  else if (insp->spectsrc_count < SUSCAN_SPECTSRC_BANK_MAX_VIEWS
+      && (mask >> insp->spectsrc_count) != 0)
+    msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_OBJECT;
+  else {
+    suscan_inspector_lock(insp);
+    insp->spectsrc_mask = mask;
+    suscan_inspector_unlock(insp);
+  }
+
+done:
+  if (insp != NULL)
+    suscan_local_analyzer_return_inspector(self, insp);
+
+  return SU_TRUE;
+}
+
 DEF_MSGCB(GET_CONFIG)
 {
   suscan_inspector_t *insp = NULL;
@@ -650,7 +706,9 @@ DEF_MSGCB(CLOSE)
     goto done);
 
   SU_TRYCATCH(
-    suscan_inspector_factory_halt_inspector(self->insp_factory, insp),
+    suscan_inspector_factory_halt_inspector(
+      suscan_inspector_get_factory(insp),
+      insp),
     goto done);
 
   SU_TRYCATCH(
@@ -712,6 +770,7 @@ suscan_insp_server_init(void)
   INIT_MSGCB(SET_ID);
   INIT_MSGCB(ESTIMATOR);
   INIT_MSGCB(SPECTRUM);
+  INIT_MSGCB(SPECTRUM_MASK);
   INIT_MSGCB(GET_CONFIG);
   INIT_MSGCB(SET_CONFIG);
   INIT_MSGCB(SET_TLE);
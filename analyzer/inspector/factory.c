@@ -94,7 +94,7 @@ suscan_inspector_factory_destroy(suscan_inspector_factory_t *self)
   if (self->userdata != NULL)
     (self->iface->dtor) (self->userdata);
 
-  if (self->sched != NULL)
+  if (self->sched != NULL && !self->sched_shared)
     suscan_inspsched_destroy(self->sched);
 
   if (self->inspector_list_init)
@@ -283,6 +283,28 @@ suscan_inspector_factory_force_sync(suscan_inspector_factory_t *self)
   return suscan_inspsched_sync(self->sched);
 }
 
+SUBOOL
+suscan_inspector_factory_share_sched(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_factory_t *owner)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(self->inspector_count == 0, goto done);
+  SU_TRYCATCH(self->mq_ctl == owner->mq_ctl, goto done);
+
+  if (self->sched != NULL && !self->sched_shared)
+    suscan_inspsched_destroy(self->sched);
+
+  self->sched        = owner->sched;
+  self->sched_shared = SU_TRUE;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 /*
  * TODO: This is not enough to halt an inspector, as overridable
  * requests may keep references to it. Remember to call
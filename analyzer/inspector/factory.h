@@ -94,6 +94,7 @@ struct suscan_inspector_factory {
   SUBOOL              inspector_list_init;
   
   suscan_inspsched_t *sched;   /* Inspector scheduler */
+  SUBOOL              sched_shared; /* Scheduler owned by other factory */
 };
 
 typedef struct suscan_inspector_factory suscan_inspector_factory_t;
@@ -219,6 +220,16 @@ SUBOOL suscan_inspector_factory_notify_freq(
 
 SUBOOL suscan_inspector_factory_force_sync(suscan_inspector_factory_t *self);
 
+/*
+ * Make this factory queue its tasks in the scheduler of another factory,
+ * so inspectors of both factories are run by the same worker pool and
+ * synchronized by a single call to force_sync. Must be called before
+ * opening any inspector, and the owner must outlive this factory.
+ */
+SUBOOL suscan_inspector_factory_share_sched(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_factory_t *owner);
+
 SUBOOL suscan_inspector_factory_halt_inspector(
   suscan_inspector_factory_t *self,
   suscan_inspector_t *insp);
@@ -73,6 +73,8 @@ struct suscan_ask_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
   SUCOMPLEX           phase;      /* Local oscillator phase */
   SUCOMPLEX           last;       /* Last sample processed */
+
+  SUCOMPLEX           block[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE]; /* Work buffer */
 };
 
 SUSCOUNT
@@ -329,6 +331,7 @@ suscan_ask_inspector_commit_config(void *private)
   }
 }
 
+/* Samples are processed in blocks, one stage at a time (see psk.c) */
 SUSDIFF
 suscan_ask_inspector_feed(
     void *private,
@@ -336,76 +339,74 @@ suscan_ask_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX const_gain = 0;
-  SUCOMPLEX det_x;
+  SUSCOUNT i, n, fed = 0;
   SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  SUCOMPLEX last = 0;
+  SUBOOL new_sample;
 
   struct suscan_ask_inspector *ask_insp =
       (struct suscan_ask_inspector *) private;
+  const struct suscan_ask_inspector_params *params = &ask_insp->cur_params;
+  SUCOMPLEX *y = ask_insp->block;
 
-  last = ask_insp->last;
-
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
+  while ((n = suscan_inspector_feed_block_size(insp, count - fed)) > 0) {
     /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&ask_insp->lo)) * ask_insp->phase;
+    suscan_inspector_mix_block(&ask_insp->lo, ask_insp->phase, y, x + fed, n);
 
     /* Perform gain control */
-    switch (ask_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        const_gain = 2 * ask_insp->cur_params.gc.gc_gain * det_x;
-        break;
-
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        const_gain  = 2 * su_agc_feed(&ask_insp->agc, det_x);
-        break;
-    }
+    suscan_inspector_gain_block(
+        &ask_insp->agc,
+        params->gc.gc_ctrl == SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC,
+        params->gc.gc_gain,
+        y,
+        n);
 
     /* Apply PLL, if enabled */
-    if (ask_insp->cur_params.ask.uses_pll)
-      const_gain = su_pll_track(&ask_insp->pll, const_gain);
+    if (params->ask.uses_pll)
+      for (i = 0; i < n; ++i)
+        y[i] = su_pll_track(&ask_insp->pll, y[i]);
 
     /* Select the component to be demodulated */
-    switch (ask_insp->cur_params.ask.channel) {
+    switch (params->ask.channel) {
       case SUSCAN_INSPECTOR_ASK_CHANNEL_I:
-        det_x = SU_C_REAL(const_gain);
+        for (i = 0; i < n; ++i)
+          y[i] = SU_C_REAL(y[i]);
         break;
 
       case SUSCAN_INSPECTOR_ASK_CHANNEL_Q:
-        det_x = I * SU_C_IMAG(const_gain);
+        for (i = 0; i < n; ++i)
+          y[i] = I * SU_C_IMAG(y[i]);
         break;
 
       default:
-        det_x = const_gain;
+        break;
     }
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, det_x);
+    SU_TRYCATCH(suscan_inspector_feed_sc_block(insp, y, n), return -1);
 
     /* Add matched filter, if enabled */
-    if (ask_insp->cur_params.mf.mf_conf
-        == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&ask_insp->mf, det_x);
-
-    /* Check if channel sampler is enabled */
-    if (ask_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&ask_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&ask_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&ask_insp->cd, &output, 1) == 1;
+    if (params->mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+      for (i = 0; i < n; ++i)
+        y[i] = su_iir_filt_feed(&ask_insp->mf, y[i]);
+
+    /* Symbol timing: fixed rate sampler or clock recovery */
+    for (i = 0; i < n; ++i) {
+      if (params->br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+        output = y[i];
+        new_sample = su_sampler_feed(&ask_insp->sampler, &output);
+      } else {
+        su_clock_detector_feed(&ask_insp->cd, y[i]);
+        new_sample = su_clock_detector_read(&ask_insp->cd, &output, 1) == 1;
+      }
+
+      if (new_sample)
+        suscan_inspector_push_sample(insp, output * .75 * ask_insp->phase);
     }
 
-    if (new_sample)
-      suscan_inspector_push_sample(insp, output * .75 * ask_insp->phase);
+    fed += n;
   }
 
-  ask_insp->last = last;
-
-  return i;
+  return fed;
 }
 
 void
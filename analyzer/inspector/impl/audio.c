@@ -27,6 +27,7 @@
 #include <sigutils/clock.h>
 
 #include <analyzer/version.h>
+#include <analyzer/resampler.h>
 
 #include "inspector/interface.h"
 #include "inspector/params.h"
@@ -56,7 +57,9 @@ struct suscan_audio_inspector_params {
 
 #define SUSCAN_AUDIO_INSPECTOR_MIN_TS             1e-1
 
-#define SUSCAN_AUDIO_INSPECTOR_BRICKWALL_LEN      200
+#define SUSCAN_AUDIO_INSPECTOR_FM_ZERO_CROSSINGS  8
+#define SUSCAN_AUDIO_INSPECTOR_AM_ZERO_CROSSINGS  6
+#define SUSCAN_AUDIO_INSPECTOR_SSB_ZERO_CROSSINGS 16
 #define SUSCAN_AUDIO_AM_LPF_SECONDS               .1
 #define SUSCAN_AUDIO_AM_ATTENUATION               .25
 #define SUSCAN_AUDIO_AM_CARRIER_AVERAGING_SECONDS .2
@@ -70,13 +73,12 @@ struct suscan_audio_inspector {
 
   /* Blocks */
   su_agc_t  agc;          /* AGC, for AM-like modulations */
-  su_iir_filt_t filt;     /* Input filter */
 
   su_iir_filt_t fm_lpf;   /* FM low pass filter */
 
   su_pll_t pll;           /* Carrier tracking PLL */
   su_ncqo_t lo;           /* Oscillator */
-  su_sampler_t sampler;   /* Fixed rate sampler */
+  suscan_resampler_t *resampler; /* Audio filter and resampler */
 
   SUFLOAT beta;           /* Coefficient for single pole IIR filter */
   SUCOMPLEX last;         /* Last processed sample (for quad demod) */
@@ -88,6 +90,11 @@ struct suscan_audio_inspector {
   SUFLOAT am_power_carr;  /* Measure of AM power carrier */
 
   SUFLOAT ssb_power_chan; /* Measure of SSB power */
+
+  SUCOMPLEX block[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE]; /* Work buffer */
+  SUCOMPLEX out[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE];   /* Resampler output */
+  SUSCOUNT  out_ptr;      /* First output not yet pushed */
+  SUSCOUNT  out_len;
 };
 
 SUPRIVATE void
@@ -109,15 +116,14 @@ suscan_audio_inspector_params_initialize(
 SUPRIVATE void
 suscan_audio_inspector_destroy(struct suscan_audio_inspector *insp)
 {
-  su_iir_filt_finalize(&insp->filt);
-
   su_iir_filt_finalize(&insp->fm_lpf);
 
   su_pll_finalize(&insp->pll);
 
   su_agc_finalize(&insp->agc);
 
-  su_sampler_finalize(&insp->sampler);
+  if (insp->resampler != NULL)
+    suscan_resampler_destroy(insp->resampler);
 
   free(insp);
 }
@@ -176,11 +182,7 @@ suscan_audio_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
   /* PLL init, this is an experimental optimum that works rather well for AM */
   su_pll_init(&new->pll, 0, .005f * bw);
 
-  /* Filter init */
-  SU_TRY_FAIL(su_iir_bwlpf_init(
-      &new->filt,
-      5,
-      SU_ABS2NORM_FREQ(sinfo->equiv_fs, new->cur_params.audio.cutoff)));
+  /* Audio filter and resampler are created when demodulation is enabled */
 
   /* NCQO init, used to sideband adjustment */
   su_ncqo_init(&new->lo, .5 * bw);
@@ -283,15 +285,99 @@ suscan_audio_inspector_needs_agc_update(
   return SU_FALSE;
 }
 
+SUINLINE SUBOOL
+suscan_audio_inspector_needs_resampler_update(
+  const struct suscan_audio_inspector *self)
+{
+  return self->resampler == NULL
+      || self->req_params.audio.demod != self->cur_params.audio.demod
+      || self->req_params.audio.sample_rate
+        != self->cur_params.audio.sample_rate
+      || self->req_params.audio.cutoff != self->cur_params.audio.cutoff;
+}
+
+/*
+ * The audio filter is part of the resampler, and its selectivity
+ * depends on the demodulator.
+ */
+SUPRIVATE SUBOOL
+suscan_audio_inspector_update_resampler(struct suscan_audio_inspector *self)
+{
+  suscan_resampler_t *resampler = NULL;
+  unsigned int zero_crossings;
+  SUBOOL ok = SU_FALSE;
+
+  switch (self->req_params.audio.demod) {
+    case SUSCAN_INSPECTOR_AUDIO_DEMOD_FM:
+      /*
+       * FM transmissions are rather wide (up to 15 kHz), and pilot tones
+       * are at around 19 kHz. We prefer to attenuate the pilot tone instead
+       * of providing high stability at lower cutoff frequencies.
+       */
+      zero_crossings = SUSCAN_AUDIO_INSPECTOR_FM_ZERO_CROSSINGS;
+      break;
+
+    case SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW:
+    case SUSCAN_INSPECTOR_AUDIO_DEMOD_AM:
+      /*
+       * AM transmissions are around 12 kHz (6 per sideband). In this case,
+       * it is okay to provide a filter with a wider transition band.
+       */
+      zero_crossings = SUSCAN_AUDIO_INSPECTOR_AM_ZERO_CROSSINGS;
+      break;
+
+    case SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB:
+    case SUSCAN_INSPECTOR_AUDIO_DEMOD_USB:
+      /*
+       * SSB transmissions are usually very narrow, and require great
+       * selectivity, even at low cutoffs. We sacrifice CPU in order
+       * to attain this.
+       */
+      zero_crossings = SUSCAN_AUDIO_INSPECTOR_SSB_ZERO_CROSSINGS;
+      break;
+
+    default:
+      SU_ERROR("Unsupported audio demodulator\n");
+      goto done;
+  }
+
+  SU_MAKE(
+      resampler,
+      suscan_resampler,
+      self->samp_info.equiv_fs,
+      self->req_params.audio.sample_rate,
+      self->req_params.audio.cutoff,
+      zero_crossings);
+
+  /* Every input sample must fit in the output buffer */
+  if (suscan_resampler_get_input_count(
+      resampler,
+      SUSCAN_INSPECTOR_FEED_BLOCK_SIZE) == 0) {
+    SU_ERROR("Audio sample rate too high for this channel\n");
+    goto done;
+  }
+
+  if (self->resampler != NULL)
+    suscan_resampler_destroy(self->resampler);
+
+  self->resampler = resampler;
+  resampler = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (resampler != NULL)
+    suscan_resampler_destroy(resampler);
+
+  return ok;
+}
+
 /* Called inside inspector mutex */
 void
 suscan_audio_inspector_commit_config(void *private)
 {
   struct suscan_audio_inspector *self =
       (struct suscan_audio_inspector *) private;
-  su_iir_filt_t filt;
-  SUBOOL filt_initialized;
-  SUFLOAT fs = self->samp_info.equiv_fs;
 
   self->last  = 0;
 
@@ -305,72 +391,79 @@ suscan_audio_inspector_commit_config(void *private)
   }
 
   /* Configure demod */
-  if (self->req_params.audio.demod != SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED) {
-    switch (self->req_params.audio.demod) {
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_FM:
-        /*
-         * FM transmissions are rather wide (up to 15 kHz), and pilot tones
-         * are at around 19 kHz. We prefer to attenuate the pilot tone instead
-         * of providing high stability at lower cutoff frequencies.
-         */
-        filt_initialized = su_iir_bwlpf_init(
-            &filt,
-            5,
-            SU_ABS2NORM_FREQ(fs, self->req_params.audio.cutoff));
+  if (self->req_params.audio.demod != SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED
+      && self->req_params.audio.sample_rate > 0
+      && suscan_audio_inspector_needs_resampler_update(self)) {
+    if (!suscan_audio_inspector_update_resampler(self)) {
+      SU_ERROR("Failed to update audio resampler\n");
+
+      /* Keep the settings the current resampler was built for */
+      self->req_params.audio.demod       = self->cur_params.audio.demod;
+      self->req_params.audio.sample_rate = self->cur_params.audio.sample_rate;
+      self->req_params.audio.cutoff      = self->cur_params.audio.cutoff;
+    }
+  }
 
-        break;
+  self->cur_params = self->req_params;
+}
 
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW:
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_AM:
-        /*
-         * AM transmissions are around 12 kHz (6 per sideband). In this case,
-         * it is okay to provide a filter with lower Q but stable at lower
-         * cutoff frequencies.
-         */
-        filt_initialized = su_iir_bwlpf_init(
-            &filt,
-            3,
-            SU_ABS2NORM_FREQ(fs, self->req_params.audio.cutoff));
+/*
+ * When the output rate is higher than the input rate, the resampler may
+ * produce more samples than the sampler buffer can take. These are kept
+ * and pushed in the next call.
+ */
+SUINLINE SUBOOL
+suscan_audio_inspector_flush(
+    struct suscan_audio_inspector *self,
+    suscan_inspector_t *insp)
+{
+  self->out_ptr += suscan_inspector_push_sample_buffer(
+      insp,
+      self->out + self->out_ptr,
+      self->out_len - self->out_ptr);
 
-        break;
+  return self->out_ptr == self->out_len;
+}
 
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB:
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_USB:
-        /*
-         * SSB transmissions are usually very narrow, and require great
-         * selectivity, even at low cutoffs. We sacrifice CPU in order
-         * to attain this.
-         */
-        filt_initialized = su_iir_brickwall_lp_init(
-            &filt,
-            SUSCAN_AUDIO_INSPECTOR_BRICKWALL_LEN,
-            SU_ABS2NORM_FREQ(fs, self->req_params.audio.cutoff));
-        break;
+/*
+ * Largest input block that does not take the sample buffer past the
+ * watermark. The remaining room is counted in output samples, and mapped
+ * to input samples through the resampler ratio (i.e. it is multiplied by
+ * the decimation when the output rate is lower than the input rate).
+ */
+SUINLINE SUSCOUNT
+suscan_audio_inspector_get_block_size(
+    const struct suscan_audio_inspector *self,
+    const suscan_inspector_t *insp,
+    SUSCOUNT avail)
+{
+  SUSCOUNT len  = suscan_inspector_get_output_length(insp);
+  SUSCOUNT wm   = insp->sample_msg_watermark;
+  SUSCOUNT room = SUSCAN_INSPECTOR_FEED_BLOCK_SIZE;
+  SUSCOUNT max;
 
-      default:
-        filt_initialized = SU_FALSE;
-        break;
-    }
+  if (len < wm && wm - len < room)
+    room = wm - len;
 
-    if (!filt_initialized) {
-      SU_ERROR("No memory left to initialize audio filter");
-    } else {
-      su_iir_filt_finalize(&self->filt);
-      self->filt = filt;
-    }
-  }
+  /* Fall back to the full output buffer if a single input is too much */
+  if ((max = suscan_resampler_get_input_count(self->resampler, room)) == 0)
+    max = suscan_resampler_get_input_count(
+        self->resampler,
+        SUSCAN_INSPECTOR_FEED_BLOCK_SIZE);
 
-  /* Set sampling info */
-  if (self->req_params.audio.sample_rate > 0) {
-    su_sampler_finalize(&self->sampler);
-    su_sampler_init(
-        &self->sampler,
-        SU_ABS2NORM_BAUD(fs, self->req_params.audio.sample_rate));
-  }
+  /* The work buffer holds one block of input samples */
+  avail = suscan_inspector_feed_block_size(insp, avail);
 
-  self->cur_params = self->req_params;
+  return avail < max ? avail : max;
 }
 
+/*
+ * Samples are processed in blocks, one stage at a time (see psk.c).
+ * Blocks are sized so that they do not go past the sample message
+ * watermark, so that the feed function still returns as soon as it is
+ * reached. The audio filter and the change of rate are done by a
+ * polyphase resampler, which works at the output rate.
+ */
 SUSDIFF
 suscan_audio_inspector_feed(
     void *private,
@@ -378,141 +471,167 @@ suscan_audio_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUCOMPLEX last, det_x, output = 0;
-  SUSCOUNT i;
-  SUCOMPLEX lo;
-  SUCOMPLEX ylp;
+  SUCOMPLEX last, output, lo, ylp;
+  SUSCOUNT i, n, fed = 0;
+  SUFLOAT k;
+  SUBOOL reached = SU_FALSE;
   struct suscan_audio_inspector *self =
       (struct suscan_audio_inspector *) private;
-  SUBOOL raw = self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW;
-
-  if (self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED)
+  const struct suscan_audio_inspector_params *params = &self->cur_params;
+  enum suscan_inspector_audio_demod demod = params->audio.demod;
+  SUBOOL raw = demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW;
+  SUSCOUNT wm = insp->sample_msg_watermark;
+  SUCOMPLEX *y = self->block;
+
+  if (demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED
+      || self->resampler == NULL)
     return count;
 
-  last = self->last;
-
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    det_x = SU_C_VALID(x[i]) ? x[i] : 0;
-
-    if (!raw
-        && self->cur_params.audio.squelch
-        && (self->cur_params.audio.demod
-              == SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB
-            || self->cur_params.audio.demod
-                == SUSCAN_INSPECTOR_AUDIO_DEMOD_USB)) {
-      SU_SPLPF_FEED(
-          self->ssb_power_chan,
-          SU_C_REAL(det_x * SU_C_CONJ(det_x)),
-          self->sql_alpha);
-
-      if (self->ssb_power_chan
-          * suscan_inspector_get_equiv_fs(insp)
-            / suscan_inspector_get_equiv_bw(insp)
-            < self->cur_params.audio.squelch_level)
-        det_x = 0;
-    }
+  if (!suscan_audio_inspector_flush(self, insp))
+    return 0;
+
+  while (!reached
+      && (n = suscan_audio_inspector_get_block_size(
+          self,
+          insp,
+          count - fed)) > 0) {
+    for (i = 0; i < n; ++i)
+      y[i] = SU_C_VALID(x[fed + i]) ? x[fed + i] : 0;
 
     if (!raw) {
-      /* Perform gain control */
-      switch (self->cur_params.gc.gc_ctrl) {
-        case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-          det_x = 2 * self->cur_params.gc.gc_gain * det_x;
-          break;
-
-        case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-          det_x  = 2 * su_agc_feed(&self->agc, det_x);
-          break;
+      if (params->audio.squelch
+          && (demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB
+              || demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_USB)) {
+        k = suscan_inspector_get_equiv_fs(insp)
+            / suscan_inspector_get_equiv_bw(insp);
+
+        for (i = 0; i < n; ++i) {
+          SU_SPLPF_FEED(
+              self->ssb_power_chan,
+              SU_C_REAL(y[i] * SU_C_CONJ(y[i])),
+              self->sql_alpha);
+
+          if (self->ssb_power_chan * k < params->audio.squelch_level)
+            y[i] = 0;
+        }
       }
+
+      /* Perform gain control */
+      suscan_inspector_gain_block(
+          &self->agc,
+          params->gc.gc_ctrl == SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC,
+          params->gc.gc_gain,
+          y,
+          n);
     }
 
-    switch (self->cur_params.audio.demod) {
+    switch (demod) {
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_FM:
-        output = SU_C_ARG(det_x * SU_C_CONJ(last)) / M_PI;
-        last   = det_x;
+        /* In place, from the end: y[i - 1] is still the input sample */
+        last = self->last;
+        self->last = y[n - 1];
+
+        for (i = n - 1; i > 0; --i)
+          y[i] = SU_C_ARG(y[i] * SU_C_CONJ(y[i - 1])) / M_PI;
+        y[0] = SU_C_ARG(y[0] * SU_C_CONJ(last)) / M_PI;
 
         /*
          * FM squelch compares the output in lower frequencies
          * with the output of the full channel.
          */
-        if (self->cur_params.audio.squelch) {
-          ylp = su_iir_filt_feed(&self->fm_lpf, output);
-
-          SU_SPLPF_FEED(
-              self->fm_power_low,
-              SU_C_REAL(ylp * SU_C_CONJ(ylp)),
-              self->sql_alpha);
-
-          SU_SPLPF_FEED(
-              self->fm_power_chan,
-              SU_C_REAL(output * SU_C_CONJ(output)),
-              self->sql_alpha);
-
-          if (!sufreleq(self->fm_power_chan, self->fm_power_low, 1e-1))
-            output = 0;
+        if (params->audio.squelch) {
+          for (i = 0; i < n; ++i) {
+            ylp = su_iir_filt_feed(&self->fm_lpf, y[i]);
+
+            SU_SPLPF_FEED(
+                self->fm_power_low,
+                SU_C_REAL(ylp * SU_C_CONJ(ylp)),
+                self->sql_alpha);
+
+            SU_SPLPF_FEED(
+                self->fm_power_chan,
+                SU_C_REAL(y[i] * SU_C_CONJ(y[i])),
+                self->sql_alpha);
+
+            if (!sufreleq(self->fm_power_chan, self->fm_power_low, 1e-1))
+              y[i] = 0;
+          }
         }
-
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_AM:
-        /* Synchronous detection */
-        output  = su_pll_track(&self->pll, det_x);
-
-        /* Carrier removal */
-        SU_SPLPF_FEED(last, output, self->beta);
-
-        if (self->cur_params.audio.squelch) {
-          SU_SPLPF_FEED(
-              self->am_power_carr,
-              SU_C_REAL(last * SU_C_CONJ(last)),
-              self->sql_alpha);
-
-          if (self->am_power_carr < self->cur_params.audio.squelch_level)
-            output = 0;
-          else
+        last = self->last;
+
+        for (i = 0; i < n; ++i) {
+          /* Synchronous detection */
+          output = su_pll_track(&self->pll, y[i]);
+
+          /* Carrier removal */
+          SU_SPLPF_FEED(last, output, self->beta);
+
+          if (params->audio.squelch) {
+            SU_SPLPF_FEED(
+                self->am_power_carr,
+                SU_C_REAL(last * SU_C_CONJ(last)),
+                self->sql_alpha);
+
+            if (self->am_power_carr < params->audio.squelch_level)
+              output = 0;
+            else
+              output -= last;
+          } else {
             output -= last;
-        } else {
-          output -= last;
+          }
+
+          /* Volume attenuation */
+          y[i] = output * SUSCAN_AUDIO_AM_ATTENUATION;
         }
 
-        /* Volume attenuation */
-        output *= SUSCAN_AUDIO_AM_ATTENUATION;
+        self->last = last;
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_USB:
-        lo = su_ncqo_read(&self->lo);
-        output  = det_x * lo;
+        for (i = 0; i < n; ++i) {
+          lo = su_ncqo_read(&self->lo);
+          y[i] *= lo;
+        }
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB:
-        lo = su_ncqo_read(&self->lo);
-        output = det_x * SU_C_CONJ(lo);
+        for (i = 0; i < n; ++i) {
+          lo = su_ncqo_read(&self->lo);
+          y[i] *= SU_C_CONJ(lo);
+        }
         break;
 
       /* Pass thru */
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW:
-        output = SUSCAN_AUDIO_RAW_GAIN * det_x;
+        for (i = 0; i < n; ++i)
+          y[i] *= SUSCAN_AUDIO_RAW_GAIN;
+        break;
 
       default:
         break;
     }
 
-    output *= self->cur_params.audio.volume;
+    k = params->audio.volume;
+    for (i = 0; i < n; ++i)
+      y[i] *= k;
 
-    output = su_iir_filt_feed(&self->filt, output);
+    self->out_ptr = 0;
+    self->out_len = suscan_resampler_feed(self->resampler, y, n, self->out);
 
-    if (su_sampler_feed(&self->sampler, &output)) {
-      suscan_inspector_push_sample(insp, output * .75);
-      if (suscan_inspector_get_output_length(insp) == insp->sample_msg_watermark) {
-        ++i; /* Important! We have consumed this sample too! */
-        break;
-      }
-    }
-  }
+    for (i = 0; i < self->out_len; ++i)
+      self->out[i] *= .75;
 
+    fed += n;
 
-  self->last = last;
+    if (!suscan_audio_inspector_flush(self, insp)
+        || suscan_inspector_get_output_length(insp) >= wm)
+      reached = SU_TRUE;
+  }
 
-  return i;
+  return fed;
 }
 
 void
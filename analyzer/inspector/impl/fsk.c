@@ -72,6 +72,10 @@ struct suscan_fsk_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
   SUCOMPLEX           phase;      /* Local oscillator phase */
   SUCOMPLEX           last;       /* Last processed sample */
+
+  /* Work buffers */
+  SUCOMPLEX           block[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE];
+  SUCOMPLEX           demod[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE];
 };
 
 SUSCOUNT
@@ -305,6 +309,7 @@ suscan_fsk_inspector_commit_config(void *private)
   }
 }
 
+/* Samples are processed in blocks, one stage at a time (see psk.c) */
 SUSDIFF
 suscan_fsk_inspector_feed(
     void *private,
@@ -312,69 +317,79 @@ suscan_fsk_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX const_gain = 0;
-  SUCOMPLEX det_x;
+  SUSCOUNT i, n, fed = 0;
   SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  SUCOMPLEX last = 0;
+  SUCOMPLEX last;
+  SUBOOL new_sample;
 
   struct suscan_fsk_inspector *fsk_insp =
       (struct suscan_fsk_inspector *) private;
+  const struct suscan_fsk_inspector_params *params = &fsk_insp->cur_params;
+  SUCOMPLEX *y = fsk_insp->block;
+  SUCOMPLEX *z = fsk_insp->demod;
 
-  last = fsk_insp->last;
-
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
+  while ((n = suscan_inspector_feed_block_size(insp, count - fed)) > 0) {
     /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&fsk_insp->lo));
+    suscan_inspector_mix_block(&fsk_insp->lo, 1, y, x + fed, n);
 
     /* Perform gain control */
-    switch (fsk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        const_gain = 2 * fsk_insp->cur_params.gc.gc_gain * det_x;
-        break;
-
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        const_gain = 2 * su_agc_feed(&fsk_insp->agc, det_x);
-        break;
-    }
+    suscan_inspector_gain_block(
+        &fsk_insp->agc,
+        params->gc.gc_ctrl == SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC,
+        params->gc.gc_gain,
+        y,
+        n);
 
     /*
      * We are actually encoding frequency information in the phase. This
      * is intentional, as the UI quantizes the argument of each sample.
      */
-    if (fsk_insp->cur_params.fsk.quad_demod)
-      det_x = const_gain * SU_C_CONJ(last);
-    else
-      det_x = (const_gain * SU_C_CONJ(last)) /
-      (.5 * (const_gain * SU_C_CONJ(const_gain) + last * SU_C_CONJ(last)) + 1e-8);
+    last = fsk_insp->last;
+
+    if (params->fsk.quad_demod) {
+      z[0] = y[0] * SU_C_CONJ(last);
+      for (i = 1; i < n; ++i)
+        z[i] = y[i] * SU_C_CONJ(y[i - 1]);
+    } else {
+      z[0] = (y[0] * SU_C_CONJ(last)) /
+        (.5 * (y[0] * SU_C_CONJ(y[0]) + last * SU_C_CONJ(last)) + 1e-8);
+      for (i = 1; i < n; ++i)
+        z[i] = (y[i] * SU_C_CONJ(y[i - 1])) /
+          (.5 * (y[i] * SU_C_CONJ(y[i]) + y[i - 1] * SU_C_CONJ(y[i - 1]))
+            + 1e-8);
+    }
 
-    last = const_gain;
+    fsk_insp->last = y[n - 1];
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, SU_C_ARG(det_x));
+    for (i = 0; i < n; ++i)
+      y[i] = SU_C_ARG(z[i]);
 
-    /* Add matched filter, if enabled */
-    if (fsk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&fsk_insp->mf, det_x);
+    SU_TRYCATCH(suscan_inspector_feed_sc_block(insp, y, n), return -1);
 
-    /* Check if channel sampler is enabled */
-    if (fsk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&fsk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&fsk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&fsk_insp->cd, &output, 1) == 1;
+    /* Add matched filter, if enabled */
+    if (params->mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+      for (i = 0; i < n; ++i)
+        z[i] = su_iir_filt_feed(&fsk_insp->mf, z[i]);
+
+    /* Symbol timing: fixed rate sampler or clock recovery */
+    for (i = 0; i < n; ++i) {
+      if (params->br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+        output = z[i];
+        new_sample = su_sampler_feed(&fsk_insp->sampler, &output);
+      } else {
+        su_clock_detector_feed(&fsk_insp->cd, z[i]);
+        new_sample = su_clock_detector_read(&fsk_insp->cd, &output, 1) == 1;
+      }
+
+      if (new_sample)
+        suscan_inspector_push_sample(insp, output * .75 * fsk_insp->phase);
     }
 
-    if (new_sample)
-      suscan_inspector_push_sample(insp, output * .75 * fsk_insp->phase);
+    fed += n;
   }
 
-  fsk_insp->last = last;
-
-  return i;
+  return fed;
 }
 
 void
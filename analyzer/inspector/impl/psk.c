@@ -76,6 +76,8 @@ struct suscan_psk_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
 
   SUCOMPLEX           phase;      /* Local oscillator phase */
+
+  SUCOMPLEX           block[SUSCAN_INSPECTOR_FEED_BLOCK_SIZE]; /* Work buffer */
 };
 
 SUSCOUNT
@@ -393,6 +395,12 @@ suscan_psk_inspector_commit_config(void *private)
   }
 }
 
+/*
+ * Samples are processed in blocks, one stage at a time. Every stage only
+ * depends on its own state, so the result is the same as running the
+ * whole chain sample by sample, but configuration checks are done once
+ * per block and stateless stages can be vectorized.
+ */
 SUSDIFF
 suscan_psk_inspector_feed(
     void *private,
@@ -400,64 +408,66 @@ suscan_psk_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX det_x;
+  SUSCOUNT i, n, fed = 0;
   SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
+  SUBOOL new_sample;
   struct suscan_psk_inspector *psk_insp =
       (struct suscan_psk_inspector *) private;
+  const struct suscan_psk_inspector_params *params = &psk_insp->cur_params;
+  SUCOMPLEX *y = psk_insp->block;
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
+  while ((n = suscan_inspector_feed_block_size(insp, count - fed)) > 0) {
     /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&psk_insp->lo)) * psk_insp->phase;
+    suscan_inspector_mix_block(&psk_insp->lo, psk_insp->phase, y, x + fed, n);
 
     /* Perform gain control */
-    switch (psk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        det_x *= 2 * psk_insp->cur_params.gc.gc_gain;
-        break;
-
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        det_x  = 2 * su_agc_feed(&psk_insp->agc, det_x);
-        break;
-    }
+    suscan_inspector_gain_block(
+        &psk_insp->agc,
+        params->gc.gc_ctrl == SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC,
+        params->gc.gc_gain,
+        y,
+        n);
 
     /* Perform frequency correction */
-    if (psk_insp->cur_params.fc.fc_ctrl
-        != SUSCAN_INSPECTOR_CARRIER_CONTROL_MANUAL) {
-      su_costas_feed(&psk_insp->costas, det_x);
-      det_x = psk_insp->costas.y;
+    if (params->fc.fc_ctrl != SUSCAN_INSPECTOR_CARRIER_CONTROL_MANUAL) {
+      for (i = 0; i < n; ++i) {
+        su_costas_feed(&psk_insp->costas, y[i]);
+        y[i] = psk_insp->costas.y;
+      }
     }
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, det_x);
+    SU_TRYCATCH(suscan_inspector_feed_sc_block(insp, y, n), return -1);
 
     /* Add matched filter, if enabled */
-    if (psk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&psk_insp->mf, det_x);
+    if (params->mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+      for (i = 0; i < n; ++i)
+        y[i] = su_iir_filt_feed(&psk_insp->mf, y[i]);
+
+    /* Symbol timing: fixed rate sampler or clock recovery */
+    for (i = 0; i < n; ++i) {
+      if (params->br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+        output = y[i];
+        new_sample = su_sampler_feed(&psk_insp->sampler, &output);
+      } else {
+        su_clock_detector_feed(&psk_insp->cd, y[i]);
+        new_sample = su_clock_detector_read(&psk_insp->cd, &output, 1) == 1;
+      }
 
-    /* Check if channel sampler is enabled */
-    if (psk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&psk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&psk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&psk_insp->cd, &output, 1) == 1;
-    }
+      /* Apply channel equalizer, if enabled */
+      if (new_sample) {
+        if (params->eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA)
+          output = su_equalizer_feed(&psk_insp->eq, output);
 
-    /* Apply channel equalizer, if enabled */
-    if (new_sample) {
-      if (psk_insp->cur_params.eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA) {
-        output = su_equalizer_feed(&psk_insp->eq, output);
+        /* Reduce amplitude so it fits in the constellation window */
+        suscan_inspector_push_sample(insp, output * .75);
       }
-
-      /* Reduce amplitude so it fits in the constellation window */
-      suscan_inspector_push_sample(insp, output * .75);
     }
+
+    fed += n;
   }
 
-  return i;
+  return fed;
 }
 
 void
@@ -527,6 +527,126 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_inspector_send_spectrum(
+    suscan_inspector_t *insp,
+    uint32_t spectsrc_id,
+    const SUFLOAT *spectrum,
+    SUSCOUNT size)
+{
+  struct suscan_analyzer_inspector_msg *msg = NULL;
+
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      msg = suscan_analyzer_inspector_msg_new(
+          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM,
+          rand()),
+      goto done);
+
+  msg->inspector_id  = insp->inspector_id;
+  msg->spectsrc_id   = spectsrc_id;
+  msg->samp_rate     = insp->samp_info.equiv_fs;
+  msg->spectrum_size = size;
+
+  SU_TRYCATCH(
+      msg->spectrum_data = malloc(size * sizeof(SUFLOAT)),
+      goto done);
+
+  memcpy(msg->spectrum_data, spectrum, size * sizeof(SUFLOAT));
+
+  /* Provide a more accurate real timestamp */
+  gettimeofday(&msg->rt_time, NULL);
+  SU_TRYCATCH(
+      suscan_mq_write(
+          insp->mq_out,
+          SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+          msg),
+      goto done);
+
+  msg = NULL; /* We don't own this anymore */
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_inspector_msg_destroy(msg);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspector_on_spectrum_data(
+    void *userdata,
+    const SUFLOAT *spectrum,
+    SUSCOUNT size)
+{
+  suscan_inspector_t *insp = (suscan_inspector_t *) userdata;
+
+  return suscan_inspector_send_spectrum(
+    insp,
+    insp->spectsrc_index,
+    spectrum,
+    size);
+}
+
+/* Views are reported with the same (1-based) id used to select them */
+SUPRIVATE SUBOOL
+suscan_inspector_on_bank_spectrum_data(
+    void *userdata,
+    unsigned int view,
+    const SUFLOAT *spectrum,
+    SUSCOUNT size)
+{
+  suscan_inspector_t *insp = (suscan_inspector_t *) userdata;
+
+  return suscan_inspector_send_spectrum(insp, view + 1, spectrum, size);
+}
+
+/*
+ * The bank is only touched from the inspector thread. Mask changes
+ * requested by the client are picked up here.
+ */
+SUPRIVATE SUBOOL
+suscan_inspector_sync_spectsrc_bank(suscan_inspector_t *insp, uint32_t mask)
+{
+  unsigned int i;
+
+  if (insp->spectsrc_bank == NULL) {
+    if (mask == 0)
+      return SU_TRUE;
+
+    SU_MAKE_FAIL(
+      insp->spectsrc_bank,
+      suscan_spectsrc_bank,
+      insp->samp_info.equiv_fs,
+      1. / insp->interval_spectrum,
+      SUSCAN_INSPECTOR_SPECTRUM_BUF_SIZE,
+      SU_CHANNEL_DETECTOR_WINDOW_BLACKMANN_HARRIS,
+      suscan_inspector_on_bank_spectrum_data,
+      insp);
+
+    for (i = 0; i < insp->spectsrc_count; ++i)
+      SU_TRY_FAIL(
+        suscan_spectsrc_bank_add_view(
+          insp->spectsrc_bank,
+          insp->spectsrc_list[i]->classptr));
+
+    if (insp->spectsrc_count > 0)
+      suscan_spectsrc_bank_set_throttle_factor(
+        insp->spectsrc_bank,
+        insp->spectsrc_list[0]->throttle_factor);
+  }
+
+  if (suscan_spectsrc_bank_get_mask(insp->spectsrc_bank) != mask)
+    SU_TRY_FAIL(suscan_spectsrc_bank_set_mask(insp->spectsrc_bank, mask));
+
+  return SU_TRUE;
+
+fail:
+  return SU_FALSE;
+}
+
 SUBOOL
 suscan_inspector_spectrum_loop(
     suscan_inspector_t *insp,
@@ -534,10 +654,39 @@ suscan_inspector_spectrum_loop(
     SUSCOUNT samp_count)
 {
   suscan_spectsrc_t *src = NULL;
-  SUSDIFF fed;
+  uint32_t index, mask;
+
+  /* Written by the server thread, under the inspector mutex */
+  suscan_inspector_lock(insp);
+  index = insp->spectsrc_index;
+  mask  = insp->spectsrc_mask;
+  suscan_inspector_unlock(insp);
 
-  if (insp->spectsrc_index > 0) {
-    src = insp->spectsrc_list[insp->spectsrc_index - 1];
+  if (suscan_inspector_is_freq_domain(insp)) {
+    /* Switched to the frequency domain: the views no longer apply */
+    if (mask != 0) {
+      suscan_inspector_lock(insp);
+      insp->spectsrc_mask = 0;
+      suscan_inspector_unlock(insp);
+
+      SU_TRY_FAIL(suscan_inspector_sync_spectsrc_bank(insp, 0));
+    }
+  } else {
+    SU_TRY_FAIL(suscan_inspector_sync_spectsrc_bank(insp, mask));
+
+    if (mask != 0) {
+      SU_TRY_FAIL(
+        suscan_spectsrc_bank_feed(
+          insp->spectsrc_bank,
+          samp_buf,
+          samp_count) >= 0);
+
+      return SU_TRUE;
+    }
+  }
+
+  if (index > 0) {
+    src = insp->spectsrc_list[index - 1];
 
     if (suscan_inspector_is_freq_domain(insp)) {
       uint64_t interval = insp->interval_spectrum * 1e9;
@@ -552,14 +701,7 @@ suscan_inspector_spectrum_loop(
             samp_count));
       }
     } else {
-      while (samp_count > 0) {
-        fed = suscan_spectsrc_feed(src, samp_buf, samp_count);
-
-        SU_TRY_FAIL(fed >= 0);
-
-        samp_buf   += fed;
-        samp_count -= fed;
-      }
+      SU_TRY_FAIL(suscan_spectsrc_feed(src, samp_buf, samp_count) >= 0);
     }
   }
 
@@ -604,64 +746,99 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_inspector_send_estimation(
+    suscan_inspector_t *insp,
+    unsigned int estimator_id,
+    SUFLOAT value)
+{
+  struct suscan_analyzer_inspector_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      msg = suscan_analyzer_inspector_msg_new(
+          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
+          rand()),
+      goto done);
+
+  msg->enabled = SU_TRUE;
+  msg->estimator_id = estimator_id;
+  msg->value = value;
+  msg->inspector_id = insp->inspector_id;
+
+  SU_TRYCATCH(
+      suscan_mq_write(
+          insp->mq_out,
+          SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+          msg),
+      goto done);
+
+  msg = NULL; /* We don't own this anymore */
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_inspector_msg_destroy(msg);
+
+  return ok;
+}
+
+/*
+ * Estimators run once per report interval: when a report is due, every
+ * enabled estimator is armed and collects a block of contiguous samples,
+ * which is processed in one go. The value is reported as soon as the
+ * block is complete. Between reports, estimators cost nothing.
+ */
 SUBOOL
 suscan_inspector_estimator_loop(
     suscan_inspector_t *insp,
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count)
 {
-  struct suscan_analyzer_inspector_msg *msg = NULL;
+  suscan_estimator_t *estimator;
   unsigned int i;
   uint64_t now;
   SUFLOAT value;
   SUFLOAT seconds;
+  SUBOOL due = SU_FALSE;
+  SUBOOL ready;
 
-  /* Check esimator state and update clients */
   if (insp->interval_estimator > 0) {
     now = suscan_gettime();
     seconds = (now - insp->last_estimator) * 1e-9;
     if (seconds >= insp->interval_estimator) {
       insp->last_estimator = now;
-      for (i = 0; i < insp->estimator_count; ++i)
-        if (suscan_estimator_is_enabled(insp->estimator_list[i])) {
-          if (suscan_estimator_is_enabled(insp->estimator_list[i]))
-            SU_TRYCATCH(
-                suscan_estimator_feed(
-                    insp->estimator_list[i],
-                    samp_buf,
-                    samp_count),
-                goto fail);
-
-          if (suscan_estimator_read(insp->estimator_list[i], &value)) {
-            SU_TRYCATCH(
-                msg = suscan_analyzer_inspector_msg_new(
-                    SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
-                    rand()),
-                goto fail);
-
-            msg->enabled = SU_TRUE;
-            msg->estimator_id = i;
-            msg->value = value;
-            msg->inspector_id = insp->inspector_id;
-
-            SU_TRYCATCH(
-                suscan_mq_write(
-                    insp->mq_out,
-                    SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
-                    msg),
-                goto fail);
-          }
-        }
+      due = SU_TRUE;
     }
   }
 
-  return SU_TRUE;
+  for (i = 0; i < insp->estimator_count; ++i) {
+    estimator = insp->estimator_list[i];
 
-fail:
-  if (msg != NULL)
-    suscan_analyzer_inspector_msg_destroy(msg);
+    if (!suscan_estimator_is_enabled(estimator)) {
+      if (suscan_estimator_is_armed(estimator))
+        suscan_estimator_disarm(estimator);
+      continue;
+    }
 
-  return SU_FALSE;
+    if (due)
+      suscan_estimator_arm(estimator);
+
+    if (!suscan_estimator_is_armed(estimator))
+      continue;
+
+    SU_TRYCATCH(
+        suscan_estimator_collect(estimator, samp_buf, samp_count, &ready) >= 0,
+        return SU_FALSE);
+
+    if (ready && suscan_estimator_read(estimator, &value))
+      SU_TRYCATCH(
+          suscan_inspector_send_estimation(insp, i, value),
+          return SU_FALSE);
+  }
+
+  return SU_TRUE;
 }
 
 SUBOOL 
@@ -860,6 +1037,9 @@ suscan_inspector_destroy(suscan_inspector_t *self)
   if (self->estimator_list != NULL)
     free(self->estimator_list);
 
+  if (self->spectsrc_bank != NULL)
+    suscan_spectsrc_bank_destroy(self->spectsrc_bank);
+
   for (i = 0; i < self->spectsrc_count; ++i)
     suscan_spectsrc_destroy(self->spectsrc_list[i]);
 
@@ -892,6 +1072,9 @@ suscan_inspector_set_throttle_factor(
     
   for (i = 0; i < self->spectsrc_count; ++i)
     suscan_spectsrc_set_throttle_factor(self->spectsrc_list[i], factor);
+
+  if (self->spectsrc_bank != NULL)
+    suscan_spectsrc_bank_set_throttle_factor(self->spectsrc_bank, factor);
 }
 
 void
@@ -947,54 +1130,6 @@ fail:
   return SU_FALSE;
 }
 
-SUPRIVATE SUBOOL
-suscan_inspector_on_spectrum_data(
-    void *userdata,
-    const SUFLOAT *spectrum,
-    SUSCOUNT size)
-{
-  struct suscan_analyzer_inspector_msg *msg = NULL;
-  suscan_inspector_t *insp = (suscan_inspector_t *) userdata;
-
-  SUBOOL ok = SU_FALSE;
-
-  SU_TRYCATCH(
-      msg = suscan_analyzer_inspector_msg_new(
-          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM,
-          rand()),
-      goto done);
-
-  msg->inspector_id  = insp->inspector_id;
-  msg->spectsrc_id   = insp->spectsrc_index;
-  msg->samp_rate     = insp->samp_info.equiv_fs;
-  msg->spectrum_size = size;
-
-  SU_TRYCATCH(
-      msg->spectrum_data = malloc(size * sizeof(SUFLOAT)),
-      goto done);
-
-  memcpy(msg->spectrum_data, spectrum, size * sizeof(SUFLOAT));
-
-  /* Provide a more accurate real timestamp */
-  gettimeofday(&msg->rt_time, NULL);
-  SU_TRYCATCH(
-      suscan_mq_write(
-          insp->mq_out,
-          SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
-          msg),
-      goto done);
-
-  msg = NULL; /* We don't own this anymore */
-
-  ok = SU_TRUE;
-
-done:
-  if (msg != NULL)
-    suscan_analyzer_inspector_msg_destroy(msg);
-
-  return ok;
-}
-
 SUPRIVATE SUBOOL
 suscan_inspector_add_spectsrc(
     suscan_inspector_t *insp,
@@ -26,6 +26,8 @@ extern "C" {
 
 #include <sigutils/sigutils.h>
 #include <sigutils/specttuner.h>
+#include <sigutils/agc.h>
+#include <sigutils/ncqo.h>
 #include "interface.h"
 #include <analyzer/corrector.h>
 #include <util/com.h>
@@ -38,6 +40,7 @@ extern "C" {
 #define SUSCAN_INSPECTOR_TUNER_BUF_SIZE    SU_BLOCK_STREAM_BUFFER_SIZE
 #define SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE  65536
 #define SUSCAN_INSPECTOR_SPECTRUM_BUF_SIZE 8192
+#define SUSCAN_INSPECTOR_FEED_BLOCK_SIZE   256
 
 struct suscan_inspector_factory;
 
@@ -63,6 +66,7 @@ struct suscan_inspector {
   struct suscan_mq *mq_ctl;     /* Non-owner */
   enum suscan_aync_state state; /* Used to remove analyzer from queue */
   SUBOOL frequency_domain;      /* Used to tell if the inspector is in the frequency domain */
+  SUBOOL cfar_opened;           /* Opened by the CFAR detector */
   
   /* Specific inspector interface being used */
   const struct suscan_inspector_interface *iface;
@@ -86,6 +90,7 @@ struct suscan_inspector {
   uint64_t last_orbit_report;
 
   uint32_t spectsrc_index;
+  uint32_t spectsrc_mask;  /* Views evaluated together. Overrides the index */
 
   SUBOOL    params_requested;    /* New parameters requested */
   SUBOOL    bandwidth_notified;  /* New bandwidth set */
@@ -104,6 +109,7 @@ struct suscan_inspector {
   
   PTR_LIST(suscan_estimator_t, estimator); /* Parameter estimators */
   PTR_LIST(suscan_spectsrc_t, spectsrc); /* Spectrum source */
+  suscan_spectsrc_bank_t *spectsrc_bank; /* Created on first use */
 };
 
 typedef struct suscan_inspector suscan_inspector_t;
@@ -264,6 +270,107 @@ suscan_inspector_feed_sc_sample(suscan_inspector_t *self, SUCOMPLEX x)
 
   return ok;
 }
+
+SUINLINE SUBOOL
+suscan_inspector_feed_sc_block(
+  suscan_inspector_t *self,
+  const SUCOMPLEX *x,
+  SUSCOUNT size)
+{
+  SUSDIFF got;
+  SUBOOL ok = SU_TRUE;
+
+  while (size > 0) {
+    if ((got = su_specttuner_feed_bulk_single(self->sc_stuner, x, size)) < 0)
+      return SU_FALSE;
+
+    if (su_specttuner_new_data(self->sc_stuner)) {
+      if (su_specttuner_get_channel_count(self->sc_stuner) > 0) {
+        if (pthread_mutex_lock(&self->sc_stuner_mutex) == 0) {
+          ok = su_specttuner_feed_all_channels(self->sc_stuner) && ok;
+          (void) pthread_mutex_unlock(&self->sc_stuner_mutex);
+        }
+      }
+
+      su_specttuner_ack_data(self->sc_stuner);
+    } else if (got == 0) {
+      break;
+    }
+
+    x    += got;
+    size -= got;
+  }
+
+  return ok;
+}
+
+/*
+ * Number of samples that demodulators may process as a single block
+ * in their feed functions. Demodulators produce at most one output
+ * sample per input sample, so a block of this size never overflows
+ * the sampler buffer halfway.
+ */
+SUINLINE SUSCOUNT
+suscan_inspector_feed_block_size(
+  const suscan_inspector_t *self,
+  SUSCOUNT remaining)
+{
+  SUSCOUNT size = suscan_inspector_sampler_buf_avail(self);
+
+  if (size > SUSCAN_INSPECTOR_FEED_BLOCK_SIZE)
+    size = SUSCAN_INSPECTOR_FEED_BLOCK_SIZE;
+
+  return remaining < size ? remaining : size;
+}
+
+/*
+ * Carrier re-centering: y = x * conj(lo) * phase. When the oscillator is
+ * not running (no carrier offset) this reduces to a constant product.
+ */
+SUINLINE void
+suscan_inspector_mix_block(
+  su_ncqo_t *lo,
+  SUCOMPLEX phase,
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUSCOUNT size)
+{
+  SUCOMPLEX k;
+  SUSCOUNT i;
+
+  if (su_ncqo_get_freq(lo) == 0) {
+    k = SU_C_CONJ(su_ncqo_read(lo)) * phase;
+    for (i = 0; i < size; ++i)
+      y[i] = x[i] * k;
+  } else {
+    for (i = 0; i < size; ++i)
+      y[i] = SU_C_CONJ(su_ncqo_read(lo));
+
+    for (i = 0; i < size; ++i)
+      y[i] *= x[i] * phase;
+  }
+}
+
+/* Manual gain control, or AGC */
+SUINLINE void
+suscan_inspector_gain_block(
+  su_agc_t *agc,
+  SUBOOL automatic,
+  SUFLOAT gain,
+  SUCOMPLEX *x,
+  SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  if (automatic) {
+    for (i = 0; i < size; ++i)
+      x[i] = 2 * su_agc_feed(agc, x[i]);
+  } else {
+    gain *= 2;
+    for (i = 0; i < size; ++i)
+      x[i] *= gain;
+  }
+}
 #endif /* __cplusplus */
 
 /******************************* Public API **********************************/
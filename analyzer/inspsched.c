@@ -218,17 +218,23 @@ suscan_inspsched_queue_task(
     suscan_inspsched_t *sched,
     struct suscan_inspector_task_info *task_info)
 {
+  unsigned int index;
+
+  /* Tasks may be queued concurrently by several channelizer shards */
+  SU_TRYCATCH(pthread_mutex_lock(&sched->task_mutex) == 0, return SU_FALSE);
+  index = sched->last_worker;
+  if (++sched->last_worker == sched->worker_count)
+    sched->last_worker = 0;
+  (void) pthread_mutex_unlock(&sched->task_mutex);
+
   /* Process new samples */
   SU_TRYCATCH(
       suscan_worker_push(
-          sched->worker_list[sched->last_worker],
+          sched->worker_list[index],
           suscan_inpsched_task_cb,
           task_info),
       return SU_FALSE);
 
-  if (++sched->last_worker == sched->worker_count)
-    sched->last_worker = 0;
-
   return SU_TRUE;
 }
 
@@ -167,11 +167,34 @@ fail:
 }
 
 /******************************* PSD message **********************************/
+/*
+ * Borrowed arrays cannot be given away: whoever takes them gets a copy
+ */
+SUPRIVATE void *
+suscan_analyzer_msg_copy_borrowed(const void *data, size_t size)
+{
+  void *copy;
+
+  if (data == NULL)
+    return NULL;
+
+  SU_TRYCATCH(copy = malloc(size), return NULL);
+
+  memcpy(copy, data, size);
+
+  return copy;
+}
+
 SUFLOAT *
 suscan_analyzer_psd_msg_take_psd(struct suscan_analyzer_psd_msg *msg)
 {
   SUFLOAT *result = msg->psd_data;
 
+  if (msg->pdu != NULL)
+    result = suscan_analyzer_msg_copy_borrowed(
+        result,
+        msg->psd_size * sizeof(SUFLOAT));
+
   msg->psd_data = NULL;
   msg->psd_size = 0;
 
@@ -193,6 +216,8 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_psd_msg)
   SUSCAN_PACK(float, self->samp_rate);
   SUSCAN_PACK(float, self->measured_samp_rate);
   SUSCAN_PACK(float, self->N0);
+  SUSCAN_PACK(uint,  self->dropped);
+  SUSCAN_PACK(uint,  self->decimation);
 
   SU_TRYCATCH(
       suscan_pack_compact_single_array(
@@ -228,30 +253,56 @@ SUSCAN_PARTIAL_DESERIALIZER_PROTO(suscan_analyzer_psd_msg)
   SUSCAN_UNPACK(float,  self->samp_rate);
   SUSCAN_UNPACK(float,  self->measured_samp_rate);
   SUSCAN_UNPACK(float,  self->N0);
+  SUSCAN_UNPACK(uint64, self->dropped);
+  SUSCAN_UNPACK(uint32, self->decimation);
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
-SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_psd_msg)
+SUPRIVATE SUBOOL
+suscan_analyzer_psd_msg_deserialize_ex(
+    struct suscan_analyzer_psd_msg *self,
+    grow_buf_t *buffer,
+    SUBOOL borrow)
 {
+  SUBOOL borrowed = SU_FALSE;
   SUSCAN_UNPACK_BOILERPLATE_START;
 
   SU_TRY_FAIL(
     suscan_analyzer_psd_msg_deserialize_partial(self, buffer));
 
-  SU_TRY_FAIL(
-      suscan_unpack_compact_single_array(
-          buffer,
-          &self->psd_data,
-          &self->psd_size));
+  if (borrow) {
+    SU_TRY_FAIL(
+        suscan_unpack_compact_single_array_borrow(
+            buffer,
+            &self->psd_data,
+            &self->psd_size,
+            &borrowed));
+
+    if (borrowed)
+      self->pdu = grow_buf_get_buffer(buffer);
+  } else {
+    SU_TRY_FAIL(
+        suscan_unpack_compact_single_array(
+            buffer,
+            &self->psd_data,
+            &self->psd_size));
+  }
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_psd_msg)
+{
+  return suscan_analyzer_psd_msg_deserialize_ex(self, buffer, SU_FALSE);
+}
+
 void
 suscan_analyzer_psd_msg_destroy(struct suscan_analyzer_psd_msg *msg)
 {
-  if (msg->psd_data != NULL)
+  if (msg->pdu != NULL)
+    free(msg->pdu);
+  else if (msg->psd_data != NULL)
     free(msg->psd_data);
 
   free(msg);
@@ -271,6 +322,7 @@ suscan_analyzer_psd_msg_new_from_data(
 
   new->psd_size = psd_size;
   new->samp_rate = samp_rate;
+  new->decimation = 1;
 
   new->fc = 0;
 
@@ -301,6 +353,8 @@ suscan_analyzer_psd_msg_new(const su_channel_detector_t *cd)
       new = calloc(1, sizeof(struct suscan_analyzer_psd_msg)),
       goto fail);
 
+  new->decimation = 1;
+
   if (cd != NULL) {
     new->psd_size = cd->params.window_size;
     new->samp_rate = cd->params.samp_rate;
@@ -380,6 +434,54 @@ SUSCAN_DESERIALIZER_PROTO(sigutils_channel)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+/********************** Channel message serialization ************************/
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_channel_msg)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+  unsigned int i;
+
+  SU_TRYCATCH(
+      cbor_pack_array_start(buffer, self->channel_count) == 0,
+      goto fail);
+
+  for (i = 0; i < self->channel_count; ++i)
+    SU_TRYCATCH(
+        sigutils_channel_serialize(self->channel_list[i], buffer),
+        goto fail);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_channel_msg)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+  struct sigutils_channel channel;
+  uint64_t count = 0;
+  unsigned int i;
+  SUBOOL end_required = SU_FALSE;
+
+  SU_TRYCATCH(
+      cbor_unpack_array_start(buffer, &count, &end_required) == 0,
+      goto fail);
+  SU_TRYCATCH(!end_required, goto fail);
+
+  if (count > 0)
+    SU_TRYCATCH(
+        self->channel_list = calloc(count, sizeof(struct sigutils_channel *)),
+        goto fail);
+
+  for (i = 0; i < count; ++i) {
+    memset(&channel, 0, sizeof(struct sigutils_channel));
+    SU_TRYCATCH(sigutils_channel_deserialize(&channel, buffer), goto fail);
+    SU_TRYCATCH(self->channel_list[i] = su_channel_dup(&channel), goto fail);
+
+    /* Keep the count consistent, so that the destructor can clean up */
+    self->channel_count = i + 1;
+  }
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
 SUPRIVATE SUBOOL
 suscan_analyzer_inspector_msg_serialize_open(
     grow_buf_t *buffer,
@@ -559,20 +661,35 @@ suscan_analyzer_inspector_msg_serialize_spectrum(
 SUPRIVATE SUBOOL
 suscan_analyzer_inspector_msg_deserialize_spectrum(
     grow_buf_t *buffer,
-    struct suscan_analyzer_inspector_msg *self)
+    struct suscan_analyzer_inspector_msg *self,
+    SUBOOL borrow)
 {
+  SUBOOL borrowed = SU_FALSE;
   SUSCAN_UNPACK_BOILERPLATE_START;
   SUSCAN_UNPACK(uint32, self->spectsrc_id);
   SUSCAN_UNPACK(freq,   self->fc);
   SUSCAN_UNPACK(float,  self->N0);
   SUSCAN_UNPACK(uint64, self->samp_rate);
 
-  SU_TRYCATCH(
-      suscan_unpack_compact_float_array(
-          buffer,
-          &self->spectrum_data,
-          &self->spectrum_size),
-      goto fail);
+  if (borrow) {
+    SU_TRYCATCH(
+        suscan_unpack_compact_float_array_borrow(
+            buffer,
+            &self->spectrum_data,
+            &self->spectrum_size,
+            &borrowed),
+        goto fail);
+
+    if (borrowed)
+      self->pdu = grow_buf_get_buffer(buffer);
+  } else {
+    SU_TRYCATCH(
+        suscan_unpack_compact_float_array(
+            buffer,
+            &self->spectrum_data,
+            &self->spectrum_size),
+        goto fail);
+  }
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
@@ -782,6 +899,30 @@ suscan_analyzer_inspector_msg_deserialize_signal(
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_serialize_spectrum_mask(
+    grow_buf_t *buffer,
+    const struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(uint, self->spectsrc_mask);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_deserialize_spectrum_mask(
+    grow_buf_t *buffer,
+    struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(uint32, self->spectsrc_mask);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
 SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
 {
   SUSCAN_PACK_BOILERPLATE_START;
@@ -850,6 +991,12 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
           goto fail);
       break;
     
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM_MASK:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_serialize_spectrum_mask(buffer, self),
+          goto fail);
+      break;
+
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL:
       SU_TRYCATCH(
           suscan_analyzer_inspector_msg_serialize_signal(buffer, self),
@@ -877,7 +1024,11 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
   SUSCAN_PACK_BOILERPLATE_END;
 }
 
-SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_deserialize_ex(
+    struct suscan_analyzer_inspector_msg *self,
+    grow_buf_t *buffer,
+    SUBOOL borrow)
 {
   SUSCAN_UNPACK_BOILERPLATE_START;
   uint64_t tv_sec = 0;
@@ -915,7 +1066,10 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
 
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM:
       SU_TRYCATCH(
-          suscan_analyzer_inspector_msg_deserialize_spectrum(buffer, self),
+          suscan_analyzer_inspector_msg_deserialize_spectrum(
+              buffer,
+              self,
+              borrow),
           goto fail);
       break;
 
@@ -949,6 +1103,12 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
           goto fail);
       break;
     
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM_MASK:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_deserialize_spectrum_mask(buffer, self),
+          goto fail);
+      break;
+
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL:
       SU_TRYCATCH(
           suscan_analyzer_inspector_msg_deserialize_signal(buffer, self),
@@ -977,6 +1137,11 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
+{
+  return suscan_analyzer_inspector_msg_deserialize_ex(self, buffer, SU_FALSE);
+}
+
 struct suscan_analyzer_inspector_msg *
 suscan_analyzer_inspector_msg_new(
     enum suscan_analyzer_inspector_msgkind kind,
@@ -1001,6 +1166,11 @@ suscan_analyzer_inspector_msg_take_spectrum(
 {
   SUFLOAT *result = msg->spectrum_data;
 
+  if (msg->pdu != NULL)
+    result = suscan_analyzer_msg_copy_borrowed(
+        result,
+        msg->spectrum_size * sizeof(SUFLOAT));
+
   msg->spectrum_data = NULL;
   msg->spectrum_size = 0;
 
@@ -1038,7 +1208,7 @@ suscan_analyzer_inspector_msg_destroy(struct suscan_analyzer_inspector_msg *msg)
       break;
 
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM:
-      if (msg->spectrum_data != NULL)
+      if (msg->spectrum_data != NULL && msg->pdu == NULL)
         free(msg->spectrum_data);
       break;
 
@@ -1055,6 +1225,9 @@ suscan_analyzer_inspector_msg_destroy(struct suscan_analyzer_inspector_msg *msg)
       ;
   }
 
+  if (msg->pdu != NULL)
+    free(msg->pdu);
+
   free(msg);
 }
 
@@ -1074,21 +1247,48 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_sample_batch_msg)
   SUSCAN_PACK_BOILERPLATE_END;
 }
 
-SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_sample_batch_msg)
+SUPRIVATE SUBOOL
+suscan_analyzer_sample_batch_msg_deserialize_ex(
+    struct suscan_analyzer_sample_batch_msg *self,
+    grow_buf_t *buffer,
+    SUBOOL borrow)
 {
+  SUBOOL borrowed = SU_FALSE;
   SUSCAN_UNPACK_BOILERPLATE_START;
 
   SUSCAN_UNPACK(uint32, self->inspector_id);
-  SU_TRYCATCH(
-      suscan_unpack_compact_complex_array(
-          buffer,
-          &self->samples,
-          &self->sample_count),
-      goto fail);
+
+  if (borrow) {
+    SU_TRYCATCH(
+        suscan_unpack_compact_complex_array_borrow(
+            buffer,
+            &self->samples,
+            &self->sample_count,
+            &borrowed),
+        goto fail);
+
+    if (borrowed)
+      self->pdu = grow_buf_get_buffer(buffer);
+  } else {
+    SU_TRYCATCH(
+        suscan_unpack_compact_complex_array(
+            buffer,
+            &self->samples,
+            &self->sample_count),
+        goto fail);
+  }
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_sample_batch_msg)
+{
+  return suscan_analyzer_sample_batch_msg_deserialize_ex(
+      self,
+      buffer,
+      SU_FALSE);
+}
+
 struct suscan_analyzer_sample_batch_msg *
 suscan_analyzer_sample_batch_msg_new(
     uint32_t inspector_id,
@@ -1125,7 +1325,9 @@ void
 suscan_analyzer_sample_batch_msg_destroy(
     struct suscan_analyzer_sample_batch_msg *msg)
 {
-  if (msg->samples != NULL)
+  if (msg->pdu != NULL)
+    free(msg->pdu);
+  else if (msg->samples != NULL)
     free(msg->samples);
 
   free(msg);
@@ -1215,6 +1417,237 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_replay_msg)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+/************************** PSD statistics messages ***************************/
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_psd_stats_params)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(float, self->update_int);
+  SUSCAN_PACK(float, self->window);
+  SUSCAN_PACK(float, self->alpha);
+  SUSCAN_PACK(float, self->threshold);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_psd_stats_params)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(float, self->update_int);
+  SUSCAN_UNPACK(float, self->window);
+  SUSCAN_UNPACK(float, self->alpha);
+  SUSCAN_UNPACK(float, self->threshold);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_psd_stats_msg)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(int,   self->fc);
+  SUSCAN_PACK(uint,  self->timestamp.tv_sec);
+  SUSCAN_PACK(uint,  self->timestamp.tv_usec);
+  SUSCAN_PACK(float, self->samp_rate);
+  SUSCAN_PACK(float, self->window);
+  SUSCAN_PACK(uint,  self->frames);
+
+  SU_TRY_FAIL(suscan_pack_compact_single_array(buffer, self->max, self->size));
+  SU_TRY_FAIL(suscan_pack_compact_single_array(buffer, self->min, self->size));
+  SU_TRY_FAIL(suscan_pack_compact_single_array(buffer, self->mean, self->size));
+  SU_TRY_FAIL(suscan_pack_compact_single_array(buffer, self->p50, self->size));
+  SU_TRY_FAIL(suscan_pack_compact_single_array(buffer, self->p90, self->size));
+  SU_TRY_FAIL(
+    suscan_pack_compact_single_array(buffer, self->occupancy, self->size));
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_psd_stats_msg_unpack_array(
+  grow_buf_t *buffer,
+  SUFLOAT **array,
+  SUSCOUNT expected)
+{
+  SUSCOUNT size = 0;
+
+  SU_TRYCATCH(
+    suscan_unpack_compact_single_array(buffer, array, &size),
+    return SU_FALSE);
+
+  if (size != expected) {
+    SU_ERROR("Inconsistent PSD statistics array size\n");
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_psd_stats_msg)
+{
+  uint64_t tv_sec = 0;
+  uint32_t tv_usec = 0;
+  SUSCOUNT size = 0;
+
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(int64,  self->fc);
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->timestamp.tv_sec  = tv_sec;
+  self->timestamp.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(float,  self->samp_rate);
+  SUSCAN_UNPACK(float,  self->window);
+  SUSCAN_UNPACK(uint64, self->frames);
+
+  /* The first array determines the size of the rest */
+  SU_TRY_FAIL(suscan_unpack_compact_single_array(buffer, &self->max, &size));
+  self->size = size;
+
+  SU_TRY_FAIL(
+    suscan_analyzer_psd_stats_msg_unpack_array(buffer, &self->min, size));
+  SU_TRY_FAIL(
+    suscan_analyzer_psd_stats_msg_unpack_array(buffer, &self->mean, size));
+  SU_TRY_FAIL(
+    suscan_analyzer_psd_stats_msg_unpack_array(buffer, &self->p50, size));
+  SU_TRY_FAIL(
+    suscan_analyzer_psd_stats_msg_unpack_array(buffer, &self->p90, size));
+  SU_TRY_FAIL(
+    suscan_analyzer_psd_stats_msg_unpack_array(
+      buffer,
+      &self->occupancy,
+      size));
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+/************************ CFAR detector parameters ***************************/
+void
+suscan_analyzer_cfar_params_finalize(struct suscan_analyzer_cfar_params *self)
+{
+  if (self->auto_open != NULL)
+    free(self->auto_open);
+
+  self->auto_open = NULL;
+}
+
+SUBOOL
+suscan_analyzer_cfar_params_copy(
+    struct suscan_analyzer_cfar_params *dest,
+    const struct suscan_analyzer_cfar_params *orig)
+{
+  char *auto_open = NULL;
+
+  if (orig->auto_open != NULL)
+    SU_TRYCATCH(auto_open = strdup(orig->auto_open), return SU_FALSE);
+
+  suscan_analyzer_cfar_params_finalize(dest);
+
+  *dest = *orig;
+  dest->auto_open = auto_open;
+
+  return SU_TRUE;
+}
+
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_cfar_params)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(bool,  self->enabled);
+  SUSCAN_PACK(uint,  self->mode);
+  SUSCAN_PACK(uint,  self->guard);
+  SUSCAN_PACK(uint,  self->ref);
+  SUSCAN_PACK(float, self->on_db);
+  SUSCAN_PACK(float, self->off_db);
+  SUSCAN_PACK(uint,  self->min_bins);
+  SUSCAN_PACK(uint,  self->merge_gap);
+  SUSCAN_PACK(uint,  self->confirm);
+  SUSCAN_PACK(uint,  self->hold);
+  SUSCAN_PACK(uint,  self->max_open);
+  SUSCAN_PACK(str,   self->auto_open == NULL ? "" : self->auto_open);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_cfar_params)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(bool,   self->enabled);
+  SUSCAN_UNPACK(uint32, self->mode);
+  SUSCAN_UNPACK(uint32, self->guard);
+  SUSCAN_UNPACK(uint32, self->ref);
+  SUSCAN_UNPACK(float,  self->on_db);
+  SUSCAN_UNPACK(float,  self->off_db);
+  SUSCAN_UNPACK(uint32, self->min_bins);
+  SUSCAN_UNPACK(uint32, self->merge_gap);
+  SUSCAN_UNPACK(uint32, self->confirm);
+  SUSCAN_UNPACK(uint32, self->hold);
+  SUSCAN_UNPACK(uint32, self->max_open);
+  SUSCAN_UNPACK(str,    self->auto_open);
+
+  /* Empty class name: no auto-open */
+  if (self->auto_open != NULL && *self->auto_open == '\0') {
+    free(self->auto_open);
+    self->auto_open = NULL;
+  }
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+void
+suscan_analyzer_psd_stats_msg_destroy(struct suscan_analyzer_psd_stats_msg *msg)
+{
+  if (msg->max != NULL)
+    free(msg->max);
+
+  if (msg->min != NULL)
+    free(msg->min);
+
+  if (msg->mean != NULL)
+    free(msg->mean);
+
+  if (msg->p50 != NULL)
+    free(msg->p50);
+
+  if (msg->p90 != NULL)
+    free(msg->p90);
+
+  if (msg->occupancy != NULL)
+    free(msg->occupancy);
+
+  free(msg);
+}
+
+struct suscan_analyzer_psd_stats_msg *
+suscan_analyzer_psd_stats_msg_new(SUSCOUNT size)
+{
+  struct suscan_analyzer_psd_stats_msg *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_analyzer_psd_stats_msg);
+
+  if (size > 0) {
+    new->size = size;
+
+    SU_ALLOCATE_MANY_FAIL(new->max,       size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->min,       size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->mean,      size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->p50,       size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->p90,       size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->occupancy, size, SUFLOAT);
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_analyzer_psd_stats_msg_destroy(new);
+
+  return NULL;
+}
+
 /*********************** Generic message serialization ************************/
 SUBOOL
 suscan_analyzer_msg_serialize(
@@ -1234,12 +1667,13 @@ suscan_analyzer_msg_serialize(
     case SUSCAN_ANALYZER_MESSAGE_TYPE_READ_ERROR:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SOURCE_INIT:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST:
       SU_TRY_FAIL(suscan_analyzer_status_msg_serialize(ptr, buffer));
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_CHANNEL:
-      SU_WARNING("Channel-type messages are not currently supported\n");
-      goto fail;
+      SU_TRY_FAIL(suscan_analyzer_channel_msg_serialize(ptr, buffer));
+      break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
       SU_TRY_FAIL(suscan_analyzer_inspector_msg_serialize(ptr, buffer));
@@ -1275,6 +1709,18 @@ suscan_analyzer_msg_serialize(
     case SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY:
       SU_TRY_FAIL(suscan_analyzer_replay_msg_serialize(ptr, buffer));
       break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS:
+      SU_TRY_FAIL(suscan_analyzer_psd_stats_params_serialize(ptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS:
+      SU_TRY_FAIL(suscan_analyzer_psd_stats_msg_serialize(ptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS:
+      SU_TRY_FAIL(suscan_analyzer_cfar_params_serialize(ptr, buffer));
+      break;
     
   }
 
@@ -1291,8 +1737,30 @@ suscan_analyzer_msg_deserialize_partial(uint32_t *type, grow_buf_t *buffer)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
-SUBOOL
-suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
+/* PDU storage adopted by a message with borrowed arrays, if any */
+SUPRIVATE void *
+suscan_analyzer_msg_get_pdu(uint32_t type, const void *ptr)
+{
+  switch (type) {
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
+      return ((const struct suscan_analyzer_inspector_msg *) ptr)->pdu;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
+      return ((const struct suscan_analyzer_psd_msg *) ptr)->pdu;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
+      return ((const struct suscan_analyzer_sample_batch_msg *) ptr)->pdu;
+  }
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_msg_deserialize_ex(
+    uint32_t *type,
+    void **ptr,
+    grow_buf_t *buffer,
+    SUBOOL borrow)
 {
   SUSCAN_UNPACK_BOILERPLATE_START;
   void *msgptr = NULL;
@@ -1308,27 +1776,36 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
     case SUSCAN_ANALYZER_MESSAGE_TYPE_READ_ERROR:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SOURCE_INIT:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST:
       SU_TRY_FAIL(msgptr = suscan_analyzer_status_msg_new(0, NULL));
       SU_TRY_FAIL(suscan_analyzer_status_msg_deserialize(msgptr, buffer));
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_CHANNEL:
-      SU_WARNING("Channel-type messages are not currently supported\n");
-      goto fail;
+      SU_TRY_FAIL(
+        msgptr = calloc(1, sizeof (struct suscan_analyzer_channel_msg)));
+      SU_TRY_FAIL(suscan_analyzer_channel_msg_deserialize(msgptr, buffer));
+      break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
       SU_TRY_FAIL(msgptr = suscan_analyzer_inspector_msg_new(0, 0));
-      SU_TRY_FAIL(suscan_analyzer_inspector_msg_deserialize(msgptr, buffer));
+      SU_TRY_FAIL(
+          suscan_analyzer_inspector_msg_deserialize_ex(msgptr, buffer, borrow));
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
       SU_TRY_FAIL(msgptr = suscan_analyzer_psd_msg_new(NULL));
-      SU_TRY_FAIL(suscan_analyzer_psd_msg_deserialize(msgptr, buffer));
+      SU_TRY_FAIL(
+          suscan_analyzer_psd_msg_deserialize_ex(msgptr, buffer, borrow));
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
       SU_TRY_FAIL(msgptr = suscan_analyzer_sample_batch_msg_new(0, NULL, 0));
-      SU_TRY_FAIL(suscan_analyzer_sample_batch_msg_deserialize(msgptr, buffer));
+      SU_TRY_FAIL(
+          suscan_analyzer_sample_batch_msg_deserialize_ex(
+              msgptr,
+              buffer,
+              borrow));
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_THROTTLE:
@@ -1360,6 +1837,21 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
       SU_TRY_FAIL(suscan_analyzer_replay_msg_deserialize(msgptr, buffer));
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS:
+      SU_TRY_FAIL(msgptr = calloc(1, sizeof (struct suscan_analyzer_psd_stats_params)));
+      SU_TRY_FAIL(suscan_analyzer_psd_stats_params_deserialize(msgptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS:
+      SU_TRY_FAIL(msgptr = suscan_analyzer_psd_stats_msg_new(0));
+      SU_TRY_FAIL(suscan_analyzer_psd_stats_msg_deserialize(msgptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS:
+      SU_TRY_FAIL(msgptr = calloc(1, sizeof (struct suscan_analyzer_cfar_params)));
+      SU_TRY_FAIL(suscan_analyzer_cfar_params_deserialize(msgptr, buffer));
+      break;
+
     default:
       SU_WARNING("Unknown message type `%d'\n", *type);
       goto fail;
@@ -1367,6 +1859,13 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
 
   SUSCAN_UNPACK_BOILERPLATE_FINALLY;
 
+  /*
+   * The message took over the PDU storage. It is released along with the
+   * message, even if deserialization failed.
+   */
+  if (msgptr != NULL && suscan_analyzer_msg_get_pdu(*type, msgptr) != NULL)
+    memset(buffer, 0, sizeof(grow_buf_t));
+
   if (ok)
     *ptr = msgptr;
   else if (msgptr != NULL)
@@ -1375,6 +1874,18 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
   SUSCAN_UNPACK_BOILERPLATE_RETURN;
 }
 
+SUBOOL
+suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
+{
+  return suscan_analyzer_msg_deserialize_ex(type, ptr, buffer, SU_FALSE);
+}
+
+SUBOOL
+suscan_analyzer_msg_deserialize_pdu(uint32_t *type, void **ptr, grow_buf_t *pdu)
+{
+  return suscan_analyzer_msg_deserialize_ex(type, ptr, pdu, SU_TRUE);
+}
+
 /************************ Generic message disposal ****************************/
 void
 suscan_analyzer_dispose_message(uint32_t type, void *ptr)
@@ -1389,6 +1900,7 @@ suscan_analyzer_dispose_message(uint32_t type, void *ptr)
     case SUSCAN_ANALYZER_MESSAGE_TYPE_READ_ERROR:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST:
       suscan_analyzer_status_msg_destroy(ptr);
       break;
 
@@ -1408,8 +1920,18 @@ suscan_analyzer_dispose_message(uint32_t type, void *ptr)
       suscan_analyzer_sample_batch_msg_destroy(ptr);
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS:
+      suscan_analyzer_psd_stats_msg_destroy(ptr);
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS:
+      suscan_analyzer_cfar_params_finalize(ptr);
+      free(ptr);
+      break;
+
     case SUSCAN_ANALYZER_MESSAGE_TYPE_PARAMS:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_THROTTLE:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS:
       free(ptr);
       break;
   }
@@ -1456,18 +1978,15 @@ done:
 }
 
 SUBOOL
-suscan_analyzer_send_detector_channels(
+suscan_analyzer_send_channels(
     suscan_analyzer_t *analyzer,
-    const su_channel_detector_t *detector)
+    struct sigutils_channel **list,
+    unsigned int len)
 {
   struct suscan_analyzer_channel_msg *msg = NULL;
-  struct sigutils_channel **ch_list;
-  unsigned int ch_count;
   SUBOOL ok = SU_FALSE;
 
-  su_channel_detector_get_channel_list(detector, &ch_list, &ch_count);
-
-  if ((msg = suscan_analyzer_channel_msg_new(analyzer, ch_list, ch_count))
+  if ((msg = suscan_analyzer_channel_msg_new(analyzer, list, len))
       == NULL) {
     suscan_analyzer_send_status(
         analyzer,
@@ -1502,6 +2021,19 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_send_detector_channels(
+    suscan_analyzer_t *analyzer,
+    const su_channel_detector_t *detector)
+{
+  struct sigutils_channel **ch_list;
+  unsigned int ch_count;
+
+  su_channel_detector_get_channel_list(detector, &ch_list, &ch_count);
+
+  return suscan_analyzer_send_channels(analyzer, ch_list, ch_count);
+}
+
 SUBOOL
 suscan_analyzer_send_source_info(
     suscan_analyzer_t *self,
@@ -1596,6 +2128,24 @@ suscan_analyzer_send_psd_from_smoothpsd(
     const su_smoothpsd_t *smoothpsd,
     SUBOOL looped,
     SUSCOUNT history_size)
+{
+  return suscan_analyzer_send_psd_from_smoothpsd_ex(
+    self,
+    smoothpsd,
+    looped,
+    history_size,
+    0,
+    1);
+}
+
+SUBOOL
+suscan_analyzer_send_psd_from_smoothpsd_ex(
+    suscan_analyzer_t *self,
+    const su_smoothpsd_t *smoothpsd,
+    SUBOOL looped,
+    SUSCOUNT history_size,
+    SUSCOUNT dropped,
+    unsigned int decimation)
 {
   struct suscan_analyzer_psd_msg *msg = NULL;
   SUBOOL ok = SU_FALSE;
@@ -1620,6 +2170,8 @@ suscan_analyzer_send_psd_from_smoothpsd(
   msg->looped = looped;
   msg->history_size = history_size;
   msg->N0 = 0;
+  msg->dropped = dropped;
+  msg->decimation = decimation;
 
   if (!suscan_mq_write(
       self->mq_out,
@@ -48,6 +48,9 @@ extern "C" {
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_SEEK          0xd
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_HISTORY_SIZE  0xe
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY        0xf
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS_PARAMS 0x10
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS     0x11 /* Spectrum stats */
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_CFAR_PARAMS   0x12 /* Signal detector */
 
 /* Invalid message. No one should even send this. */
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_INVALID       0x8000000
@@ -75,7 +78,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_status_msg) {
 };
 
 /* Channel notification message */
-struct suscan_analyzer_channel_msg {
+SUSCAN_SERIALIZABLE(suscan_analyzer_channel_msg) {
   const suscan_source_t *source;
   PTR_LIST(struct sigutils_channel, channel);
   const suscan_analyzer_t *sender;
@@ -101,6 +104,82 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_replay_msg) {
   SUBOOL replay;
 };
 
+/* PSD statistics parameters */
+SUSCAN_SERIALIZABLE(suscan_analyzer_psd_stats_params) {
+  SUFLOAT update_int; /* Seconds between stats frames. 0: disabled */
+  SUFLOAT window;     /* Seconds after which stats are reset. 0: never */
+  SUFLOAT alpha;      /* Averaging constant of the EMA */
+  SUFLOAT threshold;  /* Occupancy threshold, in dB above the noise floor */
+};
+
+#define suscan_analyzer_psd_stats_params_INITIALIZER {  \
+  1,    /* update_int */                                \
+  60,   /* window */                                    \
+  .05,  /* alpha */                                     \
+  6,    /* threshold */                                 \
+}
+
+/* CFAR signal detector parameters */
+#define SUSCAN_ANALYZER_CFAR_MODE_CA 0 /* Cell-averaging */
+#define SUSCAN_ANALYZER_CFAR_MODE_OS 1 /* Ordered-statistic */
+
+/* Inspectors opened by the detector are requested with these IDs */
+#define SUSCAN_ANALYZER_CFAR_REQ_ID_BASE 0xcfa00000
+#define SUSCAN_ANALYZER_CFAR_REQ_ID_MASK 0xfff00000
+
+SUSCAN_SERIALIZABLE(suscan_analyzer_cfar_params) {
+  SUBOOL   enabled;
+  uint32_t mode;
+  uint32_t guard;     /* Guard cells at each side of the cell under test */
+  uint32_t ref;       /* Reference cells at each side of the guard cells */
+  SUFLOAT  on_db;     /* A detection starts above this level over N0 */
+  SUFLOAT  off_db;    /* ... and extends over bins above this level */
+  uint32_t min_bins;  /* Narrower detections are discarded */
+  uint32_t merge_gap; /* Detections closer than this (in bins) are merged */
+  uint32_t confirm;   /* Frames before a new channel is reported */
+  uint32_t hold;      /* Frames a channel survives without detections */
+  uint32_t max_open;  /* Maximum number of auto-opened inspectors */
+  char    *auto_open; /* Inspector class to open on new channels, or NULL */
+};
+
+#define suscan_analyzer_cfar_params_INITIALIZER {       \
+  SU_FALSE,                      /* enabled */          \
+  SUSCAN_ANALYZER_CFAR_MODE_CA,  /* mode */             \
+  2,                             /* guard */            \
+  16,                            /* ref */              \
+  10,                            /* on_db */            \
+  6,                             /* off_db */           \
+  2,                             /* min_bins */         \
+  2,                             /* merge_gap */        \
+  3,                             /* confirm */          \
+  10,                            /* hold */             \
+  8,                             /* max_open */         \
+  NULL,                          /* auto_open */        \
+}
+
+SUBOOL suscan_analyzer_cfar_params_copy(
+    struct suscan_analyzer_cfar_params *dest,
+    const struct suscan_analyzer_cfar_params *orig);
+
+void suscan_analyzer_cfar_params_finalize(
+    struct suscan_analyzer_cfar_params *self);
+
+/* PSD statistics. All levels are in dB */
+SUSCAN_SERIALIZABLE(suscan_analyzer_psd_stats_msg) {
+  int64_t  fc;
+  struct   timeval timestamp; /* Source time of the last PSD frame */
+  SUFLOAT  samp_rate;
+  SUFLOAT  window;            /* Seconds covered by these statistics */
+  uint64_t frames;            /* PSD frames covered by these statistics */
+  SUSCOUNT size;
+  SUFLOAT *max;
+  SUFLOAT *min;
+  SUFLOAT *mean;
+  SUFLOAT *p50;
+  SUFLOAT *p90;
+  SUFLOAT *occupancy;         /* Fraction of frames above the threshold */
+};
+
 
 /* Channel spectrum message */
 SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
@@ -113,8 +192,11 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
   SUFLOAT  samp_rate;
   SUFLOAT  measured_samp_rate;
   SUFLOAT  N0;
+  SUSCOUNT dropped;    /* Samples left out of the PSD (dropped or decimated) */
+  uint32_t decimation; /* The PSD is computed from one buffer every N */
   SUSCOUNT psd_size;
   SUFLOAT *psd_data;
+  void    *pdu;        /* If not NULL, psd_data points into this PDU */
 };
 
 /* These messages allow partial deserialization */
@@ -125,6 +207,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_sample_batch_msg) {
   uint32_t   inspector_id;
   SUCOMPLEX *samples;
   SUSCOUNT   sample_count;
+  void      *pdu;      /* If not NULL, samples point into this PDU */
 };
 
 /*
@@ -153,6 +236,7 @@ enum suscan_analyzer_inspector_msgkind {
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CORRECTION,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL,
+  SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM_MASK,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_COUNT
 };
 
@@ -185,6 +269,7 @@ suscan_analyzer_inspector_msgkind_to_string(
     SUSCAN_COMP_MSGKIND(ORBIT_REPORT);
     SUSCAN_COMP_MSGKIND(INVALID_CORRECTION);
     SUSCAN_COMP_MSGKIND(SIGNAL);
+    SUSCAN_COMP_MSGKIND(SPECTRUM_MASK);
 
     default:
       return "UNKNOWN";
@@ -204,12 +289,15 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_inspector_msg) {
 
   struct timeval rt_time;
 
+  void *pdu;             /* If not NULL, spectrum_data points into this PDU */
+
   union {
     struct {
       char *class_name;
       struct sigutils_channel channel;
       suscan_config_t *config;
       SUBOOL precise;
+      uint32_t source; /* Source index, local multi-source analyzers only */
       uint32_t fs;  /* Baseband rate */
       SUFLOAT equiv_fs; /* Channel rate */
       SUFLOAT bandwidth;
@@ -231,6 +319,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_inspector_msg) {
       SUSCOUNT  samp_rate;
       SUFREQ    fc;
       SUFLOAT   N0;
+      uint32_t  spectsrc_mask; /* Bit n enables spectrum source n + 1 */
     };
 
     struct {
@@ -261,6 +350,11 @@ SUBOOL suscan_analyzer_send_status(
     int code,
     const char *err_msg_fmt, ...);
 
+SUBOOL suscan_analyzer_send_channels(
+    suscan_analyzer_t *analyzer,
+    struct sigutils_channel **list,
+    unsigned int len);
+
 SUBOOL suscan_analyzer_send_detector_channels(
     suscan_analyzer_t *analyzer,
     const su_channel_detector_t *detector);
@@ -275,6 +369,14 @@ SUBOOL suscan_analyzer_send_psd_from_smoothpsd(
     SUBOOL looped,
     SUSCOUNT history_size);
 
+SUBOOL suscan_analyzer_send_psd_from_smoothpsd_ex(
+    suscan_analyzer_t *self,
+    const su_smoothpsd_t *smoothpsd,
+    SUBOOL looped,
+    SUSCOUNT history_size,
+    SUSCOUNT dropped,
+    unsigned int decimation);
+
 SUBOOL suscan_analyzer_send_source_info(
     suscan_analyzer_t *self,
     const struct suscan_source_info *info);
@@ -325,6 +427,13 @@ SUFLOAT *suscan_analyzer_psd_msg_take_psd(struct suscan_analyzer_psd_msg *msg);
 
 void suscan_analyzer_psd_msg_destroy(struct suscan_analyzer_psd_msg *msg);
 
+/* PSD statistics message */
+struct suscan_analyzer_psd_stats_msg *suscan_analyzer_psd_stats_msg_new(
+    SUSCOUNT size);
+
+void suscan_analyzer_psd_stats_msg_destroy(
+    struct suscan_analyzer_psd_stats_msg *msg);
+
 /* Sample batch message */
 struct suscan_analyzer_sample_batch_msg *suscan_analyzer_sample_batch_msg_new(
     uint32_t inspector_id,
@@ -350,6 +459,19 @@ suscan_analyzer_msg_deserialize(
     void **ptr,
     grow_buf_t *buffer);
 
+/*
+ * Deserializes a message from a received PDU, avoiding copies of bulk
+ * arrays (PSD data, sample batches and inspector spectra). These are left
+ * inside the PDU, and the message adopts the PDU storage, releasing it when
+ * disposed. In that case, pdu is left empty. pdu must own its storage (it
+ * cannot be a loan) and must not be parsed again.
+ */
+SUBOOL
+suscan_analyzer_msg_deserialize_pdu(
+    uint32_t *type,
+    void **ptr,
+    grow_buf_t *pdu);
+
 /* Generic message disposer */
 void suscan_analyzer_dispose_message(uint32_t type, void *ptr);
 
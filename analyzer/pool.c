@@ -206,6 +206,7 @@ SU_METHOD(suscan_sample_buffer_pool, suscan_sample_buffer_t *, acquire)
 
     ++ret->refcnt;
     ret->acquired = SU_TRUE;
+    ret->length   = ret->size;
     
     SU_TRYCATCH(pthread_mutex_lock(&self->mutex) == 0, return NULL);
     --self->free_num;
@@ -249,6 +250,7 @@ SU_METHOD(suscan_sample_buffer_pool, suscan_sample_buffer_t *, try_acquire)
   SU_TRYZ_FAIL(pthread_mutex_unlock(&self->mutex));
 
   ret->acquired = SU_TRUE;
+  ret->length   = ret->size;
   ++ret->refcnt;
 
   return ret;
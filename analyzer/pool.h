@@ -44,6 +44,7 @@ struct suscan_sample_buffer {
 
   SUCOMPLEX *data;
   SUSCOUNT   size;
+  SUSCOUNT   length; /* Samples actually stored, size by default */
 
   void *circ_priv; /* Private data for the circularity info */
   void *user_priv; /* Private data for user */
@@ -63,6 +64,12 @@ SU_GETTER(suscan_sample_buffer, SUSCOUNT, size)
   return self->size;
 }
 
+SUINLINE
+SU_GETTER(suscan_sample_buffer, SUSCOUNT, length)
+{
+  return self->length;
+}
+
 SUINLINE
 SU_GETTER(suscan_sample_buffer, void *, userdata)
 {
@@ -81,6 +88,12 @@ SU_METHOD(suscan_sample_buffer, void, set_userdata, void *userdata)
   self->user_priv = userdata;
 }
 
+SUINLINE
+SU_METHOD(suscan_sample_buffer, void, set_length, SUSCOUNT length)
+{
+  self->length = length;
+}
+
 SUINLINE
 SU_METHOD(suscan_sample_buffer, void, set_offset, SUSCOUNT off)
 {
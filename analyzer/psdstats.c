@@ -0,0 +1,226 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "psd-stats"
+
+#include <string.h>
+#include <analyzer/psdstats.h>
+
+void
+suscan_psd_stats_destroy(suscan_psd_stats_t *self)
+{
+  if (self->max != NULL)
+    free(self->max);
+
+  if (self->min != NULL)
+    free(self->min);
+
+  if (self->mean != NULL)
+    free(self->mean);
+
+  if (self->dev != NULL)
+    free(self->dev);
+
+  if (self->p50 != NULL)
+    free(self->p50);
+
+  if (self->p90 != NULL)
+    free(self->p90);
+
+  if (self->busy != NULL)
+    free(self->busy);
+
+  if (self->frame_db != NULL)
+    free(self->frame_db);
+
+  if (self->scratch != NULL)
+    free(self->scratch);
+
+  free(self);
+}
+
+suscan_psd_stats_t *
+suscan_psd_stats_new(
+  const struct suscan_analyzer_psd_stats_params *params,
+  SUSCOUNT size)
+{
+  suscan_psd_stats_t *new = NULL;
+
+  SU_TRYCATCH(size > 0, goto fail);
+  SU_TRYCATCH(params->alpha > 0 && params->alpha <= 1, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_psd_stats_t);
+
+  new->params = *params;
+  new->size   = size;
+
+  SU_ALLOCATE_MANY_FAIL(new->max,      size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->min,      size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->mean,     size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->dev,      size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->p50,      size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->p90,      size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->busy,     size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->frame_db, size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->scratch,  size, SUFLOAT);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_psd_stats_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_psd_stats_reset(suscan_psd_stats_t *self)
+{
+  /* Everything else is initialized by the first frame */
+  self->frames = 0;
+}
+
+SUFLOAT
+suscan_psd_select(SUFLOAT *x, SUSCOUNT size, SUSCOUNT k)
+{
+  SUSCOUNT lo = 0, hi = size - 1, i, j;
+  SUFLOAT pivot, tmp;
+
+  while (lo < hi) {
+    pivot = x[lo + (hi - lo) / 2];
+    i = lo;
+    j = hi;
+
+    while (i <= j) {
+      while (x[i] < pivot)
+        ++i;
+      while (x[j] > pivot)
+        --j;
+
+      if (i <= j) {
+        tmp  = x[i];
+        x[i] = x[j];
+        x[j] = tmp;
+        ++i;
+        if (j == 0)
+          break;
+        --j;
+      }
+    }
+
+    if (k <= j)
+      hi = j;
+    else if (k >= i)
+      lo = i;
+    else
+      break;
+  }
+
+  return x[k];
+}
+
+SUBOOL
+suscan_psd_stats_feed(
+  suscan_psd_stats_t *self,
+  const SUFLOAT *psd,
+  SUSCOUNT size)
+{
+  SUFLOAT alpha = self->params.alpha;
+  SUFLOAT x, step, floor_db, threshold;
+  SUSCOUNT i;
+
+  if (size != self->size) {
+    SU_ERROR(
+      "PSD size mismatch (expected %d, got %d)\n",
+      self->size,
+      size);
+    return SU_FALSE;
+  }
+
+  for (i = 0; i < size; ++i)
+    self->frame_db[i] = SU_POWER_DB_RAW(psd[i] + SUFLOAT_THRESHOLD);
+
+  /* Noise floor of this frame */
+  memcpy(self->scratch, self->frame_db, size * sizeof(SUFLOAT));
+  floor_db  = suscan_psd_select(self->scratch, size, size / 2);
+  threshold = floor_db + self->params.threshold;
+
+  if (self->frames == 0) {
+    memcpy(self->max,  self->frame_db, size * sizeof(SUFLOAT));
+    memcpy(self->min,  self->frame_db, size * sizeof(SUFLOAT));
+    memcpy(self->mean, self->frame_db, size * sizeof(SUFLOAT));
+    memcpy(self->p50,  self->frame_db, size * sizeof(SUFLOAT));
+    memcpy(self->p90,  self->frame_db, size * sizeof(SUFLOAT));
+    memset(self->dev,  0, size * sizeof(SUFLOAT));
+
+    for (i = 0; i < size; ++i)
+      self->busy[i] = self->frame_db[i] > threshold;
+  } else {
+    for (i = 0; i < size; ++i) {
+      x = self->frame_db[i];
+
+      if (x > self->max[i])
+        self->max[i] = x;
+      if (x < self->min[i])
+        self->min[i] = x;
+
+      self->dev[i]  += alpha * (SU_ABS(x - self->mean[i]) - self->dev[i]);
+      self->mean[i] += alpha * (x - self->mean[i]);
+
+      step = SU_MAX(
+        SUSCAN_PSD_STATS_QUANTILE_GAIN * self->dev[i],
+        SUSCAN_PSD_STATS_MIN_STEP_DB);
+
+      self->p50[i] += x > self->p50[i] ? .5 * step : -.5 * step;
+      self->p90[i] += x > self->p90[i] ? .9 * step : -.1 * step;
+
+      if (x > threshold)
+        self->busy[i] += 1;
+    }
+  }
+
+  ++self->frames;
+
+  return SU_TRUE;
+}
+
+struct suscan_analyzer_psd_stats_msg *
+suscan_psd_stats_make_msg(const suscan_psd_stats_t *self)
+{
+  struct suscan_analyzer_psd_stats_msg *msg = NULL;
+  SUFLOAT k;
+  SUSCOUNT i;
+
+  SU_TRYCATCH(self->frames > 0, return NULL);
+  SU_TRYCATCH(msg = suscan_analyzer_psd_stats_msg_new(self->size), return NULL);
+
+  msg->frames = self->frames;
+
+  memcpy(msg->max,  self->max,  self->size * sizeof(SUFLOAT));
+  memcpy(msg->min,  self->min,  self->size * sizeof(SUFLOAT));
+  memcpy(msg->mean, self->mean, self->size * sizeof(SUFLOAT));
+  memcpy(msg->p50,  self->p50,  self->size * sizeof(SUFLOAT));
+  memcpy(msg->p90,  self->p90,  self->size * sizeof(SUFLOAT));
+
+  k = 1. / self->frames;
+  for (i = 0; i < self->size; ++i)
+    msg->occupancy[i] = k * self->busy[i];
+
+  return msg;
+}
@@ -0,0 +1,98 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_PSDSTATS_H
+#define _ANALYZER_PSDSTATS_H
+
+#include <sigutils/sigutils.h>
+#include <analyzer/msg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_PSD_STATS_QUANTILE_GAIN  .25
+#define SUSCAN_PSD_STATS_MIN_STEP_DB    .01
+
+/*
+ * Per-bin spectrum statistics, computed from consecutive PSD frames:
+ * running max and min, exponential average, P50 and P90 and occupancy
+ * (fraction of frames in which the bin was above the noise floor plus
+ * some threshold). Quantiles are estimated by stochastic approximation
+ * (one state variable per bin and quantile), with a step size that is
+ * proportional to the mean absolute deviation of the bin. The noise floor
+ * is the median of every frame.
+ */
+struct suscan_psd_stats {
+  struct suscan_analyzer_psd_stats_params params;
+  SUSCOUNT size;
+  uint64_t frames;
+
+  SUFLOAT *max;
+  SUFLOAT *min;
+  SUFLOAT *mean;
+  SUFLOAT *dev;
+  SUFLOAT *p50;
+  SUFLOAT *p90;
+  SUFLOAT *busy;
+
+  SUFLOAT *frame_db;
+  SUFLOAT *scratch;
+};
+
+typedef struct suscan_psd_stats suscan_psd_stats_t;
+
+suscan_psd_stats_t *suscan_psd_stats_new(
+    const struct suscan_analyzer_psd_stats_params *params,
+    SUSCOUNT size);
+
+void suscan_psd_stats_reset(suscan_psd_stats_t *self);
+
+/* psd is given in linear units, its size must match the size of self */
+SUBOOL suscan_psd_stats_feed(
+    suscan_psd_stats_t *self,
+    const SUFLOAT *psd,
+    SUSCOUNT size);
+
+SUINLINE SUSCOUNT
+suscan_psd_stats_get_size(const suscan_psd_stats_t *self)
+{
+  return self->size;
+}
+
+SUINLINE uint64_t
+suscan_psd_stats_get_frames(const suscan_psd_stats_t *self)
+{
+  return self->frames;
+}
+
+/* Hoare's selection: returns the k-th smallest element, reordering x */
+SUFLOAT suscan_psd_select(SUFLOAT *x, SUSCOUNT size, SUSCOUNT k);
+
+/* Only levels and frame count are filled. The rest is up to the caller */
+struct suscan_analyzer_psd_stats_msg *suscan_psd_stats_make_msg(
+    const suscan_psd_stats_t *self);
+
+void suscan_psd_stats_destroy(suscan_psd_stats_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_PSDSTATS_H */
@@ -0,0 +1,225 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "resampler"
+
+#include <string.h>
+#include <math.h>
+#include <analyzer/resampler.h>
+
+void
+suscan_resampler_destroy(suscan_resampler_t *self)
+{
+  if (self->table != NULL)
+    free(self->table);
+
+  if (self->history != NULL)
+    free(self->history);
+
+  free(self);
+}
+
+/* Blackman-windowed sinc, t in input samples from the filter center */
+SUPRIVATE SUFLOAT
+suscan_resampler_prototype(const suscan_resampler_t *self, SUFLOAT t)
+{
+  SUFLOAT fc = 2 * self->cutoff / self->fs_in;
+  SUFLOAT u  = t / self->taps + .5;
+  SUFLOAT h, w;
+
+  if (u <= 0 || u >= 1)
+    return 0;
+
+  h = SU_ABS(t) < 1e-6 ? fc : SU_SIN(M_PI * fc * t) / (M_PI * t);
+  w = .42 - .5 * SU_COS(2 * M_PI * u) + .08 * SU_COS(4 * M_PI * u);
+
+  return h * w;
+}
+
+/*
+ * Row p holds the taps for outputs that fall p / SUSCAN_RESAMPLER_PHASES
+ * samples after the newest input, in the order of the history buffer
+ * (oldest first). Each row is normalized to unit DC gain.
+ */
+SUPRIVATE void
+suscan_resampler_init_table(suscan_resampler_t *self)
+{
+  SUFLOAT *row;
+  SUFLOAT frac, sum;
+  SUSCOUNT i, p;
+
+  for (p = 0; p <= SUSCAN_RESAMPLER_PHASES; ++p) {
+    row  = self->table + p * self->taps;
+    frac = (SUFLOAT) p / SUSCAN_RESAMPLER_PHASES;
+    sum  = 0;
+
+    for (i = 0; i < self->taps; ++i) {
+      row[i] = suscan_resampler_prototype(
+          self,
+          (SUFLOAT) self->taps / 2 - 1 - i + frac);
+      sum += row[i];
+    }
+
+    if (sum > 0)
+      for (i = 0; i < self->taps; ++i)
+        row[i] /= sum;
+  }
+}
+
+suscan_resampler_t *
+suscan_resampler_new(
+    SUFLOAT fs_in,
+    SUFLOAT fs_out,
+    SUFLOAT cutoff,
+    unsigned int zero_crossings)
+{
+  suscan_resampler_t *new = NULL;
+  SUFLOAT max_cutoff;
+  SUSCOUNT taps;
+
+  SU_TRYCATCH(fs_in > 0 && fs_out > 0, goto fail);
+  SU_TRYCATCH(cutoff > 0, goto fail);
+  SU_TRYCATCH(zero_crossings > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_resampler_t);
+
+  max_cutoff = SUSCAN_RESAMPLER_MAX_CUTOFF * SU_MIN(fs_in, fs_out);
+  if (cutoff > max_cutoff)
+    cutoff = max_cutoff;
+
+  taps = SU_CEIL(zero_crossings * fs_in / cutoff);
+  if (taps < 2)
+    taps = 2;
+
+  if (taps > SUSCAN_RESAMPLER_MAX_TAPS) {
+    SU_WARNING(
+        "Resampler filter too long (%lu taps), clipped to %d\n",
+        (unsigned long) taps,
+        SUSCAN_RESAMPLER_MAX_TAPS);
+    taps = SUSCAN_RESAMPLER_MAX_TAPS;
+  }
+
+  new->fs_in  = fs_in;
+  new->fs_out = fs_out;
+  new->cutoff = cutoff;
+  new->taps   = taps;
+  new->step   = (SUDOUBLE) fs_in / fs_out;
+
+  SU_ALLOCATE_MANY_FAIL(
+      new->table,
+      (SUSCAN_RESAMPLER_PHASES + 1) * taps,
+      SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->history, 2 * taps, SUCOMPLEX);
+
+  suscan_resampler_init_table(new);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_resampler_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_resampler_reset(suscan_resampler_t *self)
+{
+  memset(self->history, 0, 2 * self->taps * sizeof(SUCOMPLEX));
+
+  self->ptr = 0;
+  self->pos = 0;
+}
+
+SUSCOUNT
+suscan_resampler_get_output_count(
+    const suscan_resampler_t *self,
+    SUSCOUNT size)
+{
+  if (size <= self->pos)
+    return 0;
+
+  return ceil((size - self->pos) / self->step);
+}
+
+SUSCOUNT
+suscan_resampler_get_input_count(
+    const suscan_resampler_t *self,
+    SUSCOUNT size)
+{
+  SUSCOUNT count = floor(self->pos + size * self->step);
+
+  /* Rounding may go either way. Stick to the exact output count. */
+  while (count > 0 && suscan_resampler_get_output_count(self, count) > size)
+    --count;
+
+  return count;
+}
+
+SUINLINE SUCOMPLEX
+suscan_resampler_eval(const suscan_resampler_t *self, SUDOUBLE pos)
+{
+  const SUCOMPLEX *x = self->history + self->ptr;
+  const SUFLOAT *h;
+  SUCOMPLEX y0 = 0, y1 = 0, y2 = 0, y3 = 0;
+  SUSCOUNT i, p;
+
+  /* pos is in [0, 1), so p is in [0, SUSCAN_RESAMPLER_PHASES] */
+  p = pos * SUSCAN_RESAMPLER_PHASES + .5;
+  h = self->table + p * self->taps;
+
+  /* Independent partial sums, so the additions can overlap */
+  for (i = 0; i + 3 < self->taps; i += 4) {
+    y0 += h[i]     * x[i];
+    y1 += h[i + 1] * x[i + 1];
+    y2 += h[i + 2] * x[i + 2];
+    y3 += h[i + 3] * x[i + 3];
+  }
+
+  for (; i < self->taps; ++i)
+    y0 += h[i] * x[i];
+
+  return (y0 + y1) + (y2 + y3);
+}
+
+SUSCOUNT
+suscan_resampler_feed(
+    suscan_resampler_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT size,
+    SUCOMPLEX *y)
+{
+  SUSCOUNT i, n = 0;
+
+  for (i = 0; i < size; ++i) {
+    /* Both copies, so that the last taps samples are always contiguous */
+    self->history[self->ptr] = self->history[self->ptr + self->taps] = x[i];
+    if (++self->ptr == self->taps)
+      self->ptr = 0;
+
+    while (self->pos < 1) {
+      y[n++] = suscan_resampler_eval(self, self->pos);
+      self->pos += self->step;
+    }
+
+    self->pos -= 1;
+  }
+
+  return n;
+}
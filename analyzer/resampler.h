@@ -0,0 +1,100 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_RESAMPLER_H
+#define _ANALYZER_RESAMPLER_H
+
+#include <sigutils/sigutils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Polyphase FIR resampler, for arbitrary rate ratios. The prototype
+ * filter is a windowed sinc, tabulated in SUSCAN_RESAMPLER_PHASES
+ * phases. The filter is evaluated only at output instants, using the
+ * closest phase (one multiply-accumulate per tap and output). With 256
+ * phases, the timing error is below 1/512 of an input sample.
+ *
+ * The position of the next output is kept in input sample units, in
+ * double precision. This way, the average output rate is the requested
+ * one, and not the closest rate that integer decimation can give.
+ *
+ * zero_crossings is the number of zero crossings of the sinc on each
+ * side of the filter, and sets its selectivity. The filter spans
+ * 2 * zero_crossings / (2 * cutoff / samp_rate) input samples, so it
+ * gets longer as the ratio between the input rate and the cutoff grows.
+ */
+#define SUSCAN_RESAMPLER_PHASES       256
+#define SUSCAN_RESAMPLER_MAX_TAPS     2048
+#define SUSCAN_RESAMPLER_MAX_CUTOFF   .45 /* Relative to the lowest rate */
+
+struct suscan_resampler {
+  SUFLOAT   fs_in;
+  SUFLOAT   fs_out;
+  SUFLOAT   cutoff;
+  SUSCOUNT  taps;    /* Taps per phase */
+  SUFLOAT  *table;   /* (SUSCAN_RESAMPLER_PHASES + 1) rows of taps */
+
+  SUCOMPLEX *history; /* Last taps inputs, stored twice */
+  SUSCOUNT   ptr;
+
+  SUDOUBLE  step;    /* Input samples per output sample */
+  SUDOUBLE  pos;     /* Next output, relative to the next input */
+};
+
+typedef struct suscan_resampler suscan_resampler_t;
+
+suscan_resampler_t *suscan_resampler_new(
+    SUFLOAT fs_in,
+    SUFLOAT fs_out,
+    SUFLOAT cutoff,
+    unsigned int zero_crossings);
+
+void suscan_resampler_reset(suscan_resampler_t *self);
+
+/* Number of outputs produced by the next size inputs */
+SUSCOUNT suscan_resampler_get_output_count(
+    const suscan_resampler_t *self,
+    SUSCOUNT size);
+
+/* Largest number of inputs that produce at most size outputs */
+SUSCOUNT suscan_resampler_get_input_count(
+    const suscan_resampler_t *self,
+    SUSCOUNT size);
+
+/*
+ * Consumes all size inputs. y must have room for (at least)
+ * suscan_resampler_get_output_count(self, size) samples. Returns the
+ * number of samples written to y.
+ */
+SUSCOUNT suscan_resampler_feed(
+    suscan_resampler_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT size,
+    SUCOMPLEX *y);
+
+void suscan_resampler_destroy(suscan_resampler_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_RESAMPLER_H */
@@ -280,3 +280,145 @@ suscan_unpack_compact_complex_array(
   return SU_TRUE;
 }
 
+
+/*
+ * Returns where an array of size-byte elements borrowed at data can be
+ * placed, or NULL. Arrays are moved back to the closest aligned address,
+ * over bytes of the same buffer that have been consumed already.
+ */
+SUPRIVATE void *
+suscan_borrow_aligned(grow_buf_t *buffer, void *data, size_t size)
+{
+  uint8_t *base = grow_buf_get_buffer(buffer);
+  uint8_t *dest = (uint8_t *) data - (uintptr_t) data % size;
+
+  return dest >= base ? dest : NULL;
+}
+
+SUBOOL
+suscan_unpack_compact_single_array_borrow(
+    grow_buf_t *buffer,
+    SUSINGLE **oarray,
+    SUSCOUNT *osize,
+    SUBOOL *oborrowed)
+{
+  SUSINGLE *array = NULL;
+  void *data = NULL;
+  size_t data_size = 0;
+  SUSCOUNT array_length = 0;
+  SUBOOL borrowed = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SUSCAN_UNPACK(uint64, array_length);
+
+  if (array_length > 0) {
+    SU_TRYCATCH(
+        cbor_unpack_blob_borrow(buffer, &data, &data_size) == 0,
+        goto fail);
+    SU_TRYCATCH(data_size == array_length * sizeof(SUSINGLE), goto fail);
+
+    if ((array = suscan_borrow_aligned(buffer, data, sizeof(SUSINGLE)))
+        != NULL)
+      borrowed = SU_TRUE;
+    else
+      SU_ALLOCATE_MANY_FAIL(array, array_length, SUSINGLE);
+
+    /* Safe in place: the destination never goes past the source */
+    suscan_single_array_be_to_cpu(array, data, array_length);
+  }
+
+  *oarray    = array;
+  *osize     = array_length;
+  *oborrowed = borrowed;
+
+  array = NULL;
+
+  ok = SU_TRUE;
+
+fail:
+  if (array != NULL && !borrowed)
+    free(array);
+
+  return ok;
+}
+
+SUBOOL
+suscan_unpack_compact_double_array_borrow(
+    grow_buf_t *buffer,
+    SUDOUBLE **oarray,
+    SUSCOUNT *osize,
+    SUBOOL *oborrowed)
+{
+  SUDOUBLE *array = NULL;
+  void *data = NULL;
+  size_t data_size = 0;
+  SUSCOUNT array_length = 0;
+  SUBOOL borrowed = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SUSCAN_UNPACK(uint64, array_length);
+
+  if (array_length > 0) {
+    SU_TRYCATCH(
+        cbor_unpack_blob_borrow(buffer, &data, &data_size) == 0,
+        goto fail);
+    SU_TRYCATCH(data_size == array_length * sizeof(SUDOUBLE), goto fail);
+
+    if ((array = suscan_borrow_aligned(buffer, data, sizeof(SUDOUBLE)))
+        != NULL)
+      borrowed = SU_TRUE;
+    else
+      SU_ALLOCATE_MANY_FAIL(array, array_length, SUDOUBLE);
+
+    suscan_double_array_be_to_cpu(array, data, array_length);
+  }
+
+  *oarray    = array;
+  *osize     = array_length;
+  *oborrowed = borrowed;
+
+  array = NULL;
+
+  ok = SU_TRUE;
+
+fail:
+  if (array != NULL && !borrowed)
+    free(array);
+
+  return ok;
+}
+
+SUBOOL
+suscan_unpack_compact_complex_array_borrow(
+    grow_buf_t *buffer,
+    SUCOMPLEX **array,
+    SUSCOUNT *size,
+    SUBOOL *borrowed)
+{
+  SUSCOUNT fake_size = 0;
+
+  if (!suscan_unpack_compact_float_array_borrow(
+      buffer,
+      (SUFLOAT **) array,
+      &fake_size,
+      borrowed)) {
+    SU_ERROR("Failed to unpack float components of complex array\n");
+    return SU_FALSE;
+  }
+
+  if (fake_size & 1) {
+    if (!*borrowed)
+      free(*array);
+    *array = NULL;
+    *size  = 0;
+    *borrowed = SU_FALSE;
+
+    SU_ERROR("Complex array: odd number of floats (%d)\n", fake_size);
+
+    return SU_FALSE;
+  }
+
+  *size = fake_size >> 1;
+
+  return SU_TRUE;
+}
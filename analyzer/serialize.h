@@ -25,9 +25,13 @@
 #ifdef _SU_SINGLE_PRECISION
 #  define suscan_pack_compact_float_array   suscan_pack_compact_single_array
 #  define suscan_unpack_compact_float_array suscan_unpack_compact_single_array
+#  define suscan_unpack_compact_float_array_borrow \
+  suscan_unpack_compact_single_array_borrow
 #else
 #  define suscan_pack_compact_float_array   suscan_pack_compact_double_array
 #  define suscan_unpack_compact_float_array suscan_unpack_compact_double_array
+#  define suscan_unpack_compact_float_array_borrow \
+  suscan_unpack_compact_double_array_borrow
 #endif /* _SU_SINGLE_PRECISION */
 
 #define SUSCAN_TYPE_SERIALIZER_PROTO(typename)         \
@@ -176,4 +180,33 @@ SUBOOL suscan_unpack_compact_complex_array(
     SUCOMPLEX **array,
     SUSCOUNT *size);
 
+/*
+ * Borrowing unpackers, for bulk arrays. Arrays are converted to host byte
+ * order in place and left inside the storage of the buffer, instead of
+ * being copied to a new allocation. If *borrowed is set to SU_TRUE, the
+ * array is only valid as long as that storage is, and must not be freed.
+ * This is destructive: the buffer cannot be parsed again afterwards.
+ *
+ * Borrowed arrays are aligned by moving them over bytes of the buffer
+ * that were already consumed. If that is not possible, a copy is made
+ * and *borrowed is set to SU_FALSE.
+ */
+SUBOOL suscan_unpack_compact_single_array_borrow(
+    grow_buf_t *buffer,
+    SUSINGLE **oarray,
+    SUSCOUNT *osize,
+    SUBOOL *oborrowed);
+
+SUBOOL suscan_unpack_compact_double_array_borrow(
+    grow_buf_t *buffer,
+    SUDOUBLE **oarray,
+    SUSCOUNT *osize,
+    SUBOOL *oborrowed);
+
+SUBOOL suscan_unpack_compact_complex_array_borrow(
+    grow_buf_t *buffer,
+    SUCOMPLEX **array,
+    SUSCOUNT *size,
+    SUBOOL *borrowed);
+
 #endif /* _SUSCAN_SERIALIZE_H */
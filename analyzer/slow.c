@@ -655,6 +655,60 @@ suscan_local_analyzer_set_psd_samp_rate_overridable(
       NULL);
 }
 
+/*
+ * PSD statistics are computed by the PSD worker, which picks these
+ * parameters up before processing its next PSD frame.
+ */
+SUBOOL
+suscan_local_analyzer_set_psd_stats_params_overridable(
+    suscan_local_analyzer_t *self,
+    const struct suscan_analyzer_psd_stats_params *params)
+{
+  SU_TRYCATCH(
+      self->parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL,
+      return SU_FALSE);
+
+  SU_TRYCATCH(params->update_int >= 0, return SU_FALSE);
+  SU_TRYCATCH(params->window >= 0, return SU_FALSE);
+  SU_TRYCATCH(params->alpha > 0 && params->alpha <= 1, return SU_FALSE);
+
+  SU_TRYCATCH(pthread_mutex_lock(&self->hotconf_mutex) != -1, return SU_FALSE);
+  self->psd_stats_req_params = *params;
+  self->psd_stats_req = SU_TRUE;
+  pthread_mutex_unlock(&self->hotconf_mutex);
+
+  return SU_TRUE;
+}
+
+/* Same for the CFAR detector, which is also run by the PSD worker */
+SUBOOL
+suscan_local_analyzer_set_cfar_params_overridable(
+    suscan_local_analyzer_t *self,
+    const struct suscan_analyzer_cfar_params *params)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      self->parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL,
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      params->mode == SUSCAN_ANALYZER_CFAR_MODE_CA
+      || params->mode == SUSCAN_ANALYZER_CFAR_MODE_OS,
+      return SU_FALSE);
+  SU_TRYCATCH(params->ref > 0, return SU_FALSE);
+  SU_TRYCATCH(params->off_db >= 0, return SU_FALSE);
+  SU_TRYCATCH(params->on_db >= params->off_db, return SU_FALSE);
+
+  SU_TRYCATCH(pthread_mutex_lock(&self->hotconf_mutex) != -1, return SU_FALSE);
+  ok = suscan_analyzer_cfar_params_copy(&self->cfar_req_params, params);
+  if (ok)
+    self->cfar_req = SU_TRUE;
+  pthread_mutex_unlock(&self->hotconf_mutex);
+
+  return ok;
+}
+
 SUBOOL
 suscan_local_analyzer_slow_set_freq(
     suscan_local_analyzer_t *self,
@@ -529,12 +529,58 @@ suscan_source_get_time(suscan_source_t *self, struct timeval *tv)
   }
 }
 
+SUBOOL
+suscan_source_get_hw_time(
+  suscan_source_t *self,
+  const void **clock,
+  long long *ns)
+{
+  SUSCOUNT pending;
+
+  if (self->history_replay || self->iface->get_hw_time == NULL)
+    return SU_FALSE;
+
+  if (!(self->iface->get_hw_time) (self->src_priv, clock, ns))
+    return SU_FALSE;
+
+  /* Decimated samples not returned yet were read from the device earlier */
+  if (self->decim > 1) {
+    pending = self->decim_spillover_size - self->decim_spillover_ptr;
+    *ns -= (long long) (
+      1e9 * (SUDOUBLE) (pending * self->decim) / self->info.source_samp_rate);
+  }
+
+  return SU_TRUE;
+}
+
 SUSCOUNT 
 suscan_source_get_consumed_samples(const suscan_source_t *self)
 {
   return self->total_samples;
 }
 
+void
+suscan_source_report_overflow(suscan_source_t *self)
+{
+  ++self->info.overflow_count;
+}
+
+void
+suscan_source_report_lost_samples(suscan_source_t *self, SUSCOUNT lost)
+{
+  /* Lost samples are reported at the device rate */
+  if (self->decim > 1)
+    lost /= self->decim;
+
+  self->info.lost_samples += lost;
+}
+
+void
+suscan_source_set_hw_timestamps(suscan_source_t *self, SUBOOL enabled)
+{
+  self->info.hw_timestamps = enabled;
+}
+
 void
 suscan_source_get_end_time(
   const suscan_source_t *self,
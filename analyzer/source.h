@@ -87,6 +87,7 @@ struct suscan_source_interface {
   SUSDIFF  (*max_size) (void *);
   
   void     (*get_time) (void *, struct timeval *tv);
+  SUBOOL   (*get_hw_time) (void *, const void **clock, long long *ns);
   SUBOOL   (*seek) (void *,  SUSCOUNT samples);
 
   SUBOOL   (*set_frequency) (void *, SUFREQ freq);
@@ -182,6 +183,17 @@ suscan_sample_buffer_t *suscan_source_read_buffer(
 SUSDIFF  suscan_source_get_max_size(const suscan_source_t *self);
 
 void   suscan_source_get_time(suscan_source_t *self, struct timeval *tv);
+
+/*
+ * Device time (in ns) of the next sample returned by suscan_source_read.
+ * Only sources reporting the same clock handle can be compared against
+ * each other (e.g. different channels of the same SDR device). Fails if
+ * the source does not provide hardware time (yet) or is replaying history.
+ */
+SUBOOL suscan_source_get_hw_time(
+  suscan_source_t *self,
+  const void **clock,
+  long long *ns);
 SUBOOL suscan_source_seek(suscan_source_t *self, SUSCOUNT);
 
 SUBOOL suscan_source_override_throttle(suscan_source_t *self, SUSCOUNT val);
@@ -211,6 +223,11 @@ void     suscan_source_clear_history(suscan_source_t *self);
 /* Other API methods */
 SUSCOUNT suscan_source_get_dc_samples(const suscan_source_t *self);
 SUSCOUNT suscan_source_get_consumed_samples(const suscan_source_t *self);
+
+/* Sample loss accounting, used by real time source implementations */
+void     suscan_source_report_overflow(suscan_source_t *self);
+void     suscan_source_report_lost_samples(suscan_source_t *self, SUSCOUNT);
+void     suscan_source_set_hw_timestamps(suscan_source_t *self, SUBOOL);
 SUSCOUNT suscan_source_get_base_samp_rate(const suscan_source_t *self);
 void     suscan_source_get_end_time(
   const suscan_source_t *self, 
@@ -187,6 +187,7 @@ suscan_source_config_destroy(suscan_source_config_t *config)
     SU_DISPOSE(suscan_device_spec, config->device_spec);
 
   suscan_source_config_clear_gains(config);
+  suscan_source_config_clear_settle_bands(config);
 
   free(config);
 }
@@ -560,6 +561,112 @@ suscan_source_config_set_gain(
   return SU_TRUE;
 }
 
+/************************** Retune settle bands ******************************/
+SUPRIVATE struct suscan_source_settle_band *
+suscan_source_config_lookup_settle_band(
+    const suscan_source_config_t *config,
+    SUFREQ freq)
+{
+  unsigned int i;
+
+  for (i = 0; i < config->settle_band_count; ++i)
+    if (config->settle_band_list[i]->freq_min <= freq
+        && freq <= config->settle_band_list[i]->freq_max)
+      return config->settle_band_list[i];
+
+  return NULL;
+}
+
+SUBOOL
+suscan_source_config_set_settle_samples(
+    suscan_source_config_t *config,
+    SUFREQ freq_min,
+    SUFREQ freq_max,
+    SUSCOUNT samples,
+    SUFLOAT samp_rate)
+{
+  struct suscan_source_settle_band *band = NULL;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(freq_min <= freq_max);
+  SU_TRY(samp_rate > 0);
+
+  /* Calibrating the same band again replaces the previous result */
+  for (i = 0; i < config->settle_band_count; ++i)
+    if (sufeq(config->settle_band_list[i]->freq_min, freq_min, 1)
+        && sufeq(config->settle_band_list[i]->freq_max, freq_max, 1)) {
+      config->settle_band_list[i]->samples   = samples;
+      config->settle_band_list[i]->samp_rate = samp_rate;
+      return SU_TRUE;
+    }
+
+  SU_ALLOCATE(band, struct suscan_source_settle_band);
+
+  band->freq_min  = freq_min;
+  band->freq_max  = freq_max;
+  band->samples   = samples;
+  band->samp_rate = samp_rate;
+
+  SU_TRYC(PTR_LIST_APPEND_CHECK(config->settle_band, band));
+  band = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (band != NULL)
+    free(band);
+
+  return ok;
+}
+
+SUSDIFF
+suscan_source_config_get_settle_samples(
+    const suscan_source_config_t *config,
+    SUFREQ freq,
+    SUFLOAT samp_rate)
+{
+  const struct suscan_source_settle_band *band;
+
+  if ((band = suscan_source_config_lookup_settle_band(config, freq)) == NULL)
+    return -1;
+
+  return (SUSDIFF) SU_CEIL(band->samples * samp_rate / band->samp_rate);
+}
+
+SUBOOL
+suscan_source_config_walk_settle_bands(
+    const suscan_source_config_t *config,
+    SUBOOL (*band_cb) (
+      void *private,
+      const struct suscan_source_settle_band *band),
+    void *private)
+{
+  unsigned int i;
+
+  for (i = 0; i < config->settle_band_count; ++i)
+    if (!(band_cb) (private, config->settle_band_list[i]))
+      return SU_FALSE;
+
+  return SU_TRUE;
+}
+
+void
+suscan_source_config_clear_settle_bands(suscan_source_config_t *config)
+{
+  unsigned int i;
+
+  for (i = 0; i < config->settle_band_count; ++i)
+    if (config->settle_band_list[i] != NULL)
+      free(config->settle_band_list[i]);
+
+  if (config->settle_band_list != NULL)
+    free(config->settle_band_list);
+
+  config->settle_band_count = 0;
+  config->settle_band_list  = NULL;
+}
+
 SUFLOAT
 suscan_source_config_get_ppm(const suscan_source_config_t *config)
 {
@@ -943,6 +1050,15 @@ suscan_source_config_clone(const suscan_source_config_t *config)
             config->hidden_gain_list[i]->name,
             config->hidden_gain_list[i]->val));
 
+  for (i = 0; i < config->settle_band_count; ++i)
+    SU_TRY_FAIL(
+        suscan_source_config_set_settle_samples(
+            new,
+            config->settle_band_list[i]->freq_min,
+            config->settle_band_list[i]->freq_max,
+            config->settle_band_list[i]->samples,
+            config->settle_band_list[i]->samp_rate));
+
   new->freq       = config->freq;
   new->lnb_freq   = config->lnb_freq;
   new->bandwidth  = config->bandwidth;
@@ -1023,6 +1139,7 @@ suscan_source_config_to_object(const suscan_source_config_t *cfg)
 {
   suscan_object_t *new = NULL;
   suscan_object_t *obj = NULL;
+  suscan_object_t *entry = NULL;
   unsigned int i;
 
   const char *tmp;
@@ -1092,9 +1209,47 @@ suscan_source_config_to_object(const suscan_source_config_t *cfg)
   SU_TRY_FAIL(suscan_object_set_field(new, "gains", obj));
   obj = NULL;
 
+  /* Save retune settle calibration */
+  if (cfg->settle_band_count > 0) {
+    SU_TRY_FAIL(obj = suscan_object_new(SUSCAN_OBJECT_TYPE_SET));
+
+    for (i = 0; i < cfg->settle_band_count; ++i) {
+      SU_TRY_FAIL(entry = suscan_object_new(SUSCAN_OBJECT_TYPE_OBJECT));
+      SU_TRY_FAIL(suscan_object_set_class(entry, "settle_band"));
+      SU_TRY_FAIL(
+          suscan_object_set_field_double(
+              entry,
+              "freq_min",
+              cfg->settle_band_list[i]->freq_min));
+      SU_TRY_FAIL(
+          suscan_object_set_field_double(
+              entry,
+              "freq_max",
+              cfg->settle_band_list[i]->freq_max));
+      SU_TRY_FAIL(
+          suscan_object_set_field_uint(
+              entry,
+              "samples",
+              cfg->settle_band_list[i]->samples));
+      SU_TRY_FAIL(
+          suscan_object_set_field_float(
+              entry,
+              "samp_rate",
+              cfg->settle_band_list[i]->samp_rate));
+      SU_TRY_FAIL(suscan_object_set_append(obj, entry));
+      entry = NULL;
+    }
+
+    SU_TRY_FAIL(suscan_object_set_field(new, "settle", obj));
+    obj = NULL;
+  }
+
   return new;
 
 fail:
+  if (entry != NULL)
+    suscan_object_destroy(entry);
+
   if (obj != NULL)
     suscan_object_destroy(obj);
 
@@ -1193,6 +1348,25 @@ suscan_source_config_from_object(const suscan_object_t *object)
     }
   }
 
+  /* Retrieve retune settle calibration */
+  if ((obj = suscan_object_get_field(object, "settle")) != NULL) {
+    if (suscan_object_get_type(obj) == SUSCAN_OBJECT_TYPE_SET) {
+      count = suscan_object_set_get_count(obj);
+      for (i = 0; i < count; ++i) {
+        if ((entry = suscan_object_set_get(obj, i)) != NULL
+            && suscan_object_get_type(entry) == SUSCAN_OBJECT_TYPE_OBJECT)
+          SU_TRYCATCH(
+              suscan_source_config_set_settle_samples(
+                  new,
+                  suscan_object_get_field_double(entry, "freq_min", 0),
+                  suscan_object_get_field_double(entry, "freq_max", 0),
+                  suscan_object_get_field_uint(entry, "samples", 0),
+                  suscan_object_get_field_float(entry, "samp_rate", 0)),
+              SU_WARNING("Profile-declared settle band #%d invalid\n", i));
+      }
+    }
+  }
+
   return new;
 
 fail:
@@ -1221,14 +1395,19 @@ fail:
   return SU_FALSE;
 }
 
-/* Put everything back on config context */
+/*
+ * Put everything back on config context. Profiles are matched in order
+ * against the stored ones, and only those that changed are replaced, so
+ * the context is not rewritten if no profile changed.
+ */
 SUPRIVATE SUBOOL
 suscan_sources_on_save(suscan_config_context_t *ctx, void *private)
 {
-  unsigned int i;
+  suscan_object_t *list = ctx->list;
+  unsigned int i, j = 0, count;
   suscan_object_t *cfg = NULL;
 
-  suscan_config_context_flush(ctx);
+  count = suscan_object_set_get_count(list);
 
   for (i = 0; i < config_count; ++i) {
     if (config_list[i] != NULL) {
@@ -1236,12 +1415,27 @@ suscan_sources_on_save(suscan_config_context_t *ctx, void *private)
           cfg = suscan_source_config_to_object(config_list[i]),
           goto fail);
 
-      SU_TRYCATCH(suscan_config_context_put(ctx, cfg), goto fail);
+      while (j < count && suscan_object_set_get(list, j) == NULL)
+        ++j;
+
+      if (j == count) {
+        SU_TRYCATCH(suscan_config_context_put(ctx, cfg), goto fail);
+      } else if (suscan_object_equals(suscan_object_set_get(list, j), cfg)) {
+        suscan_object_destroy(cfg);
+        ++j;
+      } else {
+        SU_TRYCATCH(suscan_object_set_put(list, j++, cfg), goto fail);
+      }
 
       cfg = NULL;
     }
   }
 
+  /* Profiles that no longer exist */
+  for (; j < count; ++j)
+    if (suscan_object_set_get(list, j) != NULL)
+      SU_TRYCATCH(suscan_object_set_delete(list, j), goto fail);
+
   return SU_TRUE;
 
 fail:
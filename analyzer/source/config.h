@@ -61,6 +61,19 @@ struct suscan_source_gain_value {
   SUFLOAT val;
 };
 
+/*
+ * Number of samples that must be discarded after retuning to a frequency
+ * in [freq_min, freq_max] (tuner frequencies, i.e. without LNB offset)
+ * before the samples delivered by the device can be trusted. The amount
+ * was measured at samp_rate and is scaled accordingly on lookup.
+ */
+struct suscan_source_settle_band {
+  SUFREQ   freq_min;
+  SUFREQ   freq_max;
+  SUSCOUNT samples;
+  SUFLOAT  samp_rate;
+};
+
 struct suscan_source_metadata {
   SUFREQ         frequency;
   unsigned       sample_rate;
@@ -98,6 +111,9 @@ SUSCAN_SERIALIZABLE(suscan_source_config) {
   unsigned int channel;
   PTR_LIST(struct suscan_source_gain_value, gain);
   PTR_LIST(struct suscan_source_gain_value, hidden_gain);
+
+  /* Retune settle calibration (not transferred to remote analyzers) */
+  PTR_LIST(struct suscan_source_settle_band, settle_band);
 };
 
 typedef struct suscan_source_config suscan_source_config_t;
@@ -238,6 +254,33 @@ SUBOOL suscan_source_config_set_gain(
     const char *name,
     SUFLOAT value);
 
+SUBOOL suscan_source_config_set_settle_samples(
+    suscan_source_config_t *config,
+    SUFREQ freq_min,
+    SUFREQ freq_max,
+    SUSCOUNT samples,
+    SUFLOAT samp_rate);
+
+SUSDIFF suscan_source_config_get_settle_samples(
+    const suscan_source_config_t *config,
+    SUFREQ freq,
+    SUFLOAT samp_rate);
+
+SUBOOL suscan_source_config_walk_settle_bands(
+    const suscan_source_config_t *config,
+    SUBOOL (*band_cb) (
+      void *privdata,
+      const struct suscan_source_settle_band *band),
+    void *privdata);
+
+void suscan_source_config_clear_settle_bands(suscan_source_config_t *config);
+
+SUINLINE SUBOOL
+suscan_source_config_is_settle_calibrated(const suscan_source_config_t *config)
+{
+  return config->settle_band_count > 0;
+}
+
 SUFLOAT suscan_source_config_get_ppm(const suscan_source_config_t *config);
 void suscan_source_config_set_ppm(
     suscan_source_config_t *config,
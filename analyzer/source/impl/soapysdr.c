@@ -23,6 +23,7 @@
 #include <analyzer/device/properties.h>
 #include <analyzer/device/facade.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 #ifdef _SU_SINGLE_PRECISION
 #  define SUSCAN_SOAPY_SAMPFMT SOAPY_SDR_CF32
@@ -30,6 +31,9 @@
 #  define SUSCAN_SOAPY_SAMPFMT SOAPY_SDR_CF64
 #endif
 
+#define SUSCAN_SOAPY_FORMAT_SETTING   SUSCAN_SOAPY_SETTING_PREFIX "format"
+#define SUSCAN_SOAPY_RAW_BUFFER_SIZE  16384
+
 SUPRIVATE SoapySDRKwargs *
 strmap_to_SoapySDRKwargs(const strmap_t *map)
 {
@@ -57,6 +61,152 @@ fail:
   return NULL;
 }
 
+/*
+ * Devices are shared among all the sources that open them (e.g. the
+ * different channels of a dual-channel receiver). Each source sets up its
+ * own RX stream on the shared device. Devices are identified by their
+ * device arguments, leaving out the per-source settings.
+ */
+struct suscan_source_soapysdr_device {
+  char           *key;
+  SoapySDRDevice *sdr;
+  unsigned int    refcount;
+};
+
+SUPRIVATE pthread_mutex_t g_soapysdr_device_mutex = PTHREAD_MUTEX_INITIALIZER;
+PTR_LIST_PRIVATE(struct suscan_source_soapysdr_device, g_soapysdr_device);
+
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_is_device_arg(const char *key)
+{
+  return strncmp(
+      key,
+      SUSCAN_SOURCE_SETTING_PREFIX,
+      SUSCAN_SOURCE_SETTING_PFXLEN) != 0
+    && strncmp(
+      key,
+      SUSCAN_STREAM_SETTING_PREFIX,
+      SUSCAN_STREAM_SETTING_PFXLEN) != 0
+    && strncmp(
+      key,
+      SUSCAN_SOAPY_SETTING_PREFIX,
+      SUSCAN_SOAPY_SETTING_PFXLEN) != 0;
+}
+
+SUPRIVATE int
+suscan_source_soapysdr_compare_args(const void *a, const void *b)
+{
+  return strcmp(*(const char **) a, *(const char **) b);
+}
+
+SUPRIVATE char *
+suscan_source_soapysdr_make_device_key(const SoapySDRKwargs *args)
+{
+  const char **pairs = NULL;
+  char *key = NULL, *tmp;
+  size_t i, count = 0;
+
+  SU_ALLOCATE_MANY(pairs, args->size + 1, const char *);
+
+  for (i = 0; i < args->size; ++i)
+    if (suscan_source_soapysdr_is_device_arg(args->keys[i]))
+      pairs[count++] = args->keys[i];
+
+  qsort(pairs, count, sizeof(const char *), suscan_source_soapysdr_compare_args);
+
+  SU_TRY(key = strdup(""));
+  for (i = 0; i < count; ++i) {
+    SU_TRY(
+      tmp = strbuild(
+        "%s%s=%s,",
+        key,
+        pairs[i],
+        SoapySDRKwargs_get(args, pairs[i])));
+    free(key);
+    key = tmp;
+  }
+
+done:
+  if (pairs != NULL)
+    free(pairs);
+
+  return key;
+}
+
+SUPRIVATE struct suscan_source_soapysdr_device *
+suscan_source_soapysdr_device_acquire(const SoapySDRKwargs *args)
+{
+  struct suscan_source_soapysdr_device *dev = NULL, *new = NULL;
+  char *key = NULL;
+  unsigned int i;
+  SUBOOL mutex_acquired = SU_FALSE;
+
+  SU_TRY(key = suscan_source_soapysdr_make_device_key(args));
+
+  SU_TRYZ(pthread_mutex_lock(&g_soapysdr_device_mutex));
+  mutex_acquired = SU_TRUE;
+
+  for (i = 0; i < g_soapysdr_device_count; ++i)
+    if (g_soapysdr_device_list[i] != NULL
+      && strcmp(g_soapysdr_device_list[i]->key, key) == 0) {
+      dev = g_soapysdr_device_list[i];
+      ++dev->refcount;
+      goto done;
+    }
+
+  SU_ALLOCATE(new, struct suscan_source_soapysdr_device);
+
+  if ((new->sdr = SoapySDRDevice_make(args)) == NULL) {
+    SU_ERROR("Failed to open SDR device: %s\n", SoapySDRDevice_lastError());
+    goto done;
+  }
+
+  new->key      = key;
+  new->refcount = 1;
+  key = NULL;
+
+  SU_TRYC(PTR_LIST_APPEND_CHECK(g_soapysdr_device, new));
+
+  dev = new;
+  new = NULL;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&g_soapysdr_device_mutex);
+
+  if (new != NULL) {
+    if (new->sdr != NULL)
+      SoapySDRDevice_unmake(new->sdr);
+    if (new->key != NULL)
+      free(new->key);
+    free(new);
+  }
+
+  if (key != NULL)
+    free(key);
+
+  return dev;
+}
+
+SUPRIVATE void
+suscan_source_soapysdr_device_release(
+  struct suscan_source_soapysdr_device *dev)
+{
+  SUBOOL last;
+
+  (void) pthread_mutex_lock(&g_soapysdr_device_mutex);
+  last = --dev->refcount == 0;
+  if (last)
+    (void) PTR_LIST_REMOVE(g_soapysdr_device, dev);
+  (void) pthread_mutex_unlock(&g_soapysdr_device_mutex);
+
+  if (last) {
+    SoapySDRDevice_unmake(dev->sdr);
+    free(dev->key);
+    free(dev);
+  }
+}
+
 SUPRIVATE SoapySDRArgInfo *
 suscan_source_soapysdr_find_setting(
   const struct suscan_source_soapysdr *source,
@@ -115,13 +265,99 @@ done:
     free(ref_string);
 }
 
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_setup_stream(
+  struct suscan_source_soapysdr *self,
+  const char *format,
+  const SoapySDRKwargs *args)
+{
+#if SOAPY_SDR_API_VERSION < 0x00080000
+  if (SoapySDRDevice_setupStream(
+      self->sdr,
+      &self->rx_stream,
+      SOAPY_SDR_RX,
+      format,
+      self->chan_array,
+      1,
+      args) != 0)
+    self->rx_stream = NULL;
+#else
+  self->rx_stream = SoapySDRDevice_setupStream(
+      self->sdr,
+      SOAPY_SDR_RX,
+      format,
+      self->chan_array,
+      1,
+      args);
+#endif
+
+  return self->rx_stream != NULL;
+}
+
+/*
+ * Devices with integer ADCs are read in their native format (if it is one
+ * we know how to convert), which halves (or quarters) the amount of memory
+ * the driver has to move around. Conversion to float is done by us, in
+ * suscan_source_soapysdr_convert. This can be disabled with the
+ * soapy:format=float device tweak.
+ */
+SUPRIVATE const char *
+suscan_source_soapysdr_choose_format(struct suscan_source_soapysdr *self)
+{
+  const char *setting;
+  char *native = NULL;
+  double full_scale = 0;
+  const char *format = SUSCAN_SOAPY_SAMPFMT;
+
+  self->format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT;
+  self->scale  = 1;
+
+  setting = SoapySDRKwargs_get(self->sdr_args, SUSCAN_SOAPY_FORMAT_SETTING);
+  if (setting != NULL && strcmp(setting, "native") != 0) {
+    if (strcmp(setting, "float") != 0)
+      SU_WARNING("Unknown stream format `%s', using float\n", setting);
+    return format;
+  }
+
+  native = SoapySDRDevice_getNativeStreamFormat(
+    self->sdr,
+    SOAPY_SDR_RX,
+    self->chan_array[0],
+    &full_scale);
+
+  if (native == NULL || full_scale <= 0)
+    goto done;
+
+  if (strcmp(native, SOAPY_SDR_CS16) == 0) {
+    self->format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16;
+    format       = SOAPY_SDR_CS16;
+  } else if (strcmp(native, SOAPY_SDR_CS8) == 0) {
+    self->format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8;
+    format       = SOAPY_SDR_CS8;
+  }
+
+  if (self->format != SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT) {
+    self->scale = 1. / full_scale;
+    SU_INFO(
+      "Reading samples in native format %s (full scale: %g)\n",
+      format,
+      full_scale);
+  }
+
+done:
+  if (native != NULL)
+    free(native);
+
+  return format;
+}
+
 SUPRIVATE SUBOOL
 suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
 {
   suscan_source_config_t *config = self->config;
   unsigned int i;
   char *antenna = NULL;
-  const char *key, *desc, *val;
+  const char *key, *desc, *val, *format;
   strmap_t *all_params = NULL;
   SoapySDRArgInfo *arg;
   SUBOOL ok = SU_FALSE;
@@ -129,10 +365,8 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   SU_TRY(all_params = suscan_device_spec_get_all(config->device_spec));
   SU_TRY(self->sdr_args = strmap_to_SoapySDRKwargs(all_params));
 
-  if ((self->sdr = SoapySDRDevice_make(self->sdr_args)) == NULL) {
-    SU_ERROR("Failed to open SDR device: %s\n", SoapySDRDevice_lastError());
-    goto done;
-  }
+  SU_TRY(self->device = suscan_source_soapysdr_device_acquire(self->sdr_args));
+  self->sdr = self->device->sdr;
 
   if (self->config->antenna != NULL)
     if (SoapySDRDevice_setAntenna(
@@ -274,24 +508,23 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
     }
   }
 
-#if SOAPY_SDR_API_VERSION < 0x00080000
-  if (SoapySDRDevice_setupStream(
-      self->sdr,
-      &self->rx_stream,
-      SOAPY_SDR_RX,
+  format = suscan_source_soapysdr_choose_format(self);
+
+  if (!suscan_source_soapysdr_setup_stream(self, format, &stream_args_to_set)
+    && self->format != SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT) {
+    SU_WARNING(
+      "Cannot open stream in native format (%s), falling back to float\n",
+      SoapySDRDevice_lastError());
+    self->format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT;
+    self->scale  = 1;
+    (void) suscan_source_soapysdr_setup_stream(
+      self,
       SUSCAN_SOAPY_SAMPFMT,
-      self->chan_array,
-      1,
-      &stream_args_to_set) != 0) {
-#else
-  if ((self->rx_stream = SoapySDRDevice_setupStream(
-      self->sdr,
-      SOAPY_SDR_RX,
-      SUSCAN_SOAPY_SAMPFMT,
-      self->chan_array,
-      1,
-      &stream_args_to_set)) == NULL) {
-#endif
+      &stream_args_to_set);
+  }
+
+  if (self->rx_stream == NULL) {
+    SoapySDRKwargs_clear(&stream_args_to_set);
     SU_ERROR(
         "Failed to open RX stream on SDR device: %s\n",
         SoapySDRDevice_lastError());
@@ -355,7 +588,9 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
       key = self->sdr_args->keys[i] + SUSCAN_SOAPY_SETTING_PFXLEN;
       val = self->sdr_args->vals[i];
 
-      if (strcmp(key, "clock") == 0) {
+      if (strcmp(key, "format") == 0) {
+        /* Already handled when the stream was set up */
+      } else if (strcmp(key, "clock") == 0) {
         if (SoapySDRDevice_setClockSource(self->sdr, val) != 0) {
           SU_ERROR(
             "Cannot set clock source to %s: %s\n",
@@ -371,6 +606,15 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   }
 
   self->mtu = SoapySDRDevice_getStreamMTU(self->sdr, self->rx_stream);
+
+  if (self->format != SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT) {
+    self->raw_size = SU_MAX(self->mtu, SUSCAN_SOAPY_RAW_BUFFER_SIZE);
+    SU_ALLOCATE_MANY(
+      self->raw_buf,
+      2 * self->raw_size * 
+        (self->format == SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16 ? 2 : 1),
+      uint8_t);
+  }
   self->samp_rate = SoapySDRDevice_getSampleRate(self->sdr, SOAPY_SDR_RX, config->channel);
 
   if ((antenna = SoapySDRDevice_getAntenna(
@@ -414,8 +658,11 @@ suscan_source_soapysdr_close(void *ptr)
     self->sdr_args = NULL;
   }
 
-  if (self->sdr != NULL)
-    SoapySDRDevice_unmake(self->sdr);
+  if (self->device != NULL)
+    suscan_source_soapysdr_device_release(self->device);
+
+  if (self->raw_buf != NULL)
+    free(self->raw_buf);
 
   free(self);
 }
@@ -561,6 +808,7 @@ suscan_source_soapysdr_open(
   SU_ALLOCATE_FAIL(new, struct suscan_source_soapysdr);
 
   new->config = config;
+  new->source = source;
 
   SU_TRY_FAIL(suscan_source_soapysdr_init_sdr(new));
 
@@ -594,6 +842,86 @@ suscan_source_soapysdr_start(void *userdata)
   return SU_TRUE;
 }
 
+SUINLINE long long
+suscan_source_soapysdr_samples_to_ns(
+  const struct suscan_source_soapysdr *self,
+  SUSCOUNT samples)
+{
+  return (long long) (1e9 * (SUDOUBLE) samples / self->samp_rate);
+}
+
+/*
+ * Hardware time bookkeeping. If the device timestamps its reads, every
+ * timestamp is compared against the one we would expect from the samples
+ * read so far. Any difference is a gap in the sample stream (usually,
+ * after an overflow), which is accounted as lost samples.
+ */
+SUPRIVATE void
+suscan_source_soapysdr_update_time(
+  struct suscan_source_soapysdr *self,
+  int flags,
+  long long timeNs,
+  SUSCOUNT got)
+{
+  struct timeval tv;
+  long long expected, gap;
+  SUSCOUNT lost;
+
+  if (flags & SOAPY_SDR_HAS_TIME) {
+    if (!self->have_hw_time) {
+      /* First timestamp: anchor hardware time to host time */
+      gettimeofday(&tv, NULL);
+      self->hw_time_offset = 
+        (tv.tv_sec * 1000000000ll + tv.tv_usec * 1000ll)
+        - (timeNs + suscan_source_soapysdr_samples_to_ns(self, got));
+      self->have_hw_time = SU_TRUE;
+      suscan_source_set_hw_timestamps(self->source, SU_TRUE);
+    } else {
+      expected = self->hw_time_ns 
+        + suscan_source_soapysdr_samples_to_ns(self, self->hw_time_samples);
+      gap = timeNs - expected;
+
+      lost = (SUSCOUNT) ((SUDOUBLE) gap * self->samp_rate * 1e-9 + .5);
+      if (gap > 0 && lost > 0) {
+        SU_WARNING(
+          "Stream discontinuity: %lld samples lost\n",
+          (long long) lost);
+        suscan_source_report_lost_samples(self->source, lost);
+      }
+    }
+
+    self->hw_time_ns      = timeNs;
+    self->hw_time_samples = got;
+  } else {
+    self->hw_time_samples += got;
+  }
+}
+
+/*
+ * Integer to float conversion. Loops are kept branchless and with
+ * restrict-qualified pointers, so that the compiler can vectorize them.
+ */
+SUPRIVATE void
+suscan_source_soapysdr_convert(
+  const struct suscan_source_soapysdr *self,
+  SUCOMPLEX *__restrict out,
+  SUSCOUNT len)
+{
+  SUFLOAT *__restrict re = (SUFLOAT *) out;
+  SUFLOAT scale = self->scale;
+  SUSCOUNT i;
+
+  if (self->format == SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16) {
+    const int16_t *__restrict in = (const int16_t *) self->raw_buf;
+    for (i = 0; i < 2 * len; ++i)
+      re[i] = scale * in[i];
+  } else {
+    const int8_t *__restrict in = (const int8_t *) self->raw_buf;
+    for (i = 0; i < 2 * len; ++i)
+      re[i] = scale * in[i];
+  }
+}
+
 SUPRIVATE SUSDIFF
 suscan_source_soapysdr_read(
   void *userdata,
@@ -601,29 +929,41 @@ suscan_source_soapysdr_read(
   SUSCOUNT max)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  void *target = buf;
   int result;
   int flags = 0;
   long long timeNs = 0;
   SUBOOL retry;
 
+  if (self->format != SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT) {
+    target = self->raw_buf;
+    if (max > self->raw_size)
+      max = self->raw_size;
+  }
+
   do {
     retry = SU_FALSE;
+    flags = 0;
     if (self->force_eos)
       result = 0;
     else
       result = SoapySDRDevice_readStream(
           self->sdr,
           self->rx_stream,
-          (void * const*) &buf,
+          (void * const*) &target,
           max,
           &flags,
           &timeNs,
           SUSCAN_SOURCE_DEFAULT_READ_TIMEOUT); /* Setting this to 0 caused extreme CPU usage in MacOS */
 
-    if (result == SOAPY_SDR_TIMEOUT
-        || result == SOAPY_SDR_OVERFLOW
-        || result == SOAPY_SDR_UNDERFLOW) {
-      /* We should use this statuses as quality indicators */
+    if (result == SOAPY_SDR_OVERFLOW) {
+      /* 
+       * Samples were dropped by the driver. With hardware timestamps,
+       * the size of the gap is measured in the next read.
+       */
+      suscan_source_report_overflow(self->source);
+      retry = SU_TRUE;
+    } else if (result == SOAPY_SDR_TIMEOUT || result == SOAPY_SDR_UNDERFLOW) {
       retry = SU_TRUE;
     }
   } while (retry);
@@ -636,13 +976,55 @@ suscan_source_soapysdr_read(
     return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
   }
 
+  if (result > 0) {
+    if (self->format != SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT)
+      suscan_source_soapysdr_convert(self, buf, result);
+
+    suscan_source_soapysdr_update_time(self, flags, timeNs, result);
+  }
+
   return result;
 }
 
 SUPRIVATE void
 suscan_source_soapysdr_get_time(void *userdata, struct timeval *tv)
 {
-  gettimeofday(tv, NULL);
+  struct suscan_source_soapysdr *self = 
+    (struct suscan_source_soapysdr *) userdata;
+  long long ns;
+
+  if (!self->have_hw_time) {
+    gettimeofday(tv, NULL);
+    return;
+  }
+
+  /* Time of the next sample to be read, according to the hardware */
+  ns = self->hw_time_offset 
+    + self->hw_time_ns
+    + suscan_source_soapysdr_samples_to_ns(self, self->hw_time_samples);
+
+  tv->tv_sec  = ns / 1000000000ll;
+  tv->tv_usec = (ns % 1000000000ll) / 1000;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_get_hw_time(
+  void *userdata,
+  const void **clock,
+  long long *ns)
+{
+  struct suscan_source_soapysdr *self = 
+    (struct suscan_source_soapysdr *) userdata;
+
+  if (!self->have_hw_time)
+    return SU_FALSE;
+
+  /* Streams of the same device share its clock */
+  *clock = self->device;
+  *ns    = self->hw_time_ns
+    + suscan_source_soapysdr_samples_to_ns(self, self->hw_time_samples);
+
+  return SU_TRUE;
 }
 
 
@@ -850,6 +1232,7 @@ SUPRIVATE struct suscan_source_interface g_soapysdr_source =
   .set_dc_remove   = suscan_source_soapysdr_set_dc_remove,
   .set_agc         = suscan_source_soapysdr_set_agc,
   .get_time        = suscan_source_soapysdr_get_time,
+  .get_hw_time     = suscan_source_soapysdr_get_hw_time,
   .get_freq_limits = suscan_source_soapysdr_get_freq_limits,
 
   /* Unset members */
@@ -30,13 +30,22 @@
 
 struct suscan_source_config;
 struct suscan_source;
+struct suscan_source_soapysdr_device;
+
+/* Wire format of the RX stream */
+enum suscan_source_soapysdr_format {
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_FLOAT, /* SUCOMPLEX, no conversion needed */
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16,
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8
+};
 
 struct suscan_source_soapysdr {
   struct suscan_source_config *config;
   struct suscan_source        *source;
 
   SoapySDRKwargs  *sdr_args;
-  SoapySDRDevice  *sdr;
+  SoapySDRDevice  *sdr;       /* Owned by device, which may be shared */
+  struct suscan_source_soapysdr_device *device;
   SoapySDRStream  *rx_stream;
   SoapySDRArgInfo *settings;
   size_t           settings_count;
@@ -49,9 +58,21 @@ struct suscan_source_soapysdr {
   SUFLOAT samp_rate; /* Actual sample rate */
   size_t mtu;
 
+  /* Native sample format */
+  enum suscan_source_soapysdr_format format;
+  SUFLOAT  scale;       /* 1 / full scale */
+  void    *raw_buf;
+  SUSCOUNT raw_size;    /* In samples */
+
   /* To prevent source from looping forever */
   SUBOOL force_eos;
   SUBOOL have_dc;
+
+  /* Hardware time bookkeeping */
+  SUBOOL    have_hw_time;
+  long long hw_time_ns;      /* Timestamp of the last timestamped read */
+  SUSCOUNT  hw_time_samples; /* Samples read since that timestamp */
+  long long hw_time_offset;  /* From hardware time to host time (ns) */
 };
 
 #endif /* _SOURCES_IMPL_SOAPYSDR_H */
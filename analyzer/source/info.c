@@ -168,6 +168,10 @@ SUSCAN_SERIALIZER_PROTO(suscan_source_info)
   for (i = 0; i < self->antenna_count; ++i)
     SUSCAN_PACK(str, self->antenna_list[i]);
 
+  SUSCAN_PACK(bool, self->hw_timestamps);
+  SUSCAN_PACK(uint, self->overflow_count);
+  SUSCAN_PACK(uint, self->lost_samples);
+
   SUSCAN_PACK_BOILERPLATE_END;
 }
 
@@ -272,6 +276,10 @@ SUSCAN_DESERIALIZER_PROTO(suscan_source_info)
     self->antenna_list = NULL;
   }
 
+  SUSCAN_UNPACK(bool,   self->hw_timestamps);
+  SUSCAN_UNPACK(uint64, self->overflow_count);
+  SUSCAN_UNPACK(uint64, self->lost_samples);
+
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
@@ -315,6 +323,10 @@ suscan_source_info_init_copy(
     self->source_end   = origin->source_end;
   }
 
+  self->hw_timestamps  = origin->hw_timestamps;
+  self->overflow_count = origin->overflow_count;
+  self->lost_samples   = origin->lost_samples;
+
   if (origin->antenna != NULL)
     SU_TRYCATCH(self->antenna = strdup(origin->antenna), goto done);
 
@@ -149,6 +149,11 @@ SUSCAN_SERIALIZABLE(suscan_source_info) {
   struct timeval source_start;
   struct timeval source_end;
 
+  /* Sample loss accounting (real time sources) */
+  SUBOOL   hw_timestamps;  /* Source time is derived from hardware time */
+  SUSCOUNT overflow_count;
+  SUSCOUNT lost_samples;
+
   PTR_LIST(struct suscan_source_gain_info, gain);
   PTR_LIST(char, antenna);
 };
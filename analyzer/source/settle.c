@@ -0,0 +1,299 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "source-settle"
+
+#include <sigutils/sigutils.h>
+#include <analyzer/source/settle.h>
+
+struct suscan_source_settle_stats {
+  SUFLOAT power_mean;
+  SUFLOAT power_tol;
+  SUFLOAT r1_mean;
+  SUFLOAT r1_tol;
+};
+
+struct suscan_source_settle_ctx {
+  suscan_source_t *source;
+  const struct suscan_source_settle_params *params;
+  SUFREQ     lnb;
+  SUFLOAT    samp_rate;
+  SUCOMPLEX *buffer;
+};
+
+SUPRIVATE SUBOOL
+suscan_source_settle_read_block(struct suscan_source_settle_ctx *self)
+{
+  SUSCOUNT p = 0;
+  SUSDIFF got;
+
+  while (p < self->params->block_size) {
+    got = suscan_source_read(
+      self->source,
+      self->buffer + p,
+      self->params->block_size - p);
+
+    if (got <= 0) {
+      SU_ERROR("Source read failed while calibrating (%d)\n", got);
+      return SU_FALSE;
+    }
+
+    p += got;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_settle_skip(struct suscan_source_settle_ctx *self, SUSCOUNT len)
+{
+  SUSCOUNT i, blocks = len / self->params->block_size;
+
+  for (i = 0; i < blocks; ++i)
+    if (!suscan_source_settle_read_block(self))
+      return SU_FALSE;
+
+  return SU_TRUE;
+}
+
+/*
+ * Block features: mean power (in dB) and magnitude of the normalized lag-1
+ * autocorrelation. The latter is sensitive to the spectral shape of the
+ * stale samples and of the PLL transient, even if the power is similar.
+ */
+SUPRIVATE void
+suscan_source_settle_features(
+    const struct suscan_source_settle_ctx *self,
+    SUFLOAT *power,
+    SUFLOAT *r1)
+{
+  const SUCOMPLEX *x = self->buffer;
+  SUSCOUNT i, len = self->params->block_size;
+  SUCOMPLEX acc = 0;
+  SUFLOAT energy = 0;
+
+  for (i = 0; i < len; ++i) {
+    energy += SU_C_REAL(x[i] * SU_C_CONJ(x[i]));
+    if (i > 0)
+      acc += x[i] * SU_C_CONJ(x[i - 1]);
+  }
+
+  *power = SU_POWER_DB_RAW(energy / len + SUFLOAT_THRESHOLD);
+  *r1    = energy > 0 ? SU_C_ABS(acc) / energy : 0;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_settle_reference(
+    struct suscan_source_settle_ctx *self,
+    struct suscan_source_settle_stats *stats)
+{
+  SUFLOAT power, r1;
+  SUFLOAT p_sum = 0, p_sum2 = 0, r_sum = 0, r_sum2 = 0;
+  SUFLOAT p_std, r_std;
+  unsigned int i, n = SUSCAN_SOURCE_SETTLE_REFERENCE_BLOCKS;
+
+  for (i = 0; i < n; ++i) {
+    if (!suscan_source_settle_read_block(self))
+      return SU_FALSE;
+
+    suscan_source_settle_features(self, &power, &r1);
+
+    p_sum  += power;
+    p_sum2 += power * power;
+    r_sum  += r1;
+    r_sum2 += r1 * r1;
+  }
+
+  stats->power_mean = p_sum / n;
+  stats->r1_mean    = r_sum / n;
+
+  p_std = SU_SQRT(SU_MAX(p_sum2 / n - stats->power_mean * stats->power_mean, 0));
+  r_std = SU_SQRT(SU_MAX(r_sum2 / n - stats->r1_mean * stats->r1_mean, 0));
+
+  stats->power_tol = SU_MAX(
+    SUSCAN_SOURCE_SETTLE_SIGMAS * p_std,
+    SUSCAN_SOURCE_SETTLE_MIN_POWER_TOL_DB);
+  stats->r1_tol = SU_MAX(
+    SUSCAN_SOURCE_SETTLE_SIGMAS * r_std,
+    SUSCAN_SOURCE_SETTLE_MIN_R1_TOL);
+
+  return SU_TRUE;
+}
+
+/*
+ * Retune away and back, and return the number of samples before the first
+ * block that is followed by stable_blocks consecutive blocks within the
+ * reference tolerance. Reading stops as soon as such a run is found. If
+ * there is none, we return max_samples.
+ */
+SUPRIVATE SUBOOL
+suscan_source_settle_trial(
+    struct suscan_source_settle_ctx *self,
+    SUFREQ fc,
+    SUFREQ away,
+    const struct suscan_source_settle_stats *stats,
+    SUSCOUNT *samples)
+{
+  SUSCOUNT i, blocks = self->params->max_samples / self->params->block_size;
+  SUSCOUNT run = 0;
+  SUFLOAT power, r1;
+
+  SU_TRYCATCH(
+    suscan_source_set_freq2(self->source, away, self->lnb),
+    return SU_FALSE);
+  if (!suscan_source_settle_skip(self, self->params->max_samples))
+    return SU_FALSE;
+
+  SU_TRYCATCH(
+    suscan_source_set_freq2(self->source, fc, self->lnb),
+    return SU_FALSE);
+
+  for (i = 0; i < blocks; ++i) {
+    if (!suscan_source_settle_read_block(self))
+      return SU_FALSE;
+
+    suscan_source_settle_features(self, &power, &r1);
+
+    if (SU_ABS(power - stats->power_mean) > stats->power_tol
+        || SU_ABS(r1 - stats->r1_mean) > stats->r1_tol)
+      run = 0;
+    else if (++run >= self->params->stable_blocks)
+      break;
+  }
+
+  if (i < blocks)
+    *samples = (i + 1 - run) * self->params->block_size;
+  else
+    *samples = self->params->max_samples;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_settle_band(
+    struct suscan_source_settle_ctx *self,
+    SUFREQ band_min,
+    SUFREQ band_max,
+    SUSCOUNT *samples)
+{
+  struct suscan_source_settle_stats stats;
+  SUFREQ fc = .5 * (band_min + band_max);
+  SUFREQ away;
+  SUSCOUNT trial_samples, worst = 0;
+  unsigned int i;
+
+  /* Tune away by one sample rate, staying within the calibration range */
+  away = fc + self->samp_rate;
+  if (away > self->params->freq_max)
+    away = fc - self->samp_rate;
+
+  SU_TRYCATCH(
+    suscan_source_set_freq2(self->source, fc, self->lnb),
+    return SU_FALSE);
+  if (!suscan_source_settle_skip(self, self->params->max_samples))
+    return SU_FALSE;
+
+  if (!suscan_source_settle_reference(self, &stats))
+    return SU_FALSE;
+
+  for (i = 0; i < self->params->trials; ++i) {
+    if (!suscan_source_settle_trial(self, fc, away, &stats, &trial_samples))
+      return SU_FALSE;
+
+    if (trial_samples > worst)
+      worst = trial_samples;
+  }
+
+  if (worst >= self->params->max_samples)
+    SU_WARNING(
+      "Signal did not settle in band %.0lf-%.0lf Hz after %lld samples\n",
+      band_min,
+      band_max,
+      self->params->max_samples);
+  else
+    worst += self->params->guard_blocks * self->params->block_size;
+
+  *samples = SU_MIN(worst, self->params->max_samples);
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_source_calibrate_settle(
+    suscan_source_t *source,
+    const struct suscan_source_settle_params *params,
+    suscan_source_config_t *config)
+{
+  struct suscan_source_settle_ctx ctx;
+  SUFREQ band_bw, band_min, band_max;
+  SUSCOUNT samples;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&ctx, 0, sizeof(struct suscan_source_settle_ctx));
+
+  SU_TRY(suscan_source_is_capturing(source));
+  SU_TRY(suscan_source_is_real_time(source));
+  SU_TRY(params->freq_max >= params->freq_min);
+  SU_TRY(params->bands > 0);
+  SU_TRY(params->trials > 0);
+  SU_TRY(params->block_size > 1);
+  SU_TRY(params->stable_blocks > 0);
+  SU_TRY(params->max_samples >= params->block_size);
+
+  ctx.source    = source;
+  ctx.params    = params;
+  ctx.lnb       = suscan_source_config_get_lnb_freq(
+    suscan_source_get_config(source));
+  ctx.samp_rate = suscan_source_get_samp_rate(source);
+
+  SU_ALLOCATE_MANY(ctx.buffer, params->block_size, SUCOMPLEX);
+
+  band_bw = (params->freq_max - params->freq_min) / params->bands;
+
+  for (i = 0; i < params->bands; ++i) {
+    band_min = params->freq_min + i * band_bw;
+    band_max = band_min + band_bw;
+
+    SU_TRY(suscan_source_settle_band(&ctx, band_min, band_max, &samples));
+
+    SU_INFO(
+      "Band %.0lf-%.0lf Hz: %lld samples to settle\n",
+      band_min,
+      band_max,
+      samples);
+
+    /* Settle bands are saved in tuner frequencies */
+    SU_TRY(
+      suscan_source_config_set_settle_samples(
+        config,
+        band_min - ctx.lnb,
+        band_max - ctx.lnb,
+        samples,
+        ctx.samp_rate));
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (ctx.buffer != NULL)
+    free(ctx.buffer);
+
+  return ok;
+}
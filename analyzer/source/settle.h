@@ -0,0 +1,85 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_SOURCE_SETTLE_H
+#define _ANALYZER_SOURCE_SETTLE_H
+
+#include <analyzer/source.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_BANDS         8
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_TRIALS        5
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_BLOCK_SIZE    1024
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_MAX_SAMPLES   1048576
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_GUARD_BLOCKS  1
+#define SUSCAN_SOURCE_SETTLE_DEFAULT_STABLE_BLOCKS 8
+#define SUSCAN_SOURCE_SETTLE_REFERENCE_BLOCKS      32
+#define SUSCAN_SOURCE_SETTLE_MIN_POWER_TOL_DB      1.
+#define SUSCAN_SOURCE_SETTLE_MIN_R1_TOL            .05
+#define SUSCAN_SOURCE_SETTLE_SIGMAS                3
+
+/*
+ * Retune settle calibration. The frequency range [freq_min, freq_max] is
+ * split in a number of bands. In every band, we measure the statistics
+ * (block power and lag-1 autocorrelation) of the settled signal at the
+ * center of the band. Then, we retune away and back several times, and
+ * look for the first block that is followed by stable_blocks consecutive
+ * blocks within the tolerance of the settled signal. The worst case of all trials (plus a
+ * few guard blocks) is saved in the source configuration, and used by the
+ * wide spectrum worker to decide how many samples to discard after hops.
+ */
+struct suscan_source_settle_params {
+  SUFREQ       freq_min;     /* RF frequency, LNB is taken into account */
+  SUFREQ       freq_max;
+  unsigned int bands;
+  unsigned int trials;
+  SUSCOUNT     block_size;
+  SUSCOUNT     max_samples;
+  unsigned int guard_blocks;
+  unsigned int stable_blocks;
+};
+
+#define suscan_source_settle_params_INITIALIZER {                       \
+  0,                                          /* freq_min */            \
+  0,                                          /* freq_max */            \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_BANDS,         /* bands */               \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_TRIALS,        /* trials */              \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_BLOCK_SIZE,    /* block_size */          \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_MAX_SAMPLES,   /* max_samples */         \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_GUARD_BLOCKS,  /* guard_blocks */        \
+  SUSCAN_SOURCE_SETTLE_DEFAULT_STABLE_BLOCKS, /* stable_blocks */       \
+}
+
+/*
+ * Runs the calibration on a capturing, real time source and stores
+ * the result in config (usually, the profile the source was opened with).
+ */
+SUBOOL suscan_source_calibrate_settle(
+    suscan_source_t *source,
+    const struct suscan_source_settle_params *params,
+    suscan_source_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_SOURCE_SETTLE_H */
@@ -147,36 +147,47 @@ fail:
 }
 
 
-SUSCOUNT
+/*
+ * Sources with a preprocessing routine process the input in chunks of
+ * buffer_size samples. The preprocessing routine reads directly from the
+ * caller's buffer, so there is no intermediate copy.
+ */
+SUSDIFF
 suscan_spectsrc_feed(
     suscan_spectsrc_t *self,
     const SUCOMPLEX *data,
     SUSCOUNT size)
 {
-  if (self->classptr->preproc != NULL) {
-    /* Spectrum source has a preprocessing routine. Apply data to it */
-    if (size > self->buffer_size)
-      size = self->buffer_size;
+  SUSCOUNT chunk, fed = 0;
+
+  if (self->classptr->preproc == NULL) {
+    SU_TRYCATCH(
+        su_smoothpsd_feed(self->smooth_psd, data, size),
+        return -1);
+
+    return size;
+  }
+
+  while (fed < size) {
+    chunk = SU_MIN(size - fed, self->buffer_size);
 
-    memcpy(self->buffer, data, size * sizeof(SUCOMPLEX));
     SU_TRYCATCH(
         (self->classptr->preproc) (
             self,
             self->privdata,
             self->buffer,
-            size),
-        return SU_FALSE);
-
-    SU_TRYCATCH(
-        su_smoothpsd_feed(self->smooth_psd, self->buffer, size),
+            data + fed,
+            chunk),
         return -1);
-  } else {
+
     SU_TRYCATCH(
-        su_smoothpsd_feed(self->smooth_psd, data, size),
+        su_smoothpsd_feed(self->smooth_psd, self->buffer, chunk),
         return -1);
+
+    fed += chunk;
   }
 
-  return size;
+  return fed;
 }
 
 void
@@ -194,6 +205,365 @@ suscan_spectsrc_destroy(suscan_spectsrc_t *self)
   free(self);
 }
 
+/*************************** Spectrum source bank ****************************/
+SUPRIVATE void
+suscan_spectsrc_view_finalize(struct suscan_spectsrc_view *view)
+{
+  if (view->src != NULL)
+    suscan_spectsrc_destroy(view->src);
+
+  if (view->ring != NULL)
+    free(view->ring);
+
+  if (view->psd != NULL)
+    free(view->psd);
+}
+
+/*
+ * Views only need the class and its private state: the bank does the
+ * windowing and the FFT itself, so no smoothpsd is created for them.
+ */
+SUPRIVATE SUBOOL
+suscan_spectsrc_view_init(
+    struct suscan_spectsrc_view *view,
+    const struct suscan_spectsrc_class *classdef,
+    SUSCOUNT size)
+{
+  suscan_spectsrc_t *src = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  memset(view, 0, sizeof(struct suscan_spectsrc_view));
+
+  SU_ALLOCATE(src, suscan_spectsrc_t);
+  view->src = src;
+
+  src->classptr        = classdef;
+  src->buffer_size     = size;
+  src->throttle_factor = 1.;
+
+  SU_TRY(src->privdata = (classdef->ctor) (src));
+
+  SU_ALLOCATE_MANY(view->ring, size, SUCOMPLEX);
+  SU_ALLOCATE_MANY(view->psd,  size, SUFLOAT);
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok)
+    suscan_spectsrc_view_finalize(view);
+
+  return ok;
+}
+
+SUPRIVATE void
+suscan_spectsrc_bank_update_timing(suscan_spectsrc_bank_t *self)
+{
+  SUFLOAT interval =
+    self->samp_rate * self->throttle_factor / self->refresh_rate;
+
+  self->interval = SU_MAX(SU_FLOOR(interval), 1);
+  self->hop      = SU_MIN(self->interval, self->size);
+}
+
+void
+suscan_spectsrc_bank_set_throttle_factor(
+    suscan_spectsrc_bank_t *self,
+    SUFLOAT throttle_factor)
+{
+  if (!sufeq(throttle_factor, self->throttle_factor, 1e-6)) {
+    self->throttle_factor = throttle_factor;
+    suscan_spectsrc_bank_update_timing(self);
+
+    if (self->since_fft >= self->hop)
+      self->since_fft = 0;
+
+    if (self->since_update >= self->interval)
+      self->since_update = 0;
+  }
+}
+
+void
+suscan_spectsrc_bank_destroy(suscan_spectsrc_bank_t *self)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->view_count; ++i)
+    suscan_spectsrc_view_finalize(self->view_list + i);
+
+  if (self->fft_plan != NULL)
+    suscan_fft_plan_release(self->fft_plan);
+
+  if (self->fft_buf != NULL)
+    SU_FFTW(_free) (self->fft_buf);
+
+  if (self->window != NULL)
+    suscan_fft_window_release(self->window);
+
+  free(self);
+}
+
+suscan_spectsrc_bank_t *
+suscan_spectsrc_bank_new(
+    SUFLOAT  samp_rate,
+    SUFLOAT  spectrum_rate,
+    SUSCOUNT size,
+    enum sigutils_channel_detector_window window_type,
+    SUBOOL (*on_spectrum) (
+        void *userdata,
+        unsigned int view,
+        const SUFLOAT *data,
+        SUSCOUNT size),
+    void *userdata)
+{
+  suscan_spectsrc_bank_t *new = NULL;
+
+  SU_TRYCATCH(samp_rate > 0, goto fail);
+  SU_TRYCATCH(spectrum_rate > 0, goto fail);
+  SU_TRYCATCH(size > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_spectsrc_bank_t);
+
+  new->samp_rate       = samp_rate;
+  new->refresh_rate    = spectrum_rate;
+  new->throttle_factor = 1.;
+  new->size            = size;
+  new->on_spectrum     = on_spectrum;
+  new->userdata        = userdata;
+
+  suscan_spectsrc_bank_update_timing(new);
+
+  SU_TRY_FAIL(new->window = suscan_fft_window_acquire(window_type, size));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_spectsrc_bank_destroy(new);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_spectsrc_bank_add_view(
+    suscan_spectsrc_bank_t *self,
+    const struct suscan_spectsrc_class *classdef)
+{
+  SU_TRYCATCH(
+      self->view_count < SUSCAN_SPECTSRC_BANK_MAX_VIEWS,
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_spectsrc_view_init(
+          self->view_list + self->view_count,
+          classdef,
+          self->size),
+      return SU_FALSE);
+
+  ++self->view_count;
+
+  return SU_TRUE;
+}
+
+/*
+ * The FFT plan transforms all active views in a single call. Changing
+ * the mask requires the plan for the new number of views, which is
+ * usually cached already.
+ */
+SUBOOL
+suscan_spectsrc_bank_set_mask(suscan_spectsrc_bank_t *self, uint32_t mask)
+{
+  struct suscan_spectsrc_view *view;
+  SUCOMPLEX *fft_buf = NULL;
+  suscan_fft_plan_t *fft_plan = NULL;
+  unsigned int i, count = 0;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->view_count < SUSCAN_SPECTSRC_BANK_MAX_VIEWS
+      && (mask >> self->view_count) != 0) {
+    SU_ERROR("Spectrum view mask 0x%x out of range\n", mask);
+    goto done;
+  }
+
+  for (i = 0; i < self->view_count; ++i)
+    if (mask & (1u << i))
+      ++count;
+
+  if (count > 0) {
+    SU_TRY(
+        fft_buf = SU_FFTW(_malloc) (
+            count * self->size * sizeof(SUCOMPLEX)));
+
+    SU_TRY(
+        fft_plan = suscan_fft_plan_acquire(self->size, count, FFTW_FORWARD));
+  }
+
+  if (self->fft_plan != NULL)
+    suscan_fft_plan_release(self->fft_plan);
+
+  if (self->fft_buf != NULL)
+    SU_FFTW(_free) (self->fft_buf);
+
+  self->fft_plan = fft_plan;
+  self->fft_buf  = fft_buf;
+  fft_plan = NULL;
+  fft_buf  = NULL;
+
+  /* Views that were just enabled start from scratch */
+  self->active_count = 0;
+  for (i = 0; i < self->view_count; ++i) {
+    if (mask & (1u << i)) {
+      view = self->view_list + i;
+
+      if (!(self->mask & (1u << i)))
+        memset(view->ring, 0, self->size * sizeof(SUCOMPLEX));
+
+      memset(view->psd, 0, self->size * sizeof(SUFLOAT));
+      self->active_list[self->active_count++] = i;
+    }
+  }
+
+  self->mask         = mask;
+  self->fft_count    = 0;
+  self->since_update = 0;
+
+  ok = SU_TRUE;
+
+done:
+  if (fft_plan != NULL)
+    suscan_fft_plan_release(fft_plan);
+
+  if (fft_buf != NULL)
+    SU_FFTW(_free) (fft_buf);
+
+  return ok;
+}
+
+SUPRIVATE void
+suscan_spectsrc_bank_run_fft(suscan_spectsrc_bank_t *self)
+{
+  struct suscan_spectsrc_view *view;
+  const SUFLOAT *w = self->window;
+  SUCOMPLEX *frame;
+  SUSCOUNT size = self->size;
+  SUSCOUNT head = size - self->p; /* Oldest samples are at p */
+  SUSCOUNT i;
+  unsigned int j;
+
+  for (j = 0; j < self->active_count; ++j) {
+    view  = self->view_list + self->active_list[j];
+    frame = self->fft_buf + j * size;
+
+    for (i = 0; i < head; ++i)
+      frame[i] = view->ring[self->p + i] * w[i];
+
+    for (i = head; i < size; ++i)
+      frame[i] = view->ring[i - head] * w[i];
+  }
+
+  suscan_fft_plan_execute(self->fft_plan, self->fft_buf);
+
+  for (j = 0; j < self->active_count; ++j) {
+    view  = self->view_list + self->active_list[j];
+    frame = self->fft_buf + j * size;
+
+    for (i = 0; i < size; ++i)
+      view->psd[i] += SU_C_REAL(frame[i] * SU_C_CONJ(frame[i]));
+  }
+
+  ++self->fft_count;
+}
+
+SUPRIVATE SUBOOL
+suscan_spectsrc_bank_update(suscan_spectsrc_bank_t *self)
+{
+  struct suscan_spectsrc_view *view;
+  SUFLOAT k = 1. / ((SUFLOAT) self->fft_count * self->size);
+  SUSCOUNT i;
+  unsigned int j;
+
+  for (j = 0; j < self->active_count; ++j) {
+    view = self->view_list + self->active_list[j];
+
+    for (i = 0; i < self->size; ++i)
+      view->psd[i] *= k;
+
+    SU_TRYCATCH(
+        (self->on_spectrum) (
+            self->userdata,
+            self->active_list[j],
+            view->psd,
+            self->size),
+        return SU_FALSE);
+
+    memset(view->psd, 0, self->size * sizeof(SUFLOAT));
+  }
+
+  self->fft_count = 0;
+
+  return SU_TRUE;
+}
+
+/*
+ * Samples are processed in chunks that never cross the end of the ring
+ * nor an FFT boundary. Preprocessing writes straight into the ring of
+ * each view, so the input is read only once per view.
+ */
+SUSDIFF
+suscan_spectsrc_bank_feed(
+    suscan_spectsrc_bank_t *self,
+    const SUCOMPLEX *data,
+    SUSCOUNT size)
+{
+  struct suscan_spectsrc_view *view;
+  SUSCOUNT chunk, fed = 0;
+  unsigned int j;
+
+  if (self->active_count == 0)
+    return size;
+
+  while (fed < size) {
+    chunk = SU_MIN(size - fed, self->size - self->p);
+    chunk = SU_MIN(chunk, self->hop - self->since_fft);
+
+    for (j = 0; j < self->active_count; ++j) {
+      view = self->view_list + self->active_list[j];
+
+      if (view->src->classptr->preproc == NULL)
+        memcpy(view->ring + self->p, data + fed, chunk * sizeof(SUCOMPLEX));
+      else
+        SU_TRYCATCH(
+            (view->src->classptr->preproc) (
+                view->src,
+                view->src->privdata,
+                view->ring + self->p,
+                data + fed,
+                chunk),
+            return -1);
+    }
+
+    self->p += chunk;
+    if (self->p == self->size)
+      self->p = 0;
+
+    self->since_fft    += chunk;
+    self->since_update += chunk;
+    fed                += chunk;
+
+    if (self->since_fft == self->hop) {
+      self->since_fft = 0;
+      suscan_spectsrc_bank_run_fft(self);
+
+      /* Keep the remainder, so that the mean update rate is exact */
+      if (self->since_update >= self->interval) {
+        self->since_update -= self->interval;
+        SU_TRYCATCH(suscan_spectsrc_bank_update(self), return -1);
+      }
+    }
+  }
+
+  return fed;
+}
+
 SUBOOL
 suscan_spectsrcs_initialized(void)
 {
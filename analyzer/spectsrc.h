@@ -23,6 +23,7 @@
 #include <sigutils/sigutils.h>
 #include <sigutils/detect.h>
 #include <sigutils/smoothpsd.h>
+#include <analyzer/fftcache.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,10 +37,17 @@ struct suscan_spectsrc_class {
 
   void * (*ctor) (struct suscan_spectsrc *src);
 
+  /*
+   * Preprocessing is done out of place: it reads size samples from
+   * input and writes the result to output (never longer than the FFT
+   * size). Kernels should avoid loop-carried dependencies, so that the
+   * compiler can vectorize them.
+   */
   SUBOOL (*preproc)  (
       struct suscan_spectsrc *src,
       void *privdata,
-      SUCOMPLEX *buffer,
+      SUCOMPLEX *output,
+      const SUCOMPLEX *input,
       SUSCOUNT size);
 
   void (*dtor) (void *privdata);
@@ -82,13 +90,114 @@ void suscan_spectsrc_set_throttle_factor(
   suscan_spectsrc_t *self,
   SUFLOAT throttle_factor);
 
-SUSCOUNT suscan_spectsrc_feed(
+/* Consumes all data. Returns the number of samples fed, or -1 on error */
+SUSDIFF suscan_spectsrc_feed(
     suscan_spectsrc_t *src,
     const SUCOMPLEX *data,
     SUSCOUNT size);
 
 void suscan_spectsrc_destroy(suscan_spectsrc_t *src);
 
+/*
+ * Spectrum source bank. Evaluates several spectrum sources (views) of the
+ * same sample stream at once. All views share the window, the framing of
+ * the input and a single batched FFT plan, so requesting several views
+ * of the same channel is much cheaper than feeding independent sources.
+ * Windows and plans come from the FFT cache, and are shared with every
+ * other bank of the same size.
+ *
+ * Views are identified by the order in which they were added, and are
+ * enabled through a bitmask. FFTs are computed every hop samples (with
+ * overlap if the refresh rate requires it) and averaged until the next
+ * update. Spectra are delivered in FFT order, one callback per view.
+ */
+#define SUSCAN_SPECTSRC_BANK_MAX_VIEWS 32
+
+struct suscan_spectsrc_view {
+  suscan_spectsrc_t *src;   /* Class, private state and batch size */
+  SUCOMPLEX         *ring;  /* Last size preprocessed samples */
+  SUFLOAT           *psd;   /* Power accumulated since the last update */
+};
+
+struct suscan_spectsrc_bank {
+  SUFLOAT   samp_rate;
+  SUFLOAT   refresh_rate;
+  SUFLOAT   throttle_factor;
+  SUSCOUNT  size;
+  SUSCOUNT  hop;          /* Samples between consecutive FFTs */
+  SUSCOUNT  interval;     /* Samples between consecutive updates */
+  SUSCOUNT  p;            /* Ring write pointer, shared by all views */
+  SUSCOUNT  since_fft;
+  SUSCOUNT  since_update;
+  SUSCOUNT  fft_count;    /* FFTs accumulated since the last update */
+
+  const SUFLOAT *window;  /* Shared, normalized to unit mean power */
+
+  uint32_t     mask;
+  unsigned int active_list[SUSCAN_SPECTSRC_BANK_MAX_VIEWS];
+  unsigned int active_count;
+
+  SUCOMPLEX         *fft_buf;  /* One frame per active view, back to back */
+  suscan_fft_plan_t *fft_plan; /* Shared, batch of active_count FFTs */
+
+  struct suscan_spectsrc_view view_list[SUSCAN_SPECTSRC_BANK_MAX_VIEWS];
+  unsigned int view_count;
+
+  SUBOOL (*on_spectrum) (
+      void *userdata,
+      unsigned int view,
+      const SUFLOAT *data,
+      SUSCOUNT size);
+  void *userdata;
+};
+
+typedef struct suscan_spectsrc_bank suscan_spectsrc_bank_t;
+
+suscan_spectsrc_bank_t *suscan_spectsrc_bank_new(
+    SUFLOAT  samp_rate,
+    SUFLOAT  spectrum_rate,
+    SUSCOUNT size,
+    enum sigutils_channel_detector_window window_type,
+    SUBOOL (*on_spectrum) (
+        void *userdata,
+        unsigned int view,
+        const SUFLOAT *data,
+        SUSCOUNT size),
+    void *userdata);
+
+/* Views are created disabled */
+SUBOOL suscan_spectsrc_bank_add_view(
+    suscan_spectsrc_bank_t *self,
+    const struct suscan_spectsrc_class *classdef);
+
+SUBOOL suscan_spectsrc_bank_set_mask(
+    suscan_spectsrc_bank_t *self,
+    uint32_t mask);
+
+SUINLINE uint32_t
+suscan_spectsrc_bank_get_mask(const suscan_spectsrc_bank_t *self)
+{
+  return self->mask;
+}
+
+SUINLINE unsigned int
+suscan_spectsrc_bank_get_view_count(const suscan_spectsrc_bank_t *self)
+{
+  return self->view_count;
+}
+
+void suscan_spectsrc_bank_set_throttle_factor(
+    suscan_spectsrc_bank_t *self,
+    SUFLOAT throttle_factor);
+
+/* Consumes all data. Returns the number of samples fed, or -1 on error */
+SUSDIFF suscan_spectsrc_bank_feed(
+    suscan_spectsrc_bank_t *self,
+    const SUCOMPLEX *data,
+    SUSCOUNT size);
+
+void suscan_spectsrc_bank_destroy(suscan_spectsrc_bank_t *self);
+
 SUBOOL suscan_spectsrc_psd_register(void);
 SUBOOL suscan_spectsrc_cyclo_register(void);
 SUBOOL suscan_spectsrc_fmcyclo_register(void);
@@ -35,21 +35,19 @@ SUBOOL
 suscan_spectsrc_cyclo_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] * SU_C_CONJ(prev);
-    prev = buffer[i];
-    buffer[i] = SU_CYCLO_GAIN * diff;
-  }
+  output[0] = SU_CYCLO_GAIN * input[0] * SU_C_CONJ(*last);
 
-  *last = prev;
+  for (i = 1; i < size; ++i)
+    output[i] = SU_CYCLO_GAIN * input[i] * SU_C_CONJ(input[i - 1]);
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -33,13 +33,19 @@ SUBOOL
 suscan_spectsrc_exp_2_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
+  SUFLOAT k = 1. / src->buffer_size; /* Independent of the batch size */
+  SUCOMPLEX z;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i)
-    buffer[i] = cpow(buffer[i] / (SU_C_ABS(buffer[i]) + 1e-8), 2) / size;
+  for (i = 0; i < size; ++i) {
+    z = input[i] / (SU_C_ABS(input[i]) + SU_ADDSFX(1e-8));
+    z *= z;
+    output[i] = k * z;
+  }
 
   return SU_TRUE;
 }
@@ -40,24 +40,29 @@ SUBOOL
 suscan_spectsrc_fmcyclo_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   struct fmcyclo_ctx *ctx = (struct fmcyclo_ctx *) private;
-  SUCOMPLEX fm_prev = ctx->fm_prev;
-  SUFLOAT   pd_prev = ctx->pd_prev;
-  SUFLOAT   phase_diff;
+  SUFLOAT   pd_last;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    phase_diff = SU_C_ARG(buffer[i] * SU_C_CONJ(fm_prev));
-    fm_prev = buffer[i];
-    buffer[i] = FMCYCLO_GAIN * SU_ABS(phase_diff - pd_prev);
-    pd_prev = phase_diff;
-  }
+  /* First pass: phase differences */
+  output[0] = SU_C_ARG(input[0] * SU_C_CONJ(ctx->fm_prev));
+  for (i = 1; i < size; ++i)
+    output[i] = SU_C_ARG(input[i] * SU_C_CONJ(input[i - 1]));
 
-  ctx->fm_prev = fm_prev;
-  ctx->pd_prev = pd_prev;
+  pd_last = SU_C_REAL(output[size - 1]);
+
+  /* Second pass, backwards: differences of phase differences */
+  for (i = size - 1; i > 0; --i)
+    output[i] = FMCYCLO_GAIN
+      * SU_ABS(SU_C_REAL(output[i]) - SU_C_REAL(output[i - 1]));
+  output[0] = FMCYCLO_GAIN * SU_ABS(SU_C_REAL(output[0]) - ctx->pd_prev);
+
+  ctx->fm_prev = input[size - 1];
+  ctx->pd_prev = pd_last;
 
   return SU_TRUE;
 }
@@ -35,21 +35,19 @@ SUBOOL
 suscan_spectsrc_fmspect_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = SU_C_ARG(buffer[i] * SU_C_CONJ(prev));
-    prev = buffer[i];
-    buffer[i] = FMSPECT_GAIN * diff;
-  }
+  output[0] = FMSPECT_GAIN * SU_C_ARG(input[0] * SU_C_CONJ(*last));
 
-  *last = prev;
+  for (i = 1; i < size; ++i)
+    output[i] = FMSPECT_GAIN * SU_C_ARG(input[i] * SU_C_CONJ(input[i - 1]));
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -35,13 +35,14 @@ SUBOOL
 suscan_spectsrc_pmspect_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   SUSCOUNT i;
 
   for (i = 0; i < size; ++i)
-    buffer[i] = PM_DEMOD_GAIN * SU_C_ARG(buffer[i]);
+    output[i] = PM_DEMOD_GAIN * SU_C_ARG(input[i]);
 
   return SU_TRUE;
 }
@@ -33,21 +33,19 @@ SUBOOL
 suscan_spectsrc_timediff_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff;
-  }
+  output[0] = input[0] - *last;
 
-  *last = prev;
+  for (i = 1; i < size; ++i)
+    output[i] = input[i] - input[i - 1];
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -56,21 +54,23 @@ SUBOOL
 suscan_spectsrc_abstimediff_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    SUCOMPLEX *output,
+    const SUCOMPLEX *input,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
   SUCOMPLEX diff;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff * SU_C_CONJ(diff);
+  diff = input[0] - *last;
+  output[0] = diff * SU_C_CONJ(diff);
+
+  for (i = 1; i < size; ++i) {
+    diff = input[i] - input[i - 1];
+    output[i] = diff * SU_C_CONJ(diff);
   }
 
-  *last = prev;
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
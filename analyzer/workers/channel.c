@@ -220,8 +220,10 @@ suscan_local_analyzer_on_new_freq(
 
 /*********************** Channel opening and closing *************************/
 SUPRIVATE su_specttuner_channel_t *
-suscan_local_analyzer_open_channel_ex(
-    suscan_local_analyzer_t *self,
+suscan_local_analyzer_open_stuner_channel(
+    su_specttuner_t *stuner,
+    pthread_mutex_t *stuner_mutex,
+    SUFLOAT samp_rate,
     const struct sigutils_channel *chan_info,
     SUBOOL precise,
     su_specttuner_channel_data_func_t on_data,
@@ -236,7 +238,7 @@ suscan_local_analyzer_open_channel_ex(
   params.f0 =
       SU_NORM2ANG_FREQ(
           SU_ABS2NORM_FREQ(
-              suscan_analyzer_get_samp_rate(self->parent),
+              samp_rate,
               chan_info->fc - chan_info->ft));
 
   if (params.f0 < 0)
@@ -245,7 +247,7 @@ suscan_local_analyzer_open_channel_ex(
   params.bw =
       SU_NORM2ANG_FREQ(
           SU_ABS2NORM_FREQ(
-              suscan_analyzer_get_samp_rate(self->parent),
+              samp_rate,
               chan_info->f_hi - chan_info->f_lo));
 
   params.guard    = SUSCAN_ANALYZER_GUARD_BAND_PROPORTION;
@@ -255,42 +257,92 @@ suscan_local_analyzer_open_channel_ex(
   params.on_data  = on_data;
   params.on_freq_changed = on_new_freq;
 
-  SU_TRYCATCH(pthread_mutex_lock(&self->stuner_mutex) == 0, goto done);
+  SU_TRYCATCH(pthread_mutex_lock(stuner_mutex) == 0, goto done);
   mutex_acquired = SU_TRUE;
 
   SU_TRYCATCH(
-      channel = su_specttuner_open_channel(self->stuner, &params),
+      channel = su_specttuner_open_channel(stuner, &params),
       goto done);
 
 done:
   if (mutex_acquired)
-    (void) pthread_mutex_unlock(&self->stuner_mutex);
+    (void) pthread_mutex_unlock(stuner_mutex);
 
   return channel;
 }
 
-/* TODO: Move this logic to factory impl */
 SUPRIVATE SUBOOL
-suscan_local_analyzer_close_channel(
-    suscan_local_analyzer_t *self,
+suscan_local_analyzer_close_stuner_channel(
+    su_specttuner_t *stuner,
+    pthread_mutex_t *stuner_mutex,
     su_specttuner_channel_t *channel)
 {
   SUBOOL mutex_acquired = SU_FALSE;
   SUBOOL ok = SU_FALSE;
 
-  SU_TRYCATCH(pthread_mutex_lock(&self->stuner_mutex) == 0, goto done);
+  SU_TRYCATCH(pthread_mutex_lock(stuner_mutex) == 0, goto done);
   mutex_acquired = SU_TRUE;
 
-  ok = su_specttuner_close_channel(self->stuner, channel);
+  ok = su_specttuner_close_channel(stuner, channel);
 
 done:
   if (mutex_acquired)
-    (void) pthread_mutex_unlock(&self->stuner_mutex);
+    (void) pthread_mutex_unlock(stuner_mutex);
 
   return ok;
 }
 
+SUPRIVATE su_specttuner_channel_t *
+suscan_local_analyzer_open_channel_ex(
+    suscan_local_analyzer_t *self,
+    const struct sigutils_channel *chan_info,
+    SUBOOL precise,
+    su_specttuner_channel_data_func_t on_data,
+    su_specttuner_channel_new_freq_func_t on_new_freq,
+    void *privdata)
+{
+  return suscan_local_analyzer_open_stuner_channel(
+    self->stuner,
+    &self->stuner_mutex,
+    suscan_analyzer_get_samp_rate(self->parent),
+    chan_info,
+    precise,
+    on_data,
+    on_new_freq,
+    privdata);
+}
+
+/* TODO: Move this logic to factory impl */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_close_channel(
+    suscan_local_analyzer_t *self,
+    su_specttuner_channel_t *channel)
+{
+  return suscan_local_analyzer_close_stuner_channel(
+    self->stuner,
+    &self->stuner_mutex,
+    channel);
+}
+
 /**************** Implementation of the local inspector factory **************/
+SUPRIVATE void
+suscan_local_inspector_factory_init_samp_info(
+  struct suscan_inspector_sampling_info *samp_info,
+  const su_specttuner_t *stuner,
+  const su_specttuner_channel_t *schan,
+  SUFLOAT samp_rate)
+{
+  samp_info->equiv_fs   = samp_rate / schan->decimation;
+  samp_info->bw_bd      = SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(schan));
+  samp_info->bw         = .5 * schan->decimation * samp_info->bw_bd;
+  samp_info->f0         = SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(schan));
+  samp_info->fft_size   = schan->size;
+  samp_info->fft_bins   = schan->width;
+  samp_info->early_windowing = su_specttuner_uses_early_windowing(stuner);
+
+  samp_info->decimation = schan->decimation;
+}
+
 SUPRIVATE void *
 suscan_local_inspector_factory_ctor(suscan_inspector_factory_t *parent, va_list ap)
 {
@@ -346,16 +398,12 @@ suscan_local_inspector_factory_open(
   /* Prepare output fields */
   *inspclass = classname;
 
-  /* Initialize sampling info */
-  samp_info->equiv_fs   = SU_ASFLOAT(samp_rate) / schan->decimation;
-  samp_info->bw_bd      = SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(schan));
-  samp_info->bw         = .5 * schan->decimation * samp_info->bw_bd;
-  samp_info->f0         = SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(schan));
-  samp_info->fft_size   = schan->size;
-  samp_info->fft_bins   = schan->width;
-  samp_info->early_windowing = su_specttuner_uses_early_windowing(self->stuner);
+  suscan_local_inspector_factory_init_samp_info(
+    samp_info,
+    self->stuner,
+    schan,
+    samp_rate);
 
-  samp_info->decimation = schan->decimation;
   return schan;
 }
 
@@ -536,10 +584,225 @@ static struct suscan_inspector_factory_class g_local_factory = {
   .dtor                = suscan_local_inspector_factory_dtor
 };
 
+
+/********* Implementation of the secondary spectral tuner factory ************/
+/*
+ * Inspector factory of the spectral tuners other than the main one
+ * (auxiliary sources and channelizer shards). Each factory works on a
+ * struct suscan_local_analyzer_tuner, which tells where the tuner, its
+ * mutex, the sample rate and the tuner frequency come from.
+ */
+SUPRIVATE void *
+suscan_local_tuner_inspector_factory_ctor(
+  suscan_inspector_factory_t *parent,
+  va_list ap)
+{
+  struct suscan_local_analyzer_tuner *self;
+
+  self = va_arg(ap, struct suscan_local_analyzer_tuner *);
+
+  suscan_inspector_factory_set_mq_out(parent, self->owner->parent->mq_out);
+  suscan_inspector_factory_set_mq_ctl(parent, &self->owner->mq_in);
+
+  return self;
+}
+
+SUPRIVATE void
+suscan_local_tuner_inspector_factory_get_time(
+  void *userdata,
+  struct timeval *tv)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+
+  suscan_source_get_time(self->source, tv);
+}
+
+SUPRIVATE void *
+suscan_local_tuner_inspector_factory_open(
+  void *userdata, 
+  const char **inspclass, 
+  struct suscan_inspector_sampling_info *samp_info, 
+  va_list ap)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  SUFLOAT samp_rate = (self->get_samp_rate) (self->userdata);
+  const char *classname;
+  const struct sigutils_channel *channel;
+  su_specttuner_channel_t *schan;
+  SUBOOL precise;
+
+  classname = va_arg(ap, const char *);
+  channel   = va_arg(ap, const struct sigutils_channel *);
+  precise   = va_arg(ap, SUBOOL);
+
+  schan = suscan_local_analyzer_open_stuner_channel(
+    self->stuner,
+    self->stuner_mutex,
+    samp_rate,
+    channel,
+    precise,
+    suscan_local_analyzer_on_channel_data,
+    suscan_local_analyzer_on_new_freq,
+    NULL);
+
+  if (schan == NULL) {
+    SU_ERROR(
+      "%s %d: failed to open channel (invalid channel?)\n",
+      self->desc,
+      self->index);
+    return NULL;
+  }
+
+  *inspclass = classname;
+
+  suscan_local_inspector_factory_init_samp_info(
+    samp_info,
+    self->stuner,
+    schan,
+    samp_rate);
+
+  return schan;
+}
+
+SUPRIVATE void
+suscan_local_tuner_inspector_factory_close(
+  void *userdata, 
+  void *insp_self)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_self;
+  suscan_inspector_t *insp      = (suscan_inspector_t *) chan->params.privdata;
+
+  if (insp != NULL)
+    SU_DEREF(insp, specttuner);
+
+  if (!suscan_local_analyzer_close_stuner_channel(
+    self->stuner,
+    self->stuner_mutex,
+    chan))
+    SU_WARNING("Failed to close channel!\n");
+}
+
+SUPRIVATE SUBOOL
+suscan_local_tuner_inspector_factory_set_bandwidth(
+  void *userdata, 
+  void *insp_userdata, 
+  SUFLOAT bandwidth)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  SUFLOAT relbw;
+
+  relbw = SU_NORM2ANG_FREQ(
+    SU_ABS2NORM_FREQ((self->get_samp_rate) (self->userdata), bandwidth));
+
+  (void) su_specttuner_set_channel_bandwidth(self->stuner, chan, relbw);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUFLOAT
+suscan_local_tuner_inspector_factory_get_bandwidth(
+  void *userdata, 
+  void *insp_userdata)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+
+  return SU_NORM2ABS_FREQ(
+    (self->get_samp_rate) (self->userdata),
+    SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(chan)));
+}
+
+SUPRIVATE SUBOOL
+suscan_local_tuner_inspector_factory_set_frequency(
+  void *userdata, 
+  void *insp_userdata, 
+  SUFREQ frequency)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  SUFLOAT f0;
+
+  f0 = SU_NORM2ANG_FREQ(
+    SU_ABS2NORM_FREQ((self->get_samp_rate) (self->userdata), frequency));
+
+  if (f0 < 0)
+    f0 += 2 * PI;
+
+  (void) su_specttuner_set_channel_freq(self->stuner, chan, f0);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUFREQ
+suscan_local_tuner_inspector_factory_get_abs_freq(
+  void *userdata, 
+  void *insp_userdata)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+
+  return (self->get_freq) (self->userdata) + SU_NORM2ABS_FREQ(
+      (self->get_samp_rate) (self->userdata),
+      SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(chan)));
+}
+
+SUPRIVATE SUBOOL
+suscan_local_tuner_inspector_factory_set_freq_correction(
+  void *userdata, 
+  void *insp_userdata,
+  SUFLOAT delta)
+{
+  struct suscan_local_analyzer_tuner *self =
+    (struct suscan_local_analyzer_tuner *) userdata;
+  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  SUFLOAT domega;
+
+  domega = SU_NORM2ANG_FREQ(
+    SU_ABS2NORM_FREQ((self->get_samp_rate) (self->userdata), delta));
+  
+  su_specttuner_set_channel_delta_f(self->stuner, chan, domega);
+
+  return SU_TRUE;
+}
+
+static struct suscan_inspector_factory_class g_local_tuner_factory = {
+  .name                = "local-analyzer-tuner",
+  .ctor                = suscan_local_tuner_inspector_factory_ctor,
+  .get_time            = suscan_local_tuner_inspector_factory_get_time,
+  .open                = suscan_local_tuner_inspector_factory_open,
+  .bind                = suscan_local_inspector_factory_bind,
+  .close               = suscan_local_tuner_inspector_factory_close,
+  .free_buf            = suscan_local_inspector_factory_free_buf,
+  .set_bandwidth       = suscan_local_tuner_inspector_factory_set_bandwidth,
+  .get_bandwidth       = suscan_local_tuner_inspector_factory_get_bandwidth,
+  .set_frequency       = suscan_local_tuner_inspector_factory_set_frequency,
+  .set_domain          = suscan_local_inspector_factory_set_domain,
+  .get_abs_freq        = suscan_local_tuner_inspector_factory_get_abs_freq,
+  .set_freq_correction = suscan_local_tuner_inspector_factory_set_freq_correction,
+  .dtor                = suscan_local_inspector_factory_dtor
+};
+
 SUBOOL
 suscan_local_analyzer_register_factory(void)
 {
-  return suscan_inspector_factory_class_register(&g_local_factory);
+  SU_TRYCATCH(
+    suscan_inspector_factory_class_register(&g_local_factory),
+    return SU_FALSE);
+
+  SU_TRYCATCH(
+    suscan_inspector_factory_class_register(&g_local_tuner_factory),
+    return SU_FALSE);
+
+  return SU_TRUE;
 }
 
 /******************** Source worker for channel mode *************************/
@@ -547,10 +810,15 @@ SUINLINE SUBOOL
 suscan_local_analyzer_parse_seek_overridable(suscan_local_analyzer_t *self)
 {
   SUSCOUNT pos;
+  unsigned int i;
 
   if (self->seek_req) {
     pos = self->seek_req_value;
     suscan_source_seek(self->source, pos);
+
+    /* Keep auxiliary sources aligned with the main source */
+    for (i = 0; i < self->aux_source_count; ++i)
+      suscan_source_seek(self->aux_source_list[i]->source, pos);
     self->seek_req = self->seek_req_value != pos;
   }
 
@@ -573,45 +841,95 @@ suscan_local_analyzer_parse_overridable(suscan_local_analyzer_t *self)
   return SU_TRUE;
 }
 
+/************************** PSD statistics stage *****************************/
 SUPRIVATE SUBOOL
-suscan_local_analyzer_on_psd(
-    void *userdata,
-    const SUFLOAT *psd,
-    unsigned int size)
+suscan_local_analyzer_send_psd_stats(suscan_local_analyzer_t *self)
 {
-  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_analyzer_psd_stats_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
 
-  SU_TRYCATCH(
-      suscan_analyzer_send_psd_from_smoothpsd(
-        self->parent, 
-        self->smooth_psd,
-        suscan_source_has_looped(self->source),
-        suscan_source_get_current_history_size(self->source)),
-      return SU_FALSE);
+  SU_TRY(msg = suscan_psd_stats_make_msg(self->psd_stats));
 
-  return SU_TRUE;
+  msg->fc        = self->source_info.frequency;
+  msg->samp_rate = self->source_info.source_samp_rate;
+  msg->window    =
+    (self->psd_stats_last - self->psd_stats_start) * 1e-9;
+  suscan_analyzer_get_source_time(self->parent, &msg->timestamp);
+
+  SU_TRY(
+    suscan_mq_write(
+      self->parent->mq_out,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS,
+      msg));
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_psd_stats_msg_destroy(msg);
+
+  return ok;
 }
 
-SUBOOL
-suscan_local_analyzer_init_channel_worker(suscan_local_analyzer_t *self)
+/*
+ * Runs in the PSD worker: picks pending parameter changes, accumulates
+ * the last PSD frame and delivers a statistics frame every update_int
+ * seconds. Statistics are reset every window seconds, or when the FFT
+ * size changes.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_update_psd_stats(
+    suscan_local_analyzer_t *self,
+    const SUFLOAT *psd,
+    unsigned int size)
 {
-  struct sigutils_smoothpsd_params sp_params =
-      sigutils_smoothpsd_params_INITIALIZER;
+  uint64_t now = suscan_gettime_coarse();
+  SUBOOL reset = SU_FALSE;
   SUBOOL ok = SU_FALSE;
 
-  /* Create smooth PSD */
-  sp_params.fft_size     = self->parent->params.detector_params.window_size;
-  sp_params.samp_rate    = self->source_info.effective_samp_rate;
-  sp_params.refresh_rate = 1. / self->interval_psd;
+  if (self->psd_stats_req) {
+    SU_TRY(pthread_mutex_lock(&self->hotconf_mutex) != -1);
+    self->psd_stats_params = self->psd_stats_req_params;
+    self->psd_stats_req = SU_FALSE;
+    pthread_mutex_unlock(&self->hotconf_mutex);
 
-  self->sp_params = sp_params;
+    if (self->psd_stats != NULL) {
+      suscan_psd_stats_destroy(self->psd_stats);
+      self->psd_stats = NULL;
+    }
+  }
 
-  SU_MAKE(
-    self->smooth_psd,
-    su_smoothpsd,
-    &sp_params,
-    suscan_local_analyzer_on_psd,
-    self);
+  if (self->psd_stats_params.update_int <= 0)
+    return SU_TRUE;
+
+  if (self->psd_stats != NULL
+    && suscan_psd_stats_get_size(self->psd_stats) != size) {
+    suscan_psd_stats_destroy(self->psd_stats);
+    self->psd_stats = NULL;
+  }
+
+  if (self->psd_stats == NULL) {
+    SU_MAKE(self->psd_stats, suscan_psd_stats, &self->psd_stats_params, size);
+    self->psd_stats_start = self->psd_stats_last = now;
+  }
+
+  if (self->psd_stats_params.window > 0
+    && (now - self->psd_stats_start) * 1e-9 >= self->psd_stats_params.window)
+    reset = SU_TRUE;
+
+  SU_TRY(suscan_psd_stats_feed(self->psd_stats, psd, size));
+
+  if ((now - self->psd_stats_last) * 1e-9 >= self->psd_stats_params.update_int
+    || reset) {
+    self->psd_stats_last = now;
+    SU_TRY(suscan_local_analyzer_send_psd_stats(self));
+  }
+
+  if (reset) {
+    suscan_psd_stats_reset(self->psd_stats);
+    self->psd_stats_start = now;
+  }
 
   ok = SU_TRUE;
 
@@ -619,29 +937,294 @@ done:
   return ok;
 }
 
-SUBOOL
-suscan_psd_worker_cb(
-  struct suscan_mq *mq_out,
-    void *wk_private,
-    void *cb_private)
+/************************** CFAR signal detector *****************************/
+SUPRIVATE SUBOOL
+suscan_local_analyzer_cfar_open(
+    suscan_local_analyzer_t *self,
+    const struct suscan_cfar_track *track)
 {
-  suscan_local_analyzer_t *self  = (suscan_local_analyzer_t *) wk_private;
-  suscan_sample_buffer_t *buffer = (suscan_sample_buffer_t *)  cb_private;
-  SUCOMPLEX *samples = suscan_sample_buffer_data(buffer);
-  SUSCOUNT size = suscan_sample_buffer_size(buffer);
-
-  if (self->circularity)
-    size >>= 1;
-  
-  SU_TRY(su_smoothpsd_feed(self->smooth_psd, samples, size));
+  struct sigutils_channel channel = track->channel;
+  SUFREQ fc = self->cfar_fc;
 
-done:
-  if (!suscan_sample_buffer_pool_give(self->bufpool, buffer))
-    SU_ERROR("Failed to give buffer!\n");
+  channel.fc   += fc;
+  channel.f_lo += fc;
+  channel.f_hi += fc;
+  channel.ft    = fc;
+
+  SU_TRYCATCH(
+    suscan_analyzer_open_async(
+      self->parent,
+      self->cfar_params.auto_open,
+      &channel,
+      SUSCAN_ANALYZER_CFAR_REQ_ID_BASE
+      | (track->id & ~SUSCAN_ANALYZER_CFAR_REQ_ID_MASK)),
+    return SU_FALSE);
+
+  (void) pthread_mutex_lock(&self->hotconf_mutex);
+  ++self->cfar_opened;
+  (void) pthread_mutex_unlock(&self->hotconf_mutex);
+
+  return SU_TRUE;
+}
+
+/*
+ * Called by the inspector server once a channel requested by the detector
+ * is closed (or failed to open), so the detector can open new ones.
+ */
+void
+suscan_local_analyzer_release_cfar_channel(suscan_local_analyzer_t *self)
+{
+  (void) pthread_mutex_lock(&self->hotconf_mutex);
+  if (self->cfar_opened > 0)
+    --self->cfar_opened;
+  (void) pthread_mutex_unlock(&self->hotconf_mutex);
+}
+
+/*
+ * Runs in the PSD worker, after the PSD statistics: feeds the detector
+ * with the last PSD frame, opens inspectors on newly confirmed channels
+ * and delivers the channel list every interval_channels seconds. Tracks
+ * are relative to the center frequency, so we forget them after retunes.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_update_cfar(
+    suscan_local_analyzer_t *self,
+    const SUFLOAT *psd,
+    unsigned int size)
+{
+  const struct suscan_cfar_track *track;
+  struct sigutils_channel **list;
+  SUFLOAT samp_rate = self->source_info.source_samp_rate;
+  unsigned int i, count, opened;
+  uint64_t now;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->cfar_req) {
+    SU_TRY(pthread_mutex_lock(&self->hotconf_mutex) != -1);
+    suscan_analyzer_cfar_params_finalize(&self->cfar_params);
+    self->cfar_params = self->cfar_req_params;
+    self->cfar_req_params.auto_open = NULL;
+    self->cfar_req = SU_FALSE;
+    pthread_mutex_unlock(&self->hotconf_mutex);
+
+    if (self->cfar != NULL) {
+      suscan_cfar_destroy(self->cfar);
+      self->cfar = NULL;
+    }
+  }
+
+  if (!self->cfar_params.enabled)
+    return SU_TRUE;
+
+  if (self->cfar != NULL
+    && (suscan_cfar_get_size(self->cfar) != size
+    || suscan_cfar_get_samp_rate(self->cfar) != samp_rate)) {
+    suscan_cfar_destroy(self->cfar);
+    self->cfar = NULL;
+  }
+
+  if (self->cfar == NULL) {
+    SU_MAKE(self->cfar, suscan_cfar, &self->cfar_params, size, samp_rate);
+    self->cfar_fc = self->source_info.frequency;
+  }
+
+  if (self->cfar_fc != self->source_info.frequency) {
+    suscan_cfar_reset(self->cfar);
+    self->cfar_fc = self->source_info.frequency;
+  }
+
+  SU_TRY(suscan_cfar_feed(self->cfar, psd, size));
+
+  if (self->cfar_params.auto_open != NULL) {
+    count = suscan_cfar_get_track_count(self->cfar);
+    for (i = 0; i < count; ++i) {
+      (void) pthread_mutex_lock(&self->hotconf_mutex);
+      opened = self->cfar_opened;
+      (void) pthread_mutex_unlock(&self->hotconf_mutex);
+
+      if (opened >= self->cfar_params.max_open)
+        break;
+
+      /* A failed auto-open must not stop PSD delivery */
+      track = suscan_cfar_get_track(self->cfar, i);
+      if (track->fresh && !suscan_local_analyzer_cfar_open(self, track))
+        SU_WARNING(
+          "CFAR: cannot open channel at %g Hz\n",
+          track->channel.fc + self->cfar_fc);
+    }
+  }
+
+  if (self->interval_channels > 0) {
+    now = suscan_gettime_coarse();
+    if ((now - self->last_channels) * 1e-9 >= self->interval_channels) {
+      self->last_channels = now;
+      suscan_cfar_get_channel_list(self->cfar, &list, &count);
+      SU_TRY(suscan_analyzer_send_channels(self->parent, list, count));
+    }
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_on_psd(
+    void *userdata,
+    const SUFLOAT *psd,
+    unsigned int size)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+
+  SU_TRYCATCH(
+      suscan_local_analyzer_update_psd_stats(self, psd, size),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_local_analyzer_update_cfar(self, psd, size),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_analyzer_send_psd_from_smoothpsd_ex(
+        self->parent, 
+        self->smooth_psd,
+        suscan_source_has_looped(self->source),
+        suscan_source_get_current_history_size(self->source),
+        self->psd_dropped,
+        self->psd_decimation),
+      return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_local_analyzer_init_channel_worker(suscan_local_analyzer_t *self)
+{
+  struct sigutils_smoothpsd_params sp_params =
+      sigutils_smoothpsd_params_INITIALIZER;
+  struct suscan_sample_buffer_pool_params bp_params = 
+    suscan_sample_buffer_pool_params_INITIALIZER;
+  SUBOOL ok = SU_FALSE;
+
+  /* Create smooth PSD */
+  sp_params.fft_size     = self->parent->params.detector_params.window_size;
+  sp_params.samp_rate    = self->source_info.effective_samp_rate;
+  sp_params.refresh_rate = 1. / self->interval_psd;
+
+  self->sp_params = sp_params;
+
+  SU_MAKE(
+    self->smooth_psd,
+    su_smoothpsd,
+    &sp_params,
+    suscan_local_analyzer_on_psd,
+    self);
+
+  /*
+   * PSD tap buffers. They hold exactly one read, i.e. half of the
+   * baseband buffer if VM circularity is enabled.
+   */
+  bp_params.alloc_size  = self->bufpool->params.alloc_size;
+  bp_params.max_buffers = SUSCAN_LOCAL_ANALYZER_PSD_POOL_SIZE;
+  bp_params.name        = "psd";
+
+  if (self->circularity)
+    bp_params.alloc_size >>= 1;
+
+  SU_MAKE(self->psd_pool, suscan_sample_buffer_pool, &bp_params);
+  self->psd_decimation = 1;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUBOOL
+suscan_psd_worker_cb(
+  struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_local_analyzer_t *self  = (suscan_local_analyzer_t *) wk_private;
+  suscan_sample_buffer_t *buffer = (suscan_sample_buffer_t *)  cb_private;
+  SUCOMPLEX *samples = suscan_sample_buffer_data(buffer);
+  SUSCOUNT size = suscan_sample_buffer_length(buffer);
+
+  SU_TRY(su_smoothpsd_feed(self->smooth_psd, samples, size));
+
+done:
+  if (!suscan_sample_buffer_pool_give(self->psd_pool, buffer))
+    SU_ERROR("Failed to give buffer!\n");
 
   return SU_FALSE;
 }
 
+/*
+ * PSD tap: the samples of every read are copied to a buffer of the PSD
+ * pool, so the PSD worker never competes with the channelizer for baseband
+ * buffers. If the PSD worker falls behind, we do not block the source.
+ * Instead, the read is dropped and the PSD input is decimated, i.e. only
+ * one read in every psd_decimation is delivered. Both dropped and skipped
+ * reads are accounted in the PSD message. As whole reads are skipped, the
+ * averaged spectrum remains unbiased. Decimation is relaxed once the PSD
+ * worker catches up.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_tap_psd(
+  suscan_local_analyzer_t *self,
+  const SUCOMPLEX *samples,
+  SUSCOUNT size)
+{
+  suscan_sample_buffer_t *copy = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if (++self->psd_skip < self->psd_decimation) {
+    self->psd_dropped += size;
+    return SU_TRUE;
+  }
+
+  self->psd_skip = 0;
+
+  if (suscan_sample_buffer_pool_released(self->psd_pool)) {
+    if (self->psd_decimation > 1
+      && ++self->psd_idle >= SUSCAN_LOCAL_ANALYZER_PSD_RELAX_COUNT) {
+      self->psd_decimation >>= 1;
+      self->psd_idle = 0;
+    }
+  } else {
+    self->psd_idle = 0;
+  }
+
+  copy = suscan_sample_buffer_pool_try_acquire(self->psd_pool);
+  if (copy == NULL) {
+    self->psd_dropped += size;
+    if (self->psd_decimation < SUSCAN_LOCAL_ANALYZER_PSD_MAX_DECIMATION)
+      self->psd_decimation <<= 1;
+
+    return SU_TRUE;
+  }
+
+  if (size > suscan_sample_buffer_size(copy))
+    size = suscan_sample_buffer_size(copy);
+
+  memcpy(suscan_sample_buffer_data(copy), samples, size * sizeof(SUCOMPLEX));
+  suscan_sample_buffer_set_length(copy, size);
+
+  SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, copy));
+  copy = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (copy != NULL)
+    if (!suscan_sample_buffer_pool_give(self->psd_pool, copy))
+      SU_ERROR("Failed to give buffer!\n");
+
+  return ok;
+}
+
 
 /* 
  * If we rely on circularity, we alternate between the EVEN and ODD states:
@@ -762,6 +1345,663 @@ done:
   return ok;
 }
 
+/************************ Auxiliary source objects ***************************/
+void
+suscan_local_analyzer_aux_source_destroy(
+  struct suscan_local_analyzer_aux_source *self)
+{
+  if (self->source != NULL && suscan_source_is_capturing(self->source))
+    suscan_source_stop_capture(self->source);
+
+  /* Factory first: it holds pointers to specttuner channels */
+  if (self->insp_factory != NULL)
+    suscan_inspector_factory_destroy(self->insp_factory);
+
+  if (self->stuner_init)
+    pthread_mutex_destroy(&self->stuner_mutex);
+
+  if (self->stuner != NULL)
+    su_specttuner_destroy(self->stuner);
+
+  if (self->read_buf != NULL)
+    free(self->read_buf);
+
+  if (self->source != NULL)
+    suscan_source_destroy(self->source);
+
+  free(self);
+}
+
+SUPRIVATE SUFLOAT
+suscan_local_analyzer_aux_source_get_samp_rate(const void *userdata)
+{
+  const struct suscan_local_analyzer_aux_source *self =
+    (const struct suscan_local_analyzer_aux_source *) userdata;
+
+  return self->samp_rate;
+}
+
+SUPRIVATE SUFREQ
+suscan_local_analyzer_aux_source_get_freq(const void *userdata)
+{
+  const struct suscan_local_analyzer_aux_source *self =
+    (const struct suscan_local_analyzer_aux_source *) userdata;
+
+  return self->freq;
+}
+
+struct suscan_local_analyzer_aux_source *
+suscan_local_analyzer_aux_source_new(
+  suscan_local_analyzer_t *owner,
+  unsigned int index,
+  suscan_source_config_t *config,
+  const struct sigutils_specttuner_params *st_params)
+{
+  struct suscan_local_analyzer_aux_source *new = NULL;
+  const struct suscan_source_info *info;
+  pthread_mutexattr_t attr;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_local_analyzer_aux_source);
+
+  new->owner = owner;
+  new->index = index;
+
+  SU_MAKE_FAIL(new->source, suscan_source, config);
+  info = suscan_source_get_info(new->source);
+
+  if (info->effective_samp_rate != owner->source_info.effective_samp_rate) {
+    SU_ERROR(
+      "Auxiliary source %d: sample rate mismatch (%d != %d)\n",
+      index,
+      info->effective_samp_rate,
+      owner->source_info.effective_samp_rate);
+    goto fail;
+  }
+
+  new->freq      = info->frequency;
+  new->samp_rate = info->effective_samp_rate;
+
+  SU_MAKE_FAIL(new->stuner, su_specttuner, st_params);
+
+  /* Recursive, for the same reasons as in the main spectral tuner */
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  SU_TRYCATCH(pthread_mutex_init(&new->stuner_mutex, &attr) == 0, goto fail);
+  new->stuner_init = SU_TRUE;
+
+  /* Lockstep reads are never larger than the main sample buffers */
+  new->read_size = st_params->window_size;
+  SU_ALLOCATE_MANY_FAIL(new->read_buf, new->read_size, SUCOMPLEX);
+
+  new->tuner.owner         = owner;
+  new->tuner.desc          = "Auxiliary source";
+  new->tuner.index         = index;
+  new->tuner.stuner        = new->stuner;
+  new->tuner.stuner_mutex  = &new->stuner_mutex;
+  new->tuner.source        = new->source;
+  new->tuner.userdata      = new;
+  new->tuner.get_samp_rate = suscan_local_analyzer_aux_source_get_samp_rate;
+  new->tuner.get_freq      = suscan_local_analyzer_aux_source_get_freq;
+
+  SU_TRYCATCH(
+    new->insp_factory = suscan_inspector_factory_new(
+      "local-analyzer-tuner",
+      &new->tuner),
+    goto fail);
+
+  SU_TRYCATCH(
+    suscan_inspector_factory_share_sched(
+      new->insp_factory,
+      owner->insp_factory),
+    goto fail);
+
+  SU_TRYCATCH(suscan_source_start_capture(new->source), goto fail);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_local_analyzer_aux_source_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_fill_aux_buffer(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_analyzer_aux_source *aux,
+  SUCOMPLEX *buffer,
+  SUSCOUNT size)
+{
+  SUSCOUNT p = 0;
+  SUSDIFF got;
+
+  while (p < size) {
+    got = suscan_source_read(aux->source, buffer + p, size - p);
+    if (got <= 0) {
+      SU_ERROR("Auxiliary source %d: read failed (%d)\n", aux->index, got);
+      suscan_local_analyzer_send_eos(self, got);
+      return SU_FALSE;
+    }
+
+    p += got;
+  }
+
+  return SU_TRUE;
+}
+
+/*
+ * Sources that share a hardware clock with the main source (e.g. other
+ * channels of the same SDR device) are aligned on their timestamps: t0 is
+ * the device time of the first main source sample of this round. If the
+ * auxiliary source is behind, the difference is discarded. If it is ahead
+ * (usually, after it lost samples), we ask for zero padding instead.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_align_aux_source(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_analyzer_aux_source *aux,
+  const void *clock,
+  long long t0,
+  SUSCOUNT *pad)
+{
+  const void *aux_clock;
+  long long t;
+  SUSDIFF offset;
+  SUSCOUNT chunk;
+
+  *pad = 0;
+
+  if (!suscan_source_get_hw_time(aux->source, &aux_clock, &t))
+    return SU_TRUE;
+
+  if (aux_clock != clock) {
+    if (!aux->clock_warned) {
+      SU_WARNING(
+        "Auxiliary source %d does not share a clock with the main source, "
+        "aligning by sample count only\n",
+        aux->index);
+      aux->clock_warned = SU_TRUE;
+    }
+
+    return SU_TRUE;
+  }
+
+  offset = (SUSDIFF) floor(1e-9 * (t0 - t) * aux->samp_rate + .5);
+
+  if (offset > 0) {
+    while (offset > 0) {
+      chunk = SU_MIN((SUSCOUNT) offset, aux->read_size);
+      if (!suscan_local_analyzer_fill_aux_buffer(
+        self,
+        aux,
+        aux->read_buf,
+        chunk))
+        return SU_FALSE;
+      offset -= chunk;
+    }
+  } else if (offset < 0) {
+    *pad = -offset;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_read_aux_source(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_analyzer_aux_source *aux,
+  SUSCOUNT size,
+  SUSCOUNT pad)
+{
+  if (pad > size)
+    pad = size;
+
+  if (pad > 0)
+    memset(aux->read_buf, 0, pad * sizeof(SUCOMPLEX));
+
+  if (!suscan_local_analyzer_fill_aux_buffer(
+    self,
+    aux,
+    aux->read_buf + pad,
+    size - pad))
+    return SU_FALSE;
+
+  if (self->iq_rev)
+    suscan_analyzer_do_iq_rev(aux->read_buf, size);
+
+  aux->feed_ptr  = aux->read_buf;
+  aux->feed_left = size;
+
+  return SU_TRUE;
+}
+
+/*
+ * Read size samples from every auxiliary source (i.e. the same number of
+ * samples we have just read from the main source), aligned on hardware
+ * time when possible, and channelize them.
+ * Spectral tuners are fed in rounds of one window each. All inspectors
+ * share the same scheduler, so we sync only once per round.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_aux_sources(
+  suscan_local_analyzer_t *self,
+  SUSCOUNT size)
+{
+  struct suscan_local_analyzer_aux_source *aux;
+  const void *clock = NULL;
+  long long t0 = 0;
+  SUSCOUNT pad = 0;
+  SUSDIFF got;
+  unsigned int i;
+  SUBOOL have_time;
+  SUBOOL pending, new_data;
+  SUBOOL ok = SU_FALSE;
+
+  /* Device time of the first sample read from the main source */
+  have_time = suscan_source_get_hw_time(self->source, &clock, &t0);
+  if (have_time)
+    t0 -= (long long) (1e9 * size / self->source_info.effective_samp_rate);
+
+  if (size > self->aux_source_list[0]->read_size)
+    size = self->aux_source_list[0]->read_size;
+
+  for (i = 0; i < self->aux_source_count; ++i) {
+    aux = self->aux_source_list[i];
+    if (have_time)
+      SU_TRY(
+        suscan_local_analyzer_align_aux_source(self, aux, clock, t0, &pad));
+    SU_TRY(suscan_local_analyzer_read_aux_source(self, aux, size, pad));
+
+    /* Nothing to channelize. Just keep the source in sync. */
+    if (su_specttuner_get_channel_count(aux->stuner) == 0)
+      aux->feed_left = 0;
+  }
+
+  do {
+    pending  = SU_FALSE;
+    new_data = SU_FALSE;
+
+    for (i = 0; i < self->aux_source_count; ++i) {
+      aux = self->aux_source_list[i];
+      if (aux->feed_left == 0)
+        continue;
+
+      SU_TRY(pthread_mutex_lock(&aux->stuner_mutex) == 0);
+      aux->stuner_locked = SU_TRUE;
+
+      got = su_specttuner_feed_bulk_single(
+        aux->stuner,
+        aux->feed_ptr,
+        aux->feed_left);
+      SU_TRY(got != -1);
+
+      aux->feed_ptr  += got;
+      aux->feed_left -= got;
+
+      new_data = new_data || su_specttuner_new_data(aux->stuner);
+      pending  = pending  || aux->feed_left > 0;
+    }
+
+    if (new_data)
+      suscan_inspector_factory_force_sync(self->insp_factory);
+
+    for (i = 0; i < self->aux_source_count; ++i) {
+      aux = self->aux_source_list[i];
+      if (aux->stuner_locked) {
+        if (su_specttuner_new_data(aux->stuner))
+          su_specttuner_ack_data(aux->stuner);
+        aux->stuner_locked = SU_FALSE;
+        (void) pthread_mutex_unlock(&aux->stuner_mutex);
+      }
+    }
+  } while (pending);
+
+  ok = SU_TRUE;
+
+done:
+  for (i = 0; i < self->aux_source_count; ++i) {
+    aux = self->aux_source_list[i];
+    if (aux->stuner_locked) {
+      aux->stuner_locked = SU_FALSE;
+      (void) pthread_mutex_unlock(&aux->stuner_mutex);
+    }
+  }
+
+  return ok;
+}
+
+/************************** Channelizer shards *******************************/
+void
+suscan_local_analyzer_shard_destroy(struct suscan_local_analyzer_shard *self)
+{
+  if (self->worker != NULL)
+    if (!suscan_analyzer_halt_worker(self->worker)) {
+      SU_ERROR("Shard worker destruction failed, memory leak ahead\n");
+      return;
+    }
+
+  /* Factory first: it holds pointers to specttuner channels */
+  if (self->insp_factory != NULL)
+    suscan_inspector_factory_destroy(self->insp_factory);
+
+  if (self->stuner_init)
+    pthread_mutex_destroy(&self->stuner_mutex);
+
+  if (self->stuner != NULL)
+    su_specttuner_destroy(self->stuner);
+
+  free(self);
+}
+
+SUPRIVATE SUFLOAT
+suscan_local_analyzer_shard_get_samp_rate(const void *userdata)
+{
+  const struct suscan_local_analyzer_shard *self =
+    (const struct suscan_local_analyzer_shard *) userdata;
+
+  return suscan_analyzer_get_samp_rate(self->owner->parent);
+}
+
+SUPRIVATE SUFREQ
+suscan_local_analyzer_shard_get_freq(const void *userdata)
+{
+  const struct suscan_local_analyzer_shard *self =
+    (const struct suscan_local_analyzer_shard *) userdata;
+
+  return self->owner->source_info.frequency;
+}
+
+struct suscan_local_analyzer_shard *
+suscan_local_analyzer_shard_new(
+  suscan_local_analyzer_t *owner,
+  unsigned int index,
+  const struct sigutils_specttuner_params *st_params)
+{
+  struct suscan_local_analyzer_shard *new = NULL;
+  pthread_mutexattr_t attr;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_local_analyzer_shard);
+
+  new->owner = owner;
+  new->index = index;
+
+  SU_MAKE_FAIL(new->stuner, su_specttuner, st_params);
+
+  /* Recursive, for the same reasons as in the main spectral tuner */
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  SU_TRYCATCH(pthread_mutex_init(&new->stuner_mutex, &attr) == 0, goto fail);
+  new->stuner_init = SU_TRUE;
+
+  new->tuner.owner         = owner;
+  new->tuner.desc          = "Channelizer shard";
+  new->tuner.index         = index;
+  new->tuner.stuner        = new->stuner;
+  new->tuner.stuner_mutex  = &new->stuner_mutex;
+  new->tuner.source        = owner->source;
+  new->tuner.userdata      = new;
+  new->tuner.get_samp_rate = suscan_local_analyzer_shard_get_samp_rate;
+  new->tuner.get_freq      = suscan_local_analyzer_shard_get_freq;
+
+  SU_TRYCATCH(
+    new->insp_factory = suscan_inspector_factory_new(
+      "local-analyzer-tuner",
+      &new->tuner),
+    goto fail);
+
+  SU_TRYCATCH(
+    suscan_inspector_factory_share_sched(
+      new->insp_factory,
+      owner->insp_factory),
+    goto fail);
+
+  SU_TRYCATCH(
+    new->worker = suscan_worker_new_ex(
+      "shard-worker",
+      &owner->mq_in,
+      new),
+    goto fail);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_local_analyzer_shard_destroy(new);
+
+  return NULL;
+}
+
+/*
+ * Shards are created lazily by the analyzer thread. The shard list is
+ * never reallocated, and the number of shards is published under the
+ * shard mutex.
+ */
+SUPRIVATE unsigned int
+suscan_local_analyzer_get_active_shards(suscan_local_analyzer_t *self)
+{
+  unsigned int count;
+
+  if (!self->shard_sync_init)
+    return 0;
+
+  (void) pthread_mutex_lock(&self->shard_mutex);
+  count = self->shard_count;
+  (void) pthread_mutex_unlock(&self->shard_mutex);
+
+  return count;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_have_shard_channels(suscan_local_analyzer_t *self)
+{
+  unsigned int i, count = suscan_local_analyzer_get_active_shards(self);
+
+  for (i = 0; i < count; ++i)
+    if (su_specttuner_get_channel_count(self->shard_list[i]->stuner) > 0)
+      return SU_TRUE;
+
+  return SU_FALSE;
+}
+
+SUPRIVATE void
+suscan_local_analyzer_shard_done(suscan_local_analyzer_t *self)
+{
+  (void) pthread_mutex_lock(&self->shard_mutex);
+  --self->shard_busy;
+  pthread_cond_broadcast(&self->shard_cond);
+  (void) pthread_mutex_unlock(&self->shard_mutex);
+}
+
+SUPRIVATE void
+suscan_local_analyzer_shard_join(suscan_local_analyzer_t *self)
+{
+  (void) pthread_mutex_lock(&self->shard_mutex);
+  while (self->shard_busy > 0)
+    pthread_cond_wait(&self->shard_cond, &self->shard_mutex);
+  (void) pthread_mutex_unlock(&self->shard_mutex);
+}
+
+/*
+ * Shard worker: extract the channels of the next window and wait for the
+ * source worker to sync the inspector scheduler. The spectral tuner stays
+ * locked (by this thread) until the data has been acknowledged.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_shard_wk_cb(
+  struct suscan_mq *mq_out,
+  void *wk_private,
+  void *cb_private)
+{
+  struct suscan_local_analyzer_shard *shard =
+    (struct suscan_local_analyzer_shard *) wk_private;
+  suscan_local_analyzer_t *owner = shard->owner;
+  SUBOOL locked = SU_FALSE;
+  SUSDIFF got;
+
+  shard->new_data = SU_FALSE;
+
+  if (pthread_mutex_lock(&shard->stuner_mutex) == 0) {
+    locked = SU_TRUE;
+
+    got = su_specttuner_feed_bulk_single(
+      shard->stuner,
+      shard->feed_ptr,
+      shard->feed_left);
+
+    if (got == -1) {
+      shard->failed    = SU_TRUE;
+      shard->feed_left = 0;
+    } else {
+      shard->feed_ptr  += got;
+      shard->feed_left -= got;
+    }
+
+    shard->new_data = su_specttuner_new_data(shard->stuner);
+  } else {
+    shard->failed    = SU_TRUE;
+    shard->feed_left = 0;
+  }
+
+  suscan_local_analyzer_shard_done(owner);
+
+  (void) pthread_mutex_lock(&owner->shard_mutex);
+  while (owner->shard_round == shard->round)
+    pthread_cond_wait(&owner->shard_cond, &owner->shard_mutex);
+  (void) pthread_mutex_unlock(&owner->shard_mutex);
+
+  if (locked) {
+    if (shard->new_data)
+      su_specttuner_ack_data(shard->stuner);
+    (void) pthread_mutex_unlock(&shard->stuner_mutex);
+  }
+
+  suscan_local_analyzer_shard_done(owner);
+
+  return SU_FALSE;
+}
+
+/*
+ * Channelize the buffer with the main spectral tuner and all shards. Every
+ * round, shards extract one window in their own workers while the main
+ * spectral tuner does the same in the source worker. The main tuner is
+ * synced and released right away, so its mutex is never held while we wait
+ * for the shards. Then, the inspector scheduler is synced once more for the
+ * shards, and they acknowledge their data.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_shards(
+  suscan_local_analyzer_t *self,
+  suscan_sample_buffer_t *buffer,
+  SUSCOUNT size)
+{
+  struct suscan_local_analyzer_shard *shard;
+  const SUCOMPLEX *data = suscan_sample_buffer_data(buffer);
+  const SUCOMPLEX *main_ptr = data;
+  SUSCOUNT main_left = 0;
+  SUSDIFF got;
+  unsigned int i, pushed, count;
+  SUBOOL pending, new_data;
+  SUBOOL ok = SU_TRUE;
+
+  count = suscan_local_analyzer_get_active_shards(self);
+
+  if (su_specttuner_get_channel_count(self->stuner) > 0)
+    main_left = size;
+
+  for (i = 0; i < count; ++i) {
+    shard = self->shard_list[i];
+    shard->feed_ptr  = data;
+    shard->feed_left =
+      su_specttuner_get_channel_count(shard->stuner) > 0 ? size : 0;
+    shard->failed    = SU_FALSE;
+  }
+
+  do {
+    /* Fork */
+    (void) pthread_mutex_lock(&self->shard_mutex);
+    pushed = 0;
+    for (i = 0; i < count; ++i) {
+      shard = self->shard_list[i];
+      shard->new_data = SU_FALSE;
+
+      if (shard->feed_left == 0)
+        continue;
+
+      shard->round = self->shard_round;
+      if (suscan_worker_push(
+        shard->worker,
+        suscan_local_analyzer_shard_wk_cb,
+        NULL))
+        ++pushed;
+      else
+        shard->failed = SU_TRUE;
+    }
+    self->shard_busy = pushed;
+    (void) pthread_mutex_unlock(&self->shard_mutex);
+
+    /* Main spectral tuner, in this thread */
+    if (main_left > 0 && pthread_mutex_lock(&self->stuner_mutex) == 0) {
+      if (self->circularity) {
+        su_specttuner_force_state(self->stuner, self->circ_state);
+        if (!su_specttuner_trigger(
+          self->stuner,
+          suscan_sample_buffer_userdata(buffer)))
+          ok = SU_FALSE;
+        main_left = 0;
+      } else {
+        got = su_specttuner_feed_bulk_single(
+          self->stuner,
+          main_ptr,
+          main_left);
+        if (got == -1) {
+          ok = SU_FALSE;
+          main_left = 0;
+        } else {
+          main_ptr  += got;
+          main_left -= got;
+        }
+      }
+
+      if (su_specttuner_new_data(self->stuner)) {
+        suscan_inspector_factory_force_sync(self->insp_factory);
+        su_specttuner_ack_data(self->stuner);
+      }
+
+      (void) pthread_mutex_unlock(&self->stuner_mutex);
+    }
+
+    /* Join and sync */
+    suscan_local_analyzer_shard_join(self);
+
+    new_data = SU_FALSE;
+    for (i = 0; i < count; ++i)
+      new_data = new_data || self->shard_list[i]->new_data;
+
+    if (new_data)
+      suscan_inspector_factory_force_sync(self->insp_factory);
+
+    /* Release shards and wait for them to acknowledge their data */
+    (void) pthread_mutex_lock(&self->shard_mutex);
+    self->shard_busy = pushed;
+    ++self->shard_round;
+    pthread_cond_broadcast(&self->shard_cond);
+    (void) pthread_mutex_unlock(&self->shard_mutex);
+
+    suscan_local_analyzer_shard_join(self);
+
+    pending = main_left > 0;
+    for (i = 0; i < count; ++i) {
+      shard = self->shard_list[i];
+      if (shard->failed)
+        ok = SU_FALSE;
+      pending = pending || shard->feed_left > 0;
+    }
+  } while (pending);
+
+  return ok;
+}
+
 /********************** Worker callback implementation ************************/
 SUPRIVATE SUBOOL
 suscan_local_analyzer_buffer_channelizer_wk_cb(
@@ -794,22 +2034,15 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
   suscan_local_analyzer_process_start(self);
   samples = suscan_sample_buffer_data(buffer);
 
+  SU_TRY(suscan_local_analyzer_check_lost_samples(self));
+
   if (self->iq_rev)
     suscan_analyzer_do_iq_rev(samples, got);
 
   SU_TRY(suscan_local_analyzer_feed_baseband_filters(self, samples, got));
 
-  /*
-    * NO CIRCULARITY: Increment reference and deliver to worker.
-    * 
-    * We deliver the calculation of the PSD FFT to a different worker.
-    * Additionally. We only feed the PSD worker if we are sure that the
-    * next allocation of a buffer is not going to sleep.
-    */
-  if (suscan_sample_buffer_pool_free_num(self->bufpool) > 0) {
-    suscan_sample_buffer_inc_ref(buffer);
-    SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, buffer));
-  }
+  /* We deliver the calculation of the PSD FFT to a different worker. */
+  SU_TRY(suscan_local_analyzer_tap_psd(self, samples, got));
 
   if (SUSCAN_ANALYZER_FS_MEASURE_INTERVAL > 0) {
     seconds = (self->read_start - self->last_measure) * 1e-9;
@@ -828,7 +2061,14 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
   }
 
   /* Feed inspectors! */
-  SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
+  if (suscan_local_analyzer_have_shard_channels(self)) {
+    SU_TRY(suscan_local_analyzer_feed_shards(self, buffer, got));
+  } else {
+    SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
+  }
+
+  if (self->aux_source_count > 0)
+    SU_TRY(suscan_local_analyzer_feed_aux_sources(self, got));
 
 
   /* Finish processing */
@@ -854,7 +2094,7 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
     void *cb_private)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
-  suscan_sample_buffer_t *buffer = NULL, *dup;
+  suscan_sample_buffer_t *buffer = NULL;
   SUCOMPLEX *samples;
   SUSDIFF got;
   SUBOOL mutex_acquired = SU_FALSE;
@@ -878,6 +2118,8 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
   suscan_local_analyzer_process_start(self);
   samples = suscan_sample_buffer_data(buffer);
 
+  SU_TRY(suscan_local_analyzer_check_lost_samples(self));
+
   if (self->iq_rev)
     suscan_analyzer_do_iq_rev(samples, got);
 
@@ -887,15 +2129,8 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
           samples,
           got));
 
-  /*
-   * CIRCULARITY: Buffer is being reused and must be duplicated
-   *
-   * This duplicate is contingent and we don't want it to block.
-   */
-  
-  dup = suscan_sample_buffer_pool_try_dup(self->bufpool, buffer);
-  if (dup != NULL)
-    SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, dup));
+  /* CIRCULARITY: Buffer is being reused, the PSD tap copies the last read */
+  SU_TRY(suscan_local_analyzer_tap_psd(self, samples, got));
 
   if (SUSCAN_ANALYZER_FS_MEASURE_INTERVAL > 0) {
     seconds = (self->read_start - self->last_measure) * 1e-9;
@@ -914,7 +2149,14 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
   }
 
   /* Feed inspectors! */
-  SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
+  if (suscan_local_analyzer_have_shard_channels(self)) {
+    SU_TRY(suscan_local_analyzer_feed_shards(self, buffer, got));
+  } else {
+    SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
+  }
+
+  if (self->aux_source_count > 0)
+    SU_TRY(suscan_local_analyzer_feed_aux_sources(self, got));
 
   /* Finish processing */
   suscan_local_analyzer_process_end(self);
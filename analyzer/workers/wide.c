@@ -34,6 +34,7 @@
 #include <sigutils/sigutils.h>
 #include <sigutils/detect.h>
 #include <analyzer/impl/local.h>
+#include <analyzer/psdstats.h>
 
 #include "mq.h"
 #include "msg.h"
@@ -44,6 +45,182 @@ static uint64_t micros() {
   return tv.tv_sec * 1000000ull + tv.tv_usec;
 }
 
+/*
+ * Adaptive strategy tuning. Segment activity is the fraction of PSD bins
+ * above the noise floor (estimated from the median) or the change in
+ * power since the last visit, whichever is bigger.
+ */
+#define SUSCAN_WIDE_ADAPTIVE_MAX_SEGMENTS    16384
+#define SUSCAN_WIDE_ADAPTIVE_MAX_DWELL       8   /* PSDs per visit, busiest */
+#define SUSCAN_WIDE_ADAPTIVE_ALPHA           .25 /* Activity smoothing */
+#define SUSCAN_WIDE_ADAPTIVE_ACTIVITY_FLOOR  .05 /* Quiet segments age too */
+#define SUSCAN_WIDE_ADAPTIVE_THRESHOLD_DB    10. /* Occupied bin threshold */
+#define SUSCAN_WIDE_ADAPTIVE_OCCUPANCY_GAIN  10. /* 10% occupancy saturates */
+#define SUSCAN_WIDE_ADAPTIVE_POWER_SCALE_DB  6.  /* Power change saturation */
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_ensure_segments(
+    suscan_local_analyzer_t *self,
+    SUFREQ part_bw)
+{
+  struct suscan_local_analyzer_segment *new_list = NULL;
+  SUFREQ min = self->current_sweep_params.min_freq;
+  SUFREQ max = self->current_sweep_params.max_freq;
+  SUFREQ step = part_bw;
+  SUSCOUNT i, count;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->segment_list != NULL
+      && self->segment_min_freq == min
+      && self->segment_max_freq == max
+      && self->segment_bw == part_bw)
+    return SU_TRUE;
+
+  count = SU_FLOOR((max - min) / part_bw) + 1;
+  if (count > SUSCAN_WIDE_ADAPTIVE_MAX_SEGMENTS) {
+    count = SUSCAN_WIDE_ADAPTIVE_MAX_SEGMENTS;
+    step  = (max - min) / (count - 1);
+  }
+
+  SU_ALLOCATE_MANY(new_list, count, struct suscan_local_analyzer_segment);
+
+  for (i = 0; i < count; ++i)
+    new_list[i].freq = SU_MIN(min + i * step, max);
+
+  if (self->segment_list != NULL)
+    free(self->segment_list);
+
+  self->segment_list     = new_list;
+  self->segment_count    = count;
+  self->segment_curr     = 0;
+  self->segment_bw       = part_bw;
+  self->segment_min_freq = min;
+  self->segment_max_freq = max;
+  self->dwell_count      = 0;
+  self->dwell_target     = 1;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/*
+ * Segment selection: unvisited segments first, then any segment that was
+ * not visited for longer than the maximum revisit interval (oldest first)
+ * and, if none, the one with the biggest activity-weighted age.
+ */
+SUPRIVATE SUFREQ
+suscan_local_analyzer_adaptive_next(suscan_local_analyzer_t *self)
+{
+  const struct suscan_local_analyzer_segment *seg;
+  uint64_t now = micros();
+  uint64_t age, max_age, overdue_age = 0;
+  SUSDIFF best = -1, overdue = -1;
+  SUFLOAT prio, best_prio = -1;
+  SUSCOUNT i;
+
+  max_age = self->current_sweep_params.max_revisit_int * 1e6;
+
+  for (i = 0; i < self->segment_count; ++i)
+    if (!self->segment_list[i].visited) {
+      best = i;
+      break;
+    }
+
+  if (best == -1) {
+    for (i = 0; i < self->segment_count; ++i) {
+      if (i == self->segment_curr && self->segment_count > 1)
+        continue;
+
+      seg  = self->segment_list + i;
+      age  = now > seg->last_visit ? now - seg->last_visit : 0;
+      prio = (seg->activity + SUSCAN_WIDE_ADAPTIVE_ACTIVITY_FLOOR) * age;
+
+      if (age > max_age && age > overdue_age) {
+        overdue     = i;
+        overdue_age = age;
+      }
+
+      if (prio > best_prio) {
+        best      = i;
+        best_prio = prio;
+      }
+    }
+
+    if (overdue != -1)
+      best = overdue;
+  }
+
+  seg = self->segment_list + best;
+
+  self->segment_curr = best;
+  self->dwell_count  = 0;
+  self->dwell_target = 1 + SU_FLOOR(
+      seg->activity * (SUSCAN_WIDE_ADAPTIVE_MAX_DWELL - 1) + .5);
+
+  return seg->freq;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_update_activity(suscan_local_analyzer_t *self)
+{
+  const su_channel_detector_t *cd = self->detector;
+  struct suscan_local_analyzer_segment *seg;
+  SUSCOUNT i, size = cd->params.window_size, occupied = 0;
+  SUFLOAT *tmp;
+  SUFLOAT total = 0, thres, power, occupancy, change, instant;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->segment_list == NULL || self->segment_curr >= self->segment_count)
+    return SU_TRUE;
+
+  seg = self->segment_list + self->segment_curr;
+
+  if (self->activity_buf_size != size) {
+    SU_TRY(tmp = realloc(self->activity_buf, size * sizeof(SUFLOAT)));
+    self->activity_buf      = tmp;
+    self->activity_buf_size = size;
+  }
+
+  for (i = 0; i < size; ++i) {
+    self->activity_buf[i] = SU_C_REAL(cd->fft[i] * SU_C_CONJ(cd->fft[i]));
+    total += self->activity_buf[i];
+  }
+
+  /* The median of a noise-only periodogram is N0 * ln(2) */
+  thres = suscan_psd_select(self->activity_buf, size, size / 2)
+    / M_LN2
+    * SU_POWER_MAG_RAW(SUSCAN_WIDE_ADAPTIVE_THRESHOLD_DB);
+
+  for (i = 0; i < size; ++i)
+    if (self->activity_buf[i] > thres)
+      ++occupied;
+
+  occupancy = SU_MIN(
+      1,
+      SUSCAN_WIDE_ADAPTIVE_OCCUPANCY_GAIN * occupied / (SUFLOAT) size);
+  power = SU_POWER_DB_RAW(total / size + SUFLOAT_THRESHOLD);
+  change = seg->visited
+    ? SU_MIN(1, SU_ABS(power - seg->power) / SUSCAN_WIDE_ADAPTIVE_POWER_SCALE_DB)
+    : 0;
+  instant = SU_MAX(occupancy, change);
+
+  if (seg->visited)
+    seg->activity += SUSCAN_WIDE_ADAPTIVE_ALPHA * (instant - seg->activity);
+  else
+    seg->activity = instant;
+
+  seg->power      = power;
+  seg->last_visit = micros();
+  seg->visited    = SU_TRUE;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 /*
  * TODO: Add methods to define partition bandwidth
  */
@@ -62,6 +239,9 @@ suscan_local_analyzer_hop(suscan_local_analyzer_t *self)
   SUFREQ next = .5 * (
       self->current_sweep_params.max_freq
       + self->current_sweep_params.min_freq);
+  SUFREQ lnb = suscan_source_config_get_lnb_freq(
+      suscan_source_get_config(self->source));
+  SUSDIFF settle;
   uint64_t t0, hop_time;
 
   /*
@@ -119,18 +299,37 @@ suscan_local_analyzer_hop(suscan_local_analyzer_t *self)
           }
         }
         break;
+
+      case SUSCAN_ANALYZER_SWEEP_STRATEGY_ADAPTIVE:
+        /* Adaptive strategy: dwell and revisit based on segment activity */
+        SU_TRYCATCH(
+            suscan_local_analyzer_ensure_segments(
+                self,
+                fs * self->current_sweep_params.rel_bw),
+            return SU_FALSE);
+        next = suscan_local_analyzer_adaptive_next(self);
+        break;
     }
   }
 
   /* All set. Go ahed and hop */
   t0 = micros();
-  if (suscan_source_set_freq2(
-      self->source,
-      next,
-      suscan_source_config_get_lnb_freq(
-          suscan_source_get_config(self->source)))) {
+  if (suscan_source_set_freq2(self->source, next, lnb)) {
     hop_time = micros() - t0;
-    self->hop_samples = fs * hop_time / 1000000;
+
+    /*
+     * If the retune settle time of this band has been calibrated, discard
+     * exactly that. Otherwise, fall back to the time spent in the retune.
+     */
+    settle = suscan_source_config_get_settle_samples(
+        suscan_source_get_config(self->source),
+        next - lnb,
+        fs);
+    self->hop_calibrated = settle >= 0;
+    if (self->hop_calibrated)
+      self->hop_samples = settle;
+    else
+      self->hop_samples = fs * hop_time / 1000000;
     self->curr_freq = suscan_source_get_freq(self->source);
     self->source_info.frequency = self->curr_freq;
 
@@ -148,6 +347,8 @@ suscan_source_wide_wk_cb(
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
   SUSDIFF got;
+  SUSCOUNT settle, excess;
+  SUBOOL adaptive;
   SUBOOL mutex_acquired = SU_FALSE;
   SUBOOL restart = SU_FALSE;
 
@@ -162,23 +363,36 @@ suscan_source_wide_wk_cb(
     self->sweep_params_requested = SU_FALSE;
   }
 
+  adaptive = self->current_sweep_params.strategy
+    == SUSCAN_ANALYZER_SWEEP_STRATEGY_ADAPTIVE;
+
   if ((got = suscan_source_read(
       self->source,
       self->read_buf,
       self->read_size)) > 0) {
+    SU_TRYCATCH(suscan_local_analyzer_check_lost_samples(self), goto done);
 
     if (self->iq_rev)
       suscan_analyzer_do_iq_rev(self->read_buf, got);
     self->fft_samples += got;
 
-    if (self->fft_samples > self->current_sweep_params.fft_min_samples +
-        self->hop_samples) {
+    /*
+     * Calibrated bands tell us exactly how many samples to discard after
+     * the hop. There is no need to add the safety margin on top of that.
+     */
+    settle = self->hop_samples
+      + (self->hop_calibrated ? 0 : self->current_sweep_params.fft_min_samples);
+
+    if (self->fft_samples > settle) {
+      /* Only the samples past the settle point reach the detector */
+      excess = SU_MIN(self->fft_samples - settle, got);
+
       /* Feed detector (works in spectrum mode only) */
       SU_TRYCATCH(
           su_channel_detector_feed_bulk(
               self->detector,
-              self->read_buf,
-              got) == got,
+              self->read_buf + (got - excess),
+              excess) == excess,
           goto done);
 
       /*
@@ -192,10 +406,17 @@ suscan_source_wide_wk_cb(
             suscan_analyzer_send_psd(self->parent, self->detector),
             goto done);
 
-        self->fft_samples = 0;
+        if (adaptive)
+          SU_TRYCATCH(suscan_local_analyzer_update_activity(self), goto done);
+
         su_channel_detector_rewind(self->detector);
-        if (!suscan_local_analyzer_hop(self))
-          SU_ERROR("Hop failed!\n");
+
+        /* Busy segments are given more than one PSD before hopping */
+        if (!adaptive || ++self->dwell_count >= self->dwell_target) {
+          self->fft_samples = 0;
+          if (!suscan_local_analyzer_hop(self))
+            SU_ERROR("Hop failed!\n");
+        }
       }
     }
   } else {
@@ -309,9 +530,13 @@ suscan_local_analyzer_init_wide_worker(suscan_local_analyzer_t *self)
   self->current_sweep_params.max_freq = self->parent->params.max_freq;
   self->current_sweep_params.min_freq = self->parent->params.min_freq;
   self->current_sweep_params.rel_bw = 0.5;
+  self->current_sweep_params.max_revisit_int =
+          SUSCAN_ANALYZER_MAX_REVISIT_INTERVAL;
   self->sweep_params_requested = SU_FALSE;
 
-  self->hop_samples = 0;
+  self->hop_samples    = 0;
+  self->hop_calibrated = SU_FALSE;
+  self->dwell_target   = 1;
 
   ok = SU_TRUE;
 
@@ -20,6 +20,7 @@
 #define SU_LOG_DOMAIN "chanloop"
 
 #include <sigutils/log.h>
+#include <sys/time.h>
 #include <analyzer/msg.h>
 #include "chanloop.h"
 
@@ -46,34 +47,156 @@ suscli_frequency_format(char *obuf, size_t osize, SUFREQ freq, const char *unit)
   snprintf(obuf, osize - 1, "%6.3lf %c%s", freq, pfx, unit);
 }
 
-suscli_chanloop_t *
-suscli_chanloop_open(
-    const struct suscli_chanloop_params *params,
-    suscan_source_config_t *cfg)
+/*
+ * Inspector IDs start at this value, so that samples from an inspector
+ * whose ID has not been set yet (ID 0) can be told apart.
+ */
+#define SUSCAN_CHANLOOP_INSPECTOR_ID_BASE    1
+
+SUPRIVATE void
+suscli_chanloop_channel_destroy(struct suscli_chanloop_channel *self)
 {
-  struct suscan_analyzer_inspector_msg *msg;
-  void *rawmsg;
-  uint32_t type;
-  struct timeval timeout;
-  SUSCOUNT true_samp_rate;
-  SUFREQ   bandwidth;
-  SUFREQ   lofreq;
-  SUBOOL   have_inspector = SU_FALSE;
-  char     freqline[64];
+  if (self->inspcfg != NULL)
+    suscan_config_destroy(self->inspcfg);
 
-  struct sigutils_channel ch = sigutils_channel_INITIALIZER;
+  free(self);
+}
 
-  suscli_chanloop_t *new = NULL;
-  struct suscan_analyzer_params analyzer_params =
-      suscan_analyzer_params_INITIALIZER;
+SUPRIVATE void
+suscli_chanloop_channel_debug(const struct suscan_analyzer_inspector_msg *msg)
+{
+  char freqline[64];
 
-  SU_TRYCATCH(params->on_data != NULL, goto fail);
+  fprintf(stderr, "Inspector opened!\n");
+  fprintf(stderr, "  Inspector ID: 0x%08x\n", msg->inspector_id);
+  fprintf(stderr, "  Request ID:   0x%08x\n", msg->req_id);
+  fprintf(stderr, "  Handle:       0x%08x\n", msg->handle);
 
-  SU_TRYCATCH(params->relbw > 0,  goto fail);
-  SU_TRYCATCH(params->relbw <= 1, goto fail);
+  suscli_frequency_format(freqline, sizeof(freqline), msg->equiv_fs, "sps");
+  fprintf(stderr, "  EquivFS:      %s\n", freqline);
 
-  SU_TRYCATCH(params->rello - .5 * params->relbw > -.5,  goto fail);
-  SU_TRYCATCH(params->rello + .5 * params->relbw < +.5, goto fail);
+  suscli_frequency_format(freqline, sizeof(freqline), msg->channel.ft, "Hz");
+  fprintf(stderr, "  Ft:           %s\n", freqline);
+
+  suscli_frequency_format(freqline, sizeof(freqline), msg->bandwidth, "Hz");
+  fprintf(stderr, "  BW:           %s\n", freqline);
+
+  suscli_frequency_format(freqline, sizeof(freqline), msg->lo, "Hz");
+  fprintf(stderr, "  LO:           %s\n", freqline);
+}
+
+/*
+ * Samples with no ID come from an inspector whose ID has been requested
+ * but not applied yet. They are only delivered if exactly one open
+ * channel is in that state: otherwise they cannot be told apart, and
+ * they are dropped. A channel leaves that state with the first batch
+ * that carries its ID.
+ */
+SUPRIVATE struct suscli_chanloop_channel *
+suscli_chanloop_lookup_pending_channel(const suscli_chanloop_t *self)
+{
+  struct suscli_chanloop_channel *chan, *pending = NULL;
+  unsigned int i;
+
+  for (i = 0; i < self->channel_count; ++i) {
+    chan = self->channel_list[i];
+    if (chan->handle != -1 && !chan->finished && !chan->id_confirmed) {
+      if (pending != NULL)
+        return NULL;
+      pending = chan;
+    }
+  }
+
+  return pending;
+}
+
+SUPRIVATE struct suscli_chanloop_channel *
+suscli_chanloop_lookup_channel(
+    const suscli_chanloop_t *self,
+    uint32_t inspector_id)
+{
+  struct suscli_chanloop_channel *chan;
+  unsigned int index;
+
+  if (inspector_id < SUSCAN_CHANLOOP_INSPECTOR_ID_BASE)
+    return suscli_chanloop_lookup_pending_channel(self);
+
+  index = inspector_id - SUSCAN_CHANLOOP_INSPECTOR_ID_BASE;
+  if (index >= self->channel_count)
+    return NULL;
+
+  chan = self->channel_list[index];
+  chan->id_confirmed = SU_TRUE;
+
+  return chan;
+}
+
+/*
+ * An open request that timed out may still be honored later. Nobody
+ * owns the resulting inspector, so it is closed as soon as it shows up.
+ */
+SUPRIVATE void
+suscli_chanloop_close_orphan(
+    suscli_chanloop_t *self,
+    const struct suscan_analyzer_inspector_msg *msg)
+{
+  struct suscli_chanloop_channel *chan;
+  uint32_t index;
+
+  if (msg->kind != SUSCAN_ANALYZER_INSPECTOR_MSGKIND_OPEN)
+    return;
+
+  index = msg->req_id - SUSCAN_CHANLOOP_REQ_ID;
+  if (msg->req_id < SUSCAN_CHANLOOP_REQ_ID || index >= self->channel_count)
+    return;
+
+  chan = self->channel_list[index];
+  if (chan->handle == -1 && chan->finished) {
+    SU_WARNING(
+        "Channel %d: closing inspector opened after timeout\n",
+        chan->index);
+    (void) suscan_analyzer_close_async(
+        self->analyzer,
+        msg->handle,
+        msg->req_id);
+  }
+}
+
+/* Returns SU_FALSE if there are no channels left */
+SUPRIVATE SUBOOL
+suscli_chanloop_deliver_samples(
+    suscli_chanloop_t *self,
+    const struct suscan_analyzer_sample_batch_msg *msg)
+{
+  struct suscli_chanloop_channel *chan;
+
+  chan = suscli_chanloop_lookup_channel(self, msg->inspector_id);
+
+  if (chan != NULL && chan->handle != -1 && !chan->finished) {
+    if (!(chan->params.on_data) (
+        self->analyzer,
+        msg->samples,
+        msg->sample_count,
+        chan->params.userdata)) {
+      chan->finished = SU_TRUE;
+      --self->active;
+
+      (void) suscan_analyzer_close_async(
+          self->analyzer,
+          chan->handle,
+          SUSCAN_CHANLOOP_REQ_ID + chan->index);
+    }
+  }
+
+  return self->active > 0;
+}
+
+suscli_chanloop_t *
+suscli_chanloop_new(suscan_source_config_t *cfg)
+{
+  suscli_chanloop_t *new = NULL;
+  struct suscan_analyzer_params analyzer_params =
+      suscan_analyzer_params_INITIALIZER;
 
   /* Neither PSD nor channel detector */
   analyzer_params.channel_update_int = 0;
@@ -81,13 +204,9 @@ suscli_chanloop_open(
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscli_chanloop_t)), goto fail);
 
-  new->params = *params;
   new->lnb_freq = suscan_source_config_get_lnb_freq(cfg);
 
-  if (new->params.type == NULL)
-    new->params.type = "raw";
-
-  /* First step: open analyzer, get true sample rate */
+  /* Open analyzer, get true sample rate */
   SU_TRYCATCH(suscan_mq_init(&new->mq), goto fail);
   SU_TRYCATCH(
       new->analyzer = suscan_analyzer_new(
@@ -99,100 +218,163 @@ suscli_chanloop_open(
   /* Wait for analyzer to be initialized */
   SU_TRY_FAIL(suscan_analyzer_wait_until_ready(new->analyzer, NULL));
 
-  true_samp_rate = suscan_analyzer_get_samp_rate(new->analyzer);
+  new->samp_rate = suscan_analyzer_get_samp_rate(new->analyzer);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscli_chanloop_destroy(new);
+
+  return NULL;
+}
+
+int
+suscli_chanloop_add_channel(
+    suscli_chanloop_t *self,
+    const struct suscli_chanloop_params *params)
+{
+  struct suscan_analyzer_inspector_msg *msg;
+  struct suscli_chanloop_channel *new = NULL;
+  void *rawmsg;
+  uint32_t type;
+  uint32_t req_id;
+  struct timeval timeout, deadline, now;
+  SUFREQ   bandwidth;
+  SUFREQ   lofreq;
+  SUBOOL   have_inspector = SU_FALSE;
+  int index = -1;
+
+  struct sigutils_channel ch = sigutils_channel_INITIALIZER;
+
+  SU_TRYCATCH(params->on_data != NULL, goto fail);
+
+  SU_TRYCATCH(params->relbw > 0,  goto fail);
+  SU_TRYCATCH(params->relbw <= 1, goto fail);
+
+  SU_TRYCATCH(params->rello - .5 * params->relbw > -.5,  goto fail);
+  SU_TRYCATCH(params->rello + .5 * params->relbw < +.5, goto fail);
+
+  SU_TRYCATCH(new = calloc(1, sizeof(struct suscli_chanloop_channel)), goto fail);
+
+  new->params = *params;
+  new->handle = -1;
+  new->index  = self->channel_count;
+
+  if (new->params.type == NULL)
+    new->params.type = "raw";
 
-  /* Second step: deduce bandwidth/lo from sample rate and relative bw/lo */
-  bandwidth = true_samp_rate * params->relbw;
-  lofreq    = true_samp_rate * params->rello;
+  /* Deduce bandwidth/lo from sample rate and relative bw/lo */
+  bandwidth = self->samp_rate * params->relbw;
+  lofreq    = self->samp_rate * params->rello;
 
-  /* Third step: open inspector and wait for its creation */
   ch.ft   = 0;
   ch.fc   = lofreq;
   ch.f_lo = lofreq - .5 * bandwidth;
   ch.f_hi = lofreq + .5 * bandwidth;
 
   new->chan = ch;
+  req_id    = SUSCAN_CHANLOOP_REQ_ID + new->index;
+
+  SU_TRYCATCH(PTR_LIST_APPEND_CHECK(self->channel, new) != -1, goto fail);
+  index = new->index;
+  new   = NULL;
 
   timeout.tv_sec  = SUSCAN_CHANLOOP_MSG_TIMEOUT_MS / 1000;
   timeout.tv_usec = (SUSCAN_CHANLOOP_MSG_TIMEOUT_MS % 1000) * 1000;
 
   SU_TRY_FAIL(
       suscan_analyzer_open_ex_async(
-          new->analyzer,
-          new->params.type,
+          self->analyzer,
+          self->channel_list[index]->params.type,
           &ch,
           SU_TRUE, /* Precise centering */
           -1, /* parent = source channelizer */
-          SUSCAN_CHANLOOP_REQ_ID));
+          req_id));
+
+  /*
+   * Channels opened before keep receiving samples while we wait. As
+   * every message restarts the read timeout, the wait itself is bounded
+   * by an absolute deadline.
+   */
+  gettimeofday(&now, NULL);
+  timeradd(&now, &timeout, &deadline);
+
+  while (!have_inspector) {
+    gettimeofday(&now, NULL);
+    if (!timercmp(&now, &deadline, <))
+      break;
+
+    timersub(&deadline, &now, &timeout);
+
+    if ((rawmsg = suscan_analyzer_read_timeout(
+        self->analyzer,
+        &type,
+        &timeout)) == NULL)
+      break;
 
-  while (!have_inspector && (rawmsg = suscan_analyzer_read_timeout(
-      new->analyzer,
-      &type,
-      &timeout)) != NULL) {
     switch (type) {
       case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
         suscan_analyzer_dispose_message(type, rawmsg);
         goto fail;
 
+      case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
+        if (self->active > 0)
+          (void) suscli_chanloop_deliver_samples(self, rawmsg);
+        break;
+
       case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
         msg = rawmsg;
-        if (msg->kind == SUSCAN_ANALYZER_INSPECTOR_MSGKIND_OPEN) {
-          fprintf(stderr, "Inspector opened!\n");
-          fprintf(stderr, "  Inspector ID: 0x%08x\n", msg->inspector_id);
-          fprintf(stderr, "  Request ID:   0x%08x\n", msg->req_id);
-          fprintf(stderr, "  Handle:       0x%08x\n", msg->handle);
-
-          suscli_frequency_format(
-            freqline,
-            sizeof(freqline),
-            msg->equiv_fs,
-            "sps");
-          fprintf(stderr, "  EquivFS:      %s\n", freqline);
-
-          suscli_frequency_format(
-            freqline,
-            sizeof(freqline),
-            msg->channel.ft,
-            "Hz");
-          fprintf(stderr, "  Ft:           %s\n", freqline);
-
-          suscli_frequency_format(
-            freqline,
-            sizeof(freqline),
-            msg->bandwidth,
-            "Hz");
-          fprintf(stderr, "  BW:           %s\n", freqline);
-
-          suscli_frequency_format(
-            freqline,
-            sizeof(freqline),
-            msg->lo,
-            "Hz");
-          fprintf(stderr, "  LO:           %s\n", freqline);
+        if (msg->req_id == req_id
+            && msg->kind != SUSCAN_ANALYZER_INSPECTOR_MSGKIND_OPEN) {
+          /* The analyzer refused to open the inspector */
+          SU_ERROR(
+              "Channel %d: cannot open inspector (reply kind %d)\n",
+              index,
+              msg->kind);
+          suscan_analyzer_dispose_message(type, rawmsg);
+          goto fail;
+        } else if (msg->kind != SUSCAN_ANALYZER_INSPECTOR_MSGKIND_OPEN
+            || msg->req_id != req_id) {
+          suscli_chanloop_close_orphan(self, msg);
+        } else {
+          suscli_chanloop_channel_debug(msg);
 
+          new = self->channel_list[index];
           new->handle   = msg->handle;
           new->ft       = msg->channel.ft;
           new->bw       = msg->bandwidth;
           new->equiv_fs = msg->equiv_fs;
-          
+
           SU_TRYCATCH(new->inspcfg = suscan_config_dup(msg->config), goto fail);
           have_inspector = SU_TRUE;
 
+          SU_TRYCATCH(
+              suscan_analyzer_set_inspector_id_async(
+                  self->analyzer,
+                  msg->handle,
+                  SUSCAN_CHANLOOP_INSPECTOR_ID_BASE + index,
+                  req_id),
+              goto fail);
+
           /* Set parameters */
           if (new->params.on_open != NULL) {
             if ((new->params.on_open) (
-                new->analyzer,
+                self->analyzer,
                 new->inspcfg,
                 new->params.userdata)) {
               SU_TRYCATCH(
                   suscan_analyzer_set_inspector_config_async(
-                      new->analyzer,
+                      self->analyzer,
                       msg->handle,
                       new->inspcfg,
                       0),
                   goto fail);
             }
           }
+
+          new = NULL;
+          ++self->active;
         }
         break;
 
@@ -208,6 +390,35 @@ suscli_chanloop_open(
     goto fail;
   }
 
+  return index;
+
+fail:
+  /*
+   * The entry stays in the list, but it will never get samples. If the
+   * inspector was opened, close it. Otherwise, it is closed if it shows
+   * up later.
+   */
+  if (index != -1) {
+    new = self->channel_list[index];
+    if (new->handle != -1)
+      (void) suscan_analyzer_close_async(self->analyzer, new->handle, req_id);
+    new->finished = SU_TRUE;
+  } else if (new != NULL)
+    suscli_chanloop_channel_destroy(new);
+
+  return -1;
+}
+
+suscli_chanloop_t *
+suscli_chanloop_open(
+    const struct suscli_chanloop_params *params,
+    suscan_source_config_t *cfg)
+{
+  suscli_chanloop_t *new = NULL;
+
+  SU_TRY_FAIL(new = suscli_chanloop_new(cfg));
+  SU_TRY_FAIL(suscli_chanloop_add_channel(new, params) != -1);
+
   return new;
 
 fail:
@@ -220,7 +431,6 @@ fail:
 SUBOOL
 suscli_chanloop_work(suscli_chanloop_t *self)
 {
-  struct suscan_analyzer_sample_batch_msg *msg;
   void *rawmsg;
   uint32_t type;
   struct timeval timeout;
@@ -229,7 +439,7 @@ suscli_chanloop_work(suscli_chanloop_t *self)
   timeout.tv_sec  = SUSCAN_CHANLOOP_MSG_TIMEOUT_MS / 1000;
   timeout.tv_usec = (SUSCAN_CHANLOOP_MSG_TIMEOUT_MS % 1000) * 1000;
 
-  while ((rawmsg = suscan_analyzer_read_timeout(
+  while (self->active > 0 && (rawmsg = suscan_analyzer_read_timeout(
         self->analyzer,
         &type,
         &timeout)) != NULL) {
@@ -244,14 +454,7 @@ suscli_chanloop_work(suscli_chanloop_t *self)
           goto fail;
 
         case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
-          msg = rawmsg;
-
-          /* There is only one inspector opened. No need to check the handle. */
-          if (!(self->params.on_data) (
-              self->analyzer,
-              msg->samples,
-              msg->sample_count,
-              self->params.userdata)) {
+          if (!suscli_chanloop_deliver_samples(self, rawmsg)) {
             suscan_analyzer_dispose_message(type, rawmsg);
             ok = SU_TRUE;
             goto fail;
@@ -259,6 +462,10 @@ suscli_chanloop_work(suscli_chanloop_t *self)
 
           break;
 
+        case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
+          suscli_chanloop_close_orphan(self, rawmsg);
+          break;
+
         default:
           break;
       }
@@ -279,22 +486,31 @@ suscli_chanloop_set_frequency(suscli_chanloop_t *self, SUFREQ freq)
 }
 
 SUBOOL
-suscli_chanloop_set_lofreq(suscli_chanloop_t *self, SUFREQ lofreq)
+suscli_chanloop_channel_set_lofreq(
+    suscli_chanloop_t *self,
+    unsigned int index,
+    SUFREQ lofreq)
 {
+  SU_TRYCATCH(index < self->channel_count, return SU_FALSE);
+
   return suscan_analyzer_set_inspector_freq_async(
     self->analyzer,
-    self->handle,
+    self->channel_list[index]->handle,
     lofreq,
     0);
 }
 
 SUBOOL
-suscli_chanloop_commit_config(suscli_chanloop_t *self)
+suscli_chanloop_channel_commit_config(
+    suscli_chanloop_t *self,
+    unsigned int index)
 {
+  SU_TRYCATCH(index < self->channel_count, return SU_FALSE);
+
   return suscan_analyzer_set_inspector_config_async(
       self->analyzer,
-      self->handle,
-      self->inspcfg,
+      self->channel_list[index]->handle,
+      self->channel_list[index]->inspcfg,
       0);
 }
 
@@ -309,11 +525,17 @@ suscli_chanloop_cancel(suscli_chanloop_t *self)
 void
 suscli_chanloop_destroy(suscli_chanloop_t *self)
 {
+  unsigned int i;
+
   if (self->analyzer != NULL)
     suscan_analyzer_destroy(self->analyzer);
 
-  if (self->inspcfg != NULL)
-    suscan_config_destroy(self->inspcfg);
+  for (i = 0; i < self->channel_count; ++i)
+    if (self->channel_list[i] != NULL)
+      suscli_chanloop_channel_destroy(self->channel_list[i]);
+
+  if (self->channel_list != NULL)
+    free(self->channel_list);
 
   suscan_analyzer_consume_mq(&self->mq);
 
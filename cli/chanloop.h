@@ -40,21 +40,52 @@ struct suscli_chanloop_params {
   NULL, /* on_data */                           \
 }
 
-struct suscli_chanloop {
+/*
+ * A chanloop drives a set of inspector channels over one analyzer, so
+ * that a single capture can feed several demodulators. Every channel
+ * has its own inspector class, frequency, bandwidth and callbacks.
+ *
+ * Channels are opened one after another. Each one is given its own
+ * inspector ID, which is used to deliver every sample batch to the
+ * callbacks of the channel it belongs to. Batches sent before that ID
+ * takes effect are delivered only if a single channel is waiting for
+ * it, and dropped otherwise. Inspectors whose open request timed out
+ * are closed if they show up later. A channel whose on_data
+ * callback returns SU_FALSE is closed. suscli_chanloop_work() returns
+ * when all channels have been closed, or at the end of the stream.
+ */
+struct suscli_chanloop_channel {
   struct suscli_chanloop_params params;
-  suscan_analyzer_t *analyzer;
-  struct suscan_mq mq;
+  unsigned int index;
   suscan_config_t *inspcfg;
   struct sigutils_channel chan;
   SUHANDLE handle;
-  SUFLOAT equiv_fs;
-  SUFREQ  lnb_freq;
-  SUFREQ  ft;
-  SUFREQ  bw;
+  SUFLOAT  equiv_fs;
+  SUFREQ   ft;
+  SUFREQ   bw;
+  SUBOOL   id_confirmed; /* Samples with its inspector ID were seen */
+  SUBOOL   finished;
+};
+
+struct suscli_chanloop {
+  suscan_analyzer_t *analyzer;
+  struct suscan_mq mq;
+  SUFREQ   lnb_freq;
+  SUSCOUNT samp_rate;
+  unsigned int active; /* Channels that still accept samples */
+  PTR_LIST(struct suscli_chanloop_channel, channel);
 };
 
 typedef struct suscli_chanloop suscli_chanloop_t;
 
+suscli_chanloop_t *suscli_chanloop_new(suscan_source_config_t *cfg);
+
+/* Returns the index of the new channel, or -1 on failure */
+int suscli_chanloop_add_channel(
+    suscli_chanloop_t *self,
+    const struct suscli_chanloop_params *params);
+
+/* Same as suscli_chanloop_new() followed by one add_channel() */
 suscli_chanloop_t *suscli_chanloop_open(
     const struct suscli_chanloop_params *params,
     suscan_source_config_t *cfg);
@@ -63,38 +94,72 @@ SUBOOL suscli_chanloop_work(suscli_chanloop_t *self);
 
 SUBOOL suscli_chanloop_cancel(suscli_chanloop_t *self);
 
-SUBOOL suscli_chanloop_set_lofreq(suscli_chanloop_t *self, SUFREQ);
-
-SUBOOL suscli_chanloop_set_rate(suscli_chanloop_t *self, SUFLOAT);
-
 SUBOOL suscli_chanloop_set_frequency(suscli_chanloop_t *self, SUFREQ freq);
 
-SUBOOL suscli_chanloop_commit_config(suscli_chanloop_t *self);
+SUBOOL suscli_chanloop_channel_set_lofreq(
+    suscli_chanloop_t *self,
+    unsigned int index,
+    SUFREQ lofreq);
+
+SUBOOL suscli_chanloop_channel_commit_config(
+    suscli_chanloop_t *self,
+    unsigned int index);
 
 void suscli_chanloop_destroy(suscli_chanloop_t *self);
 
+SUINLINE unsigned int
+suscli_chanloop_get_channel_count(const suscli_chanloop_t *self)
+{
+  return self->channel_count;
+}
+
+SUINLINE struct suscli_chanloop_channel *
+suscli_chanloop_get_channel(const suscli_chanloop_t *self, unsigned int index)
+{
+  return index < self->channel_count ? self->channel_list[index] : NULL;
+}
+
+SUINLINE SUSCOUNT
+suscli_chanloop_get_samp_rate(const suscli_chanloop_t *self)
+{
+  return self->samp_rate;
+}
+
+/* Single channel interface: these act on the first channel */
+SUINLINE SUBOOL
+suscli_chanloop_set_lofreq(suscli_chanloop_t *self, SUFREQ lofreq)
+{
+  return suscli_chanloop_channel_set_lofreq(self, 0, lofreq);
+}
+
+SUINLINE SUBOOL
+suscli_chanloop_commit_config(suscli_chanloop_t *self)
+{
+  return suscli_chanloop_channel_commit_config(self, 0);
+}
+
 SUINLINE SUFREQ
 suscli_chanloop_get_freq(const suscli_chanloop_t *self)
 {
-  return self->ft;
+  return self->channel_list[0]->ft;
 }
 
 SUINLINE SUFREQ
 suscli_chanloop_get_bandwidth(const suscli_chanloop_t *self)
 {
-  return self->bw;
+  return self->channel_list[0]->bw;
 }
 
 SUINLINE SUFREQ
 suscli_chanloop_get_equiv_fs(const suscli_chanloop_t *self)
 {
-  return self->equiv_fs;
+  return self->channel_list[0]->equiv_fs;
 }
 
 SUINLINE suscan_config_t *
 suscli_chanloop_get_config(const suscli_chanloop_t *self)
 {
-  return self->inspcfg;
+  return self->channel_list[0]->inspcfg;
 }
 
 #endif /* _CLI_CHANLOOP_H */
@@ -571,6 +571,14 @@ suscli_init(void)
           suscli_radio_cb) != -1,
       goto fail);
 
+  SU_TRYCATCH(
+      suscli_command_register(
+          "multichan",
+          "Demodulate several channels of the same capture to files",
+          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_INSPECTORS,
+          suscli_multichan_cb) != -1,
+      goto fail);
+
   SU_TRYCATCH(
       suscli_command_register(
           "profinfo",
@@ -619,6 +627,14 @@ suscli_init(void)
           suscli_snoop_cb) != -1,
       goto fail);
 
+  SU_TRYCATCH(
+      suscli_command_register(
+          "settlecal",
+          "Calibrate the retune settle time of a profile",
+          SUSCLI_COMMAND_REQ_SOURCES,
+          suscli_settlecal_cb) != -1,
+      goto fail);
+
   ok = SU_TRUE;
 
 fail:
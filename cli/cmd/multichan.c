@@ -0,0 +1,785 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-multichan"
+
+#include <sigutils/log.h>
+#include <analyzer/analyzer.h>
+#include <analyzer/inspector/params.h>
+#include <string.h>
+#include <errno.h>
+#include <sndfile.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+#include <cli/chanloop.h>
+#include <cli/datasaver.h>
+
+#include <signal.h>
+
+/*
+ * Demodulates several channels of the same capture, each one to its own
+ * file. Channels are given as a semicolon-separated list, in which each
+ * channel is described as:
+ *
+ *   FREQUENCY,BANDWIDTH,CLASS,SINK[,PATH]
+ *
+ * CLASS is either an audio demodulator (fm, am, usb, lsb) or the name
+ * of an inspector class (raw, psk, fsk...). SINK is one of:
+ *
+ *   wav: real part of the samples, as a 16 bit WAV file (audio only)
+ *   iq:  raw complex samples, as written in memory
+ *   csv: channel power, through a CSV datasaver
+ *   bin: channel power, through a binary datasaver
+ */
+
+#define SUSCLI_MULTICHAN_DEFAULT_SAMPLE_RATE  44100
+#define SUSCLI_MULTICHAN_DEFAULT_INTERVAL_MS  50
+#define SUSCLI_MULTICHAN_DEFAULT_VOLUME_DB    0
+#define SUSCLI_MULTICHAN_DEFAULT_BANDWIDTH    5 /* In audio sample rates */
+#define SUSCLI_MULTICHAN_MAX_FIELDS           5
+
+enum suscli_multichan_sink {
+  SUSCLI_MULTICHAN_SINK_WAV,
+  SUSCLI_MULTICHAN_SINK_IQ,
+  SUSCLI_MULTICHAN_SINK_CSV,
+  SUSCLI_MULTICHAN_SINK_BIN
+};
+
+struct suscli_multichan_state;
+
+struct suscli_multichan_channel {
+  struct suscli_multichan_state *state;
+  unsigned int index;
+
+  SUFREQ  frequency;
+  SUFREQ  bandwidth;
+  char   *class;
+  enum suscan_inspector_audio_demod demod;
+  enum suscli_multichan_sink sink;
+  char   *path;
+
+  /* Sinks */
+  SNDFILE *sf;
+  FILE    *fp;
+  suscli_datasaver_t *ds;
+  SUFLOAT *audio_buffer;
+  SUSCOUNT audio_alloc;
+
+  /* Power measurement */
+  SUFLOAT  power_sum;
+  SUSCOUNT power_count;
+  SUSCOUNT samp_per_update;
+
+  SUSCOUNT samples;
+};
+
+struct suscli_multichan_params {
+  suscan_source_config_t *profile;
+  SUFREQ  frequency;
+  unsigned int samp_rate;
+  SUFLOAT interval;
+  SUFLOAT volume_db;
+  const char *channels;
+  const char *ds_overflow;
+};
+
+struct suscli_multichan_state {
+  struct suscli_multichan_params params;
+  suscli_chanloop_t *chanloop;
+  SUBOOL halting;
+
+  PTR_LIST(struct suscli_multichan_channel, channel);
+};
+
+SUPRIVATE struct suscli_multichan_state *g_state;
+
+/***************************** Channel handling *******************************/
+SUPRIVATE void
+suscli_multichan_channel_destroy(struct suscli_multichan_channel *self)
+{
+  if (self->sf != NULL)
+    sf_close(self->sf);
+
+  if (self->fp != NULL)
+    fclose(self->fp);
+
+  if (self->ds != NULL)
+    suscli_datasaver_destroy(self->ds);
+
+  if (self->audio_buffer != NULL)
+    free(self->audio_buffer);
+
+  if (self->class != NULL)
+    free(self->class);
+
+  if (self->path != NULL)
+    free(self->path);
+
+  free(self);
+}
+
+SUPRIVATE const char *
+suscli_multichan_sink_to_extension(enum suscli_multichan_sink sink)
+{
+  switch (sink) {
+    case SUSCLI_MULTICHAN_SINK_WAV:
+      return "wav";
+
+    case SUSCLI_MULTICHAN_SINK_IQ:
+      return "raw";
+
+    case SUSCLI_MULTICHAN_SINK_CSV:
+      return "csv";
+
+    case SUSCLI_MULTICHAN_SINK_BIN:
+      return "bin";
+  }
+
+  return "dat";
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_parse_sink(const char *value, enum suscli_multichan_sink *sink)
+{
+  if (strcasecmp(value, "wav") == 0)
+    *sink = SUSCLI_MULTICHAN_SINK_WAV;
+  else if (strcasecmp(value, "iq") == 0)
+    *sink = SUSCLI_MULTICHAN_SINK_IQ;
+  else if (strcasecmp(value, "csv") == 0)
+    *sink = SUSCLI_MULTICHAN_SINK_CSV;
+  else if (strcasecmp(value, "bin") == 0)
+    *sink = SUSCLI_MULTICHAN_SINK_BIN;
+  else {
+    SU_ERROR("`%s' is not a valid channel sink\n", value);
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE enum suscan_inspector_audio_demod
+suscli_multichan_parse_demod(const char *value)
+{
+  if (strcasecmp(value, "fm") == 0)
+    return SUSCAN_INSPECTOR_AUDIO_DEMOD_FM;
+  else if (strcasecmp(value, "am") == 0)
+    return SUSCAN_INSPECTOR_AUDIO_DEMOD_AM;
+  else if (strcasecmp(value, "usb") == 0)
+    return SUSCAN_INSPECTOR_AUDIO_DEMOD_USB;
+  else if (strcasecmp(value, "lsb") == 0)
+    return SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB;
+
+  return SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED;
+}
+
+/* Parses FREQUENCY,BANDWIDTH,CLASS,SINK[,PATH] (modifies spec) */
+SUPRIVATE struct suscli_multichan_channel *
+suscli_multichan_channel_new(
+    struct suscli_multichan_state *state,
+    char *spec)
+{
+  struct suscli_multichan_channel *new = NULL;
+  char *fields[SUSCLI_MULTICHAN_MAX_FIELDS];
+  char *sep;
+  unsigned int count = 0;
+
+  while (count < SUSCLI_MULTICHAN_MAX_FIELDS) {
+    fields[count++] = spec;
+    if ((sep = strchr(spec, ',')) == NULL)
+      break;
+    *sep = '\0';
+    spec = sep + 1;
+  }
+
+  if (count < 4 || sep != NULL) {
+    SU_ERROR("Malformed channel description (%d fields)\n", count);
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, struct suscli_multichan_channel);
+
+  new->state = state;
+  new->index = state->channel_count;
+
+  if (sscanf(fields[0], "%lf", &new->frequency) < 1) {
+    SU_ERROR("Invalid channel frequency `%s'\n", fields[0]);
+    goto fail;
+  }
+
+  if (sscanf(fields[1], "%lf", &new->bandwidth) < 1 || new->bandwidth <= 0) {
+    SU_ERROR("Invalid channel bandwidth `%s'\n", fields[1]);
+    goto fail;
+  }
+
+  new->demod = suscli_multichan_parse_demod(fields[2]);
+  SU_TRY_FAIL(
+      new->class = strdup(
+          new->demod != SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED
+          ? "audio"
+          : fields[2]));
+
+  SU_TRY_FAIL(suscli_multichan_parse_sink(fields[3], &new->sink));
+
+  if (new->sink == SUSCLI_MULTICHAN_SINK_WAV
+      && new->demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED) {
+    SU_ERROR(
+        "Channel %d: the wav sink needs an audio demodulator "
+        "(fm, am, usb or lsb), not `%s'\n",
+        new->index,
+        fields[2]);
+    goto fail;
+  }
+
+  if (count > 4 && strlen(fields[4]) > 0) {
+    SU_TRY_FAIL(new->path = strdup(fields[4]));
+  } else {
+    SU_TRY_FAIL(
+        new->path = strbuild(
+            "channel_%d_%.0lf.%s",
+            new->index,
+            new->frequency,
+            suscli_multichan_sink_to_extension(new->sink)));
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscli_multichan_channel_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_channel_open_sink(struct suscli_multichan_channel *self)
+{
+  struct suscli_datasaver_params ds_params;
+  hashlist_t *dshash = NULL;
+  SF_INFO info;
+  char intervalstr[64];
+  SUBOOL ok = SU_FALSE;
+
+  switch (self->sink) {
+    case SUSCLI_MULTICHAN_SINK_WAV:
+      memset(&info, 0, sizeof(SF_INFO));
+      info.samplerate = self->state->params.samp_rate;
+      info.channels   = 1;
+      info.format     = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+
+      if ((self->sf = sf_open(self->path, SFM_WRITE, &info)) == NULL) {
+        SU_ERROR(
+            "Cannot open `%s' for writing: %s\n",
+            self->path,
+            sf_strerror(NULL));
+        goto done;
+      }
+      break;
+
+    case SUSCLI_MULTICHAN_SINK_IQ:
+      if ((self->fp = fopen(self->path, "wb")) == NULL) {
+        SU_ERROR(
+            "Cannot open `%s' for writing: %s\n",
+            self->path,
+            strerror(errno));
+        goto done;
+      }
+      break;
+
+    case SUSCLI_MULTICHAN_SINK_CSV:
+    case SUSCLI_MULTICHAN_SINK_BIN:
+      snprintf(
+          intervalstr,
+          sizeof(intervalstr),
+          "%.3f",
+          self->state->params.interval);
+
+      SU_TRY(dshash = hashlist_new());
+      SU_TRY(hashlist_set(dshash, "path", self->path));
+      SU_TRY(hashlist_set(dshash, "interval", intervalstr));
+
+      memset(&ds_params, 0, sizeof(struct suscli_datasaver_params));
+      SU_TRY(
+          suscli_datasaver_overflow_from_string(
+              self->state->params.ds_overflow,
+              &ds_params.overflow));
+
+      if (self->sink == SUSCLI_MULTICHAN_SINK_CSV)
+        suscli_datasaver_params_init_csv(&ds_params, dshash);
+      else
+        suscli_datasaver_params_init_binary(&ds_params, dshash);
+
+      SU_TRY(self->ds = suscli_datasaver_new(&ds_params));
+      break;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (dshash != NULL)
+    hashlist_destroy(dshash);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_channel_write_audio(
+    struct suscli_multichan_channel *self,
+    const SUCOMPLEX *data,
+    size_t size)
+{
+  SUFLOAT *tmp;
+  size_t i;
+
+  if (size > self->audio_alloc) {
+    SU_TRYCATCH(
+        tmp = realloc(self->audio_buffer, size * sizeof(SUFLOAT)),
+        return SU_FALSE);
+    self->audio_buffer = tmp;
+    self->audio_alloc  = size;
+  }
+
+  for (i = 0; i < size; ++i)
+    self->audio_buffer[i] = SU_C_REAL(data[i]);
+
+#ifdef _SU_SINGLE_PRECISION
+  SU_TRYCATCH(
+      sf_write_float(self->sf, self->audio_buffer, size) == size,
+      return SU_FALSE);
+#else
+  SU_TRYCATCH(
+      sf_write_double(self->sf, self->audio_buffer, size) == size,
+      return SU_FALSE);
+#endif /* _SU_SINGLE_PRECISION */
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_channel_write_power(
+    struct suscli_multichan_channel *self,
+    const SUCOMPLEX *data,
+    size_t size)
+{
+  size_t i;
+
+  /* Update interval is not known until the inspector is open */
+  if (self->samp_per_update == 0)
+    return SU_TRUE;
+
+  for (i = 0; i < size; ++i) {
+    self->power_sum += SU_C_REAL(data[i] * SU_C_CONJ(data[i]));
+
+    if (++self->power_count >= self->samp_per_update) {
+      SU_TRYCATCH(
+          suscli_datasaver_write(
+              self->ds,
+              self->power_sum / self->power_count),
+          return SU_FALSE);
+      self->power_sum   = 0;
+      self->power_count = 0;
+    }
+  }
+
+  return SU_TRUE;
+}
+
+/*
+ * Rate at which the inspector delivers samples: the audio sample rate
+ * for audio, the symbol rate for PSK, FSK and ASK (if the clock is
+ * running), one sample per integration for power and the channel rate
+ * for the rest.
+ */
+SUPRIVATE SUFLOAT
+suscli_multichan_channel_get_output_rate(
+    const struct suscli_multichan_channel *self,
+    const struct suscli_chanloop_channel *chan)
+{
+  const struct suscan_field_value *value, *running;
+  SUFLOAT rate = chan->equiv_fs;
+
+  if (strcmp(self->class, "audio") == 0) {
+    value = suscan_config_get_value(chan->inspcfg, "audio.sample-rate");
+    if (value != NULL && value->as_int > 0)
+      rate = value->as_int;
+  } else if (strcmp(self->class, "psk") == 0
+      || strcmp(self->class, "fsk") == 0
+      || strcmp(self->class, "ask") == 0) {
+    running = suscan_config_get_value(chan->inspcfg, "clock.running");
+    value   = suscan_config_get_value(chan->inspcfg, "clock.baud");
+    if (running != NULL && running->as_bool
+        && value != NULL && value->as_float > 0)
+      rate = value->as_float;
+  } else if (strcmp(self->class, "power") == 0) {
+    value = suscan_config_get_value(chan->inspcfg, "power.integrate-samples");
+    if (value != NULL && value->as_int > 0)
+      rate /= value->as_int;
+  }
+
+  return rate;
+}
+
+/******************************* Chanloop callbacks ***************************/
+SUPRIVATE SUBOOL
+suscli_multichan_on_open_cb(
+    suscan_analyzer_t *analyzer,
+    suscan_config_t *config,
+    void *userdata)
+{
+  struct suscli_multichan_channel *self =
+      (struct suscli_multichan_channel *) userdata;
+
+  if (self->demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED)
+    return SU_FALSE;
+
+  SU_TRYCATCH(
+      suscan_config_set_float(
+          config,
+          "audio.volume",
+          SU_MAG_RAW(self->state->params.volume_db)),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_config_set_float(
+          config,
+          "audio.cutoff",
+          self->state->params.samp_rate / 2),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_config_set_integer(
+          config,
+          "audio.sample-rate",
+          self->state->params.samp_rate),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_config_set_integer(
+          config,
+          "audio.demodulator",
+          self->demod),
+      return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_on_data_cb(
+    suscan_analyzer_t *analyzer,
+    const SUCOMPLEX *data,
+    size_t size,
+    void *userdata)
+{
+  struct suscli_multichan_channel *self =
+      (struct suscli_multichan_channel *) userdata;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->state->halting)
+    return SU_FALSE;
+
+  switch (self->sink) {
+    case SUSCLI_MULTICHAN_SINK_WAV:
+      ok = suscli_multichan_channel_write_audio(self, data, size);
+      break;
+
+    case SUSCLI_MULTICHAN_SINK_IQ:
+      ok = fwrite(data, sizeof(SUCOMPLEX), size, self->fp) == size;
+      break;
+
+    case SUSCLI_MULTICHAN_SINK_CSV:
+    case SUSCLI_MULTICHAN_SINK_BIN:
+      ok = suscli_multichan_channel_write_power(self, data, size);
+      break;
+  }
+
+  if (!ok) {
+    SU_ERROR("Channel %d: failed to write samples\n", self->index);
+    return SU_FALSE;
+  }
+
+  self->samples += size;
+
+  return SU_TRUE;
+}
+
+/******************************* State handling *******************************/
+SUPRIVATE void
+suscli_multichan_state_finalize(struct suscli_multichan_state *self)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->channel_count; ++i)
+    if (self->channel_list[i] != NULL)
+      suscli_multichan_channel_destroy(self->channel_list[i]);
+
+  if (self->channel_list != NULL)
+    free(self->channel_list);
+
+  memset(self, 0, sizeof(struct suscli_multichan_state));
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_params_parse(
+    struct suscli_multichan_params *self,
+    const hashlist_t *p)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+        suscli_param_read_profile(
+            p,
+            "profile",
+            &self->profile),
+        goto fail);
+
+  if (self->profile == NULL) {
+    SU_ERROR("Suscan is unable to load any valid profile\n");
+    goto fail;
+  }
+
+  SU_TRYCATCH(
+      suscli_param_read_double(
+          p,
+          "frequency",
+          &self->frequency,
+          suscan_source_config_get_freq(self->profile)),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_int(
+          p,
+          "samp_rate",
+          (int *) &self->samp_rate,
+          SUSCLI_MULTICHAN_DEFAULT_SAMPLE_RATE),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_float(
+          p,
+          "interval",
+          &self->interval,
+          SUSCLI_MULTICHAN_DEFAULT_INTERVAL_MS),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_float(
+          p,
+          "volume",
+          &self->volume_db,
+          SUSCLI_MULTICHAN_DEFAULT_VOLUME_DB),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "channels",
+          &self->channels,
+          NULL),
+      goto fail);
+
+  /* As in rms: don't stall the analyzer loop on a slow CSV/bin sink */
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "ds-overflow",
+          &self->ds_overflow,
+          "drop-oldest"),
+      goto fail);
+
+  if (self->channels == NULL) {
+    SU_ERROR("No channels given (use channels=FREQ,BW,CLASS,SINK[,PATH];...)\n");
+    goto fail;
+  }
+
+  suscan_source_config_set_freq(self->profile, self->frequency);
+
+  ok = SU_TRUE;
+
+fail:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_state_init(
+    struct suscli_multichan_state *state,
+    const hashlist_t *params)
+{
+  struct suscli_multichan_channel *chan = NULL;
+  char *specs = NULL;
+  char *spec, *sep;
+  SUBOOL ok = SU_FALSE;
+
+  memset(state, 0, sizeof(struct suscli_multichan_state));
+
+  SU_TRY(suscli_multichan_params_parse(&state->params, params));
+  SU_TRY(specs = strdup(state->params.channels));
+
+  for (spec = specs; spec != NULL; spec = sep) {
+    if ((sep = strchr(spec, ';')) != NULL)
+      *sep++ = '\0';
+
+    if (strlen(spec) == 0)
+      continue;
+
+    SU_TRY(chan = suscli_multichan_channel_new(state, spec));
+    SU_TRY(suscli_multichan_channel_open_sink(chan));
+    SU_TRY(PTR_LIST_APPEND_CHECK(state->channel, chan) != -1);
+    chan = NULL;
+  }
+
+  if (state->channel_count == 0) {
+    SU_ERROR("Channel list is empty\n");
+    goto done;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (chan != NULL)
+    suscli_multichan_channel_destroy(chan);
+
+  if (specs != NULL)
+    free(specs);
+
+  if (!ok)
+    suscli_multichan_state_finalize(state);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscli_multichan_state_open_channels(struct suscli_multichan_state *self)
+{
+  struct suscli_chanloop_params chanloop_params =
+      suscli_chanloop_params_INITIALIZER;
+  struct suscli_multichan_channel *chan;
+  SUFLOAT true_rate;
+  unsigned int i;
+  int index;
+  SUBOOL ok = SU_FALSE;
+
+  true_rate = suscli_chanloop_get_samp_rate(self->chanloop);
+
+  for (i = 0; i < self->channel_count; ++i) {
+    chan = self->channel_list[i];
+
+    chanloop_params.on_open  = suscli_multichan_on_open_cb;
+    chanloop_params.on_data  = suscli_multichan_on_data_cb;
+    chanloop_params.userdata = chan;
+    chanloop_params.type     = chan->class;
+    chanloop_params.relbw    = chan->bandwidth / true_rate;
+    chanloop_params.rello    =
+      (chan->frequency - self->params.frequency) / true_rate;
+
+    if (chan->demod != SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED
+        && chan->sink == SUSCLI_MULTICHAN_SINK_WAV
+        && chan->bandwidth
+        < SUSCLI_MULTICHAN_DEFAULT_BANDWIDTH * self->params.samp_rate)
+      SU_WARNING(
+          "Channel %d: bandwidth is narrow for the audio sample rate\n",
+          i);
+
+    if ((index = suscli_chanloop_add_channel(
+        self->chanloop,
+        &chanloop_params)) == -1) {
+      SU_ERROR(
+          "Cannot open channel %d (%.0lf Hz, %s)\n",
+          i,
+          chan->frequency,
+          chan->class);
+      goto done;
+    }
+
+    chan->samp_per_update = SU_CEIL(
+        1e-3 * self->params.interval
+        * suscli_multichan_channel_get_output_rate(
+            chan,
+            suscli_chanloop_get_channel(self->chanloop, index)));
+
+    if (chan->samp_per_update == 0)
+      chan->samp_per_update = 1;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void
+suscli_multichan_state_debug(const struct suscli_multichan_state *self)
+{
+  const struct suscli_multichan_channel *chan;
+  unsigned int i;
+
+  fprintf(stderr, "Channel summary:\n");
+  for (i = 0; i < self->channel_count; ++i) {
+    chan = self->channel_list[i];
+    fprintf(
+        stderr,
+        "  %3d: %.0lf Hz, %8lu samples -> %s\n",
+        i,
+        chan->frequency,
+        (unsigned long) chan->samples,
+        chan->path);
+  }
+}
+
+void
+suscli_multichan_interrupt_handler(int sig)
+{
+  if (g_state != NULL) {
+    SU_INFO("Ctrl+C hit, stopping capture...\n");
+    g_state->halting = SU_TRUE;
+    g_state = NULL;
+  }
+}
+
+SUBOOL
+suscli_multichan_cb(const hashlist_t *params)
+{
+  struct suscli_multichan_state state;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(suscli_multichan_state_init(&state, params), goto fail);
+
+  g_state = &state;
+  signal(SIGINT, suscli_multichan_interrupt_handler);
+
+  SU_TRYCATCH(
+      state.chanloop = suscli_chanloop_new(state.params.profile),
+      goto fail);
+
+  SU_TRYCATCH(suscli_multichan_state_open_channels(&state), goto fail);
+  SU_TRYCATCH(suscli_chanloop_work(state.chanloop), goto fail);
+
+  ok = SU_TRUE;
+
+fail:
+  g_state = NULL;
+
+  if (state.chanloop != NULL) {
+    suscli_chanloop_destroy(state.chanloop);
+    suscli_multichan_state_debug(&state);
+  }
+
+  suscli_multichan_state_finalize(&state);
+
+  return ok;
+}
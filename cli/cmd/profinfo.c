@@ -32,6 +32,20 @@ suscli_profinfo_gain_cb(void *privdata, const char *name, SUFLOAT value)
   return SU_TRUE;
 }
 
+SUPRIVATE SUBOOL
+suscli_profinfo_settle_cb(
+    void *privdata,
+    const struct suscan_source_settle_band *band)
+{
+  printf(
+      "    %.0lf-%.0lf Hz: %lu samples (at %g sps)\n",
+      band->freq_min,
+      band->freq_max,
+      (unsigned long) band->samples,
+      band->samp_rate);
+  return SU_TRUE;
+}
+
 SUBOOL
 suscli_profinfo_cb(const hashlist_t *params)
 {
@@ -88,6 +102,14 @@ suscli_profinfo_cb(const hashlist_t *params)
         profile,
         suscli_profinfo_gain_cb,
         NULL);
+
+    if (suscan_source_config_is_settle_calibrated(profile)) {
+      printf("Retune settle:\n");
+      suscan_source_config_walk_settle_bands(
+          profile,
+          suscli_profinfo_settle_cb,
+          NULL);
+    }
   } else {
     printf("Type:        file\n");
     printf("Format:      ");
@@ -79,6 +79,7 @@ struct suscli_rms_params {
   const char *tcp_host;
   int         tcp_port;
   const char *tcp_desc;
+  const char *tcp_format;
 
   /* MATLAB forwarder */
   SUBOOL matlab_enabled;
@@ -92,6 +93,17 @@ struct suscli_rms_params {
   SUBOOL csv_enabled;
   const char *csv_path;
 
+  /* Binary file forwarder */
+  SUBOOL bin_enabled;
+  const char *bin_path;
+  const char *bin_desc;
+
+  /* Datasaver ring tuning */
+  const char *ds_overflow;
+  int ds_ring_size;
+  int ds_flush_size;
+  int ds_flush_interval;
+
   /* Precalculated terms */
   enum suscli_rms_mode mode_enum;
   SUFLOAT k;
@@ -538,6 +550,14 @@ suscli_rms_params_parse(
           NULL),
       goto fail);
 
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "tcp-format",
+          &self->tcp_format,
+          "text"),
+      goto fail);
+
   SU_TRYCATCH(
       suscli_param_read_bool(
           p,
@@ -586,6 +606,67 @@ suscli_rms_params_parse(
           NULL),
       goto fail);
 
+  SU_TRYCATCH(
+      suscli_param_read_bool(
+          p,
+          "bin",
+          &self->bin_enabled,
+          SU_FALSE),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "bin-path",
+          &self->bin_path,
+          NULL),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "bin-desc",
+          &self->bin_desc,
+          NULL),
+      goto fail);
+
+  /*
+   * Samples are written from the analyzer message loop. Blocking it on
+   * a slow sink would stall the analyzer, so by default the oldest
+   * unsaved samples are dropped. ds-overflow=block keeps every sample.
+   */
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          p,
+          "ds-overflow",
+          &self->ds_overflow,
+          "drop-oldest"),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_int(
+          p,
+          "ds-ring-size",
+          &self->ds_ring_size,
+          0),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_int(
+          p,
+          "ds-flush-size",
+          &self->ds_flush_size,
+          0),
+      goto fail);
+
+  SU_TRYCATCH(
+      suscli_param_read_int(
+          p,
+          "ds-flush-interval",
+          &self->ds_flush_interval,
+          0),
+      goto fail);
+
   self->k = SU_LOG(self->freq_max / self->freq_min);
 
   suscli_rms_params_debug(self);
@@ -600,14 +681,23 @@ fail:
 SUPRIVATE void
 suscli_rms_state_finalize(struct suscli_rms_state *self)
 {
+  struct suscli_datasaver_stats stats;
   unsigned int i;
 
   if (self->player != NULL)
     suscli_audio_player_destroy(self->player);
 
   for (i = 0; i < self->ds_count; ++i)
-    if (self->ds_list[i] != NULL)
+    if (self->ds_list[i] != NULL) {
+      suscli_datasaver_get_stats(self->ds_list[i], &stats);
+      if (stats.dropped > 0 || stats.blocked > 0)
+        SU_WARNING(
+            "Datasaver %d: %lu samples dropped, capture blocked %lu times\n",
+            i,
+            (unsigned long) stats.dropped,
+            (unsigned long) stats.blocked);
       suscli_datasaver_destroy(self->ds_list[i]);
+    }
 
   if (self->ds_list != NULL)
     free(self->ds_list);
@@ -640,6 +730,21 @@ suscli_rms_state_init(
   SU_TRYCATCH(suscli_rms_params_parse(&state->params, params), goto fail);
   SU_TRYCATCH(dshash = hashlist_new(), goto fail);
 
+  /* Ring settings are shared by all datasavers */
+  memset(&ds_params, 0, sizeof(struct suscli_datasaver_params));
+  SU_TRYCATCH(
+      suscli_datasaver_overflow_from_string(
+          state->params.ds_overflow,
+          &ds_params.overflow),
+      goto fail);
+
+  if (state->params.ds_ring_size > 0)
+    ds_params.ring_size = state->params.ds_ring_size;
+  if (state->params.ds_flush_size > 0)
+    ds_params.flush_size = state->params.ds_flush_size;
+  if (state->params.ds_flush_interval > 0)
+    ds_params.flush_interval_ms = state->params.ds_flush_interval;
+
   /* User requested audio play */
   if (state->params.audio) {
     audio_params.userdata  = state;
@@ -690,13 +795,32 @@ suscli_rms_state_init(
     ds = NULL;
   }
 
+  snprintf(
+      intervalstr,
+      sizeof(intervalstr), "%.3f",
+      state->params.rms_interval);
+
+  /* User requested binary file forwarder */
+  if (state->params.bin_enabled) {
+    SU_TRYCATCH(
+        hashlist_set(dshash, "path", (void *) state->params.bin_path),
+        goto fail);
+    SU_TRYCATCH(
+        hashlist_set(dshash, "interval", intervalstr),
+        goto fail);
+    SU_TRYCATCH(
+        hashlist_set(dshash, "desc", (void *) state->params.bin_desc),
+        goto fail);
+
+    suscli_datasaver_params_init_binary(&ds_params, dshash);
+    SU_TRYCATCH(ds = suscli_datasaver_new(&ds_params), goto fail);
+    SU_TRYCATCH(PTR_LIST_APPEND_CHECK(state->ds, ds) != -1, goto fail);
+    ds = NULL;
+  }
+
   /* User requested TCP forwarder */
   if (state->params.tcp_enabled) {
     snprintf(portstr, sizeof(portstr), "%d", state->params.tcp_port);
-    snprintf(
-        intervalstr,
-        sizeof(intervalstr), "%.3f",
-        state->params.rms_interval);
 
     SU_TRYCATCH(
         hashlist_set(dshash, "host", (void *) state->params.tcp_host),
@@ -710,6 +834,9 @@ suscli_rms_state_init(
     SU_TRYCATCH(
         hashlist_set(dshash, "desc", (void *) state->params.tcp_desc),
         goto fail);
+    SU_TRYCATCH(
+        hashlist_set(dshash, "format", (void *) state->params.tcp_format),
+        goto fail);
 
     suscli_datasaver_params_init_tcp(&ds_params, dshash);
 
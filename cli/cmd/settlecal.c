@@ -0,0 +1,111 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-settlecal"
+
+#include <sigutils/log.h>
+#include <analyzer/source.h>
+#include <analyzer/source/settle.h>
+#include <util/confdb.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+
+SUBOOL
+suscli_settlecal_cb(const hashlist_t *params)
+{
+  struct suscan_source_settle_params settle_params =
+    suscan_source_settle_params_INITIALIZER;
+  suscan_source_config_t *profile = NULL;
+  suscan_source_t *source = NULL;
+  SUDOUBLE fmin, fmax;
+  int bands, trials;
+  SUBOOL clear;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_profile(params, "profile", &profile));
+  SU_TRY(suscli_param_read_double(params, "fmin", &fmin, 0));
+  SU_TRY(suscli_param_read_double(params, "fmax", &fmax, 0));
+  SU_TRY(suscli_param_read_int(
+    params,
+    "bands",
+    &bands,
+    SUSCAN_SOURCE_SETTLE_DEFAULT_BANDS));
+  SU_TRY(suscli_param_read_int(
+    params,
+    "trials",
+    &trials,
+    SUSCAN_SOURCE_SETTLE_DEFAULT_TRIALS));
+  SU_TRY(suscli_param_read_bool(params, "clear", &clear, SU_FALSE));
+
+  if (profile == NULL) {
+    fprintf(stderr, "error: no profile given\n");
+    goto done;
+  }
+
+  if (fmax <= fmin) {
+    fprintf(stderr, "error: a valid frequency range (fmin, fmax) is required\n");
+    goto done;
+  }
+
+  if (bands < 1 || trials < 1) {
+    fprintf(stderr, "error: bands and trials must be positive\n");
+    goto done;
+  }
+
+  if (!suscan_source_config_is_real_time(profile)) {
+    fprintf(stderr, "error: settle calibration requires a real time source\n");
+    goto done;
+  }
+
+  settle_params.freq_min = fmin;
+  settle_params.freq_max = fmax;
+  settle_params.bands    = bands;
+  settle_params.trials   = trials;
+
+  SU_MAKE(source, suscan_source, profile);
+  SU_TRY(suscan_source_start_capture(source));
+
+  if (clear)
+    suscan_source_config_clear_settle_bands(profile);
+
+  fprintf(
+    stderr,
+    "Calibrating retune settle time of `%s' (%.0lf-%.0lf Hz, %d bands)...\n",
+    suscan_source_config_get_label(profile),
+    fmin,
+    fmax,
+    bands);
+
+  SU_TRY(suscan_source_calibrate_settle(source, &settle_params, profile));
+  SU_TRY(suscan_confdb_save_all());
+
+  fprintf(stderr, "Calibration saved to profile.\n");
+
+  ok = SU_TRUE;
+
+done:
+  if (source != NULL) {
+    if (suscan_source_is_capturing(source))
+      (void) suscan_source_stop_capture(source);
+    suscan_source_destroy(source);
+  }
+
+  return ok;
+}
@@ -137,12 +137,37 @@ suscli_snoop_msg_debug_psd_msg(
 
   if (msg->measured_samp_rate > 0)
     JSON_MSG_SUFLOAT(measured_samp_rate);
+  JSON_MSG_SUSCOUNT(dropped);
+  JSON_MSG_HANDLE(decimation);
   JSON_MSG_SUSCOUNT(psd_size);
 
   return SU_TRUE;
 }
 
 
+SUPRIVATE SUBOOL
+suscli_snoop_msg_debug_channel_msg(
+  const struct suscan_analyzer_channel_msg *msg)
+{
+  JSON_MSG_HANDLE(channel_count);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscli_snoop_msg_debug_psd_stats_msg(
+  const struct suscan_analyzer_psd_stats_msg *msg)
+{
+  JSON_MSG_INT64(fc);
+  JSON_MSG_TIMEVAL(timestamp);
+  JSON_MSG_SUFLOAT(samp_rate);
+  JSON_MSG_SUFLOAT(window);
+  JSON_MSG_SUSCOUNT(frames);
+  JSON_MSG_SUSCOUNT(size);
+
+  return SU_TRUE;
+}
+
 SUPRIVATE SUBOOL
 suscli_snoop_msg_debug_params(
   const struct suscan_analyzer_params *msg)
@@ -253,6 +278,9 @@ suscli_snoop_msg_debug_source_info(
   JSON_MSG_TIMEVAL(source_time);
   JSON_MSG_TIMEVAL(source_start);
   JSON_MSG_TIMEVAL(source_end);
+  JSON_MSG_BOOL(hw_timestamps);
+  JSON_MSG_SUSCOUNT(overflow_count);
+  JSON_MSG_SUSCOUNT(lost_samples);
 
   printf("  \"antennas\" : [");
   for (i = 0; i < msg->antenna_count; ++i)
@@ -303,10 +331,12 @@ suscli_snoop_msg_debug(uint32_t type, void *message)
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SOURCE_INIT:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_READ_ERROR: 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES_LOST:
       suscli_snoop_msg_debug_status(message);
       break;
     
     case SUSCAN_ANALYZER_MESSAGE_TYPE_CHANNEL:
+      suscli_snoop_msg_debug_channel_msg(message);
       break;
 
     case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
@@ -316,6 +346,10 @@ suscli_snoop_msg_debug(uint32_t type, void *message)
       suscli_snoop_msg_debug_psd_msg(message);
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD_STATS:
+      suscli_snoop_msg_debug_psd_stats_msg(message);
+      break;
+
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
       break;
 
@@ -131,6 +131,92 @@ suscli_tleinfo_doppler(
     printf("Doppler:           %+g Hz\n", -projvel / SPEED_OF_LIGHT_KM_S * freq);
 }
 
+SUPRIVATE SUBOOL
+suscli_tleinfo_passes(
+  const char *catalogue,
+  const xyz_t *site,
+  SUDOUBLE hours,
+  int threads,
+  SUDOUBLE freq)
+{
+  struct sgdp4_pass_request request;
+  struct sgdp4_pass_stats stats;
+  struct sgdp4_pass *pass_list = NULL;
+  orbit_t *orbit_list = NULL;
+  unsigned int orbit_count = 0, pass_count = 0, i;
+  const struct sgdp4_pass *pass;
+  char aos[32], los[32];
+  time_t t;
+  SUBOOL ok = SU_FALSE;
+
+  if (!orbit_list_from_file(catalogue, &orbit_list, &orbit_count)) {
+    SU_ERROR("Cannot load TLE catalogue\n");
+    goto done;
+  }
+
+  memset(&request, 0, sizeof(struct sgdp4_pass_request));
+
+  request.orbit_list  = orbit_list;
+  request.orbit_count = orbit_count;
+  request.site        = *site;
+  request.window      = hours * 3600.;
+  request.threads     = threads;
+  gettimeofday(&request.start, NULL);
+
+  SU_TRYCATCH(
+    sgdp4_predict_passes(&request, &pass_list, &pass_count, &stats),
+    goto done);
+
+  for (i = 0; i < pass_count; ++i) {
+    pass = pass_list + i;
+
+    t = pass->aos.tv_sec;
+    strftime(aos, sizeof(aos), "%Y-%m-%d %H:%M:%S", gmtime(&t));
+    t = pass->los.tv_sec;
+    strftime(los, sizeof(los), "%H:%M:%S", gmtime(&t));
+
+    printf(
+      "%-24s %s - %s UTC  max el %5.1lfº",
+      orbit_list[pass->orbit].name != NULL
+        ? orbit_list[pass->orbit].name
+        : "(unnamed)",
+      aos,
+      los,
+      SU_RAD2DEG(pass->max_elevation));
+
+    /* Approaching satellites (negative range rate) shift upwards */
+    if (freq > 0)
+      printf(
+        "  Doppler %+9.1lf / %+9.1lf Hz",
+        -pass->min_rate / SPEED_OF_LIGHT_KM_S * freq,
+        -pass->max_rate / SPEED_OF_LIGHT_KM_S * freq);
+
+    printf("\n");
+  }
+
+  printf(
+    "\n%u passes of %u satellites (%u never visible, %u failed) "
+    "in %.3lf s: %.1lf passes/s, %" PRIu64 " propagations\n",
+    stats.passes,
+    stats.orbits,
+    stats.skipped,
+    stats.failed,
+    stats.elapsed,
+    stats.elapsed > 0 ? stats.passes / stats.elapsed : 0.,
+    stats.propagations);
+
+  ok = SU_TRUE;
+
+done:
+  if (pass_list != NULL)
+    free(pass_list);
+
+  if (orbit_list != NULL)
+    orbit_list_destroy(orbit_list, orbit_count);
+
+  return ok;
+}
+
 SUBOOL
 suscli_tleinfo_cb(const hashlist_t *params)
 {
@@ -138,6 +224,7 @@ suscli_tleinfo_cb(const hashlist_t *params)
   sgdp4_ctx_t ctx = sgdp4_ctx_INITIALIZER;
 
   const char *orbit_file = NULL;
+  const char *catalogue = NULL;
   xyz_t pos, vel;
   xyz_t pos_ecef, vel_ecef;
   xyz_t latlon;
@@ -147,6 +234,8 @@ suscli_tleinfo_cb(const hashlist_t *params)
   SUDOUBLE t_epoch;
   SUDOUBLE t0;
   SUDOUBLE freq = 0;
+  SUDOUBLE hours = 24;
+  int threads = 0;
 
   struct timeval tv_now;
   time_t epoch, now;
@@ -183,6 +272,36 @@ suscli_tleinfo_cb(const hashlist_t *params)
     suscli_param_read_double(params, "alt", &site.height, 0.),
     goto done);
 
+  SU_TRYCATCH(
+    suscli_param_read_string(params, "catalogue", &catalogue, NULL),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(params, "hours", &hours, 24),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_int(params, "threads", &threads, 0),
+    goto done);
+
+  if (catalogue != NULL) {
+    if (isinf(site.lat) || isinf(site.lon)) {
+      SU_ERROR("Pass prediction requires a site (lat=<deg> lon=<deg>)\n");
+      goto done;
+    }
+
+    if (hours <= 0 || threads < 0) {
+      SU_ERROR("Invalid prediction window or thread count\n");
+      goto done;
+    }
+
+    site.lat = SU_DEG2RAD(site.lat);
+    site.lon = SU_DEG2RAD(site.lon);
+
+    ok = suscli_tleinfo_passes(catalogue, &site, hours, threads, freq);
+    goto done;
+  }
+
   if (file == NULL) {
     SU_ERROR("Please specify a TLE file with file=<path to TLE>\n");
     goto done;
@@ -198,7 +317,9 @@ suscli_tleinfo_cb(const hashlist_t *params)
   t_epoch = orbit_epoch_to_unix(&orbit);
   epoch = (time_t) t_epoch;
 
-  printf("Spacecraft name:   %s\n", orbit.name);
+  printf(
+    "Spacecraft name:   %s\n",
+    orbit.name != NULL ? orbit.name : "(unnamed)");
   printf("Epoch year:        %d\n", orbit.ep_year);
   printf("Epoch day:         %g\n", orbit.ep_day);
   printf("Drag term (B*):    %g\n", orbit.bstar);
@@ -28,9 +28,11 @@ SUBOOL suscli_profiles_cb(const hashlist_t *params);
 SUBOOL suscli_rms_cb(const hashlist_t *params);
 SUBOOL suscli_profinfo_cb(const hashlist_t *params);
 SUBOOL suscli_radio_cb(const hashlist_t *params);
+SUBOOL suscli_multichan_cb(const hashlist_t *params);
 SUBOOL suscli_devices_cb(const hashlist_t *params);
 SUBOOL suscli_makeprof_cb(const hashlist_t *params);
 SUBOOL suscli_tleinfo_cb(const hashlist_t *params);
 SUBOOL suscli_snoop_cb(const hashlist_t *params);
+SUBOOL suscli_settlecal_cb(const hashlist_t *params);
 
 #endif /* _CLI_CMDS_H */
@@ -20,74 +20,222 @@
 #define SU_LOG_DOMAIN "cli-datasaver"
 
 #include <sigutils/log.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <errno.h>
+#include <strings.h>
+#include <time.h>
 #include "datasaver.h"
 
+/*
+ * Ring indices and counters are free-running 64-bit integers, shared
+ * between the producer and the writer thread without locks.
+ */
+#define ATOMIC_LOAD(ptr)       __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define ATOMIC_INC(ptr, val)   __atomic_add_fetch(ptr, val, __ATOMIC_RELAXED)
+
+SUPRIVATE void
+suscli_datasaver_get_deadline(struct timespec *ts, unsigned int ms)
+{
+  clock_gettime(CLOCK_REALTIME, ts);
+
+  ts->tv_sec  += ms / 1000;
+  ts->tv_nsec += (ms % 1000) * 1000000;
+  if (ts->tv_nsec >= 1000000000) {
+    ts->tv_nsec -= 1000000000;
+    ++ts->tv_sec;
+  }
+}
+
+SUINLINE uint64_t
+suscli_datasaver_pending(suscli_datasaver_t *self)
+{
+  return ATOMIC_LOAD(&self->head) - ATOMIC_LOAD(&self->tail);
+}
+
+/*
+ * Copies everything pending into block_buffer and hands it to the
+ * implementation. With DROP_OLDEST, the producer may overwrite the
+ * slots being copied: these are detected after the copy (by reading
+ * head again) and discarded. This is a seqlock: the producer publishes
+ * head before a release fence and then fills the next slot, so any
+ * overwrite seen by the copy is followed by a head that accounts for
+ * it, once read after the acquire fence below.
+ */
 SUPRIVATE SUBOOL
-suscli_datasaver_writer_cb(
-    struct suscan_mq *mq_out,
-    void *worker_private,
-    void *callback_private)
+suscli_datasaver_drain(suscli_datasaver_t *self)
 {
-  suscli_datasaver_t *self = (suscli_datasaver_t *) worker_private;
-  SUBOOL restart = SU_FALSE;
-  SUSDIFF avail;
+  uint64_t head, tail, lost = 0, first;
+  size_t mask = self->ring_size - 1;
+  size_t count, start, part;
 
-  if (self->failed)
-    goto fail;
+  tail = self->tail;
+  head = ATOMIC_LOAD(&self->head);
+
+  if (head - tail > self->ring_size) {
+    lost += head - tail - self->ring_size;
+    tail  = head - self->ring_size;
+  }
+
+  count = head - tail;
+  if (count == 0)
+    return SU_TRUE;
+
+  start = tail & mask;
+  part  = SU_MIN(count, self->ring_size - start);
+
+  memcpy(
+      self->block_buffer,
+      self->ring + start,
+      part * sizeof(struct suscli_sample));
+  memcpy(
+      self->block_buffer + part,
+      self->ring,
+      (count - part) * sizeof(struct suscli_sample));
+
+  start = 0;
+  if (self->params.overflow == SUSCLI_DATASAVER_OVERFLOW_DROP_OLDEST) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    /* Writing sample n overwrites sample n - ring_size */
+    first = ATOMIC_LOAD(&self->head) + 1;
+    if (first > tail + self->ring_size) {
+      start = SU_MIN(first - self->ring_size - tail, count);
+      lost += start;
+    }
+  }
+
+  ATOMIC_STORE(&self->tail, head);
 
-  /* Determine wether there are pending samples */
-  SU_TRYCATCH(pthread_mutex_lock(&self->mutex) == 0, goto fail);
-  avail = self->block_ptr - self->block_consumed;
-  SU_TRYCATCH(pthread_mutex_unlock(&self->mutex) == 0, goto fail);
+  if (lost > 0)
+    ATOMIC_INC(&self->stats.dropped, lost);
 
-  if (avail > 0) {
-    if (!(self->params.write)(
+  if (start < count) {
+    if (!(self->params.write) (
         self->state,
-        self->block_buffer + self->block_consumed,
-        avail)) {
-      suscan_worker_req_halt(self->worker);
-      self->failed = SU_TRUE;
-      goto fail;
+        self->block_buffer + start,
+        count - start))
+      return SU_FALSE;
+
+    ATOMIC_INC(&self->stats.saved, count - start);
+  }
+
+  ATOMIC_INC(&self->stats.flushes, 1);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void *
+suscli_datasaver_thread(void *userdata)
+{
+  suscli_datasaver_t *self = (suscli_datasaver_t *) userdata;
+  struct timespec ts;
+  SUBOOL halting = SU_FALSE;
+
+  while (!halting) {
+    suscli_datasaver_get_deadline(&ts, self->params.flush_interval_ms);
+
+    (void) pthread_mutex_lock(&self->mutex);
+    while (!self->halting
+        && !self->producer_waiting
+        && suscli_datasaver_pending(self) < self->params.flush_size
+        && pthread_cond_timedwait(
+            &self->writer_cond,
+            &self->mutex,
+            &ts) == 0);
+    halting = self->halting;
+    (void) pthread_mutex_unlock(&self->mutex);
+
+    /* On halt, we still save whatever was left in the ring */
+    if (!suscli_datasaver_drain(self)) {
+      SU_ERROR("Datasaver failed to save samples\n");
+      ATOMIC_STORE(&self->failed, SU_TRUE);
+      halting = SU_TRUE;
     }
+
+    (void) pthread_mutex_lock(&self->mutex);
+    if (self->producer_waiting || halting) {
+      self->producer_waiting = SU_FALSE;
+      (void) pthread_cond_broadcast(&self->room_cond);
+    }
+    (void) pthread_mutex_unlock(&self->mutex);
   }
 
-  /* Check whether we should restart writer */
-  SU_TRYCATCH(pthread_mutex_lock(&self->mutex) != -1, goto fail);
-  self->block_consumed += avail;
-  avail = self->block_ptr - self->block_consumed;
-  if (avail > 0)
-    restart = SU_TRUE;
-  SU_TRYCATCH(pthread_mutex_unlock(&self->mutex) != -1, goto fail);
+  return NULL;
+}
 
-fail:
-   return restart;
+SUBOOL
+suscli_datasaver_overflow_from_string(
+    const char *string,
+    enum suscli_datasaver_overflow *overflow)
+{
+  if (string == NULL || strcasecmp(string, "block") == 0)
+    *overflow = SUSCLI_DATASAVER_OVERFLOW_BLOCK;
+  else if (strcasecmp(string, "drop-newest") == 0)
+    *overflow = SUSCLI_DATASAVER_OVERFLOW_DROP_NEWEST;
+  else if (strcasecmp(string, "drop-oldest") == 0)
+    *overflow = SUSCLI_DATASAVER_OVERFLOW_DROP_OLDEST;
+  else {
+    SU_ERROR("Unknown datasaver overflow policy `%s'\n", string);
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
 }
 
 suscli_datasaver_t *
 suscli_datasaver_new(const struct suscli_datasaver_params *params)
 {
   suscli_datasaver_t *new = NULL;
+  size_t ring_size = 1;
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscli_datasaver_t)), goto fail);
   new->params = *params;
 
+  if (new->params.ring_size == 0)
+    new->params.ring_size = SUSCLI_DATASAVER_BLOCK_SIZE;
+
+  while (ring_size < new->params.ring_size)
+    ring_size <<= 1;
+
+  if (new->params.flush_size == 0)
+    new->params.flush_size = SUSCLI_DATASAVER_FLUSH_SIZE;
+
+  if (new->params.flush_size > ring_size)
+    new->params.flush_size = ring_size;
+
+  if (new->params.flush_interval_ms == 0)
+    new->params.flush_interval_ms = SUSCLI_DATASAVER_FLUSH_INTERVAL_MS;
+
+  new->ring_size = ring_size;
+
   SU_TRYCATCH(
       new->state = (new->params.open)(new->params.userdata),
       goto fail);
 
-  new->block_size = SUSCLI_DATASAVER_BLOCK_SIZE;
   SU_TRYCATCH(
-      new->block_buffer = malloc(
-          new->block_size * sizeof(struct suscli_sample)),
+      new->ring = malloc(ring_size * sizeof(struct suscli_sample)),
+      goto fail);
+
+  SU_TRYCATCH(
+      new->block_buffer = malloc(ring_size * sizeof(struct suscli_sample)),
       goto fail);
 
   SU_TRYCATCH(pthread_mutex_init(&new->mutex, NULL) == 0, goto fail);
   new->have_mutex = SU_TRUE;
 
-  SU_TRYCATCH(suscan_mq_init(&new->mq), goto fail);
-  new->have_mq = SU_TRUE;
+  SU_TRYCATCH(pthread_cond_init(&new->writer_cond, NULL) == 0, goto fail);
+  new->have_writer_cond = SU_TRUE;
 
-  SU_TRYCATCH(new->worker = suscan_worker_new(&new->mq, new), goto fail);
+  SU_TRYCATCH(pthread_cond_init(&new->room_cond, NULL) == 0, goto fail);
+  new->have_room_cond = SU_TRUE;
+
+  SU_TRYCATCH(
+      pthread_create(&new->thread, NULL, suscli_datasaver_thread, new) == 0,
+      goto fail);
+  new->have_thread = SU_TRUE;
 
   return new;
 
@@ -109,6 +257,26 @@ suscli_datasaver_write(
   return suscli_datasaver_write_timestamp(self, &tv, data);
 }
 
+/* Slow path: wait until the writer makes room in the ring */
+SUPRIVATE SUBOOL
+suscli_datasaver_wait_room(suscli_datasaver_t *self)
+{
+  (void) pthread_mutex_lock(&self->mutex);
+
+  while (!ATOMIC_LOAD(&self->failed)
+      && suscli_datasaver_pending(self) >= self->ring_size) {
+    self->producer_waiting = SU_TRUE;
+    (void) pthread_cond_signal(&self->writer_cond);
+    (void) pthread_cond_wait(&self->room_cond, &self->mutex);
+  }
+
+  (void) pthread_mutex_unlock(&self->mutex);
+
+  ATOMIC_INC(&self->stats.blocked, 1);
+
+  return !ATOMIC_LOAD(&self->failed);
+}
+
 SUBOOL
 suscli_datasaver_write_timestamp(
     suscli_datasaver_t *self,
@@ -116,86 +284,362 @@ suscli_datasaver_write_timestamp(
     SUFLOAT data)
 {
   struct suscli_sample *samp;
-  struct suscli_sample *tmp;
-  
-  SUSDIFF avail;
-  SUBOOL ok = SU_FALSE;
-
-  SU_TRYCATCH(!self->failed, goto fail);
-
-  /* Before saving: check whether there's space left for sample */
-  SU_TRYCATCH(pthread_mutex_lock(&self->mutex) == 0, goto fail);
-  if (self->block_ptr == self->block_consumed)
-    self->block_ptr = self->block_consumed = 0;
+  uint64_t head = self->head;
 
-  avail = self->block_size - self->block_ptr;
+  SU_TRYCATCH(!ATOMIC_LOAD(&self->failed), return SU_FALSE);
 
-  if (avail == 0) {
-    tmp = realloc(
-        self->block_buffer,
-        2 * self->block_size * sizeof (struct suscli_sample));
-    if (tmp == NULL) {
-      suscan_worker_req_halt(self->worker);
-      self->failed = SU_TRUE;
-      SU_TRYCATCH(pthread_mutex_unlock(&self->mutex) == 0, goto fail);
-      goto fail;
+  if (self->params.overflow != SUSCLI_DATASAVER_OVERFLOW_DROP_OLDEST
+      && head - ATOMIC_LOAD(&self->tail) >= self->ring_size) {
+    if (self->params.overflow == SUSCLI_DATASAVER_OVERFLOW_DROP_NEWEST) {
+      ATOMIC_INC(&self->stats.dropped, 1);
+      return SU_TRUE;
     }
 
-    self->block_size  *= 2;
-    self->block_buffer = tmp;
-    avail = self->block_size - self->block_ptr;
+    SU_TRYCATCH(suscli_datasaver_wait_room(self), return SU_FALSE);
   }
 
-  samp = self->block_buffer + self->block_ptr;
-  SU_TRYCATCH(pthread_mutex_unlock(&self->mutex) == 0, goto fail);
+  /*
+   * With DROP_OLDEST, the slot may be under copy by the writer. Keep
+   * the previous head store ordered before the slot stores, so that
+   * the writer can tell a torn copy (see suscli_datasaver_drain).
+   */
+  if (self->params.overflow == SUSCLI_DATASAVER_OVERFLOW_DROP_OLDEST)
+    __atomic_thread_fence(__ATOMIC_RELEASE);
 
-  /* Populate sample */
+  samp = self->ring + (head & (self->ring_size - 1));
   samp->timestamp = *tv;
   samp->value     = data;
 
-  /*
-   * Increment block pointer and check whether the writer worker
-   * may not resume writing.
-   */
-  SU_TRYCATCH(pthread_mutex_lock(&self->mutex) == 0, goto fail);
-  avail = self->block_ptr - self->block_consumed;
-  ++self->block_ptr;
-  SU_TRYCATCH(pthread_mutex_unlock(&self->mutex) == 0, goto fail);
+  ATOMIC_STORE(&self->head, head + 1);
+  ATOMIC_INC(&self->stats.written, 1);
 
-  /*
-   * This happens when the worker is not running. Send a
-   * tentative callback.
-   */
-  if (avail == 0)
-    SU_TRYCATCH(
-        suscan_worker_push(
-            self->worker, suscli_datasaver_writer_cb,
-            NULL),
-        goto fail);
+  /* Wake up the writer only when the flush threshold is crossed */
+  if (head + 1 - ATOMIC_LOAD(&self->tail) == self->params.flush_size) {
+    (void) pthread_mutex_lock(&self->mutex);
+    (void) pthread_cond_signal(&self->writer_cond);
+    (void) pthread_mutex_unlock(&self->mutex);
+  }
 
-  ok = SU_TRUE;
+  return SU_TRUE;
+}
 
-fail:
-  return ok;
+void
+suscli_datasaver_get_stats(
+    suscli_datasaver_t *self,
+    struct suscli_datasaver_stats *stats)
+{
+  stats->written = ATOMIC_LOAD(&self->stats.written);
+  stats->saved   = ATOMIC_LOAD(&self->stats.saved);
+  stats->dropped = ATOMIC_LOAD(&self->stats.dropped);
+  stats->blocked = ATOMIC_LOAD(&self->stats.blocked);
+  stats->flushes = ATOMIC_LOAD(&self->stats.flushes);
 }
 
 void
 suscli_datasaver_destroy(suscli_datasaver_t *self)
 {
-  if (self->worker != NULL)
-    suscan_worker_halt(self->worker);
+  if (self->have_thread) {
+    (void) pthread_mutex_lock(&self->mutex);
+    self->halting = SU_TRUE;
+    (void) pthread_cond_signal(&self->writer_cond);
+    (void) pthread_mutex_unlock(&self->mutex);
 
-  if (self->block_buffer != NULL)
-    free(self->block_buffer);
+    (void) pthread_join(self->thread, NULL);
+  }
+
+  if (self->have_room_cond)
+    pthread_cond_destroy(&self->room_cond);
 
-  if (self->have_mq)
-    suscan_mq_finalize(&self->mq);
+  if (self->have_writer_cond)
+    pthread_cond_destroy(&self->writer_cond);
 
   if (self->have_mutex)
     pthread_mutex_destroy(&self->mutex);
 
+  if (self->block_buffer != NULL)
+    free(self->block_buffer);
+
+  if (self->ring != NULL)
+    free(self->ring);
+
   if (self->state != NULL)
     (self->params.close) (self->state);
 
   free(self);
 }
+
+/***************************** Encoding stream ********************************/
+SUBOOL
+suscli_datasaver_format_from_string(
+    const char *string,
+    enum suscli_datasaver_format *format)
+{
+  if (string == NULL
+      || strcasecmp(string, "text") == 0
+      || strcasecmp(string, "csv") == 0)
+    *format = SUSCLI_DATASAVER_FORMAT_TEXT;
+  else if (strcasecmp(string, "binary") == 0
+      || strcasecmp(string, "bin") == 0)
+    *format = SUSCLI_DATASAVER_FORMAT_BINARY;
+  else {
+    SU_ERROR("Unknown datasaver format `%s'\n", string);
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscli_datasaver_stream_init(
+    struct suscli_datasaver_stream *self,
+    enum suscli_datasaver_format format,
+    SUBOOL (*sink) (void *, const void *, size_t),
+    void *userdata)
+{
+  memset(self, 0, sizeof(struct suscli_datasaver_stream));
+
+  SU_TRYCATCH(
+      self->buffer = malloc(SUSCLI_DATASAVER_STREAM_INITIAL_SIZE),
+      return SU_FALSE);
+
+  self->alloc    = SUSCLI_DATASAVER_STREAM_INITIAL_SIZE;
+  self->format   = format;
+  self->sink     = sink;
+  self->userdata = userdata;
+
+  return SU_TRUE;
+}
+
+/* Makes sure that size more bytes fit in the buffer */
+SUPRIVATE SUBOOL
+suscli_datasaver_stream_reserve(
+    struct suscli_datasaver_stream *self,
+    size_t size)
+{
+  size_t alloc = self->alloc;
+  uint8_t *tmp;
+
+  if (self->size + size <= alloc)
+    return SU_TRUE;
+
+  while (self->size + size > alloc)
+    alloc <<= 1;
+
+  SU_TRYCATCH(tmp = realloc(self->buffer, alloc), return SU_FALSE);
+
+  self->buffer = tmp;
+  self->alloc  = alloc;
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscli_datasaver_stream_printf(
+    struct suscli_datasaver_stream *self,
+    const char *fmt,
+    ...)
+{
+  va_list ap;
+  size_t avail;
+  int len;
+  SUBOOL ok = SU_FALSE;
+
+  /* Most of the times, the line fits in what is left of the buffer */
+  avail = self->alloc - self->size;
+  va_start(ap, fmt);
+  len = vsnprintf((char *) self->buffer + self->size, avail, fmt, ap);
+  va_end(ap);
+
+  SU_TRYCATCH(len >= 0, goto done);
+
+  if (len >= avail) {
+    SU_TRYCATCH(suscli_datasaver_stream_reserve(self, len + 1), goto done);
+
+    va_start(ap, fmt);
+    len = vsnprintf(
+        (char *) self->buffer + self->size,
+        self->alloc - self->size,
+        fmt,
+        ap);
+    va_end(ap);
+
+    SU_TRYCATCH(len >= 0, goto done);
+  }
+
+  self->size += len;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUBOOL
+suscli_datasaver_stream_write_header(
+    struct suscli_datasaver_stream *self,
+    SUDOUBLE rate,
+    const char *desc)
+{
+  uint8_t *p;
+  uint32_t bom     = SUSCLI_DATASAVER_BINARY_BOM;
+  uint16_t version = SUSCLI_DATASAVER_BINARY_VERSION;
+  uint16_t recsize = SUSCLI_DATASAVER_BINARY_RECORD_SIZE;
+  uint32_t desclen = desc == NULL ? 0 : strlen(desc);
+  double   drate   = rate;
+
+  SU_TRYCATCH(
+      suscli_datasaver_stream_reserve(
+          self,
+          SUSCLI_DATASAVER_BINARY_HEADER_SIZE + desclen),
+      return SU_FALSE);
+
+  p = self->buffer + self->size;
+
+  memcpy(p,      SUSCLI_DATASAVER_BINARY_MAGIC, 8);
+  memcpy(p + 8,  &bom,     sizeof(uint32_t));
+  memcpy(p + 12, &version, sizeof(uint16_t));
+  memcpy(p + 14, &recsize, sizeof(uint16_t));
+  memcpy(p + 16, &drate,   sizeof(double));
+  memcpy(p + 24, &desclen, sizeof(uint32_t));
+
+  if (desclen > 0)
+    memcpy(p + SUSCLI_DATASAVER_BINARY_HEADER_SIZE, desc, desclen);
+
+  self->size += SUSCLI_DATASAVER_BINARY_HEADER_SIZE + desclen;
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscli_datasaver_stream_write_records(
+    struct suscli_datasaver_stream *self,
+    const struct suscli_sample *samples,
+    size_t length)
+{
+  uint8_t *p;
+  int64_t sec;
+  int32_t usec;
+  float value, db;
+  size_t i;
+
+  SU_TRYCATCH(
+      suscli_datasaver_stream_reserve(
+          self,
+          length * SUSCLI_DATASAVER_BINARY_RECORD_SIZE),
+      return SU_FALSE);
+
+  p = self->buffer + self->size;
+
+  for (i = 0; i < length; ++i) {
+    sec   = samples[i].timestamp.tv_sec;
+    usec  = samples[i].timestamp.tv_usec;
+    value = samples[i].value;
+    db    = SU_POWER_DB_RAW(samples[i].value);
+
+    memcpy(p,      &sec,   sizeof(int64_t));
+    memcpy(p + 8,  &usec,  sizeof(int32_t));
+    memcpy(p + 12, &value, sizeof(float));
+    memcpy(p + 16, &db,    sizeof(float));
+
+    p += SUSCLI_DATASAVER_BINARY_RECORD_SIZE;
+  }
+
+  self->size += length * SUSCLI_DATASAVER_BINARY_RECORD_SIZE;
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscli_datasaver_stream_flush(struct suscli_datasaver_stream *self)
+{
+  SUBOOL ok = SU_TRUE;
+
+  if (self->size > 0) {
+    ok = (self->sink) (self->userdata, self->buffer, self->size);
+    self->size = 0;
+  }
+
+  return ok;
+}
+
+void
+suscli_datasaver_stream_discard(struct suscli_datasaver_stream *self)
+{
+  self->size = 0;
+}
+
+void
+suscli_datasaver_stream_finalize(struct suscli_datasaver_stream *self)
+{
+  if (self->buffer != NULL)
+    free(self->buffer);
+
+  memset(self, 0, sizeof(struct suscli_datasaver_stream));
+}
+
+/******************************** File sink ***********************************/
+SUPRIVATE SUBOOL
+suscli_datasaver_file_sink_cb(void *userdata, const void *data, size_t size)
+{
+  suscli_datasaver_file_t *self = (suscli_datasaver_file_t *) userdata;
+
+  SU_TRYCATCH(fwrite(data, size, 1, self->fp) == 1, return SU_FALSE);
+  SU_TRYCATCH(fflush(self->fp) == 0, return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+suscli_datasaver_file_t *
+suscli_datasaver_file_open(
+    const char *path,
+    char *(*fname) (void),
+    enum suscli_datasaver_format format)
+{
+  suscli_datasaver_file_t *new = NULL;
+  char *new_path = NULL;
+
+  SU_ALLOCATE_FAIL(new, suscli_datasaver_file_t);
+
+  SU_TRY_FAIL(
+      suscli_datasaver_stream_init(
+          &new->stream,
+          format,
+          suscli_datasaver_file_sink_cb,
+          new));
+
+  if (path == NULL || strlen(path) == 0) {
+    SU_TRY_FAIL(new_path = (fname) ());
+    path = new_path;
+  }
+
+  if ((new->fp = fopen(
+          path,
+          format == SUSCLI_DATASAVER_FORMAT_BINARY ? "wb" : "w")) == NULL) {
+    SU_ERROR("Cannot open `%s' for writing: %s\n", path, strerror(errno));
+    goto fail;
+  }
+
+  free(new_path);
+
+  return new;
+
+fail:
+  if (new_path != NULL)
+    free(new_path);
+
+  if (new != NULL)
+    suscli_datasaver_file_close(new);
+
+  return NULL;
+}
+
+void
+suscli_datasaver_file_close(suscli_datasaver_file_t *self)
+{
+  if (self->fp != NULL)
+    fclose(self->fp);
+
+  suscli_datasaver_stream_finalize(&self->stream);
+
+  free(self);
+}
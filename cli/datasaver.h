@@ -24,44 +24,193 @@
 #include <analyzer/analyzer.h>
 #include <hashlist.h>
 #include <sys/time.h>
+#include <stdio.h>
 #include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus*/
 
-#define SUSCLI_DATASAVER_BLOCK_SIZE 4096
+/*
+ * Samples go from the producer to the writer thread through a bounded
+ * single-producer, single-consumer ring. The producer never takes a
+ * lock, except to wake up the writer once every flush_size samples
+ * (or to wait for room, if the overflow policy is BLOCK). The writer
+ * saves everything pending whenever flush_size samples are pending,
+ * or flush_interval_ms after the previous flush, whatever comes first.
+ */
+#define SUSCLI_DATASAVER_BLOCK_SIZE          4096 /* Default ring size */
+#define SUSCLI_DATASAVER_FLUSH_SIZE          256
+#define SUSCLI_DATASAVER_FLUSH_INTERVAL_MS   100
+#define SUSCLI_DATASAVER_STREAM_INITIAL_SIZE 4096
 
 struct suscli_sample {
   struct timeval timestamp;
   SUFLOAT value;
 };
 
+enum suscli_datasaver_overflow {
+  SUSCLI_DATASAVER_OVERFLOW_BLOCK,       /* Wait for the writer */
+  SUSCLI_DATASAVER_OVERFLOW_DROP_NEWEST, /* Discard incoming samples */
+  SUSCLI_DATASAVER_OVERFLOW_DROP_OLDEST  /* Overwrite unsaved samples */
+};
+
+/* Zero ring_size, flush_size or flush_interval_ms mean the default */
 struct suscli_datasaver_params {
   void *userdata;
   char *(*fname) (void);
   void *(*open) (void *userdata);
   SUBOOL (*write) (void *state, const struct suscli_sample *, size_t);
   SUBOOL (*close) (void *state);
+
+  size_t ring_size;
+  size_t flush_size;
+  unsigned int flush_interval_ms;
+  enum suscli_datasaver_overflow overflow;
+};
+
+struct suscli_datasaver_stats {
+  uint64_t written;     /* Samples accepted by the ring */
+  uint64_t saved;       /* Samples handed to the implementation */
+  uint64_t dropped;     /* Samples lost to overflow */
+  uint64_t blocked;     /* Times the producer waited for room */
+  uint64_t flushes;
 };
 
 struct suscli_datasaver {
   struct suscli_datasaver_params params;
   SUBOOL failed;
   void *state;
-  SUBOOL have_mq;
-  SUBOOL have_mutex;
-  suscan_worker_t *worker;
-  struct suscan_mq mq;
+
+  /* Ring. head is written by the producer only, tail by the writer only */
+  struct suscli_sample *ring;
+  size_t   ring_size; /* Power of two */
+  uint64_t head;
+  uint64_t tail;
+  struct suscli_sample *block_buffer; /* Writer-side copy of the ring */
+
+  /* Writer thread */
+  pthread_t       thread;
   pthread_mutex_t mutex;
-  size_t block_size;
-  size_t block_consumed;
-  size_t block_ptr;
-  struct suscli_sample *block_buffer;
+  pthread_cond_t  writer_cond;
+  pthread_cond_t  room_cond;
+  SUBOOL          have_thread;
+  SUBOOL          have_mutex;
+  SUBOOL          have_writer_cond;
+  SUBOOL          have_room_cond;
+  SUBOOL          halting;
+  SUBOOL          producer_waiting;
+
+  struct suscli_datasaver_stats stats;
 };
 
 typedef struct suscli_datasaver suscli_datasaver_t;
 
+/*
+ * Encoding layer shared by the file and network datasavers. Samples
+ * are encoded into a growing buffer, which is handed to the sink in
+ * one call per block of samples (instead of one write per sample).
+ *
+ * Text datasavers keep their own line format and encode through
+ * suscli_datasaver_stream_printf(). Binary datasavers write a header
+ * and fixed-size records:
+ *
+ *   Header:
+ *     0  char[8]  magic "SUSCANDS"
+ *     8  uint32   byte order mark (0x01020304 in the writer's order)
+ *     12 uint16   format version
+ *     14 uint16   record size
+ *     16 float64  sample rate (records per second, 0 if unknown)
+ *     24 uint32   length of the description
+ *     28 char[]   description (no null terminator)
+ *
+ *   Record:
+ *     0  int64    timestamp, seconds
+ *     8  int32    timestamp, microseconds
+ *     12 float32  value
+ *     16 float32  value, in dB
+ *
+ * All fields are in the byte order of the writer, with no padding.
+ */
+#define SUSCLI_DATASAVER_BINARY_MAGIC       "SUSCANDS"
+#define SUSCLI_DATASAVER_BINARY_BOM         0x01020304
+#define SUSCLI_DATASAVER_BINARY_VERSION     1
+#define SUSCLI_DATASAVER_BINARY_HEADER_SIZE 28
+#define SUSCLI_DATASAVER_BINARY_RECORD_SIZE 20
+
+enum suscli_datasaver_format {
+  SUSCLI_DATASAVER_FORMAT_TEXT,
+  SUSCLI_DATASAVER_FORMAT_BINARY
+};
+
+struct suscli_datasaver_stream {
+  enum suscli_datasaver_format format;
+  uint8_t *buffer;
+  size_t   alloc;
+  size_t   size;
+
+  void    *userdata;
+  SUBOOL (*sink) (void *userdata, const void *data, size_t size);
+};
+
+SUBOOL suscli_datasaver_format_from_string(
+    const char *string,
+    enum suscli_datasaver_format *format);
+
+SUBOOL suscli_datasaver_stream_init(
+    struct suscli_datasaver_stream *self,
+    enum suscli_datasaver_format format,
+    SUBOOL (*sink) (void *, const void *, size_t),
+    void *userdata);
+
+SUINLINE SUBOOL
+suscli_datasaver_stream_is_binary(const struct suscli_datasaver_stream *self)
+{
+  return self->format == SUSCLI_DATASAVER_FORMAT_BINARY;
+}
+
+SUBOOL suscli_datasaver_stream_printf(
+    struct suscli_datasaver_stream *self,
+    const char *fmt,
+    ...);
+
+SUBOOL suscli_datasaver_stream_write_header(
+    struct suscli_datasaver_stream *self,
+    SUDOUBLE rate,
+    const char *desc);
+
+SUBOOL suscli_datasaver_stream_write_records(
+    struct suscli_datasaver_stream *self,
+    const struct suscli_sample *samples,
+    size_t length);
+
+/* Pending data is discarded even if the sink fails */
+SUBOOL suscli_datasaver_stream_flush(struct suscli_datasaver_stream *self);
+
+void suscli_datasaver_stream_discard(struct suscli_datasaver_stream *self);
+
+void suscli_datasaver_stream_finalize(struct suscli_datasaver_stream *self);
+
+/*
+ * File-backed stream, shared by the file datasavers. If path is NULL or
+ * empty, the file name is generated by fname. Whatever is flushed from
+ * the stream is written to the file and flushed to the OS right away.
+ * Headers are left to the caller.
+ */
+struct suscli_datasaver_file {
+  FILE *fp;
+  struct suscli_datasaver_stream stream;
+};
+
+typedef struct suscli_datasaver_file suscli_datasaver_file_t;
+
+suscli_datasaver_file_t *suscli_datasaver_file_open(
+    const char *path,
+    char *(*fname) (void),
+    enum suscli_datasaver_format format);
+
+void suscli_datasaver_file_close(suscli_datasaver_file_t *self);
+
 SUINLINE char *
 suscli_datasaver_get_filename(const struct suscli_datasaver_params *params)
 {
@@ -74,6 +223,14 @@ suscli_datasaver_t *suscli_datasaver_new(
 SUBOOL suscli_datasaver_write(suscli_datasaver_t *, SUFLOAT);
 SUBOOL suscli_datasaver_write_timestamp(suscli_datasaver_t *, const struct timeval *, SUFLOAT);
 
+void suscli_datasaver_get_stats(
+    suscli_datasaver_t *,
+    struct suscli_datasaver_stats *);
+
+SUBOOL suscli_datasaver_overflow_from_string(
+    const char *string,
+    enum suscli_datasaver_overflow *overflow);
+
 void suscli_datasaver_destroy(suscli_datasaver_t *);
 
 /***************************** Implementations ********************************/
@@ -86,6 +243,9 @@ void suscli_datasaver_params_init_mat5(
 void suscli_datasaver_params_init_csv(
     struct suscli_datasaver_params *self,
     const hashlist_t *params);
+void suscli_datasaver_params_init_binary(
+    struct suscli_datasaver_params *self,
+    const hashlist_t *params);
 void suscli_datasaver_params_init_tcp(
     struct suscli_datasaver_params *self,
     const hashlist_t *params);
@@ -0,0 +1,141 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "binary-datasaver"
+
+#include <sigutils/log.h>
+#include <cli/datasaver.h>
+#include <cli/cli.h>
+#include <errno.h>
+#include <sigutils/util/compat-time.h>
+#include <string.h>
+
+/*
+ * Same samples as the CSV datasaver, in the binary record format
+ * described in datasaver.h. Records are written in blocks, with no
+ * formatting involved.
+ */
+
+SUPRIVATE char *
+suscli_binary_datasaver_fname_cb(void)
+{
+  time_t now;
+  struct tm tm;
+
+  time(&now);
+  gmtime_r(&now, &tm);
+
+  return strbuild(
+            "capture_%04d%02d%02d_%02d%02d%02d.bin",
+            tm.tm_year + 1900,
+            tm.tm_mon + 1,
+            tm.tm_mday,
+            tm.tm_hour,
+            tm.tm_min,
+            tm.tm_sec);
+}
+
+SUPRIVATE suscli_datasaver_file_t *
+suscli_binary_datasaver_new(
+    const char *path,
+    SUFLOAT interval,
+    const char *desc)
+{
+  suscli_datasaver_file_t *new = NULL;
+
+  SU_TRY_FAIL(
+      new = suscli_datasaver_file_open(
+          path,
+          suscli_binary_datasaver_fname_cb,
+          SUSCLI_DATASAVER_FORMAT_BINARY));
+
+  SU_TRY_FAIL(
+      suscli_datasaver_stream_write_header(
+          &new->stream,
+          interval > 0 ? 1e3 / interval : 0,
+          desc));
+  SU_TRY_FAIL(suscli_datasaver_stream_flush(&new->stream));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscli_datasaver_file_close(new);
+
+  return NULL;
+}
+
+SUPRIVATE void *
+suscli_binary_datasaver_open_cb(void *userdata)
+{
+  const char *path = NULL;
+  const char *desc = NULL;
+  SUFLOAT interval;
+  const hashlist_t *params = (const hashlist_t *) userdata;
+
+  SU_TRYCATCH(
+      suscli_param_read_string(params, "path", &path, NULL),
+      return NULL);
+
+  SU_TRYCATCH(
+      suscli_param_read_float(params, "interval", &interval, 0),
+      return NULL);
+
+  SU_TRYCATCH(
+      suscli_param_read_string(params, "desc", &desc, NULL),
+      return NULL);
+
+  return suscli_binary_datasaver_new(path, interval, desc);
+}
+
+SUPRIVATE SUBOOL
+suscli_binary_datasaver_write_cb(
+    void *state,
+    const struct suscli_sample *samples,
+    size_t length)
+{
+  suscli_datasaver_file_t *self = (suscli_datasaver_file_t *) state;
+
+  SU_TRYCATCH(
+      suscli_datasaver_stream_write_records(&self->stream, samples, length),
+      return SU_FALSE);
+
+  return suscli_datasaver_stream_flush(&self->stream);
+}
+
+SUPRIVATE SUBOOL
+suscli_binary_datasaver_close_cb(void *state)
+{
+  suscli_datasaver_file_t *self = (suscli_datasaver_file_t *) state;
+
+  suscli_datasaver_file_close(self);
+
+  return SU_TRUE;
+}
+
+void
+suscli_datasaver_params_init_binary(
+    struct suscli_datasaver_params *self,
+    const hashlist_t *params) {
+  self->userdata = (void *) params;
+  self->fname = suscli_binary_datasaver_fname_cb;
+  self->open  = suscli_binary_datasaver_open_cb;
+  self->write = suscli_binary_datasaver_write_cb;
+  self->close = suscli_binary_datasaver_close_cb;
+}
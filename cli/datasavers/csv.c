@@ -45,38 +45,30 @@ suscli_csv_datasaver_fname_cb(void)
             tm.tm_sec);
 }
 
-SUPRIVATE FILE *
-suscli_csv_fopen(const char *path)
+SUPRIVATE suscli_datasaver_file_t *
+suscli_csv_datasaver_new(const char *path)
 {
-  FILE *fp = NULL;
-  char *new_path = NULL;
-  
-  SUBOOL ok = SU_FALSE;
-
-  if (path == NULL || strlen(path) == 0) {
-    SU_TRYCATCH(new_path = suscli_csv_datasaver_fname_cb(), goto fail);
-    path = new_path;
-  }
+  suscli_datasaver_file_t *new = NULL;
 
-  if ((fp = fopen(path, "w")) == NULL) {
-    SU_ERROR("Cannot open `%s' for writing: %s\n", path, strerror(errno));
-    goto fail;
-  }
+  SU_TRY_FAIL(
+      new = suscli_datasaver_file_open(
+          path,
+          suscli_csv_datasaver_fname_cb,
+          SUSCLI_DATASAVER_FORMAT_TEXT));
 
-  SU_TRYCATCH(fprintf(fp, "timestamp_sec,timestamp_usec,value,value_db\n") > 0, goto fail);
+  SU_TRY_FAIL(
+      suscli_datasaver_stream_printf(
+          &new->stream,
+          "timestamp_sec,timestamp_usec,value,value_db\n"));
+  SU_TRY_FAIL(suscli_datasaver_stream_flush(&new->stream));
 
-  ok = SU_TRUE;
+  return new;
 
 fail:
-  if (new_path != NULL)
-    free(new_path);
+  if (new != NULL)
+    suscli_datasaver_file_close(new);
 
-  if (!ok && fp != NULL) {
-    fclose(fp);
-    fp = NULL;
-  }
-
-  return fp;
+  return NULL;
 }
 
 SUPRIVATE void *
@@ -89,7 +81,7 @@ suscli_csv_datasaver_open_cb(void *userdata)
       suscli_param_read_string(params, "path", &path, NULL),
       return NULL);
 
-  return suscli_csv_fopen(path);
+  return suscli_csv_datasaver_new(path);
 }
 
 SUPRIVATE SUBOOL
@@ -98,32 +90,31 @@ suscli_csv_datasaver_write_cb(
     const struct suscli_sample *samples,
     size_t length)
 {
-  FILE *fp = (FILE *) state;
+  suscli_datasaver_file_t *self = (suscli_datasaver_file_t *) state;
   int i;
 
+  /* Lines are formatted in memory and written once per block */
   for (i = 0; i < length; ++i) {
     SU_TRYCATCH(
-        fprintf(
-            fp,
+        suscli_datasaver_stream_printf(
+            &self->stream,
             "%ld,%d,%.9e,%g\n",
             samples[i].timestamp.tv_sec,
             (int) samples[i].timestamp.tv_usec,
             samples[i].value,
-            SU_POWER_DB_RAW(samples[i].value)) > 0,
+            SU_POWER_DB_RAW(samples[i].value)),
         return SU_FALSE);
   }
 
-  fflush(fp);
-  
-  return SU_TRUE;
+  return suscli_datasaver_stream_flush(&self->stream);
 }
 
 SUPRIVATE SUBOOL
 suscli_csv_datasaver_close_cb(void *state)
 {
-  FILE *fp = (FILE *) state;
+  suscli_datasaver_file_t *self = (suscli_datasaver_file_t *) state;
 
-  fclose(fp);
+  suscli_datasaver_file_close(self);
 
   return SU_TRUE;
 }
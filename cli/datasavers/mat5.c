@@ -115,6 +115,14 @@ suscli_mat5_datasaver_open_cb(void *userdata)
   return suscli_mat5_fopen(path, tv);
 }
 
+/*
+ * This datasaver does not encode through suscli_datasaver_stream. The
+ * MAT5 container (element tags, padding and the size of the streaming
+ * matrix, which must be patched as it grows) is handled by sigutils'
+ * su_mat_file_t. Samples are still batched, as su_mat_file_t queues the
+ * streamed columns and writes them out in su_mat_file_flush(), once per
+ * block.
+ */
 SUPRIVATE SUBOOL
 suscli_mat5_datasaver_write_cb(
     void *state,
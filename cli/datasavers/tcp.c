@@ -31,7 +31,6 @@
 #include <time.h>
 #include <string.h>
 #include <unistd.h>
-#include <stdarg.h>
 
 #ifndef MSG_NOSIGNAL
 #  define MSG_NOSIGNAL 0
@@ -82,6 +81,7 @@ struct tcp_datasaver {
   int fd;
   SUBOOL write_ready;
   SUBOOL retry;
+  struct suscli_datasaver_stream stream;
 };
 
 typedef struct tcp_datasaver tcp_datasaver_t;
@@ -98,6 +98,29 @@ suscli_tcp_get_hostname(void)
   return g_hostname;
 }
 
+/* Blocking socket: send() may still return before sending everything */
+SUPRIVATE SUBOOL
+suscli_tcp_datasaver_sink_cb(void *userdata, const void *data, size_t size)
+{
+  tcp_datasaver_t *self = (tcp_datasaver_t *) userdata;
+  const uint8_t *p = (const uint8_t *) data;
+  ssize_t sent;
+
+  while (size > 0) {
+    sent = send(self->fd, p, size, MSG_NOSIGNAL);
+    if (sent == -1 && errno == EINTR)
+      continue;
+
+    if (sent <= 0)
+      return SU_FALSE;
+
+    p    += sent;
+    size -= sent;
+  }
+
+  return SU_TRUE;
+}
+
 SU_COLLECTOR(tcp_datasaver)
 {
   if (self->host != NULL)
@@ -113,7 +136,9 @@ SU_COLLECTOR(tcp_datasaver)
     (void) shutdown(self->fd, SHUT_RDWR);
 #endif /* _WIN32 */
   }
-  
+
+  suscli_datasaver_stream_finalize(&self->stream);
+
   free(self);
 }
 
@@ -123,12 +148,20 @@ SU_INSTANCER(
   const char *host, 
   uint16_t port,
   SUFLOAT interval,
-  SUBOOL retry)
+  SUBOOL retry,
+  enum suscli_datasaver_format format)
 {
   tcp_datasaver_t *new = NULL;
 
   SU_ALLOCATE_FAIL(new, tcp_datasaver_t);
 
+  SU_TRY_FAIL(
+      suscli_datasaver_stream_init(
+          &new->stream,
+          format,
+          suscli_tcp_datasaver_sink_cb,
+          new));
+
   new->retry       = retry;
   new->write_ready = SU_FALSE;
   new->interval    = interval;
@@ -150,25 +183,43 @@ fail:
   return NULL;
 }
 
-SUPRIVATE SUBOOL
-sockprintf(int fd, const char *fmt, ...)
+SU_METHOD(tcp_datasaver, SUBOOL, send_header)
 {
-  char *buf = NULL;
+  char *desc = NULL;
   SUBOOL ok = SU_FALSE;
-  va_list ap;
 
-  va_start(ap, fmt);
+  if (self->desc == NULL)
+    SU_TRY(
+        desc = strbuild(
+            "suscli@%s (%d)",
+            suscli_tcp_get_hostname(),
+            getpid()));
+
+  /* Whatever was left from a previous connection is stale now */
+  suscli_datasaver_stream_discard(&self->stream);
+
+  if (suscli_datasaver_stream_is_binary(&self->stream)) {
+    SU_TRY(
+        suscli_datasaver_stream_write_header(
+            &self->stream,
+            1e3 / self->interval,
+            desc == NULL ? self->desc : desc));
+  } else {
+    SU_TRY(
+        suscli_datasaver_stream_printf(
+            &self->stream,
+            "RATE,%.6f\nDESC,%s\n",
+            1e3 / self->interval,
+            desc == NULL ? self->desc : desc));
+  }
 
-  SU_TRY(buf = vstrbuild(fmt, ap));
-  SU_TRY(send(fd, buf, strlen(buf), MSG_NOSIGNAL) == strlen(buf));
+  SU_TRY(suscli_datasaver_stream_flush(&self->stream));
 
   ok = SU_TRUE;
 
 done:
-  if (buf != NULL)
-    free(buf);
-  
-  va_end(ap);
+  if (desc != NULL)
+    free(desc);
 
   return ok;
 }
@@ -244,18 +295,7 @@ SU_METHOD(tcp_datasaver, SUBOOL, check_transition)
         self->write_ready = SU_TRUE;    /* Transition to CONNECTED */
         SU_TRYC(fcntl(self->fd, F_SETFL, 0)); /* Back to blocking mode. */
 
-        SU_TRY(sockprintf(self->fd, "RATE,%.6f\n", 1e3 / self->interval));
-        if (self->desc == NULL)
-          sockprintf(
-              self->fd,
-              "DESC,suscli@%s (%d)\n",
-              suscli_tcp_get_hostname(),
-              getpid());
-        else
-          sockprintf(
-              self->fd,
-              "DESC,%s\n",
-              self->desc);
+        SU_TRY(tcp_datasaver_send_header(self));
       } else {
         if (self->retry) {
           if (log_messages)
@@ -309,6 +349,8 @@ suscli_tcp_datasaver_open_cb(void *userdata)
 {
   const char *host = NULL;
   const char *desc = NULL;
+  const char *format = NULL;
+  enum suscli_datasaver_format fmt;
   SUBOOL retry;
   SUFLOAT interval;
   int port;
@@ -354,10 +396,20 @@ suscli_tcp_datasaver_open_cb(void *userdata)
           NULL),
       return NULL);
 
+  SU_TRYCATCH(
+      suscli_param_read_string(
+          params,
+          "format",
+          &format,
+          NULL),
+      return NULL);
+
+  SU_TRYCATCH(suscli_datasaver_format_from_string(format, &fmt), return NULL);
+
   if (port == 0)
     port = SUSCLI_DATASAVER_TCP_DEFAULT_PORT;
 
-  return tcp_datasaver_new(desc, host, port, interval, retry);
+  return tcp_datasaver_new(desc, host, port, interval, retry, fmt);
 }
 
 SUPRIVATE SUBOOL
@@ -369,6 +421,7 @@ suscli_tcp_datasaver_write_cb(
   tcp_datasaver_t *self = (tcp_datasaver_t *) state;
   struct timeval tv, diff;
   SUBOOL log_messages;
+  SUBOOL ok = SU_TRUE;
   int i;
 
   if (!tcp_datasaver_check_transition(self))
@@ -379,24 +432,38 @@ suscli_tcp_datasaver_write_cb(
   log_messages = diff.tv_sec >= SUSCLI_DATASAVER_TCP_LOG_DELAY;
 
   if (CONNECTED(self)) {
-    for (i = 0; i < length; ++i) {
-      if (!sockprintf(
-        self->fd,
-        "%ld,%.6lf,%.9e,%g\n",
-        samples[i].timestamp.tv_sec,
-        samples[i].timestamp.tv_usec * 1e-6,
-        samples[i].value,
-        SU_POWER_DB_RAW(samples[i].value))) {
-        if (self->retry) {
-          if (log_messages)
-            SU_WARNING("Failed to send message. Retrying...\n");
-          self->write_ready = SU_FALSE;
-          close(self->fd);
-          self->fd = -1; /* Transition to BINDING */
-        } else {
-          SU_ERROR("Failed to send RMS message. Closing datasaver.\n");
-          return SU_FALSE;
-        }
+    /* The whole block goes out in as few send() calls as possible */
+    if (suscli_datasaver_stream_is_binary(&self->stream)) {
+      ok = suscli_datasaver_stream_write_records(
+          &self->stream,
+          samples,
+          length);
+    } else {
+      for (i = 0; ok && i < length; ++i)
+        ok = suscli_datasaver_stream_printf(
+            &self->stream,
+            "%ld,%.6lf,%.9e,%g\n",
+            samples[i].timestamp.tv_sec,
+            samples[i].timestamp.tv_usec * 1e-6,
+            samples[i].value,
+            SU_POWER_DB_RAW(samples[i].value));
+    }
+
+    if (!ok) {
+      SU_ERROR("Failed to encode RMS messages. Closing datasaver.\n");
+      return SU_FALSE;
+    }
+
+    if (!suscli_datasaver_stream_flush(&self->stream)) {
+      if (self->retry) {
+        if (log_messages)
+          SU_WARNING("Failed to send message. Retrying...\n");
+        self->write_ready = SU_FALSE;
+        close(self->fd);
+        self->fd = -1; /* Transition to BINDING */
+      } else {
+        SU_ERROR("Failed to send RMS message. Closing datasaver.\n");
+        return SU_FALSE;
       }
     }
   }
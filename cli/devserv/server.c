@@ -935,6 +935,14 @@ suscli_analyzer_server_deliver_call(
           goto done);
       break;
 
+    case SUSCAN_ANALYZER_REMOTE_SET_MAX_REVISIT_INTERVAL:
+      SU_TRYCATCH(
+          suscan_analyzer_set_max_revisit_interval(
+              self->analyzer,
+              call->max_revisit_int),
+          goto done);
+      break;
+
     case SUSCAN_ANALYZER_REMOTE_MESSAGE:
       ok = SU_FALSE;
       if (call->msg.type == SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR)
@@ -73,12 +73,10 @@ gstime(SUDOUBLE jdut1)
     * ut1 + 67310.54841;  /* seconds */
 
   /* A day is worth 1 / 240 of a year */
-  gst = fmod(SU_DEG2RAD(gst) / 240.0, 2 * PI);
+  gst = SU_DEG2RAD(gst) / 240.0;
 
-  if (gst < 0.0)
-    gst += 2 * PI;
-
-  return gst;
+  /* Same as fmod() + wrap, but vectorisable */
+  return gst - 2 * PI * floor(gst / (2 * PI));
 }
 
 SUPRIVATE void 
@@ -165,6 +163,68 @@ xyz_teme_to_ecef(
   }
 }
 
+void
+xyz_teme_to_ecef_many(
+  const SUDOUBLE *jdut1,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  const xyz_array_t *ecef_pos,
+  const xyz_array_t *ecef_vel)
+{
+  const SUDOUBLE omegaearth = 7.29211514670698e-05 * (1.0  - 0.0015563/86400.0);
+  SUDOUBLE gmst;
+  SUDOUBLE st[3][3];
+  SUDOUBLE pm[3][3];
+  xyz_t r, v, rpef, vpef, out;
+  unsigned int i;
+
+  /* Same as xyz_teme_to_ecef(), with the rotations inlined */
+  for (i = 0; i < count; ++i) {
+    gmst = gstime(jdut1[i] + _SGDP4_LEAP_SECONDS / (3600. * 24.));
+
+    st[0][0] = cos(gmst);
+    st[0][1] = -sin(gmst);
+    st[0][2] = 0.0;
+    st[1][0] = sin(gmst);
+    st[1][1] = cos(gmst);
+    st[1][2] = 0.0;
+    st[2][0] = 0.0;
+    st[2][1] = 0.0;
+    st[2][2] = 1.0;
+
+    polarm(jdut1[i], pm);
+
+    r.x = pos->x[i];
+    r.y = pos->y[i];
+    r.z = pos->z[i];
+
+    XYZ_MATMUL(&rpef, st, &r);
+    XYZ_MATMUL(&out, pm, &rpef);
+
+    ecef_pos->x[i] = out.x;
+    ecef_pos->y[i] = out.y;
+    ecef_pos->z[i] = out.z;
+
+    if (vel != NULL) {
+      v.x = vel->x[i];
+      v.y = vel->y[i];
+      v.z = vel->z[i];
+
+      XYZ_MATMUL(&vpef, st, &v);
+
+      vpef.x += omegaearth * rpef.y;
+      vpef.y -= omegaearth * rpef.x;
+
+      XYZ_MATMUL(&out, pm, &vpef);
+
+      ecef_vel->x[i] = out.x;
+      ecef_vel->y[i] = out.y;
+      ecef_vel->z[i] = out.z;
+    }
+  }
+}
+
 #define XYZ_TOL   1e-8
 #define EARTHECC2 .006694385000 /* Eccentricity of Earth^2 */
 
@@ -291,6 +351,93 @@ xyz_ecef_to_razel(
   }
 }
 
+void
+xyz_ecef_to_razel_many(
+  unsigned int count,
+  const xyz_array_t *pos_ecef,
+  const xyz_array_t *vel_ecef,
+  const xyz_t *geo,
+  const xyz_array_t *pos_azel,
+  const xyz_array_t *vel_azel)
+{
+  xyz_t site_ecef;
+  xyz_t rho_ecef, drho_ecef, tmp_vec, rho_sez, drho_sez;
+  SUDOUBLE dist, rho_norm, tmp, el, az, rate;
+  SUDOUBLE sin_lon, cos_lon, sin_colat, cos_colat;
+  SUBOOL zenith;
+  unsigned int i;
+
+  /* Site-dependent terms of xyz_ecef_to_razel() */
+  xyz_geodetic_to_ecef(geo, &site_ecef);
+
+  sin_lon   = sin(geo->lon);
+  cos_lon   = cos(geo->lon);
+  sin_colat = sin(.5 * PI - geo->lat);
+  cos_colat = cos(.5 * PI - geo->lat);
+
+  for (i = 0; i < count; ++i) {
+    rho_ecef.x = pos_ecef->x[i] - site_ecef.x;
+    rho_ecef.y = pos_ecef->y[i] - site_ecef.y;
+    rho_ecef.z = pos_ecef->z[i] - site_ecef.z;
+
+    if (vel_ecef != NULL) {
+      drho_ecef.x = vel_ecef->x[i];
+      drho_ecef.y = vel_ecef->y[i];
+      drho_ecef.z = vel_ecef->z[i];
+    } else {
+      drho_ecef.x = drho_ecef.y = drho_ecef.z = 0;
+    }
+
+    dist = XYZ_NORM(&rho_ecef);
+
+    /* XYZ_ROT3 and XYZ_ROT2, with precomputed sines and cosines */
+    tmp_vec.x = cos_lon * rho_ecef.x + sin_lon * rho_ecef.y;
+    tmp_vec.y = cos_lon * rho_ecef.y - sin_lon * rho_ecef.x;
+    tmp_vec.z = rho_ecef.z;
+
+    rho_sez.x = cos_colat * tmp_vec.x - sin_colat * tmp_vec.z;
+    rho_sez.y = tmp_vec.y;
+    rho_sez.z = cos_colat * tmp_vec.z + sin_colat * tmp_vec.x;
+
+    tmp_vec.x = cos_lon * drho_ecef.x + sin_lon * drho_ecef.y;
+    tmp_vec.y = cos_lon * drho_ecef.y - sin_lon * drho_ecef.x;
+    tmp_vec.z = drho_ecef.z;
+
+    drho_sez.x = cos_colat * tmp_vec.x - sin_colat * tmp_vec.z;
+    drho_sez.y = tmp_vec.y;
+    drho_sez.z = cos_colat * tmp_vec.z + sin_colat * tmp_vec.x;
+
+    tmp      = sqrt(rho_sez.x * rho_sez.x + rho_sez.y * rho_sez.y);
+    rho_norm = XYZ_NORM(&rho_sez);
+    zenith   = fabs(tmp) <= XYZ_TOL;
+
+    el = zenith
+      ? SIGN(rho_sez.x) * .5 * PI
+      : asin(rho_sez.z / rho_norm);
+    az = zenith
+      ? atan2(drho_sez.y, -drho_sez.x)
+      : atan2(rho_sez.y, -rho_sez.x);
+
+    pos_azel->azimuth[i]   = az;
+    pos_azel->elevation[i] = el;
+    pos_azel->distance[i]  = dist;
+
+    if (vel_azel != NULL) {
+      rate = (rho_sez.x * drho_sez.x
+        + rho_sez.y * drho_sez.y
+        + rho_sez.z * drho_sez.z) / dist;
+
+      vel_azel->distance[i]  = rate;
+      vel_azel->azimuth[i]   = fabs(tmp * tmp) <= XYZ_TOL
+        ? 0
+        : (drho_sez.x * rho_sez.y - drho_sez.y * rho_sez.x) / (tmp * tmp);
+      vel_azel->elevation[i] = zenith
+        ? 0
+        : (drho_sez.z - rate * sin(el)) / tmp;
+    }
+  }
+}
+
 SUDOUBLE 
 time_unix_to_julian(SUDOUBLE timestamp)
 {
@@ -0,0 +1,554 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "sgdp4-passes"
+#define _DEFAULT_SOURCE
+
+#include "sgdp4.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <sigutils/log.h>
+#include <sigutils/util/compat-time.h>
+
+#define EARTH_ROTATION_RAD_S 7.2921150e-5
+#define POLAR_RADIUS         (EQRAD * (1. - LATCON))
+#define VISIBILITY_MARGIN    1e-2 /* Radians */
+#define ANGULAR_SPEED_MARGIN 1.1
+
+struct sgdp4_pass_result {
+  struct sgdp4_pass *pass_list;
+  unsigned int       pass_count;
+  unsigned int       pass_alloc;
+  SUBOOL             skipped;
+  SUBOOL             failed;
+  uint64_t           propagations;
+};
+
+struct sgdp4_pass_job {
+  const struct sgdp4_pass_request *request;
+  xyz_t                            site_ecef;
+  SUDOUBLE                         t_start;
+  SUDOUBLE                         t_end;
+
+  pthread_mutex_t                  mutex;
+  unsigned int                     next;
+
+  struct sgdp4_pass_result        *results;
+};
+
+/*
+ * Per-orbit search state. Time is kept in seconds since the epoch, as a
+ * double: microsecond resolution is preserved for decades.
+ */
+struct sgdp4_pass_search {
+  const struct sgdp4_pass_job *job;
+  struct sgdp4_pass_result    *result;
+  sgdp4_prediction_t           prediction;
+  unsigned int                 orbit;
+  SUDOUBLE                     gamma_vis; /* Visibility cone half-angle */
+  SUDOUBLE                     omega_max; /* Max angular speed (rad/s) */
+};
+
+SUPRIVATE void
+sgdp4_pass_time_to_timeval(SUDOUBLE t, struct timeval *tv)
+{
+  tv->tv_sec  = floor(t);
+  tv->tv_usec = (t - tv->tv_sec) * 1e6;
+}
+
+SUPRIVATE SUBOOL
+sgdp4_pass_search_eval(struct sgdp4_pass_search *self, SUDOUBLE t)
+{
+  struct timeval tv;
+
+  sgdp4_pass_time_to_timeval(t, &tv);
+  ++self->result->propagations;
+
+  return sgdp4_prediction_update(&self->prediction, &tv);
+}
+
+SUINLINE SUDOUBLE
+sgdp4_pass_search_elevation(const struct sgdp4_pass_search *self)
+{
+  return self->prediction.pos_azel.elevation;
+}
+
+SUINLINE SUDOUBLE
+sgdp4_pass_search_rate(const struct sgdp4_pass_search *self)
+{
+  return self->prediction.vel_azel.distance;
+}
+
+/* Geocentric angle between the site and the satellite */
+SUPRIVATE SUDOUBLE
+sgdp4_pass_search_gamma(const struct sgdp4_pass_search *self)
+{
+  const xyz_t *sat  = &self->prediction.pos_ecef;
+  const xyz_t *site = &self->job->site_ecef;
+  SUDOUBLE cos_gamma;
+
+  cos_gamma = xyz_dotprod(sat, site) / (XYZ_NORM(sat) * XYZ_NORM(site));
+
+  if (cos_gamma > 1)
+    cos_gamma = 1;
+  else if (cos_gamma < -1)
+    cos_gamma = -1;
+
+  return acos(cos_gamma);
+}
+
+/*
+ * Finds the horizon crossing in (t0, t1], given that the elevation is
+ * negative at one end and positive at the other. rising tells which.
+ */
+SUPRIVATE SUBOOL
+sgdp4_pass_search_bisect(
+  struct sgdp4_pass_search *self,
+  SUDOUBLE t0,
+  SUDOUBLE t1,
+  SUBOOL rising,
+  SUDOUBLE *t)
+{
+  SUDOUBLE tm;
+
+  while (t1 - t0 > SGDP4_PASS_TIME_TOL) {
+    tm = .5 * (t0 + t1);
+    if (!sgdp4_pass_search_eval(self, tm))
+      return SU_FALSE;
+
+    if ((sgdp4_pass_search_elevation(self) >= 0) == rising)
+      t1 = tm;
+    else
+      t0 = tm;
+  }
+
+  *t = t1;
+
+  return sgdp4_pass_search_eval(self, t1);
+}
+
+/* Golden section search of the maximum elevation in [a, b] */
+SUPRIVATE SUBOOL
+sgdp4_pass_search_refine_tca(
+  struct sgdp4_pass_search *self,
+  struct sgdp4_pass *pass,
+  SUDOUBLE a,
+  SUDOUBLE b)
+{
+  const SUDOUBLE r = .5 * (sqrt(5.) - 1);
+  SUDOUBLE c, d, fc, fd;
+
+  c = b - r * (b - a);
+  d = a + r * (b - a);
+
+  if (!sgdp4_pass_search_eval(self, c))
+    return SU_FALSE;
+  fc = sgdp4_pass_search_elevation(self);
+
+  if (!sgdp4_pass_search_eval(self, d))
+    return SU_FALSE;
+  fd = sgdp4_pass_search_elevation(self);
+
+  while (b - a > SGDP4_PASS_TIME_TOL) {
+    if (fc > fd) {
+      b  = d;
+      d  = c;
+      fd = fc;
+      c  = b - r * (b - a);
+      if (!sgdp4_pass_search_eval(self, c))
+        return SU_FALSE;
+      fc = sgdp4_pass_search_elevation(self);
+    } else {
+      a  = c;
+      c  = d;
+      fc = fd;
+      d  = a + r * (b - a);
+      if (!sgdp4_pass_search_eval(self, d))
+        return SU_FALSE;
+      fd = sgdp4_pass_search_elevation(self);
+    }
+  }
+
+  if (fc > pass->max_elevation) {
+    pass->max_elevation = fc;
+    sgdp4_pass_time_to_timeval(c, &pass->tca);
+  }
+
+  if (fd > pass->max_elevation) {
+    pass->max_elevation = fd;
+    sgdp4_pass_time_to_timeval(d, &pass->tca);
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+sgdp4_pass_search_update_rate(
+  const struct sgdp4_pass_search *self,
+  struct sgdp4_pass *pass)
+{
+  SUDOUBLE rate = sgdp4_pass_search_rate(self);
+
+  if (rate < pass->min_rate)
+    pass->min_rate = rate;
+
+  if (rate > pass->max_rate)
+    pass->max_rate = rate;
+}
+
+SUPRIVATE SUBOOL
+sgdp4_pass_result_push(
+  struct sgdp4_pass_result *self,
+  const struct sgdp4_pass *pass)
+{
+  struct sgdp4_pass *tmp;
+  unsigned int alloc;
+
+  if (self->pass_count == self->pass_alloc) {
+    alloc = self->pass_alloc == 0 ? 4 : 2 * self->pass_alloc;
+    SU_TRYCATCH(
+      tmp = realloc(self->pass_list, alloc * sizeof(struct sgdp4_pass)),
+      return SU_FALSE);
+
+    self->pass_list  = tmp;
+    self->pass_alloc = alloc;
+  }
+
+  self->pass_list[self->pass_count++] = *pass;
+
+  return SU_TRUE;
+}
+
+/* Tracks a pass that starts at t_aos. Returns the LOS time in *t_los */
+SUPRIVATE SUBOOL
+sgdp4_pass_search_track(
+  struct sgdp4_pass_search *self,
+  SUDOUBLE t_aos,
+  SUDOUBLE *t_los)
+{
+  struct sgdp4_pass pass;
+  SUDOUBLE t = t_aos, t_next, t_best = t_aos, el;
+  SUDOUBLE t_end = self->job->t_end;
+  SUBOOL visible = SU_TRUE;
+
+  memset(&pass, 0, sizeof(struct sgdp4_pass));
+
+  pass.orbit         = self->orbit;
+  pass.max_elevation = sgdp4_pass_search_elevation(self);
+  pass.min_rate      = pass.max_rate = sgdp4_pass_search_rate(self);
+
+  sgdp4_pass_time_to_timeval(t_aos, &pass.aos);
+  pass.tca = pass.aos;
+
+  while (visible && t < t_end) {
+    t_next = t + SGDP4_PASS_TRACK_STEP;
+    if (t_next > t_end)
+      t_next = t_end;
+
+    if (!sgdp4_pass_search_eval(self, t_next))
+      return SU_FALSE;
+
+    el = sgdp4_pass_search_elevation(self);
+
+    if (el < 0) {
+      if (!sgdp4_pass_search_bisect(self, t, t_next, SU_FALSE, &t_next))
+        return SU_FALSE;
+      visible = SU_FALSE;
+    } else if (el > pass.max_elevation) {
+      pass.max_elevation = el;
+      t_best = t_next;
+    }
+
+    sgdp4_pass_search_update_rate(self, &pass);
+    t = t_next;
+  }
+
+  *t_los = t;
+  sgdp4_pass_time_to_timeval(t, &pass.los);
+
+  /* The maximum is within a tracking step of the best sample */
+  if (!sgdp4_pass_search_refine_tca(
+    self,
+    &pass,
+    fmax(t_aos, t_best - SGDP4_PASS_TRACK_STEP),
+    fmin(t, t_best + SGDP4_PASS_TRACK_STEP)))
+    return SU_FALSE;
+
+  return sgdp4_pass_result_push(self->result, &pass);
+}
+
+SUPRIVATE SUBOOL
+sgdp4_pass_search_run(struct sgdp4_pass_search *self)
+{
+  SUDOUBLE t = self->job->t_start, t_next, dt, gamma;
+  SUDOUBLE t_end = self->job->t_end;
+
+  if (!sgdp4_pass_search_eval(self, t))
+    return SU_FALSE;
+
+  /* Already visible */
+  if (sgdp4_pass_search_elevation(self) >= 0)
+    if (!sgdp4_pass_search_track(self, t, &t))
+      return SU_FALSE;
+
+  while (t < t_end) {
+    /* The satellite cannot get within view sooner than this */
+    gamma = sgdp4_pass_search_gamma(self);
+    dt    = (gamma - self->gamma_vis) / self->omega_max;
+    if (dt < SGDP4_PASS_SEARCH_STEP)
+      dt = SGDP4_PASS_SEARCH_STEP;
+
+    t_next = t + dt;
+    if (t_next > t_end)
+      t_next = t_end;
+
+    if (!sgdp4_pass_search_eval(self, t_next))
+      return SU_FALSE;
+
+    if (sgdp4_pass_search_elevation(self) >= 0) {
+      if (!sgdp4_pass_search_bisect(self, t, t_next, SU_TRUE, &t_next))
+        return SU_FALSE;
+
+      if (!sgdp4_pass_search_track(self, t_next, &t_next))
+        return SU_FALSE;
+    }
+
+    t = t_next;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+sgdp4_pass_job_process(struct sgdp4_pass_job *job, unsigned int index)
+{
+  const orbit_t *orbit = job->request->orbit_list + index;
+  struct sgdp4_pass_result *result = job->results + index;
+  struct sgdp4_pass_search search;
+  SUDOUBLE sma, ecc, n;
+  SUBOOL geo;
+
+  /*
+   * orbit_can_be_visible() rejects geostationary satellites, as they
+   * never rise nor set. Those above the horizon are still reported, as
+   * a single pass whose AOS is the start of the window.
+   */
+  geo = orbit_is_geo(orbit)
+    && !orbit_is_decayed(orbit, &job->request->start);
+
+  if (!geo
+    && !orbit_can_be_visible(orbit, &job->request->site, &job->request->start)) {
+    result->skipped = SU_TRUE;
+    return;
+  }
+
+  memset(&search, 0, sizeof(struct sgdp4_pass_search));
+
+  search.job    = job;
+  search.result = result;
+  search.orbit  = index;
+
+  if (!sgdp4_prediction_init(&search.prediction, orbit, &job->request->site)) {
+    result->failed = SU_TRUE;
+    return;
+  }
+
+  /*
+   * Bounds for the skip-ahead: the satellite is never visible from
+   * further than the horizon of its apogee, and its geocentric angle
+   * to the site changes no faster than its angular speed at perigee
+   * plus the rotation of the Earth.
+   */
+  ecc = orbit->ecc;
+  n   = 2 * PI * orbit->rev / 86400.;
+  sma = 331.25 * pow(1440.0 / orbit->rev, 2. / 3.);
+
+  search.gamma_vis = acos(POLAR_RADIUS / (sma * (1 + ecc))) + VISIBILITY_MARGIN;
+  search.omega_max = ANGULAR_SPEED_MARGIN
+    * (n * (1 + ecc) * (1 + ecc) / pow(1 - ecc * ecc, 1.5)
+      + EARTH_ROTATION_RAD_S);
+
+  if (geo) {
+    if (!sgdp4_pass_search_eval(&search, job->t_start)) {
+      result->failed = SU_TRUE;
+      goto done;
+    }
+
+    if (sgdp4_pass_search_elevation(&search) < 0) {
+      result->skipped = SU_TRUE;
+      goto done;
+    }
+  }
+
+  if (!sgdp4_pass_search_run(&search))
+    result->failed = SU_TRUE;
+
+done:
+  sgdp4_prediction_finalize(&search.prediction);
+}
+
+SUPRIVATE void *
+sgdp4_pass_job_thread(void *data)
+{
+  struct sgdp4_pass_job *job = data;
+  unsigned int index;
+
+  for (;;) {
+    (void) pthread_mutex_lock(&job->mutex);
+    index = job->next++;
+    (void) pthread_mutex_unlock(&job->mutex);
+
+    if (index >= job->request->orbit_count)
+      break;
+
+    sgdp4_pass_job_process(job, index);
+  }
+
+  return NULL;
+}
+
+SUPRIVATE int
+sgdp4_pass_compare(const void *a, const void *b)
+{
+  const struct sgdp4_pass *pa = a, *pb = b;
+
+  if (timercmp(&pa->aos, &pb->aos, <))
+    return -1;
+  if (timercmp(&pa->aos, &pb->aos, >))
+    return 1;
+
+  return (int) pa->orbit - (int) pb->orbit;
+}
+
+SUBOOL
+sgdp4_predict_passes(
+  const struct sgdp4_pass_request *request,
+  struct sgdp4_pass **pass_list,
+  unsigned int *pass_count,
+  struct sgdp4_pass_stats *stats)
+{
+  struct sgdp4_pass_job job;
+  struct sgdp4_pass *list = NULL;
+  pthread_t *threads = NULL;
+  unsigned int i, n_threads, started = 0, count = 0, p = 0;
+  struct timespec ts_start, ts_end;
+  SUBOOL mutex_init = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+  memset(&job, 0, sizeof(struct sgdp4_pass_job));
+  memset(stats, 0, sizeof(struct sgdp4_pass_stats));
+
+  job.request = request;
+  job.t_start = request->start.tv_sec + 1e-6 * request->start.tv_usec;
+  job.t_end   = job.t_start + request->window;
+
+  xyz_geodetic_to_ecef(&request->site, &job.site_ecef);
+
+  SU_TRY(pthread_mutex_init(&job.mutex, NULL) == 0);
+  mutex_init = SU_TRUE;
+
+  if (request->orbit_count > 0)
+    SU_TRY(
+      job.results = calloc(
+        request->orbit_count,
+        sizeof(struct sgdp4_pass_result)));
+
+  if ((n_threads = request->threads) == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    n_threads = cpus < 1 ? 1 : cpus;
+  }
+
+  if (n_threads > request->orbit_count)
+    n_threads = request->orbit_count;
+
+  if (n_threads > 0)
+    SU_TRY(threads = calloc(n_threads, sizeof(pthread_t)));
+
+  /* If thread creation fails, the remaining threads do all the work */
+  for (i = 0; i < n_threads; ++i) {
+    if (pthread_create(threads + i, NULL, sgdp4_pass_job_thread, &job) != 0)
+      break;
+    ++started;
+  }
+
+  if (started == 0)
+    sgdp4_pass_job_thread(&job);
+
+  for (i = 0; i < started; ++i)
+    pthread_join(threads[i], NULL);
+
+  /* Merge */
+  for (i = 0; i < request->orbit_count; ++i)
+    count += job.results[i].pass_count;
+
+  if (count > 0)
+    SU_TRY(list = malloc(count * sizeof(struct sgdp4_pass)));
+
+  stats->orbits = request->orbit_count;
+
+  for (i = 0; i < request->orbit_count; ++i) {
+    if (job.results[i].pass_count > 0) {
+      memcpy(
+        list + p,
+        job.results[i].pass_list,
+        job.results[i].pass_count * sizeof(struct sgdp4_pass));
+      p += job.results[i].pass_count;
+    }
+
+    stats->skipped      += job.results[i].skipped;
+    stats->failed       += job.results[i].failed;
+    stats->propagations += job.results[i].propagations;
+  }
+
+  if (count > 0)
+    qsort(list, count, sizeof(struct sgdp4_pass), sgdp4_pass_compare);
+
+  stats->passes = count;
+
+  *pass_list  = list;
+  *pass_count = count;
+  list = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (list != NULL)
+    free(list);
+
+  if (job.results != NULL) {
+    for (i = 0; i < request->orbit_count; ++i)
+      if (job.results[i].pass_list != NULL)
+        free(job.results[i].pass_list);
+    free(job.results);
+  }
+
+  if (threads != NULL)
+    free(threads);
+
+  if (mutex_init)
+    pthread_mutex_destroy(&job.mutex);
+
+  clock_gettime(CLOCK_MONOTONIC, &ts_end);
+  stats->elapsed = (ts_end.tv_sec - ts_start.tv_sec)
+    + 1e-9 * (ts_end.tv_nsec - ts_start.tv_nsec);
+
+  return ok;
+}
@@ -88,6 +88,71 @@ sgdp4_prediction_update(
   return SU_TRUE;
 }
 
+unsigned int
+sgdp4_prediction_compute_many(
+  sgdp4_prediction_t *self,
+  const SUDOUBLE *t_unix,
+  unsigned int count,
+  const xyz_array_t *pos_azel,
+  const xyz_array_t *vel_azel,
+  SUBOOL *valid)
+{
+  SUDOUBLE tsince[SGDP4_VECTOR_BLOCK], jd[SGDP4_VECTOR_BLOCK];
+  SUDOUBLE px[SGDP4_VECTOR_BLOCK], py[SGDP4_VECTOR_BLOCK];
+  SUDOUBLE pz[SGDP4_VECTOR_BLOCK], vx[SGDP4_VECTOR_BLOCK];
+  SUDOUBLE vy[SGDP4_VECTOR_BLOCK], vz[SGDP4_VECTOR_BLOCK];
+  SUBOOL ok[SGDP4_VECTOR_BLOCK];
+  xyz_array_t pos = {.x = px, .y = py, .z = pz};
+  xyz_array_t vel = {.x = vx, .y = vy, .z = vz};
+  xyz_array_t dst_pos, dst_vel;
+  SUDOUBLE epoch = orbit_epoch_to_unix(&self->orbit);
+  unsigned int i, n, p, total = 0;
+
+  for (p = 0; p < count; p += n) {
+    n = count - p < SGDP4_VECTOR_BLOCK ? count - p : SGDP4_VECTOR_BLOCK;
+
+    for (i = 0; i < n; ++i) {
+      tsince[i] = (t_unix[p + i] - epoch) / 60.;
+      jd[i]     = time_unix_to_julian(t_unix[p + i]);
+    }
+
+    sgdp4_ctx_compute_many(&self->ctx, tsince, n, &pos, &vel, ok);
+    xyz_teme_to_ecef_many(jd, n, &pos, &vel, &pos, &vel);
+
+    /* As in sgdp4_prediction_update(), on the geocentric altitude */
+    for (i = 0; i < n; ++i)
+      ok[i] = ok[i]
+        && sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]) - EQRAD
+          <= MAX_REASONABLE_DISTANCE;
+
+    dst_pos.x = pos_azel->x + p;
+    dst_pos.y = pos_azel->y + p;
+    dst_pos.z = pos_azel->z + p;
+
+    if (vel_azel != NULL) {
+      dst_vel.x = vel_azel->x + p;
+      dst_vel.y = vel_azel->y + p;
+      dst_vel.z = vel_azel->z + p;
+    }
+
+    xyz_ecef_to_razel_many(
+      n,
+      &pos,
+      &vel,
+      &self->site,
+      &dst_pos,
+      vel_azel != NULL ? &dst_vel : NULL);
+
+    for (i = 0; i < n; ++i) {
+      if (valid != NULL)
+        valid[p + i] = ok[i];
+      total += ok[i];
+    }
+  }
+
+  return total;
+}
+
 SUBOOL
 orbit_is_geo(const orbit_t *orbit)
 {
@@ -129,18 +194,25 @@ orbit_is_decayed(const orbit_t *orbit, const struct timeval *tv)
 
 }
 
-SUPRIVATE SUBOOL
-sgdp4_prediction_has_aos(const sgdp4_prediction_t *self)
+/*
+ * Cheap bound: orbits that are geostationary, decayed, or whose ground
+ * track never gets close enough to the site cannot have passes.
+ */
+SUBOOL
+orbit_can_be_visible(
+  const orbit_t *orbit,
+  const xyz_t *site,
+  const struct timeval *tv)
 {
   SUDOUBLE lin, sma, apogee;
   SUDOUBLE maxlat;
 
-  if (orbit_is_geo(&self->orbit) 
-      || orbit_is_decayed(&self->orbit, &self->tv)
-      || self->orbit.rev == 0.0)
+  if (orbit_is_geo(orbit)
+      || orbit_is_decayed(orbit, tv)
+      || orbit->rev == 0.0)
     return SU_FALSE;
 
-  lin = self->orbit.eqinc;
+  lin = orbit->eqinc;
   if (lin >= .5 * PI)
     lin = PI - lin;
   
@@ -148,12 +220,18 @@ sgdp4_prediction_has_aos(const sgdp4_prediction_t *self)
    * Near the poles, many near low-inclination satellites
    * orbit below the horizon. Verify this case.
    */
-  sma    = 331.25 * pow(1440.0 / self->orbit.rev, 2. / 3.);
-  apogee = sma * (1. + self->orbit.ecc) - EQRAD;
+  sma    = 331.25 * pow(1440.0 / orbit->rev, 2. / 3.);
+  apogee = sma * (1. + orbit->ecc) - EQRAD;
 
   maxlat = acos(EQRAD / (apogee + EQRAD)) + lin;
 
-  return self->site.lat < fabs(maxlat);
+  return fabs(site->lat) < fabs(maxlat);
+}
+
+SUPRIVATE SUBOOL
+sgdp4_prediction_has_aos(const sgdp4_prediction_t *self)
+{
+  return orbit_can_be_visible(&self->orbit, &self->site, &self->tv);
 }
 
 SUPRIVATE SUDOUBLE
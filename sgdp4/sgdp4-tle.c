@@ -154,13 +154,13 @@ su_orbit_parse_tle_line(orbit_t *self, unsigned int num, const char *linebuf)
        */
 
       n = strlen(linebuf);
-      memcpy(linebufcpy, linebuf, n);
+      memcpy(linebufcpy, linebuf, n + 1);
 
       if (n >= 52 && linebufcpy[52] == ' ')
         linebufcpy[52] = '0';
 
       n = sscanf(
-        linebuf,
+        linebufcpy,
         "%1u %05u %8lf %8lf %07u %8lf %8lf %11lf%5[0-9 ]%1u",
         &line,
         &catalog,
@@ -227,6 +227,14 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+su_orbit_is_tle_line1(const char *linebuf)
+{
+  return linebuf[0] == '1'
+    && linebuf[1] == ' '
+    && strlen(linebuf) == SUSCAN_TLE_LINE_LEN;
+}
+
 SUSDIFF
 orbit_init_from_data(orbit_t *self, const void *data, SUSCOUNT len)
 {
@@ -266,11 +274,15 @@ orbit_init_from_data(orbit_t *self, const void *data, SUSCOUNT len)
         if (*line == '\0')
           break;
 
+        /* 2-line TLEs have no title line. Leave the name unset. */
+        if (linenum == 0 && su_orbit_is_tle_line1(linebuf))
+          linenum = 1;
+
         SU_TRYCATCH(
           su_orbit_parse_tle_line(self, linenum++, linebuf), 
           goto done);
 
-        /* All 3 lines of the TLE have been properly parsed */
+        /* All the lines of the TLE have been properly parsed */
         if (linenum == 3)
           consumed = i + 1;
         break;
@@ -339,6 +351,114 @@ done:
   return ok;
 }
 
+void
+orbit_list_destroy(orbit_t *orbit_list, unsigned int orbit_count)
+{
+  unsigned int i;
+
+  for (i = 0; i < orbit_count; ++i)
+    orbit_finalize(orbit_list + i);
+
+  if (orbit_list != NULL)
+    free(orbit_list);
+}
+
+/*
+ * Catalogue files are TLEs one after another, with or without a title
+ * line (3-line and 2-line formats, which may be mixed). Entries that
+ * fail to parse are skipped, up to the next line.
+ */
+SUBOOL
+orbit_list_from_file(
+  const char *file,
+  orbit_t **orbit_list,
+  unsigned int *orbit_count)
+{
+  struct stat sbuf;
+  SUSDIFF got;
+  SUSCOUNT p = 0;
+  int fd = -1;
+  const char *data;
+  void *buffer = (void *) -1;
+  orbit_t *list = NULL, *tmp;
+  unsigned int count = 0, alloc = 0, bad = 0;
+  SUBOOL line2;
+  SUBOOL ok = SU_FALSE;
+
+  if (stat(file, &sbuf) == -1) {
+    SU_ERROR("Cannot stat `%s': %s\n", file, strerror(errno));
+    goto done;
+  }
+
+  if ((fd = open(file, O_RDONLY)) == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", file, strerror(errno));
+    goto done;
+  }
+
+  if (sbuf.st_size > 0
+    && (buffer = mmap(NULL, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0))
+    == (void *) -1) {
+    SU_ERROR("mmap failed: %s\n", strerror(errno));
+    goto done;
+  }
+
+  data = buffer;
+
+  for (;;) {
+    while (p < sbuf.st_size && isspace(data[p]))
+      ++p;
+
+    if (p == sbuf.st_size)
+      break;
+
+    if (count == alloc) {
+      alloc = alloc == 0 ? 64 : 2 * alloc;
+      SU_TRYCATCH(
+        tmp = realloc(list, alloc * sizeof(orbit_t)),
+        goto done);
+      list = tmp;
+    }
+
+    got = orbit_init_from_data(list + count, data + p, sbuf.st_size - p);
+
+    if (got > 0) {
+      p += got;
+      ++count;
+    } else {
+      /* Resync: skip up to the end of the second line of this entry */
+      ++bad;
+      do {
+        line2 = data[p] == '2';
+        while (p < sbuf.st_size && data[p] != '\n')
+          ++p;
+        if (p < sbuf.st_size)
+          ++p;
+      } while (!line2 && p < sbuf.st_size);
+    }
+  }
+
+  if (bad > 0)
+    SU_WARNING("%s: %d invalid TLEs skipped\n", file, bad);
+
+  *orbit_list  = list;
+  *orbit_count = count;
+  list = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (list != NULL)
+    orbit_list_destroy(list, count);
+
+  if (buffer != (void *) -1)
+    munmap(buffer, sbuf.st_size);
+
+  if (fd != -1)
+    close(fd);
+
+  return ok;
+}
+
 time_t 
 tle_mktime(struct tm *tm) 
 {
@@ -415,7 +535,7 @@ orbit_minutes(const orbit_t *self, SUDOUBLE time)
 void
 orbit_debug(const orbit_t *self)
 {
-  SU_INFO("SAT NAME: %s\n", self->name);
+  SU_INFO("SAT NAME: %s\n", self->name != NULL ? self->name : "(unnamed)");
   SU_INFO("  Epoch:    %d + %g\n", self->ep_year, self->ep_day);
   SU_INFO("  MM:       %g rev / day\n", self->rev);
   SU_INFO("  dMM/dt:   %g rev / day²\n", self->drevdt);
@@ -59,6 +59,7 @@
 
 #define SU_LOG_DOMAIN "sgdp4"
 
+#include <string.h>
 #include <sigutils/types.h>
 #include <sigutils/log.h>
 
@@ -821,4 +822,481 @@ sgdp4_ctx_get_pos_vel(sgdp4_ctx_t *self, double jd, xyz_t *pos, xyz_t *vel)
   return rv;
 }
 
+/* ======================================================================
+   Array versions of sgdp4_ctx_compute(), for near-Earth orbits.
+
+   Elements are processed in blocks of SGDP4_VECTOR_BLOCK lanes. Each lane
+   holds its own copy of the orbital constants, so the same code serves
+   both one orbit at many instants and many orbits at one instant. The
+   block is walked by plain loops, with the branches of the scalar code
+   turned into selects, so that the compiler can vectorise them (release
+   builds use -O3 -ffast-math, which lets GCC call the vector math
+   functions of libmvec).
+
+   SGDP4_NEAR_SIMP lanes are run through the SGDP4_NEAR_NORM formulas with
+   the terms of the normal model set to zero, which reduces them to the
+   simplified ones.
+   ====================================================================== */
+
+#define VB SGDP4_VECTOR_BLOCK
+
+struct sgdp4_vector_block {
+  unsigned int count;
+  unsigned int index[VB]; /* Output element of each lane */
+  SUDOUBLE     ts[VB];
+
+  /* Orbital constants, per lane */
+  SUDOUBLE xmdot[VB], xnodp[VB];
+  SUFLOAT  xmo[VB], eo[VB], xincl[VB], omegao[VB], xnodeo[VB], bstar[VB];
+  SUFLOAT  xnodot[VB], xnodcf[VB], omgdot[VB];
+  SUFLOAT  c1[VB], c4[VB], c5[VB], d2[VB], d3[VB], d4[VB];
+  SUFLOAT  omgcof[VB], xmcof[VB], eta[VB], delmo[VB], sinXMO[VB];
+  SUFLOAT  t2cof[VB], t3cof[VB], t4cof[VB], t5cof[VB];
+  SUFLOAT  aodp[VB], aycof[VB], xlcof[VB];
+  SUFLOAT  x3thm1[VB], x1mth2[VB], x7thm1[VB], sinIO[VB], cosIO[VB];
+
+  /* Intermediate results */
+  SUDOUBLE xmp[VB], radius[VB];
+  SUFLOAT  omega[VB], cosOMG[VB];
+  SUFLOAT  a[VB], xnode[VB], axn[VB], ayn[VB], elsq[VB], maxnr[VB];
+  SUFLOAT  capu[VB], epw[VB];
+  SUFLOAT  sinEPW[VB], cosEPW[VB], esinE[VB], ecosE[VB];
+  SUFLOAT  rdotk[VB], rfdotk[VB];
+  SUFLOAT  uk[VB], xinck[VB], xnodek[VB];
+  SUFLOAT  sinT[VB], cosT[VB], sinI[VB], cosI[VB], sinS[VB], cosS[VB];
+  SUBOOL   valid[VB];
+
+  /* Results, in TEME */
+  SUDOUBLE px[VB], py[VB], pz[VB];
+  SUDOUBLE vx[VB], vy[VB], vz[VB];
+};
+
+SUINLINE SUBOOL
+sgdp4_ctx_is_near(const sgdp4_ctx_t *self)
+{
+  return self->imode == SGDP4_NEAR_SIMP || self->imode == SGDP4_NEAR_NORM;
+}
+
+SUPRIVATE void
+sgdp4_vector_block_load(
+  struct sgdp4_vector_block *self,
+  unsigned int i,
+  const sgdp4_ctx_t *ctx)
+{
+  SUBOOL norm = ctx->imode == SGDP4_NEAR_NORM;
+
+  self->xmdot[i]  = ctx->xmdot;
+  self->xnodp[i]  = ctx->xnodp;
+  self->xmo[i]    = ctx->xmo;
+  self->eo[i]     = ctx->eo;
+  self->xincl[i]  = ctx->xincl;
+  self->omegao[i] = ctx->omegao;
+  self->xnodeo[i] = ctx->xnodeo;
+  self->bstar[i]  = ctx->bstar;
+  self->xnodot[i] = ctx->xnodot;
+  self->xnodcf[i] = ctx->xnodcf;
+  self->omgdot[i] = ctx->omgdot;
+  self->c1[i]     = ctx->c1;
+  self->c4[i]     = ctx->c4;
+  self->eta[i]    = ctx->eta;
+  self->delmo[i]  = ctx->delmo;
+  self->sinXMO[i] = ctx->sinXMO;
+  self->t2cof[i]  = ctx->t2cof;
+  self->aodp[i]   = ctx->aodp;
+  self->aycof[i]  = ctx->aycof;
+  self->xlcof[i]  = ctx->xlcof;
+  self->x3thm1[i] = ctx->x3thm1;
+  self->x1mth2[i] = ctx->x1mth2;
+  self->x7thm1[i] = ctx->x7thm1;
+  self->sinIO[i]  = ctx->sinIO;
+  self->cosIO[i]  = ctx->cosIO;
+
+  /* Terms of the normal model only */
+  self->c5[i]     = norm ? ctx->c5     : 0;
+  self->d2[i]     = norm ? ctx->d2     : 0;
+  self->d3[i]     = norm ? ctx->d3     : 0;
+  self->d4[i]     = norm ? ctx->d4     : 0;
+  self->omgcof[i] = norm ? ctx->omgcof : 0;
+  self->xmcof[i]  = norm ? ctx->xmcof  : 0;
+  self->t3cof[i]  = norm ? ctx->t3cof  : 0;
+  self->t4cof[i]  = norm ? ctx->t4cof  : 0;
+  self->t5cof[i]  = norm ? ctx->t5cof  : 0;
+}
+
+/*
+ * GCC merges the sine and cosine of the same argument into a sincos()
+ * call, which it does not vectorise. Loops below are split so that each
+ * one takes either the sine or the cosine of any given argument.
+ */
+SUPRIVATE void
+sgdp4_vector_block_compute(struct sgdp4_vector_block *self)
+{
+  const int MAXI = 10;
+  unsigned int i, n = self->count;
+  SUDOUBLE worst;
+  int ii;
+
+  /* Secular gravity and atmospheric drag */
+  for (i = 0; i < n; ++i) {
+    SUDOUBLE ts = self->ts[i], xmp;
+    SUFLOAT omega, delm, temp0;
+
+    xmp   = (double) self->xmo[i] + self->xmdot[i] * ts;
+    omega = self->omegao[i] + self->omgdot[i] * ts;
+
+    delm   = self->xmcof[i]
+      * (CUBE(SUIMM(1) + self->eta[i] * SU_COSX(xmp)) - self->delmo[i]);
+    temp0  = ts * self->omgcof[i] + delm;
+    xmp   += (double) temp0;
+    omega -= temp0;
+
+    self->xmp[i]    = xmp;
+    self->omega[i]  = omega;
+    self->cosOMG[i] = SU_COS(omega);
+  }
+
+  /* Long period periodics */
+  for (i = 0; i < n; ++i) {
+    SUDOUBLE ts = self->ts[i], xmp = self->xmp[i], xl, xlt, capu;
+    SUFLOAT omega = self->omega[i];
+    SUFLOAT xnode, temp0, tempa, tempe, templ;
+    SUFLOAT a, e, beta2, axn, ayn, elsq;
+
+    xnode = self->xnodeo[i] + ts * (self->xnodot[i] + ts * self->xnodcf[i]);
+
+    tempa = SUIMM(1)
+      - (ts * (self->c1[i]
+        + ts * (self->d2[i]
+          + ts * (self->d3[i]
+            + ts * self->d4[i]))));
+
+    tempe = self->bstar[i]
+      * (self->c4[i] * ts + self->c5[i] * (SU_SINX(xmp) - self->sinXMO[i]));
+
+    templ = ts * ts
+      * (self->t2cof[i]
+        + ts * (self->t3cof[i]
+          + ts * (self->t4cof[i]
+            + ts * self->t5cof[i])));
+
+    a  = self->aodp[i] * tempa * tempa;
+    e  = self->eo[i] - tempe;
+    xl = xmp + omega + xnode + self->xnodp[i] * templ;
+
+    self->valid[i] = a >= SUIMM(1) && e >= ECC_LIMIT_LOW;
+
+    e = e < ECC_EPS ? ECC_EPS : e;
+    e = e > ECC_LIMIT_HIGH ? ECC_LIMIT_HIGH : e;
+
+    beta2 = SUIMM(1) - e * e;
+    temp0 = SUIMM(1) / (a * beta2);
+    axn   = e * self->cosOMG[i];
+    ayn   = e * SU_SIN(omega) + temp0 * self->aycof[i];
+    xlt   = xl + temp0 * self->xlcof[i] * axn;
+    elsq  = axn * axn + ayn * ayn;
+
+    self->valid[i] = self->valid[i] && elsq < SUIMM(1);
+
+    /* fmod(xlt - xnode, TWOPI), through a conversion that vectorises */
+    capu = xlt - xnode;
+    capu = capu - TWOPI * (int) (capu / TWOPI);
+
+    self->a[i]     = a;
+    self->xnode[i] = xnode;
+    self->axn[i]   = axn;
+    self->ayn[i]   = ayn;
+    self->elsq[i]  = elsq;
+    self->maxnr[i] = SU_SQRTX(elsq);
+    self->capu[i]  = self->epw[i] = capu;
+  }
+
+  /*
+   * Kepler's equation, by the same Newton-Raphson iteration as the
+   * scalar code. Lanes that have converged (or are invalid) are frozen,
+   * and the block stops when no lane is left.
+   */
+  for (ii = 0; ii < MAXI; ++ii) {
+    worst = 0;
+
+    for (i = 0; i < n; ++i)
+      self->sinEPW[i] = SU_SIN(self->epw[i]);
+
+    for (i = 0; i < n; ++i)
+      self->cosEPW[i] = SU_COS(self->epw[i]);
+
+    for (i = 0; i < n; ++i) {
+      SUFLOAT sinEPW = self->sinEPW[i], cosEPW = self->cosEPW[i];
+      SUFLOAT ecosE, esinE, epw = self->epw[i];
+      SUDOUBLE f, df, nr, err;
+
+      ecosE = self->axn[i] * cosEPW + self->ayn[i] * sinEPW;
+      esinE = self->axn[i] * sinEPW - self->ayn[i] * cosEPW;
+      f     = self->capu[i] - epw + esinE;
+      err   = self->valid[i] ? fabs(f) : 0;
+
+      df = 1.0 - ecosE;
+      nr = f / df;
+      nr = ii == 0 && FABS(nr) > 1.25 * self->maxnr[i]
+        ? SIGN2(self->maxnr[i], nr)
+        : f / (df + 0.5 * esinE * nr);
+
+      self->epw[i]   = err < NR_EPS ? epw : epw + nr;
+      self->ecosE[i] = ecosE;
+      self->esinE[i] = esinE;
+
+      worst = err > worst ? err : worst;
+    }
+
+    if (worst < NR_EPS)
+      break;
+  }
+
+  /* Short period periodics */
+  for (i = 0; i < n; ++i) {
+    SUFLOAT a = self->a[i], axn = self->axn[i], ayn = self->ayn[i];
+    SUFLOAT esinE = self->esinE[i];
+    SUFLOAT temp0, temp1, temp2, temp3, betal, pl, r, invR;
+    SUFLOAT sinu, cosu, u, sin2u, cos2u;
+    SUFLOAT rk, uk, xnodek, xinck;
+
+    temp0 = SUIMM(1) - self->elsq[i];
+    betal = SU_SQRTX(temp0);
+    pl    = a * temp0;
+    r     = a * (SUIMM(1) - self->ecosE[i]);
+    invR  = SUIMM(1) / r;
+    temp2 = a * invR;
+    temp3 = SUIMM(1) / (SUIMM(1) + betal);
+    cosu  = temp2 * (self->cosEPW[i] - axn + ayn * esinE * temp3);
+    sinu  = temp2 * (self->sinEPW[i] - ayn - axn * esinE * temp3);
+    u     = ATAN2(sinu, cosu);
+    sin2u = SUIMM(2) * sinu * cosu;
+    cos2u = SUIMM(2) * cosu * cosu - SUIMM(1);
+    temp0 = SUIMM(1) / pl;
+    temp1 = CK2 * temp0;
+    temp2 = temp1 * temp0;
+
+    rk     = r * (SUIMM(1) - SUIMM(1.5) * temp2 * betal * self->x3thm1[i])
+      + SUIMM(.5) * temp1 * self->x1mth2[i] * cos2u;
+    uk     = u - SUIMM(.25) * temp2 * self->x7thm1[i] * sin2u;
+    xnodek = self->xnode[i]
+      + SUIMM(1.5) * temp2 * self->cosIO[i] * sin2u;
+    xinck  = self->xincl[i]
+      + SUIMM(1.5) * temp2 * self->cosIO[i] * self->sinIO[i] * cos2u;
+
+    self->valid[i]  = self->valid[i] && rk >= SUIMM(1);
+    self->radius[i] = rk * XKMPER / AE;
+
+    temp0 = SU_SQRTX(a);
+    temp2 = (SUFLOAT) XKE / (a * temp0);
+
+    self->rdotk[i]  = ((SUFLOAT) XKE * temp0 * esinE * invR
+      - temp2 * temp1 * self->x1mth2[i] * sin2u)
+      * (XKMPER / AE * XMNPDA / 86400.0);
+    self->rfdotk[i] = ((SUFLOAT) XKE * SU_SQRTX(pl) * invR + temp2 * temp1 * (
+      self->x1mth2[i] * cos2u + SUIMM(1.5) * self->x3thm1[i]))
+      * (XKMPER / AE * XMNPDA / 86400.0);
+
+    self->uk[i]     = uk;
+    self->xinck[i]  = xinck;
+    self->xnodek[i] = xnodek;
+    self->cosT[i]   = SU_COS(uk);
+    self->cosI[i]   = SU_COS(xinck);
+    self->cosS[i]   = SU_COS(xnodek);
+  }
+
+  for (i = 0; i < n; ++i) {
+    self->sinT[i] = SU_SIN(self->uk[i]);
+    self->sinI[i] = SU_SIN(self->xinck[i]);
+    self->sinS[i] = SU_SIN(self->xnodek[i]);
+  }
+
+  /* As in kep_get_pos_vel_teme() */
+  for (i = 0; i < n; ++i) {
+    SUFLOAT sinT, cosT, sinI, cosI, sinS, cosS;
+    SUFLOAT xmx, xmy, ux, uy, uz, vx, vy, vz;
+    SUDOUBLE radius = self->radius[i];
+    SUDOUBLE rdotk = self->rdotk[i], rfdotk = self->rfdotk[i], k;
+
+    sinT = self->sinT[i];
+    sinI = self->sinI[i];
+    sinS = self->sinS[i];
+    cosT = self->cosT[i];
+    cosI = self->cosI[i];
+    cosS = self->cosS[i];
+
+    xmx = -sinS * cosI;
+    xmy = cosS * cosI;
+
+    ux = xmx * sinT + cosS * cosT;
+    uy = xmy * sinT + sinS * cosT;
+    uz = sinI * sinT;
+
+    vx = xmx * cosT - cosS * sinT;
+    vy = xmy * cosT - sinS * sinT;
+    vz = sinI * cosT;
+
+    /* Invalid lanes are poisoned with NaN (not under -ffast-math) */
+    k = self->valid[i] ? 1. : NAN;
+
+    self->px[i] = k * radius * ux;
+    self->py[i] = k * radius * uy;
+    self->pz[i] = k * radius * uz;
+
+    self->vx[i] = k * (rdotk * ux + rfdotk * vx);
+    self->vy[i] = k * (rdotk * uy + rfdotk * vy);
+    self->vz[i] = k * (rdotk * uz + rfdotk * vz);
+  }
+}
+
+SUPRIVATE unsigned int
+sgdp4_vector_block_store(
+  const struct sgdp4_vector_block *self,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid)
+{
+  unsigned int i, j, ok = 0;
+
+  for (i = 0; i < self->count; ++i) {
+    j = self->index[i];
+
+    pos->x[j] = self->px[i];
+    pos->y[j] = self->py[i];
+    pos->z[j] = self->pz[i];
+
+    if (vel != NULL) {
+      vel->x[j] = self->vx[i];
+      vel->y[j] = self->vy[i];
+      vel->z[j] = self->vz[i];
+    }
+
+    if (valid != NULL)
+      valid[j] = self->valid[i];
+
+    ok += self->valid[i];
+  }
+
+  return ok;
+}
+
+/* Deep space and circular orbits */
+SUPRIVATE SUBOOL
+sgdp4_ctx_compute_one(
+  sgdp4_ctx_t *self,
+  SUDOUBLE tsince,
+  unsigned int j,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid)
+{
+  kep_t K;
+  xyz_t p, v;
+  SUBOOL ok;
+
+  memset(&K, 0, sizeof(kep_t));
+
+  ok = sgdp4_ctx_compute(self, tsince, vel != NULL, &K) != SGDP4_ERROR;
+
+  if (ok) {
+    kep_get_pos_vel_teme(&K, &p, &v);
+  } else {
+    p.x = p.y = p.z = NAN;
+    v.x = v.y = v.z = NAN;
+  }
+
+  pos->x[j] = p.x;
+  pos->y[j] = p.y;
+  pos->z[j] = p.z;
+
+  if (vel != NULL) {
+    vel->x[j] = v.x;
+    vel->y[j] = v.y;
+    vel->z[j] = v.z;
+  }
+
+  if (valid != NULL)
+    valid[j] = ok;
+
+  return ok;
+}
+
+unsigned int
+sgdp4_ctx_compute_many(
+  sgdp4_ctx_t *self,
+  const SUDOUBLE *tsince,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid)
+{
+  struct sgdp4_vector_block block;
+  unsigned int i, p, ok = 0;
+
+  if (!sgdp4_ctx_is_near(self)) {
+    for (i = 0; i < count; ++i)
+      ok += sgdp4_ctx_compute_one(self, tsince[i], i, pos, vel, valid);
+
+    return ok;
+  }
+
+  /* Same orbit in every lane: constants are loaded only once */
+  for (i = 0; i < VB; ++i)
+    sgdp4_vector_block_load(&block, i, self);
+
+  for (p = 0; p < count; p += VB) {
+    block.count = count - p < VB ? count - p : VB;
+
+    for (i = 0; i < block.count; ++i) {
+      block.index[i] = p + i;
+      block.ts[i]    = tsince[p + i];
+    }
+
+    sgdp4_vector_block_compute(&block);
+    ok += sgdp4_vector_block_store(&block, pos, vel, valid);
+  }
+
+  return ok;
+}
+
+unsigned int
+sgdp4_ctx_list_compute(
+  sgdp4_ctx_t *ctx_list,
+  const SUDOUBLE *tsince,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid)
+{
+  struct sgdp4_vector_block block;
+  unsigned int i, ok = 0;
+
+  block.count = 0;
+
+  for (i = 0; i < count; ++i) {
+    if (!sgdp4_ctx_is_near(ctx_list + i)) {
+      ok += sgdp4_ctx_compute_one(ctx_list + i, tsince[i], i, pos, vel, valid);
+      continue;
+    }
+
+    sgdp4_vector_block_load(&block, block.count, ctx_list + i);
+    block.index[block.count] = i;
+    block.ts[block.count]    = tsince[i];
+
+    if (++block.count == VB) {
+      sgdp4_vector_block_compute(&block);
+      ok += sgdp4_vector_block_store(&block, pos, vel, valid);
+      block.count = 0;
+    }
+  }
+
+  if (block.count > 0) {
+    sgdp4_vector_block_compute(&block);
+    ok += sgdp4_vector_block_store(&block, pos, vel, valid);
+  }
+
+  return ok;
+}
+
+#undef VB
+
 /* ==================== End of file sgdp4.c ========================== */
@@ -120,6 +120,13 @@ SUDOUBLE orbit_minutes(const orbit_t *self, SUDOUBLE time);
 void orbit_debug(const orbit_t *self);
 void orbit_finalize(orbit_t *self);
 
+SUBOOL orbit_list_from_file(
+  const char *file,
+  orbit_t **orbit_list,
+  unsigned int *orbit_count);
+
+void orbit_list_destroy(orbit_t *orbit_list, unsigned int orbit_count);
+
 #define XYZ_MATMUL(d, m, v)                                          \
   do {                                                               \
     (d)->x = m[0][0] * (v)->x + m[1][0] * (v)->y + m[2][0] * (v)->z; \
@@ -170,6 +177,34 @@ void orbit_finalize(orbit_t *self);
     (d)->z = (v)->z;                  \
   } while (0)
 
+/*
+ * Structure-of-arrays counterpart of xyz_t, for the array versions of
+ * the propagation and conversion functions. Keeping each component in
+ * its own array lets the loops over them be vectorised.
+ */
+typedef struct xyz_array_s {
+  union {
+    SUDOUBLE *x;
+    SUDOUBLE *lon;
+    SUDOUBLE *azimuth;
+  };
+
+  union {
+    SUDOUBLE *y;
+    SUDOUBLE *lat;
+    SUDOUBLE *elevation;
+  };
+
+  union {
+    SUDOUBLE *z;
+    SUDOUBLE *height;
+    SUDOUBLE *distance;
+  };
+} xyz_array_t;
+
+/* Elements processed at once by the array functions */
+#define SGDP4_VECTOR_BLOCK 64
+
 void xyz_teme_to_ecef(
   const xyz_t *pos,
   const xyz_t *vel,
@@ -177,6 +212,15 @@ void xyz_teme_to_ecef(
   xyz_t *ecef_pos,
   xyz_t *ecef_vel);
 
+/* Element i is converted at jdut1[i]. Conversion may be done in place */
+void xyz_teme_to_ecef_many(
+  const SUDOUBLE *jdut1,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  const xyz_array_t *ecef_pos,
+  const xyz_array_t *ecef_vel);
+
 void xyz_sub(const xyz_t *a, const xyz_t *b, xyz_t *res);
 
 void xyz_mul_c(xyz_t *pos, SUDOUBLE k);
@@ -194,6 +238,15 @@ void xyz_ecef_to_razel(
   xyz_t *pos_azel,
   xyz_t *vel_azel);
 
+/* vel_ecef and vel_azel may be NULL */
+void xyz_ecef_to_razel_many(
+  unsigned int count,
+  const xyz_array_t *pos_ecef,
+  const xyz_array_t *vel_ecef,
+  const xyz_t *geo,
+  const xyz_array_t *pos_azel,
+  const xyz_array_t *vel_azel);
+
 /* ================ Single or Double precision options. ================= */
 
 #define DEFAULT_TO_SNGL 0
@@ -302,6 +355,38 @@ int sgdp4_ctx_get_pos_vel(
   xyz_t *pos, 
   xyz_t *vel);
 
+/*
+ * Array versions of sgdp4_ctx_compute() + kep_get_pos_vel_teme(). The
+ * first one propagates one orbit to count instants, the second one
+ * propagates count orbits, each one to its own tsince (in minutes).
+ *
+ * Near-Earth orbits are propagated SGDP4_VECTOR_BLOCK elements at a
+ * time, by loops that the compiler can vectorise. Deep space and
+ * circular orbits are propagated by sgdp4_ctx_compute(), one element
+ * at a time. Elements that fail to propagate are set to NaN and
+ * flagged in valid (if not NULL). vel may be NULL. Both functions
+ * return the number of valid elements.
+ *
+ * The NaN poisoning is best-effort: it is undefined under -ffast-math
+ * (-ffinite-math-only), where the compiler may drop or fold it. Callers
+ * must rely on valid[] only, never on isnan() of the outputs.
+ */
+unsigned int sgdp4_ctx_compute_many(
+  sgdp4_ctx_t *self,
+  const SUDOUBLE *tsince,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid);
+
+unsigned int sgdp4_ctx_list_compute(
+  sgdp4_ctx_t *ctx_list,
+  const SUDOUBLE *tsince,
+  unsigned int count,
+  const xyz_array_t *pos,
+  const xyz_array_t *vel,
+  SUBOOL *valid);
+
 SUDOUBLE time_unix_to_julian(SUDOUBLE timestamp);
 SUDOUBLE time_timeval_to_julian(const struct timeval *tv);
 SUDOUBLE time_julian_to_unix(SUDOUBLE jd);
@@ -327,6 +412,21 @@ SUBOOL sgdp4_prediction_update(
   sgdp4_prediction_t *self, 
   const struct timeval *tv);
 
+/*
+ * Topocentric position and velocity at count UNIX times, through the
+ * array functions. The cached state of the prediction object is left
+ * untouched. vel_azel and valid may be NULL. Returns the number of
+ * valid elements. As with sgdp4_ctx_compute_many(), invalid elements
+ * must be told apart through valid[], not by their NaN outputs.
+ */
+unsigned int sgdp4_prediction_compute_many(
+  sgdp4_prediction_t *self,
+  const SUDOUBLE *t_unix,
+  unsigned int count,
+  const xyz_array_t *pos_azel,
+  const xyz_array_t *vel_azel,
+  SUBOOL *valid);
+
 void sgdp4_prediction_get_azel(
   const sgdp4_prediction_t *self, 
   xyz_t *azel);
@@ -346,6 +446,62 @@ SUBOOL sgdp4_prediction_init(
   const orbit_t *orbit,
   const xyz_t *geo);
 
+SUBOOL orbit_can_be_visible(
+  const orbit_t *orbit,
+  const xyz_t *site,
+  const struct timeval *tv);
+
+/************** Batch pass prediction ***************/
+
+/*
+ * Passes are searched by propagating each orbit forward. While the
+ * satellite is far from the site, steps are as long as the time it
+ * needs to get within view, bounded by its maximum angular speed over
+ * the ground. Closer to the site, steps are SGDP4_PASS_SEARCH_STEP
+ * seconds long (shorter grazing passes may be missed). AOS and LOS are
+ * refined by bisection down to SGDP4_PASS_TIME_TOL. During a pass, the
+ * satellite is tracked every SGDP4_PASS_TRACK_STEP seconds to find the
+ * maximum elevation and the range rate extremes.
+ */
+#define SGDP4_PASS_SEARCH_STEP 20.
+#define SGDP4_PASS_TRACK_STEP  10.
+#define SGDP4_PASS_TIME_TOL    .1
+
+struct sgdp4_pass {
+  unsigned int   orbit;         /* Index in the orbit list */
+  struct timeval aos;           /* Window start if already visible */
+  struct timeval los;           /* Window end if still visible */
+  struct timeval tca;           /* Time of maximum elevation */
+  SUDOUBLE       max_elevation; /* Radians */
+  SUDOUBLE       min_rate;      /* Range rate extremes, in km/s */
+  SUDOUBLE       max_rate;
+};
+
+struct sgdp4_pass_request {
+  const orbit_t *orbit_list;
+  unsigned int   orbit_count;
+  xyz_t          site;          /* Geodetic, radians and km */
+  struct timeval start;
+  SUDOUBLE       window;        /* In seconds */
+  unsigned int   threads;       /* 0: one per CPU */
+};
+
+struct sgdp4_pass_stats {
+  unsigned int orbits;
+  unsigned int skipped;         /* Never visible from the site */
+  unsigned int failed;          /* Propagation errors */
+  unsigned int passes;
+  uint64_t     propagations;
+  SUDOUBLE     elapsed;         /* Wall time, in seconds */
+};
+
+/* Passes are sorted by AOS. The list must be released with free() */
+SUBOOL sgdp4_predict_passes(
+  const struct sgdp4_pass_request *request,
+  struct sgdp4_pass **pass_list,
+  unsigned int *pass_count,
+  struct sgdp4_pass_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -72,6 +72,7 @@ HEADERS += $$files($$PWD/sgdp4/*.h, true)
 SOURCES += $$files($$PWD/sgdp4/*.c, true)
 
 SOURCES += \
+    $$PWD/cli/datasavers/binary.c \
     $$PWD/cli/datasavers/csv.c \
     $$PWD/cli/datasavers/mat5.c \
     $$PWD/cli/datasavers/matlab.c \
@@ -0,0 +1,153 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <util/object.h>
+
+namespace {
+  // Large enough for the linear lookup to be noticeably quadratic
+  constexpr unsigned int kBenchFieldCount = 20000;
+
+  std::string
+  fieldName(unsigned int i)
+  {
+    return "field_" + std::to_string(i);
+  }
+
+  suscan_object_t *
+  makeObject(unsigned int count)
+  {
+    suscan_object_t *obj = suscan_object_new(SUSCAN_OBJECT_TYPE_OBJECT);
+
+    if (obj == nullptr)
+      return nullptr;
+
+    for (unsigned int i = 0; i < count; ++i) {
+      if (!suscan_object_set_field_uint(obj, fieldName(i).c_str(), i)) {
+        suscan_object_destroy(obj);
+        return nullptr;
+      }
+    }
+
+    return obj;
+  }
+}
+
+TEST(ObjectIndex, LookupAroundThreshold)
+{
+  const unsigned int count = SUSCAN_OBJECT_INDEX_THRESHOLD + 4;
+  suscan_object_t *obj = suscan_object_new(SUSCAN_OBJECT_TYPE_OBJECT);
+
+  ASSERT_NE(obj, nullptr);
+
+  // Fields appended after the index was built must be found too
+  for (unsigned int i = 0; i < count; ++i) {
+    ASSERT_TRUE(suscan_object_set_field_uint(obj, fieldName(i).c_str(), i));
+
+    for (unsigned int j = 0; j <= i; ++j)
+      EXPECT_EQ(
+        suscan_object_get_field_uint(obj, fieldName(j).c_str(), ~0u),
+        j);
+
+    EXPECT_EQ(suscan_object_get_field(obj, fieldName(i + 1).c_str()), nullptr);
+  }
+
+  // Built by the insertions, not by the lookups
+  EXPECT_NE(obj->field_index, nullptr);
+  EXPECT_EQ(obj->field_indexed, suscan_object_field_count(obj));
+
+  // A removed field can be added back
+  ASSERT_TRUE(suscan_object_set_field(obj, fieldName(0).c_str(), nullptr));
+  EXPECT_EQ(suscan_object_get_field(obj, fieldName(0).c_str()), nullptr);
+  ASSERT_TRUE(suscan_object_set_field_uint(obj, fieldName(0).c_str(), 42));
+  EXPECT_EQ(suscan_object_get_field_uint(obj, fieldName(0).c_str(), ~0u), 42u);
+
+  suscan_object_destroy(obj);
+}
+
+TEST(ObjectIndex, OverwriteClearAndCopy)
+{
+  const unsigned int count = 4 * SUSCAN_OBJECT_INDEX_THRESHOLD;
+  suscan_object_t *obj = makeObject(count);
+  suscan_object_t *copy = nullptr;
+
+  ASSERT_NE(obj, nullptr);
+
+  // Overwriting an existing field replaces it in place
+  for (unsigned int i = 0; i < count; i += 3)
+    ASSERT_TRUE(
+      suscan_object_set_field_uint(obj, fieldName(i).c_str(), i + count));
+
+  EXPECT_EQ(suscan_object_field_count(obj), count);
+
+  for (unsigned int i = 0; i < count; ++i)
+    EXPECT_EQ(
+      suscan_object_get_field_uint(obj, fieldName(i).c_str(), ~0u),
+      i % 3 == 0 ? i + count : i);
+
+  // Copies get their own index
+  copy = suscan_object_copy(obj);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_NE(copy->field_index, nullptr);
+
+  ASSERT_TRUE(suscan_object_clear_fields(obj));
+  EXPECT_EQ(suscan_object_field_count(obj), 0u);
+  EXPECT_EQ(suscan_object_get_field(obj, fieldName(0).c_str()), nullptr);
+
+  for (unsigned int i = 0; i < count; ++i)
+    EXPECT_EQ(
+      suscan_object_get_field_uint(copy, fieldName(i).c_str(), ~0u),
+      i % 3 == 0 ? i + count : i);
+
+  // The cleared object can be filled again
+  ASSERT_TRUE(suscan_object_set_field_uint(obj, fieldName(1).c_str(), 1));
+  EXPECT_EQ(suscan_object_get_field_uint(obj, fieldName(1).c_str(), ~0u), 1u);
+
+  suscan_object_destroy(copy);
+  suscan_object_destroy(obj);
+}
+
+// Synthetic benchmark: build a large object field by field, then read
+// every field back. Without the index, both loops are quadratic.
+TEST(ObjectIndex, Benchmark)
+{
+  suscan_object_t *obj = nullptr;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> setTime, getTime;
+
+  obj = makeObject(kBenchFieldCount);
+  ASSERT_NE(obj, nullptr);
+  setTime = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < kBenchFieldCount; ++i)
+    ASSERT_EQ(
+      suscan_object_get_field_uint(obj, fieldName(i).c_str(), ~0u),
+      i);
+  getTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(suscan_object_field_count(obj), kBenchFieldCount);
+
+  RecordProperty("set_seconds", std::to_string(setTime.count()));
+  RecordProperty("get_seconds", std::to_string(getTime.count()));
+
+  suscan_object_destroy(obj);
+}
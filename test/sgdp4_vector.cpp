@@ -0,0 +1,289 @@
+/*
+
+  Copyright (C) 2023 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <sgdp4/sgdp4.h>
+
+namespace {
+  // One orbit per propagation path of the array functions
+  const char *const kTles[] = {
+    // Near-Earth, normal mode
+    "ISS\n"
+    "1 25544U 98067A   23290.51465278  .00001000  00000+0  10000-3 0  9998\n"
+    "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391010006\n",
+
+    // Near-Earth, low perigee (simplified drag)
+    "LOW PERIGEE\n"
+    "1 90001U 98067A   23290.51465278  .00001000  00000+0  10000-3 0  9998\n"
+    "2 90001  97.5000  10.0000 0020000  30.0000  40.0000 16.20000000010003\n",
+
+    // High drag: decays within the time grid, exercising valid[]
+    "DECAYING\n"
+    "1 90002U 98067A   23290.51465278  .05000000  00000+0  50000-1 0  9995\n"
+    "2 90002  82.0000 120.0000 0005000   0.0000   0.0000 16.40000000010003\n",
+
+    // Deep space: falls back to the scalar path
+    "MOLNIYA\n"
+    "1 90003U 98067A   23290.51465278  .00001000  00000+0  10000-3 0  9990\n"
+    "2 90003  63.4000 200.0000 7000000 270.0000  10.0000  2.00600000010005\n",
+  };
+
+  constexpr unsigned int kOrbitCount  = sizeof(kTles) / sizeof(kTles[0]);
+  constexpr unsigned int kSampleCount = 4000;   // Not a block multiple
+  constexpr SUDOUBLE     kStepMinutes = 7.31;   // About 20 days
+
+  // Loose enough for release builds, which use -ffast-math
+  constexpr SUDOUBLE     kPosTolKm    = 1e-2;
+  constexpr SUDOUBLE     kVelTolKmS   = 1e-5;
+  constexpr SUDOUBLE     kElTolDeg    = 1e-3;
+
+  struct Xyz {
+    std::vector<SUDOUBLE> x, y, z;
+
+    explicit Xyz(unsigned int count) : x(count), y(count), z(count) {}
+
+    xyz_array_t
+    array()
+    {
+      xyz_array_t arr;
+
+      arr.x = x.data();
+      arr.y = y.data();
+      arr.z = z.data();
+
+      return arr;
+    }
+  };
+
+  class Sgdp4Vector : public ::testing::Test {
+    protected:
+      orbit_t orbits[kOrbitCount];
+
+      void
+      SetUp() override
+      {
+        for (unsigned int i = 0; i < kOrbitCount; ++i)
+          ASSERT_GT(
+            orbit_init_from_data(orbits + i, kTles[i], strlen(kTles[i])),
+            0);
+      }
+
+      void
+      TearDown() override
+      {
+        for (unsigned int i = 0; i < kOrbitCount; ++i)
+          orbit_finalize(orbits + i);
+      }
+
+      // Scalar reference. Returns false if the propagation fails.
+      bool
+      scalar(const orbit_t *orbit, SUDOUBLE tsince, xyz_t *pos, xyz_t *vel)
+      {
+        sgdp4_ctx_t ctx;
+        orbit_t copy = *orbit;
+        kep_t kep;
+
+        memset(&ctx, 0, sizeof(sgdp4_ctx_t));
+        memset(&kep, 0, sizeof(kep_t));
+
+        if (sgdp4_ctx_init(&ctx, &copy) == SGDP4_ERROR)
+          return false;
+
+        if (sgdp4_ctx_compute(&ctx, tsince, 1, &kep) == SGDP4_ERROR)
+          return false;
+
+        kep_get_pos_vel_teme(&kep, pos, vel);
+
+        return true;
+      }
+  };
+
+  SUDOUBLE
+  distance(const xyz_t *a, const Xyz &b, unsigned int i)
+  {
+    SUDOUBLE dx = a->x - b.x[i];
+    SUDOUBLE dy = a->y - b.y[i];
+    SUDOUBLE dz = a->z - b.z[i];
+
+    return sqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+TEST_F(Sgdp4Vector, ComputeManyMatchesScalar)
+{
+  std::vector<SUDOUBLE> tsince(kSampleCount);
+  unsigned int invalid = 0;
+
+  for (unsigned int i = 0; i < kSampleCount; ++i)
+    tsince[i] = -1440. + i * kStepMinutes;
+
+  for (unsigned int o = 0; o < kOrbitCount; ++o) {
+    sgdp4_ctx_t ctx;
+    orbit_t copy = orbits[o];
+    Xyz pos(kSampleCount), vel(kSampleCount);
+    xyz_array_t pos_arr = pos.array(), vel_arr = vel.array();
+    std::vector<SUBOOL> valid(kSampleCount);
+    unsigned int count, expected = 0;
+
+    SCOPED_TRACE(orbits[o].name);
+
+    memset(&ctx, 0, sizeof(sgdp4_ctx_t));
+    ASSERT_NE(sgdp4_ctx_init(&ctx, &copy), SGDP4_ERROR);
+
+    count = sgdp4_ctx_compute_many(
+      &ctx,
+      tsince.data(),
+      kSampleCount,
+      &pos_arr,
+      &vel_arr,
+      valid.data());
+
+    for (unsigned int i = 0; i < kSampleCount; ++i) {
+      xyz_t p, v;
+      bool ok = scalar(orbits + o, tsince[i], &p, &v);
+
+      ASSERT_EQ(ok, valid[i] != SU_FALSE) << "tsince = " << tsince[i];
+
+      if (!ok) {
+        ++invalid;
+        continue;
+      }
+
+      ++expected;
+      EXPECT_LT(distance(&p, pos, i), kPosTolKm) << "tsince = " << tsince[i];
+      EXPECT_LT(distance(&v, vel, i), kVelTolKmS) << "tsince = " << tsince[i];
+    }
+
+    EXPECT_EQ(count, expected);
+  }
+
+  // The decaying orbit must have exercised the invalid lanes
+  EXPECT_GT(invalid, 0u);
+}
+
+TEST_F(Sgdp4Vector, ListComputeMatchesScalar)
+{
+  // Every orbit several times, so that blocks mix propagation paths
+  constexpr unsigned int kCopies = 50;
+  constexpr unsigned int kCount  = kOrbitCount * kCopies;
+  std::vector<sgdp4_ctx_t> ctx_list(kCount);
+  std::vector<orbit_t> copies(kOrbitCount);
+  std::vector<SUDOUBLE> tsince(kCount);
+  std::vector<SUBOOL> valid(kCount);
+  Xyz pos(kCount), vel(kCount);
+  xyz_array_t pos_arr = pos.array(), vel_arr = vel.array();
+  unsigned int count, expected = 0;
+
+  for (unsigned int o = 0; o < kOrbitCount; ++o)
+    copies[o] = orbits[o];
+
+  for (unsigned int i = 0; i < kCount; ++i) {
+    memset(&ctx_list[i], 0, sizeof(sgdp4_ctx_t));
+    ASSERT_NE(
+      sgdp4_ctx_init(&ctx_list[i], &copies[i % kOrbitCount]),
+      SGDP4_ERROR);
+    tsince[i] = -1440. + i * 37 * kStepMinutes;
+  }
+
+  count = sgdp4_ctx_list_compute(
+    ctx_list.data(),
+    tsince.data(),
+    kCount,
+    &pos_arr,
+    &vel_arr,
+    valid.data());
+
+  for (unsigned int i = 0; i < kCount; ++i) {
+    xyz_t p, v;
+    bool ok = scalar(orbits + i % kOrbitCount, tsince[i], &p, &v);
+
+    ASSERT_EQ(ok, valid[i] != SU_FALSE) << "element " << i;
+
+    if (!ok)
+      continue;
+
+    ++expected;
+    EXPECT_LT(distance(&p, pos, i), kPosTolKm) << "element " << i;
+    EXPECT_LT(distance(&v, vel, i), kVelTolKmS) << "element " << i;
+  }
+
+  EXPECT_EQ(count, expected);
+}
+
+TEST_F(Sgdp4Vector, PredictionElevationMatchesScalar)
+{
+  xyz_t site;
+  SUDOUBLE t0 = 1697800000.;
+
+  site.lat    = SU_DEG2RAD(40.4);
+  site.lon    = SU_DEG2RAD(-3.7);
+  site.height = .6;
+
+  for (unsigned int o = 0; o < kOrbitCount; ++o) {
+    sgdp4_prediction_t prediction;
+    std::vector<SUDOUBLE> t(kSampleCount);
+    std::vector<SUBOOL> valid(kSampleCount);
+    Xyz azel(kSampleCount), vel_azel(kSampleCount);
+    xyz_array_t azel_arr = azel.array(), vel_azel_arr = vel_azel.array();
+    unsigned int count, expected = 0;
+
+    SCOPED_TRACE(orbits[o].name);
+
+    for (unsigned int i = 0; i < kSampleCount; ++i)
+      t[i] = t0 + i * 60. * kStepMinutes + .25;
+
+    ASSERT_TRUE(sgdp4_prediction_init(&prediction, orbits + o, &site));
+
+    count = sgdp4_prediction_compute_many(
+      &prediction,
+      t.data(),
+      kSampleCount,
+      &azel_arr,
+      &vel_azel_arr,
+      valid.data());
+
+    for (unsigned int i = 0; i < kSampleCount; ++i) {
+      struct timeval tv;
+      bool ok;
+
+      tv.tv_sec  = static_cast<time_t>(t[i]);
+      tv.tv_usec = static_cast<suseconds_t>(1e6 * (t[i] - tv.tv_sec));
+
+      ok = sgdp4_prediction_update(&prediction, &tv) != SU_FALSE;
+
+      ASSERT_EQ(ok, valid[i] != SU_FALSE) << "t = " << t[i];
+
+      if (!ok)
+        continue;
+
+      ++expected;
+      EXPECT_NEAR(
+        SU_RAD2DEG(prediction.pos_azel.elevation),
+        SU_RAD2DEG(azel.y[i]),
+        kElTolDeg) << "t = " << t[i];
+    }
+
+    EXPECT_EQ(count, expected);
+
+    sgdp4_prediction_finalize(&prediction);
+  }
+}
@@ -620,6 +620,37 @@ cbor_unpack_blob(grow_buf_t *buffer, void **data, size_t *size)
   return sync_buffers(buffer, &tmp);
 }
 
+int
+cbor_unpack_blob_borrow(grow_buf_t *buffer, void **data, size_t *size)
+{
+  uint64_t parsed_len;
+  grow_buf_t tmp;
+  ssize_t ret;
+
+  grow_buf_init_loan(
+      &tmp,
+      grow_buf_current_data(buffer),
+      grow_buf_avail(buffer),
+      grow_buf_avail(buffer));
+
+  ret = unpack_cbor_int(&tmp, CMT_BYTE, &parsed_len);
+  if (ret)
+    return ret;
+
+  if (parsed_len >= SIZE_MAX)
+    return -EOVERFLOW;
+
+  if (parsed_len > grow_buf_avail(&tmp))
+    return -EILSEQ;
+
+  /* No copies: just point to the payload and skip it */
+  *data = parsed_len > 0 ? grow_buf_current_data(&tmp) : NULL;
+  *size = parsed_len;
+
+  grow_buf_seek(&tmp, parsed_len, SEEK_CUR);
+  return sync_buffers(buffer, &tmp);
+}
+
 int
 cbor_unpack_cstr_len(grow_buf_t *buffer, char **str, size_t *len)
 {
@@ -241,6 +241,16 @@ int cbor_unpack_uint(grow_buf_t *buffer, uint64_t *v);
 int cbor_unpack_nint(grow_buf_t *buffer, uint64_t *v);
 int cbor_unpack_int(grow_buf_t *buffer, int64_t *v);
 int cbor_unpack_blob(grow_buf_t *buffer, void **data, size_t *size);
+
+/*
+ * Same as cbor_unpack_blob, but *data is left pointing to the payload
+ * inside the buffer storage, and nothing is allocated or copied. The
+ * pointer is valid as long as the storage of the buffer (or of the
+ * buffer it was loaned from) is neither released nor reallocated. The
+ * payload may be modified in place.
+ */
+int cbor_unpack_blob_borrow(grow_buf_t *buffer, void **data, size_t *size);
+
 int cbor_unpack_cstr_len(grow_buf_t *buffer, char **str,
         size_t *len);
 int cbor_unpack_str(grow_buf_t *buffer, char **str);
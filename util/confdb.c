@@ -17,6 +17,7 @@
 
 */
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sigutils/util/compat-pwd.h>
@@ -24,12 +25,16 @@
 #include <sigutils/util/compat-mman.h>
 #include <sigutils/util/compat-stat.h>
 #include <fcntl.h>
+#include <pthread.h>
 
 #define SU_LOG_DOMAIN "confdb"
 
 #include <sigutils/log.h>
+#include <analyzer/realtime.h>
 #include "confdb.h"
 #include "compat.h"
+#include "cbor.h"
+#include "sha256.h"
 
 PTR_LIST(SUPRIVATE suscan_config_context_t, context);
 
@@ -38,6 +43,19 @@ SUPRIVATE const char *confdb_user_path;
 SUPRIVATE const char *confdb_system_path;
 SUPRIVATE const char *confdb_local_path;
 SUPRIVATE const char *confdb_tle_path;
+SUPRIVATE const char *confdb_cache_path;
+
+SUPRIVATE struct suscan_confdb_stats confdb_stats;
+
+SUPRIVATE pthread_mutex_t confdb_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE pthread_cond_t  confdb_writer_cond  = PTHREAD_COND_INITIALIZER;
+SUPRIVATE pthread_mutex_t confdb_io_mutex     = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE pthread_t       confdb_writer_thread;
+SUPRIVATE SUBOOL          confdb_writer_running;
+SUPRIVATE SUBOOL          confdb_writer_busy;
+SUPRIVATE SUBOOL          confdb_writer_flush_req;
+
+PTR_LIST_PRIVATE(struct suscan_confdb_write, confdb_write);
 
 #ifndef PKGDATADIR
 #  define PKGDATADIR ""
@@ -153,6 +171,91 @@ fail:
   return NULL;
 }
 
+const char *
+suscan_confdb_get_cache_path(void)
+{
+  const char *user_path;
+  char *tmp = NULL;
+
+  if (confdb_cache_path == NULL) {
+    SU_TRYCATCH(user_path = suscan_confdb_get_user_path(), goto fail);
+    SU_TRYCATCH(tmp = strbuild("%s/cache", user_path), goto fail);
+
+    if (access(tmp, F_OK) == -1)
+      SU_TRYCATCH(mkdir(tmp, 0700) != -1, goto fail);
+
+    confdb_cache_path = tmp;
+  }
+
+  return confdb_cache_path;
+
+fail:
+  if (tmp != NULL)
+    free(tmp);
+
+  return NULL;
+}
+
+void
+suscan_confdb_get_stats(struct suscan_confdb_stats *stats)
+{
+  (void) pthread_mutex_lock(&confdb_writer_mutex);
+  *stats = confdb_stats;
+  (void) pthread_mutex_unlock(&confdb_writer_mutex);
+}
+
+/*
+ * Writes to a temporary file next to path and renames it. Readers (and
+ * a crash in the middle of the write) see either the old file or the
+ * new one, never a truncated one. Fails silently if the temporary file
+ * cannot be created, so that callers can try other directories.
+ */
+SUPRIVATE SUBOOL
+suscan_confdb_write_file(const char *path, const void *data, size_t size)
+{
+  char *tmp = NULL;
+  int fd = -1;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(tmp = strbuild("%s.tmp", path));
+
+  if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1)
+    goto done;
+
+  if (write(fd, data, size) != size) {
+    SU_ERROR("Unexpected write error while saving `%s'\n", path);
+    goto done;
+  }
+
+#ifndef _WIN32
+  SU_TRY(fsync(fd) != -1);
+#endif /* _WIN32 */
+
+  close(fd);
+  fd = -1;
+
+#ifdef _WIN32
+  /* Windows does not replace existing files on rename */
+  (void) unlink(path);
+#endif /* _WIN32 */
+
+  SU_TRY(rename(tmp, path) != -1);
+
+  ok = SU_TRUE;
+
+done:
+  if (fd != -1)
+    close(fd);
+
+  if (!ok && tmp != NULL)
+    (void) unlink(tmp);
+
+  if (tmp != NULL)
+    free(tmp);
+
+  return ok;
+}
+
 SUPRIVATE void
 suscan_config_context_destroy(suscan_config_context_t *ctx)
 {
@@ -188,6 +291,9 @@ suscan_config_context_new(const char *name)
   SU_TRYCATCH(new->save_file = strdup(name), goto fail);
   SU_TRYCATCH(new->list = suscan_object_new(SUSCAN_OBJECT_TYPE_SET), goto fail);
 
+  /* Nothing to save yet */
+  suscan_object_clear_dirty(new->list);
+
   new->save = SU_TRUE;
 
   return new;
@@ -293,93 +399,568 @@ suscan_config_context_flush(suscan_config_context_t *context)
     SU_TRYCATCH(suscan_object_set_delete(context->list, i), return);
 }
 
-SUBOOL
-suscan_config_context_scan(suscan_config_context_t *context)
+/*
+ * Config file that each path of a context is loaded from. A context
+ * cache is fresh as long as all these files keep their size and mtime.
+ */
+struct suscan_config_source {
+  char    *path;
+  uint64_t size;  /* 0 if there is nothing to load */
+  int64_t  mtime;
+  SUBOOL   xml;
+};
+
+SUPRIVATE void
+suscan_config_sources_destroy(
+    struct suscan_config_source *sources,
+    unsigned int count)
 {
-  char *path = NULL;
-  unsigned int i, j;
-  int fd = -1;
-  void *mmap_base = (void *) -1;
-  suscan_object_t *set = NULL;
+  unsigned int i;
+
+  for (i = 0; i < count; ++i)
+    if (sources[i].path != NULL)
+      free(sources[i].path);
+
+  free(sources);
+}
+
+SUPRIVATE struct suscan_config_source *
+suscan_config_context_get_sources(const suscan_config_context_t *context)
+{
+  struct suscan_config_source *sources = NULL;
   struct stat sbuf;
-  SUBOOL xml;
-  SUBOOL ok = SU_FALSE;
+  char *path = NULL;
+  unsigned int i;
+
+  SU_TRYCATCH(
+      sources = calloc(
+          context->path_count + 1,
+          sizeof(struct suscan_config_source)),
+      goto fail);
 
   for (i = 0; i < context->path_count; ++i) {
     /* Try to open as YAML */
-    xml = SU_FALSE;
     SU_TRYCATCH(
         path = strbuild("%s/%s.yaml", context->path_list[i], context->save_file),
-        goto done);
+        goto fail);
 
     if (access(path, F_OK) == -1) {
       /* Nope, try to open as XML */
       free(path);
       SU_TRYCATCH(
         path = strbuild("%s/%s.xml", context->path_list[i], context->save_file),
-        goto done);
-      xml = SU_TRUE;
+        goto fail);
+      sources[i].xml = SU_TRUE;
     }
 
     if (stat(path, &sbuf) != -1 && sbuf.st_size > 0) {
-      SU_TRYCATCH((fd = open(path, O_RDONLY)) != -1, goto done);
-
-      SU_TRYCATCH(
-          (mmap_base = mmap(
-              NULL,
-              sbuf.st_size,
-              PROT_READ,
-              MAP_PRIVATE,
-              fd,
-              0)) != (void *) -1,
-          goto done);
-
-      close(fd);
-      fd = -1;
-
-      if (xml)
-        set = suscan_object_from_xml(path, mmap_base, sbuf.st_size);
-      else
-        set = suscan_object_from_yaml(mmap_base, sbuf.st_size);
-
-      if (set != NULL) {
-        for (j = 0; j < set->object_count; ++j)
-          if (set->object_list[j] != NULL) {
-            SU_TRYCATCH(
-                suscan_object_set_append(context->list, set->object_list[j]),
-                goto done);
-            set->object_list[j] = NULL;
-          }
-
-        /* All set. Just destroy this object. */
-        suscan_object_destroy(set);
-        set = NULL;
-      }
+      sources[i].size  = sbuf.st_size;
+      sources[i].mtime = sbuf.st_mtime;
+    }
 
+    sources[i].path = path;
+    path = NULL;
+  }
 
-      munmap(mmap_base, sbuf.st_size);
-      mmap_base = (void *) -1;
-    }
+  return sources;
 
+fail:
+  if (path != NULL)
     free(path);
-    path = NULL;
+
+  if (sources != NULL)
+    suscan_config_sources_destroy(sources, context->path_count);
+
+  return NULL;
+}
+
+SUPRIVATE suscan_object_t *
+suscan_config_source_parse(const struct suscan_config_source *source)
+{
+  int fd = -1;
+  void *mmap_base = (void *) -1;
+  suscan_object_t *set = NULL;
+
+  SU_TRYCATCH((fd = open(source->path, O_RDONLY)) != -1, goto done);
+
+  SU_TRYCATCH(
+      (mmap_base = mmap(
+          NULL,
+          source->size,
+          PROT_READ,
+          MAP_PRIVATE,
+          fd,
+          0)) != (void *) -1,
+      goto done);
+
+  if (source->xml)
+    set = suscan_object_from_xml(source->path, mmap_base, source->size);
+  else
+    set = suscan_object_from_yaml(mmap_base, source->size);
+
+done:
+  if (fd != -1)
+    close(fd);
+
+  if (mmap_base != (void *) -1)
+    munmap(mmap_base, source->size);
+
+  return set;
+}
+
+/****************************** Context cache ********************************/
+/*
+ * The cache file of a context holds the SHA256 digest of the rest of
+ * the file, followed by the magic, the version, the context name, the
+ * time it took to parse the config files, the source list and the
+ * objects loaded from them. Objects are packed recursively as their type,
+ * name and class, and then either their value or the array of their
+ * children. Missing strings and set entries are packed as CBOR nulls.
+ */
+SUPRIVATE char *
+suscan_config_context_get_cache_file(const suscan_config_context_t *context)
+{
+  const char *cache_path;
+
+  if (getenv("SUSCAN_CONFDB_NO_CACHE") != NULL)
+    return NULL;
+
+  if ((cache_path = suscan_confdb_get_cache_path()) == NULL)
+    return NULL;
+
+  return strbuild("%s/%s.cache", cache_path, context->name);
+}
+
+SUPRIVATE SUBOOL
+suscan_config_cache_pack_str(grow_buf_t *buffer, const char *str)
+{
+  if (str == NULL)
+    return cbor_pack_null(buffer) == 0;
+
+  return cbor_pack_str(buffer, str) == 0;
+}
+
+SUPRIVATE SUBOOL
+suscan_config_cache_unpack_str(grow_buf_t *buffer, char **str)
+{
+  *str = NULL;
+
+  if (cbor_unpack_null(buffer) == 0)
+    return SU_TRUE;
+
+  return cbor_unpack_str(buffer, str) == 0;
+}
+
+SUPRIVATE SUBOOL
+suscan_config_cache_pack_object(
+    grow_buf_t *buffer,
+    const suscan_object_t *object)
+{
+  unsigned int i, count;
+  SUBOOL ok = SU_FALSE;
+
+  if (object == NULL)
+    return cbor_pack_null(buffer) == 0;
+
+  SU_TRYZ(cbor_pack_uint(buffer, object->type));
+  SU_TRY(suscan_config_cache_pack_str(buffer, object->name));
+  SU_TRY(suscan_config_cache_pack_str(buffer, object->class_name));
+
+  switch (object->type) {
+    case SUSCAN_OBJECT_TYPE_FIELD:
+      SU_TRY(suscan_config_cache_pack_str(buffer, object->value));
+      break;
+
+    case SUSCAN_OBJECT_TYPE_OBJECT:
+    case SUSCAN_OBJECT_TYPE_SET:
+      count = object->type == SUSCAN_OBJECT_TYPE_SET
+          ? object->object_count
+          : object->field_count;
+
+      SU_TRYZ(cbor_pack_array_start(buffer, count));
+      for (i = 0; i < count; ++i)
+        SU_TRY(
+            suscan_config_cache_pack_object(
+                buffer,
+                object->type == SUSCAN_OBJECT_TYPE_SET
+                ? object->object_list[i]
+                : object->field_list[i]));
+      SU_TRYZ(cbor_pack_array_end(buffer, count));
+      break;
+
+    default:
+      SU_ERROR("Invalid object type %d\n", object->type);
+      goto done;
   }
 
   ok = SU_TRUE;
 
+done:
+  return ok;
+}
+
+SUPRIVATE suscan_object_t *
+suscan_config_cache_unpack_object(grow_buf_t *buffer, unsigned int depth)
+{
+  suscan_object_t *new = NULL;
+  suscan_object_t *child = NULL;
+  uint64_t type, count, i;
+  SUBOOL end_required;
+
+  SU_TRY_FAIL(depth < SUSCAN_CONFDB_CACHE_MAX_DEPTH);
+  SU_TRYZ_FAIL(cbor_unpack_uint(buffer, &type));
+  SU_TRY_FAIL(type <= SUSCAN_OBJECT_TYPE_FIELD);
+
+  SU_MAKE_FAIL(new, suscan_object, type);
+
+  SU_TRY_FAIL(suscan_config_cache_unpack_str(buffer, &new->name));
+  SU_TRY_FAIL(suscan_config_cache_unpack_str(buffer, &new->class_name));
+
+  if (type == SUSCAN_OBJECT_TYPE_FIELD) {
+    SU_TRY_FAIL(suscan_config_cache_unpack_str(buffer, &new->value));
+  } else {
+    SU_TRYZ_FAIL(cbor_unpack_array_start(buffer, &count, &end_required));
+    SU_TRY_FAIL(!end_required);
+
+    for (i = 0; i < count; ++i) {
+      if (cbor_unpack_null(buffer) != 0)
+        SU_TRY_FAIL(
+            child = suscan_config_cache_unpack_object(buffer, depth + 1));
+
+      if (type == SUSCAN_OBJECT_TYPE_SET) {
+        SU_TRY_FAIL(suscan_object_set_append(new, child));
+      } else if (child != NULL) {
+        /* Names were unique when packed, no need to look them up */
+        SU_TRY_FAIL(child->name != NULL);
+        SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(new->field, child));
+      }
+
+      child = NULL;
+    }
+
+    SU_TRYZ_FAIL(cbor_unpack_array_end(buffer, end_required));
+
+    if (type == SUSCAN_OBJECT_TYPE_OBJECT)
+      (void) suscan_object_update_index(new);
+  }
+
+  return new;
+
+fail:
+  if (child != NULL)
+    suscan_object_destroy(child);
+
+  if (new != NULL)
+    suscan_object_destroy(new);
+
+  return NULL;
+}
+
+/* Returns NULL, without complaining, if the cache is missing or stale */
+SUPRIVATE suscan_object_t *
+suscan_config_context_load_cache(
+    const suscan_config_context_t *context,
+    const struct suscan_config_source *sources,
+    uint64_t *parse_time)
+{
+  char *path = NULL;
+  char *str = NULL;
+  int fd = -1;
+  void *mmap_base = (void *) -1;
+  void *digest;
+  size_t digest_size;
+  uint8_t actual[SHA256_BLOCK_SIZE];
+  SHA256_CTX sha;
+  grow_buf_t buffer;
+  struct stat sbuf;
+  uint64_t value, count;
+  int64_t mtime;
+  SUBOOL end_required;
+  unsigned int i;
+  suscan_object_t *set = NULL;
+  suscan_object_t *result = NULL;
+
+  if ((path = suscan_config_context_get_cache_file(context)) == NULL)
+    goto done;
+
+  if ((fd = open(path, O_RDONLY)) == -1)
+    goto done;
+
+  if (fstat(fd, &sbuf) == -1 || sbuf.st_size == 0)
+    goto done;
+
+  SU_TRY(
+      (mmap_base = mmap(
+          NULL,
+          sbuf.st_size,
+          PROT_READ,
+          MAP_PRIVATE,
+          fd,
+          0)) != (void *) -1);
+
+  grow_buf_init_loan(&buffer, mmap_base, sbuf.st_size, sbuf.st_size);
+
+  /* Validate contents */
+  if (cbor_unpack_blob_borrow(&buffer, &digest, &digest_size) != 0
+      || digest_size != SHA256_BLOCK_SIZE)
+    goto done;
+
+  suscan_sha256_init(&sha);
+  suscan_sha256_update(
+      &sha,
+      grow_buf_current_data(&buffer),
+      grow_buf_avail(&buffer));
+  suscan_sha256_final(&sha, actual);
+
+  if (memcmp(digest, actual, SHA256_BLOCK_SIZE) != 0) {
+    SU_WARNING("Config cache `%s' is corrupted, ignoring\n", path);
+    goto done;
+  }
+
+  if (!suscan_config_cache_unpack_str(&buffer, &str)
+      || str == NULL
+      || strcmp(str, SUSCAN_CONFDB_CACHE_MAGIC) != 0)
+    goto done;
+  free(str);
+  str = NULL;
+
+  if (cbor_unpack_uint(&buffer, &value) != 0
+      || value != SUSCAN_CONFDB_CACHE_VERSION)
+    goto done;
+
+  if (!suscan_config_cache_unpack_str(&buffer, &str)
+      || str == NULL
+      || strcmp(str, context->name) != 0)
+    goto done;
+  free(str);
+  str = NULL;
+
+  if (cbor_unpack_uint(&buffer, parse_time) != 0)
+    goto done;
+
+  /* Check freshness */
+  if (cbor_unpack_array_start(&buffer, &count, &end_required) != 0
+      || end_required
+      || count != context->path_count)
+    goto done;
+
+  for (i = 0; i < count; ++i) {
+    if (!suscan_config_cache_unpack_str(&buffer, &str)
+        || str == NULL
+        || strcmp(str, sources[i].path) != 0)
+      goto done;
+    free(str);
+    str = NULL;
+
+    if (cbor_unpack_uint(&buffer, &value) != 0 || value != sources[i].size)
+      goto done;
+
+    if (cbor_unpack_int(&buffer, &mtime) != 0 || mtime != sources[i].mtime)
+      goto done;
+  }
+
+  if (cbor_unpack_array_end(&buffer, end_required) != 0)
+    goto done;
+
+  SU_TRY(set = suscan_config_cache_unpack_object(&buffer, 0));
+  SU_TRY(set->type == SUSCAN_OBJECT_TYPE_SET);
+
+  result = set;
+  set = NULL;
+
 done:
   if (set != NULL)
     suscan_object_destroy(set);
 
-  if (fd != -1)
-    close(fd);
+  if (str != NULL)
+    free(str);
 
   if (mmap_base != (void *) -1)
     munmap(mmap_base, sbuf.st_size);
 
+  if (fd != -1)
+    close(fd);
+
+  if (path != NULL)
+    free(path);
+
+  return result;
+}
+
+SUPRIVATE SUBOOL
+suscan_config_context_save_cache(
+    const suscan_config_context_t *context,
+    const struct suscan_config_source *sources,
+    const suscan_object_t *set,
+    uint64_t parse_time)
+{
+  grow_buf_t header = grow_buf_INITIALIZER;
+  grow_buf_t payload = grow_buf_INITIALIZER;
+  uint8_t digest[SHA256_BLOCK_SIZE];
+  SHA256_CTX sha;
+  char *path = NULL;
+  time_t now = time(NULL);
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  /*
+   * mtimes have a resolution of one second. A file modified within the
+   * last second may still change without changing its mtime: do not
+   * cache it until the next run.
+   */
+  for (i = 0; i < context->path_count; ++i)
+    if (sources[i].size > 0 && sources[i].mtime >= now - 1)
+      return SU_TRUE;
+
+  if ((path = suscan_config_context_get_cache_file(context)) == NULL)
+    return SU_TRUE;
+
+  SU_TRY(suscan_config_cache_pack_str(&payload, SUSCAN_CONFDB_CACHE_MAGIC));
+  SU_TRYZ(cbor_pack_uint(&payload, SUSCAN_CONFDB_CACHE_VERSION));
+  SU_TRY(suscan_config_cache_pack_str(&payload, context->name));
+  SU_TRYZ(cbor_pack_uint(&payload, parse_time));
+
+  SU_TRYZ(cbor_pack_array_start(&payload, context->path_count));
+  for (i = 0; i < context->path_count; ++i) {
+    SU_TRY(suscan_config_cache_pack_str(&payload, sources[i].path));
+    SU_TRYZ(cbor_pack_uint(&payload, sources[i].size));
+    SU_TRYZ(cbor_pack_int(&payload, sources[i].mtime));
+  }
+  SU_TRYZ(cbor_pack_array_end(&payload, context->path_count));
+
+  SU_TRY(suscan_config_cache_pack_object(&payload, set));
+
+  suscan_sha256_init(&sha);
+  suscan_sha256_update(
+      &sha,
+      grow_buf_get_buffer(&payload),
+      grow_buf_get_size(&payload));
+  suscan_sha256_final(&sha, digest);
+
+  SU_TRYZ(cbor_pack_blob(&header, digest, SHA256_BLOCK_SIZE));
+  SU_TRYZ(grow_buf_append_contents(&header, &payload));
+
+  SU_TRY(
+      suscan_confdb_write_file(
+          path,
+          grow_buf_get_buffer(&header),
+          grow_buf_get_size(&header)));
+
+  ok = SU_TRUE;
+
+done:
   if (path != NULL)
     free(path);
 
+  grow_buf_finalize(&header);
+  grow_buf_finalize(&payload);
+
+  return ok;
+}
+
+SUPRIVATE suscan_object_t *
+suscan_config_context_parse(
+    const suscan_config_context_t *context,
+    const struct suscan_config_source *sources)
+{
+  suscan_object_t *loaded = NULL;
+  suscan_object_t *set = NULL;
+  unsigned int i, j;
+
+  SU_MAKE_FAIL(loaded, suscan_object, SUSCAN_OBJECT_TYPE_SET);
+
+  for (i = 0; i < context->path_count; ++i) {
+    if (sources[i].size == 0)
+      continue;
+
+    if ((set = suscan_config_source_parse(sources + i)) != NULL) {
+      for (j = 0; j < set->object_count; ++j)
+        if (set->object_list[j] != NULL) {
+          SU_TRY_FAIL(suscan_object_set_append(loaded, set->object_list[j]));
+          set->object_list[j] = NULL;
+        }
+
+      /* All set. Just destroy this object. */
+      suscan_object_destroy(set);
+      set = NULL;
+    }
+  }
+
+  return loaded;
+
+fail:
+  if (set != NULL)
+    suscan_object_destroy(set);
+
+  if (loaded != NULL)
+    suscan_object_destroy(loaded);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_config_context_scan(suscan_config_context_t *context)
+{
+  struct suscan_config_source *sources = NULL;
+  suscan_object_t *loaded = NULL;
+  uint64_t start, elapsed, parse_time = 0;
+  unsigned int i;
+  SUBOOL was_dirty = suscan_object_is_dirty(context->list);
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(sources = suscan_config_context_get_sources(context));
+
+  start = suscan_gettime_raw();
+  loaded = suscan_config_context_load_cache(context, sources, &parse_time);
+  elapsed = suscan_gettime_raw() - start;
+
+  if (loaded != NULL) {
+    (void) pthread_mutex_lock(&confdb_writer_mutex);
+    ++confdb_stats.cache_hits;
+    confdb_stats.cache_load_time += elapsed;
+    if (parse_time > elapsed)
+      confdb_stats.time_saved += parse_time - elapsed;
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+  } else {
+    (void) pthread_mutex_lock(&confdb_writer_mutex);
+    ++confdb_stats.cache_misses;
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+
+    start = suscan_gettime_raw();
+    SU_TRY(loaded = suscan_config_context_parse(context, sources));
+    parse_time = suscan_gettime_raw() - start;
+
+    start = suscan_gettime_raw();
+    if (!suscan_config_context_save_cache(context, sources, loaded, parse_time))
+      SU_WARNING("Failed to save cache of config context `%s'\n", context->name);
+    elapsed = suscan_gettime_raw() - start;
+
+    /* Stats are shared with the writer thread */
+    (void) pthread_mutex_lock(&confdb_writer_mutex);
+    confdb_stats.parse_time += parse_time;
+    confdb_stats.cache_save_time += elapsed;
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+  }
+
+  for (i = 0; i < loaded->object_count; ++i)
+    if (loaded->object_list[i] != NULL) {
+      SU_TRY(suscan_object_set_append(context->list, loaded->object_list[i]));
+      loaded->object_list[i] = NULL;
+    }
+
+  /* What we just loaded is already on disk */
+  if (!was_dirty)
+    suscan_object_clear_dirty(context->list);
+
+  ok = SU_TRUE;
+
+done:
+  if (loaded != NULL)
+    suscan_object_destroy(loaded);
+
+  if (sources != NULL)
+    suscan_config_sources_destroy(sources, context->path_count);
+
   return ok;
 }
 
@@ -391,67 +972,309 @@ suscan_config_context_set_save(
   ctx->save = save;
 }
 
+/******************************* Persistence *********************************/
 /*
- * TODO: This code is not robust. Save to a temporary file and
- * then move it to the right destination.
+ * Saving is incremental: contexts whose objects are not dirty are not
+ * serialized again. Serialization happens on the caller's thread, as
+ * on_save and the objects belong to it. The resulting YAML may be handed
+ * to a background writer instead of being written on the spot. Pending
+ * writes of the same context are coalesced, and every write carries a
+ * sequence number so that an older snapshot never overwrites a newer one.
  */
+struct suscan_confdb_write {
+  suscan_config_context_t *context;
+  uint64_t seq;
+  void    *data;
+  size_t   size;
+};
+
+SUPRIVATE void
+suscan_confdb_write_destroy(struct suscan_confdb_write *self)
+{
+  if (self->data != NULL)
+    free(self->data);
+
+  free(self);
+}
 
+/* Must be called with confdb_io_mutex held */
 SUPRIVATE SUBOOL
-suscan_config_context_save(suscan_config_context_t *context)
+suscan_config_context_write(
+    suscan_config_context_t *context,
+    uint64_t seq,
+    const void *data,
+    size_t size)
 {
   char *path = NULL;
   unsigned int i;
-  int fd = -1;
-  size_t size;
-  void *data = NULL;
   SUBOOL ok = SU_FALSE;
 
-  if (!context->save)
+  /* A newer snapshot has already been written */
+  if (seq <= context->written_seq)
     return SU_TRUE;
 
-  if (context->on_save != NULL)
-    SU_TRYCATCH((context->on_save)(context, context->userdata), goto done);
-
-  SU_TRYCATCH(suscan_object_to_yaml(context->list, &data, &size), goto done);
-
   for (i = 0; i < context->path_count; ++i) {
-    SU_TRYCATCH(
-        path = strbuild("%s/%s.yaml", context->path_list[i], context->save_file),
-        goto done);
-
-    if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) != -1) {
-      if (write(fd, data, size) != size) {
-        SU_ERROR(
-            "Unexpected write error while saving config context `%s'\n",
-            context->name);
-        goto done;
-      }
+    SU_TRY(
+        path = strbuild("%s/%s.yaml", context->path_list[i], context->save_file));
 
+    if (suscan_confdb_write_file(path, data, size)) {
       ok = SU_TRUE;
-      goto done;
+      break;
     }
 
     free(path);
     path = NULL;
   }
 
-  SU_ERROR(
-      "Couldn't save configuration context `%s': no suitable target directory found\n",
-      context->name);
+  if (!ok)
+    SU_ERROR(
+        "Couldn't save configuration context `%s': no suitable target directory found\n",
+        context->name);
 
 done:
-  if (fd != -1)
-    close(fd);
+  if (ok)
+    context->written_seq = seq;
+
+  /* Make sure the next save serializes it again */
+  context->write_failed = !ok;
 
   if (path != NULL)
     free(path);
 
+  return ok;
+}
+
+/* *data is left to NULL if there is nothing to save */
+SUPRIVATE SUBOOL
+suscan_config_context_snapshot(
+    suscan_config_context_t *context,
+    void **data,
+    size_t *size,
+    uint64_t *seq)
+{
+  SUBOOL failed;
+  SUBOOL ok = SU_FALSE;
+
+  *data = NULL;
+
+  if (!context->save)
+    return SU_TRUE;
+
+  if (context->on_save != NULL)
+    SU_TRY((context->on_save)(context, context->userdata));
+
+  (void) pthread_mutex_lock(&confdb_io_mutex);
+  failed = context->write_failed;
+  (void) pthread_mutex_unlock(&confdb_io_mutex);
+
+  if (!failed && !suscan_object_is_dirty(context->list)) {
+    (void) pthread_mutex_lock(&confdb_writer_mutex);
+    ++confdb_stats.saves_skipped;
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+    return SU_TRUE;
+  }
+
+  SU_TRY(suscan_object_to_yaml(context->list, data, size));
+
+  suscan_object_clear_dirty(context->list);
+  *seq = ++context->save_seq;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_config_context_save(suscan_config_context_t *context)
+{
+  void *data = NULL;
+  size_t size;
+  uint64_t seq;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscan_config_context_snapshot(context, &data, &size, &seq));
+
+  if (data == NULL) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  /* Pending writes of this context are older than this one */
+  (void) pthread_mutex_lock(&confdb_writer_mutex);
+  for (i = 0; i < confdb_write_count; ++i)
+    if (confdb_write_list[i] != NULL
+        && confdb_write_list[i]->context == context) {
+      suscan_confdb_write_destroy(confdb_write_list[i]);
+      confdb_write_list[i] = NULL;
+      ++confdb_stats.saves_coalesced;
+    }
+  ++confdb_stats.saves;
+  (void) pthread_mutex_unlock(&confdb_writer_mutex);
+
+  (void) pthread_mutex_lock(&confdb_io_mutex);
+  ok = suscan_config_context_write(context, seq, data, size);
+  (void) pthread_mutex_unlock(&confdb_io_mutex);
+
+done:
   if (data != NULL)
     free(data);
 
   return ok;
 }
 
+SUPRIVATE void *
+suscan_confdb_writer_thread(void *unused)
+{
+  struct suscan_confdb_write **list;
+  unsigned int i, count;
+  struct timespec ts;
+
+  (void) pthread_mutex_lock(&confdb_writer_mutex);
+
+  for (;;) {
+    while (confdb_write_count == 0)
+      pthread_cond_wait(&confdb_writer_cond, &confdb_writer_mutex);
+
+    /* Give callers some time to coalesce further changes */
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += SUSCAN_CONFDB_WRITE_DELAY_MS / 1000;
+    ts.tv_nsec += (SUSCAN_CONFDB_WRITE_DELAY_MS % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_nsec -= 1000000000;
+      ++ts.tv_sec;
+    }
+
+    while (!confdb_writer_flush_req
+        && pthread_cond_timedwait(
+            &confdb_writer_cond,
+            &confdb_writer_mutex,
+            &ts) == 0);
+
+    list  = confdb_write_list;
+    count = confdb_write_count;
+    confdb_write_list  = NULL;
+    confdb_write_count = 0;
+    confdb_writer_busy = SU_TRUE;
+
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+
+    (void) pthread_mutex_lock(&confdb_io_mutex);
+    for (i = 0; i < count; ++i)
+      if (list[i] != NULL) {
+        if (!suscan_config_context_write(
+            list[i]->context,
+            list[i]->seq,
+            list[i]->data,
+            list[i]->size))
+          SU_WARNING(
+              "Failed to save configuration context `%s'\n",
+              list[i]->context->name);
+        suscan_confdb_write_destroy(list[i]);
+      }
+    (void) pthread_mutex_unlock(&confdb_io_mutex);
+
+    if (list != NULL)
+      free(list);
+
+    (void) pthread_mutex_lock(&confdb_writer_mutex);
+    confdb_writer_busy = SU_FALSE;
+    pthread_cond_broadcast(&confdb_writer_cond);
+  }
+
+  return NULL;
+}
+
+SUBOOL
+suscan_config_context_save_async(suscan_config_context_t *context)
+{
+  struct suscan_confdb_write *req = NULL;
+  SUBOOL mutex_acquired = SU_FALSE;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_ALLOCATE(req, struct suscan_confdb_write);
+
+  req->context = context;
+
+  SU_TRY(
+      suscan_config_context_snapshot(
+          context,
+          &req->data,
+          &req->size,
+          &req->seq));
+
+  if (req->data == NULL) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_TRY(pthread_mutex_lock(&confdb_writer_mutex) == 0);
+  mutex_acquired = SU_TRUE;
+
+  if (!confdb_writer_running) {
+    SU_TRY(
+        pthread_create(
+            &confdb_writer_thread,
+            NULL,
+            suscan_confdb_writer_thread,
+            NULL) == 0);
+    (void) pthread_detach(confdb_writer_thread);
+    confdb_writer_running = SU_TRUE;
+
+    /* Pending writes must reach the disk before the process exits */
+    atexit(suscan_confdb_sync);
+  }
+
+  ++confdb_stats.saves;
+
+  /* Replace the pending write of this context, if any */
+  for (i = 0; i < confdb_write_count; ++i)
+    if (confdb_write_list[i] != NULL
+        && confdb_write_list[i]->context == context) {
+      suscan_confdb_write_destroy(confdb_write_list[i]);
+      confdb_write_list[i] = req;
+      req = NULL;
+      ++confdb_stats.saves_coalesced;
+      break;
+    }
+
+  if (req != NULL) {
+    SU_TRYC(PTR_LIST_APPEND_CHECK(confdb_write, req));
+    req = NULL;
+  }
+
+  pthread_cond_broadcast(&confdb_writer_cond);
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&confdb_writer_mutex);
+
+  if (req != NULL)
+    suscan_confdb_write_destroy(req);
+
+  return ok;
+}
+
+void
+suscan_confdb_sync(void)
+{
+  (void) pthread_mutex_lock(&confdb_writer_mutex);
+
+  confdb_writer_flush_req = SU_TRUE;
+  pthread_cond_broadcast(&confdb_writer_cond);
+
+  while (confdb_write_count > 0 || confdb_writer_busy)
+    pthread_cond_wait(&confdb_writer_cond, &confdb_writer_mutex);
+
+  confdb_writer_flush_req = SU_FALSE;
+
+  (void) pthread_mutex_unlock(&confdb_writer_mutex);
+}
+
 SUBOOL
 suscan_confdb_scan_all(void)
 {
@@ -484,6 +1307,24 @@ suscan_confdb_save_all(void)
   return any_ok;
 }
 
+SUBOOL
+suscan_confdb_save_all_async(void)
+{
+  unsigned int i;
+  SUBOOL any_ok = SU_FALSE;
+
+  for (i = 0; i < context_count; ++i) {
+    if (!suscan_config_context_save_async(context_list[i]))
+      SU_WARNING(
+          "Failed to save configuration context `%s'\n",
+          context_list[i]->name);
+    else
+      any_ok = SU_TRUE;
+  }
+
+  return any_ok;
+}
+
 SUBOOL
 suscan_confdb_use(const char *name)
 {
@@ -33,12 +33,42 @@ const char *suscan_confdb_get_system_path(void);
 const char *suscan_confdb_get_user_path(void);
 const char *suscan_confdb_get_local_path(void);
 const char *suscan_confdb_get_local_tle_path(void);
+const char *suscan_confdb_get_cache_path(void);
+
+/*
+ * Parsed config contexts are cached in binary form (see confdb.c).
+ * The cache is skipped if SUSCAN_CONFDB_NO_CACHE is set.
+ */
+#define SUSCAN_CONFDB_CACHE_MAGIC     "suscan-confdb-cache"
+#define SUSCAN_CONFDB_CACHE_VERSION   1
+#define SUSCAN_CONFDB_CACHE_MAX_DEPTH 64
+
+struct suscan_confdb_stats {
+  unsigned int cache_hits;
+  unsigned int cache_misses;
+  uint64_t     parse_time;      /* Spent parsing config files, in ns */
+  uint64_t     cache_load_time; /* Spent loading caches, in ns */
+  uint64_t     cache_save_time; /* Spent saving caches, in ns */
+  uint64_t     time_saved;      /* Parse time avoided by cache hits, in ns */
+  unsigned int saves;           /* Snapshots handed to the writer */
+  unsigned int saves_skipped;   /* Saves of contexts without changes */
+  unsigned int saves_coalesced; /* Snapshots superseded before being written */
+};
+
+void suscan_confdb_get_stats(struct suscan_confdb_stats *stats);
+
+#define SUSCAN_CONFDB_WRITE_DELAY_MS 500
 
 struct suscan_config_context {
   char *name;
   char *save_file;
   SUBOOL save;
 
+  /* Persistence state, see confdb.c */
+  uint64_t save_seq;
+  uint64_t written_seq;
+  SUBOOL   write_failed;
+
   PTR_LIST(char, path);
 
   suscan_object_t *list;
@@ -98,6 +128,20 @@ SUBOOL suscan_confdb_scan_all(void);
 
 SUBOOL suscan_confdb_save_all(void);
 
+/*
+ * Serialize the contexts that changed and write them to disk from a
+ * background thread, after SUSCAN_CONFDB_WRITE_DELAY_MS. Successive
+ * saves of the same context within that time are written only once.
+ * suscan_confdb_sync() waits for all pending writes to complete. It is
+ * also registered with atexit() when the background writer starts, so
+ * pending writes are not lost on a normal exit.
+ */
+SUBOOL suscan_config_context_save_async(suscan_config_context_t *context);
+
+SUBOOL suscan_confdb_save_all_async(void);
+
+void suscan_confdb_sync(void);
+
 SUBOOL suscan_confdb_use(const char *name);
 
 #ifdef __cplusplus
@@ -23,13 +23,26 @@
 
 #include <sigutils/log.h>
 #include "object.h"
+#include "hashlist.h"
 #include <inttypes.h>
 
+SUPRIVATE void
+suscan_object_drop_index(suscan_object_t *obj)
+{
+  if (obj->field_index != NULL)
+    hashlist_destroy(obj->field_index);
+
+  obj->field_index   = NULL;
+  obj->field_indexed = 0;
+}
+
 void
 suscan_object_destroy(suscan_object_t *obj)
 {
   unsigned int i;
 
+  suscan_object_drop_index(obj);
+
   switch (obj->type) {
     case SUSCAN_OBJECT_TYPE_OBJECT:
       for (i = 0; i < obj->field_count; ++i)
@@ -72,7 +85,8 @@ suscan_object_new(enum suscan_object_type type)
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_object_t)), goto fail);
 
-  new->type = type;
+  new->type  = type;
+  new->dirty = SU_TRUE;
 
   return new;
 
@@ -110,6 +124,8 @@ suscan_object_copy(const suscan_object_t *object)
         SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(new->field, dup));
         dup = NULL;
       }
+
+      (void) suscan_object_update_index(new);
     break;
 
     case SUSCAN_OBJECT_TYPE_SET:
@@ -138,6 +154,81 @@ fail:
   return NULL;
 }
 
+SUPRIVATE SUBOOL
+suscan_object_str_equals(const char *a, const char *b)
+{
+  if (a == NULL || b == NULL)
+    return a == b;
+
+  return strcmp(a, b) == 0;
+}
+
+SUBOOL
+suscan_object_equals(const suscan_object_t *a, const suscan_object_t *b)
+{
+  unsigned int i;
+
+  if (a == b)
+    return SU_TRUE;
+
+  if (a == NULL || b == NULL || a->type != b->type)
+    return SU_FALSE;
+
+  if (!suscan_object_str_equals(a->name, b->name)
+      || !suscan_object_str_equals(a->class_name, b->class_name))
+    return SU_FALSE;
+
+  if (a->type == SUSCAN_OBJECT_TYPE_FIELD)
+    return suscan_object_str_equals(a->value, b->value);
+
+  /* Fields and sets share the same list layout */
+  if (a->object_count != b->object_count)
+    return SU_FALSE;
+
+  for (i = 0; i < a->object_count; ++i)
+    if (!suscan_object_equals(a->object_list[i], b->object_list[i]))
+      return SU_FALSE;
+
+  return SU_TRUE;
+}
+
+void
+suscan_object_touch(suscan_object_t *object)
+{
+  object->dirty = SU_TRUE;
+}
+
+SUBOOL
+suscan_object_is_dirty(const suscan_object_t *object)
+{
+  unsigned int i;
+
+  if (object->dirty)
+    return SU_TRUE;
+
+  /* Fields and sets share the same list layout */
+  if (object->type != SUSCAN_OBJECT_TYPE_FIELD)
+    for (i = 0; i < object->object_count; ++i)
+      if (object->object_list[i] != NULL)
+        if (suscan_object_is_dirty(object->object_list[i]))
+          return SU_TRUE;
+
+  return SU_FALSE;
+}
+
+void
+suscan_object_clear_dirty(suscan_object_t *object)
+{
+  unsigned int i;
+
+  object->dirty = SU_FALSE;
+
+  if (object->type != SUSCAN_OBJECT_TYPE_FIELD)
+    for (i = 0; i < object->object_count; ++i)
+      if (object->object_list[i] != NULL)
+        suscan_object_clear_dirty(object->object_list[i]);
+}
+
 const char *
 suscan_object_get_class(const suscan_object_t *object)
 {
@@ -157,6 +248,7 @@ suscan_object_set_class(suscan_object_t *object, const char *class)
       free(object->class_name);
 
     object->class_name = classdup;
+    object->dirty = SU_TRUE;
   }
 
   return SU_TRUE;
@@ -181,6 +273,7 @@ suscan_object_set_name(suscan_object_t *object, const char *name)
       free(object->name);
 
     object->name = namedup;
+    object->dirty = SU_TRUE;
   }
 
   return SU_TRUE;
@@ -193,13 +286,77 @@ suscan_object_get_type(const suscan_object_t *object)
 }
 
 
+/*
+ * Adds the fields appended since the last update to the index, building it
+ * once the object has grown past SUSCAN_OBJECT_INDEX_THRESHOLD. If the same
+ * name appears more than once, the first one wins, as in the linear search.
+ * Fields are expected not to be renamed after insertion.
+ */
+SUBOOL
+suscan_object_update_index(suscan_object_t *object)
+{
+  const char *name;
+  uintptr_t pos;
+  unsigned int i;
+
+  SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_OBJECT, return SU_FALSE);
+
+  if (object->field_index == NULL) {
+    if (object->field_count < SUSCAN_OBJECT_INDEX_THRESHOLD)
+      return SU_TRUE;
+
+    SU_MAKE_FAIL(object->field_index, hashlist);
+    object->field_indexed = 0;
+  }
+
+  for (i = object->field_indexed; i < object->field_count; ++i) {
+    if (object->field_list[i] == NULL)
+      continue;
+
+    name = object->field_list[i]->name;
+    pos  = (uintptr_t) hashlist_get(object->field_index, name);
+
+    /* Names of removed fields are taken over by the new ones */
+    if (pos == 0 || object->field_list[pos - 1] == NULL)
+      SU_TRY_FAIL(
+          hashlist_set(
+              object->field_index,
+              name,
+              (void *) (uintptr_t) (i + 1)));
+  }
+
+  object->field_indexed = object->field_count;
+
+  return SU_TRUE;
+
+fail:
+  suscan_object_drop_index(object);
+
+  return SU_FALSE;
+}
+
 suscan_object_t **
 suscan_object_lookup(const suscan_object_t *object, const char *name)
 {
+  uintptr_t pos;
   unsigned int i;
 
   SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_OBJECT, return NULL);
 
+  /*
+   * Lookups never touch the index, so that concurrent readers are safe.
+   * It is maintained by the functions that add fields, and if it is
+   * missing or stale we just fall back to linear search.
+   */
+  if (object->field_index != NULL
+      && object->field_indexed == object->field_count) {
+    pos = (uintptr_t) hashlist_get(object->field_index, name);
+    if (pos == 0 || object->field_list[pos - 1] == NULL)
+      return NULL;
+
+    return object->field_list + pos - 1;
+  }
+
   for (i = 0; i < object->field_count; ++i)
     if (object->field_list[i] != NULL)
       if (strcmp(object->field_list[i]->name, name) == 0)
@@ -227,11 +384,17 @@ suscan_object_set_field(
     if (*entry != new) {
       suscan_object_destroy(*entry);
       *entry = new;
+      object->dirty = SU_TRUE;
     }
   } else if (new != NULL) {
     SU_TRYCATCH(
         PTR_LIST_APPEND_CHECK(object->field, new) != -1,
         return SU_FALSE);
+
+    object->dirty = SU_TRUE;
+
+    /* On failure, lookups just fall back to linear search */
+    (void) suscan_object_update_index(object);
   }
 
   return SU_TRUE;
@@ -268,6 +431,9 @@ suscan_object_clear_fields(suscan_object_t *object)
 
   object->field_list = NULL;
   object->field_count = 0;
+  object->dirty = SU_TRUE;
+
+  suscan_object_drop_index(object);
 
   return SU_TRUE;
 }
@@ -289,6 +455,12 @@ suscan_object_set_value(
 
   SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_FIELD, return SU_FALSE);
 
+  /* Rewriting the same value is common, and must not dirty the object */
+  if (value != NULL
+      && object->value != NULL
+      && strcmp(value, object->value) == 0)
+    return SU_TRUE;
+
   if (value != object->value) {
     if (value != NULL)
       SU_TRYCATCH(valuedup = strdup(value), return SU_FALSE);
@@ -297,6 +469,7 @@ suscan_object_set_value(
       free(object->value);
 
     object->value = valuedup;
+    object->dirty = SU_TRUE;
   }
 
   return SU_TRUE;
@@ -634,10 +807,13 @@ suscan_object_set_put(
   SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_SET, return SU_FALSE);
   SU_TRYCATCH(index < object->object_count, return SU_FALSE);
 
-  if (object->object_list[index] != NULL && new != object->object_list[index])
-    suscan_object_destroy(object->object_list[index]);
+  if (new != object->object_list[index]) {
+    if (object->object_list[index] != NULL)
+      suscan_object_destroy(object->object_list[index]);
 
-  object->object_list[index] = new;
+    object->object_list[index] = new;
+    object->dirty = SU_TRUE;
+  }
 
   return SU_TRUE;
 }
@@ -657,6 +833,8 @@ suscan_object_set_append(suscan_object_t *object, suscan_object_t *new)
       PTR_LIST_APPEND_CHECK(object->object, new) != -1,
       return SU_FALSE);
 
+  object->dirty = SU_TRUE;
+
   return SU_TRUE;
 }
 
@@ -676,6 +854,7 @@ suscan_object_set_clear(suscan_object_t *object)
 
   object->object_list = NULL;
   object->object_count = 0;
+  object->dirty = SU_TRUE;
 
   return SU_TRUE;
 }
@@ -29,6 +29,15 @@ extern "C" {
 
 #define SUSCAN_YAML_PFX "tag:actinid.org,2022:suscan:"
 
+/*
+ * Objects with at least this many fields get a hash index of their
+ * field names, built when a field insertion crosses the threshold.
+ * Lookups only read the index, so objects are safe to read concurrently.
+ */
+#define SUSCAN_OBJECT_INDEX_THRESHOLD 16
+
+struct hashlist;
+
 enum suscan_object_type {
   SUSCAN_OBJECT_TYPE_OBJECT,
   SUSCAN_OBJECT_TYPE_SET,
@@ -50,6 +59,11 @@ struct suscan_object {
       PTR_LIST(struct suscan_object, object);
     };
   };
+
+  struct hashlist *field_index;   /* Name -> position + 1. May be NULL */
+  unsigned int     field_indexed; /* Fields of field_list in field_index */
+
+  SUBOOL dirty; /* Modified since the last suscan_object_clear_dirty() */
 };
 
 typedef struct suscan_object suscan_object_t;
@@ -77,8 +91,24 @@ suscan_object_t *suscan_object_new(enum suscan_object_type type);
 
 suscan_object_t *suscan_object_copy(const suscan_object_t *object);
 
+/* Deep comparison of names, classes, values and children (in order) */
+SUBOOL suscan_object_equals(
+    const suscan_object_t *a,
+    const suscan_object_t *b);
+
 void suscan_object_destroy(suscan_object_t *object);
 
+/*
+ * Dirty tracking. New objects are dirty, and so is any object modified
+ * through this API. An object is dirty if itself or any of its children
+ * is dirty.
+ */
+void suscan_object_touch(suscan_object_t *object);
+
+SUBOOL suscan_object_is_dirty(const suscan_object_t *object);
+
+void suscan_object_clear_dirty(suscan_object_t *object);
+
 const char *suscan_object_get_class(const suscan_object_t *object);
 
 SUBOOL suscan_object_set_class(
@@ -94,6 +124,9 @@ suscan_object_t *suscan_object_get_field(
 
 SUBOOL suscan_object_clear_fields(suscan_object_t *object);
 
+/* Indexes fields appended directly to field_list */
+SUBOOL suscan_object_update_index(suscan_object_t *object);
+
 SUBOOL suscan_object_set_field(
     suscan_object_t *object,
     const char *name,